@@ -0,0 +1,1414 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "grafo.h"
+
+//------------------------------------------------------------------------------
+// suíte de medidas de desempenho reproduzível
+//
+// gera grafos sintéticos de várias famílias e tamanhos com uma semente fixa,
+// mede cada função pública da biblioteca e escreve os resultados em JSON na
+// saída padrão: tempo, nanossegundos por aresta, número de alocações e bytes
+// alocados durante a chamada e o pico de memória residente do processo
+//
+// uso: benchmark [experimento] [escala] [semente]
+//
+//   experimento: funcoes, reparo, compactacao, externo, aproximacao, filas,
+//   largura, fortes, retomada ou todos (o padrão)
+//   escala: os grafos têm de 2^8 a 2^escala vértices (14 por padrão)
+//   semente: semente dos geradores (42 por padrão)
+
+/* Funções cujo custo estimado passa deste número de operações não são
+   medidas no tamanho correspondente */
+#define LIMITE_OPERACOES 2e9
+
+/* Número de consultas (alcancavel, distancia) e de alterações
+   (insere_aresta, remove_aresta) medidas por grafo */
+#define N_CONSULTAS 1024
+
+/* Tamanho do lote de atualiza_distancias */
+#define TAMANHO_LOTE 16
+
+/* Orçamento de memória residente das arestas em disco (1MB) */
+#define ORCAMENTO_EXTERNO (1 << 20)
+
+/* Número de fontes de amostra_distancias e de bits dos contadores de
+   funcao_vizinhanca comparados com as distâncias exatas */
+#define FONTES_AMOSTRA 64
+#define BITS_VIZINHANCA 8
+
+/* Maior escala dos grafos em que as filas de prioridade de Dijkstra são
+   comparadas (o diâmetro faz uma busca a partir de cada vértice) */
+#define ESCALA_FILAS 12
+
+/* Número de fontes das buscas em largura medidas e fator de arestas dos
+   grafos R-MAT (arestas por vértice, como no Graph500) */
+#define FONTES_LARGURA 16
+#define FATOR_LARGURA 16
+
+/* Maior escala dos grafos em que a retomada (cria_controle com arquivo) é
+   medida: distancias guarda uma aresta por par alcançável */
+#define ESCALA_RETOMADA 11
+
+#ifdef __GLIBC__
+/* Contagem de alocações: o programa substitui malloc, calloc e realloc da
+   glibc por versões que contam as chamadas e os bytes pedidos (inclusive as
+   feitas pela biblioteca e pela cgraph) */
+extern void *__libc_malloc(size_t tamanho);
+extern void *__libc_calloc(size_t n, size_t tamanho);
+extern void *__libc_realloc(void *p, size_t tamanho);
+
+static unsigned long alocacoes, bytes_alocados;
+
+void *malloc(size_t tamanho) {
+  __atomic_add_fetch(&alocacoes, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&bytes_alocados, tamanho, __ATOMIC_RELAXED);
+  return __libc_malloc(tamanho);
+}
+
+void *calloc(size_t n, size_t tamanho) {
+  __atomic_add_fetch(&alocacoes, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&bytes_alocados, n * tamanho, __ATOMIC_RELAXED);
+  return __libc_calloc(n, tamanho);
+}
+
+void *realloc(void *p, size_t tamanho) {
+  __atomic_add_fetch(&alocacoes, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&bytes_alocados, tamanho, __ATOMIC_RELAXED);
+  return __libc_realloc(p, tamanho);
+}
+#else
+static unsigned long alocacoes, bytes_alocados;
+#endif
+
+/* Custo estimado de uma função em função de V e E */
+enum custo { LINEAR, V_E, V_V, V_V_E };
+
+/* Tipo de grafo exigido por uma função */
+enum exige { QUALQUER, DIRECIONADO, NAO_DIRECIONADO };
+
+/* Estado compartilhado pelas funções medidas num mesmo grafo */
+struct contexto {
+  grafo g;
+  vertice *u, *v;
+  long int *peso;
+  tabela_distancias tabela;
+  FILE *nulo;
+  long int resultado;
+};
+
+struct funcao {
+  const char *nome;
+  enum custo custo;
+  enum exige exige;
+  unsigned int repeticoes;
+  void (*executa)(struct contexto *c);
+};
+
+struct medida {
+  double inicio;
+  unsigned long alocacoes;
+  unsigned long bytes;
+};
+
+static int primeiro_resultado = 1;
+
+//------------------------------------------------------------------------------
+static double agora(void) {
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+//------------------------------------------------------------------------------
+static long int rss_maximo(void) {
+  struct rusage uso;
+
+  getrusage(RUSAGE_SELF, &uso);
+  return uso.ru_maxrss;
+}
+
+//------------------------------------------------------------------------------
+static void comeca(struct medida *m) {
+  m->alocacoes = __atomic_load_n(&alocacoes, __ATOMIC_RELAXED);
+  m->bytes = __atomic_load_n(&bytes_alocados, __ATOMIC_RELAXED);
+  m->inicio = agora();
+}
+
+//------------------------------------------------------------------------------
+static void abre_resultado(const char *experimento) {
+  fprintf(stdout, "%s\n    {\"experimento\": \"%s\"", primeiro_resultado ? "" : ",", experimento);
+  primeiro_resultado = 0;
+}
+
+//------------------------------------------------------------------------------
+static void fecha_resultado(void) {
+  fprintf(stdout, "}");
+  fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+static void relata(const char *familia, grafo g, const char *funcao, struct medida *m, unsigned int repeticoes) {
+  double segundos;
+  unsigned int arestas;
+
+  segundos = agora() - m->inicio;
+  arestas = n_arestas(g);
+
+  abre_resultado("funcoes");
+  fprintf(stdout, ", \"familia\": \"%s\", \"direcionado\": %d, \"vertices\": %u, \"arestas\": %u", familia, direcionado(g), n_vertices(g), arestas);
+  fprintf(stdout, ", \"funcao\": \"%s\", \"repeticoes\": %u, \"segundos\": %.9f", funcao, repeticoes, segundos);
+  fprintf(stdout, ", \"ns_por_aresta\": %.3f", segundos * 1e9 / repeticoes / (arestas ? arestas : 1));
+  fprintf(stdout, ", \"alocacoes\": %lu, \"bytes_alocados\": %lu", __atomic_load_n(&alocacoes, __ATOMIC_RELAXED) - m->alocacoes, __atomic_load_n(&bytes_alocados, __ATOMIC_RELAXED) - m->bytes);
+  fprintf(stdout, ", \"rss_maximo_kb\": %ld", rss_maximo());
+  fecha_resultado();
+}
+
+//------------------------------------------------------------------------------
+static void _escreve_grafo(struct contexto *c) {
+  escreve_grafo(c->nulo, c->g);
+}
+
+static void _le_grafo(struct contexto *c) {
+  FILE *f;
+
+  /* A medida inclui a escrita do arquivo temporário, que pode ser
+     descontada com a de escreve_grafo */
+  if((f = tmpfile()) != NULL) {
+    escreve_grafo(f, c->g);
+    rewind(f);
+    destroi_grafo(le_grafo(f));
+    fclose(f);
+  }
+}
+
+static void _n_arestas(struct contexto *c) {
+  c->resultado = n_arestas(c->g);
+}
+
+static void _conexo(struct contexto *c) {
+  c->resultado = conexo(c->g);
+}
+
+static void _componentes(struct contexto *c) {
+  destroi_lista(componentes(c->g), destroi_grafo);
+}
+
+static void _arvore_geradora_minima(struct contexto *c) {
+  destroi_grafo(arvore_geradora_minima(c->g));
+}
+
+static void _ordena(struct contexto *c) {
+  lista l;
+
+  if((l = ordena(c->g)) != NULL) {
+    destroi_lista(l, NULL);
+  }
+}
+
+static void _fortemente_conexo(struct contexto *c) {
+  c->resultado = fortemente_conexo(c->g);
+}
+
+static void _alcancavel(struct contexto *c) {
+  unsigned int i;
+
+  for(i = 0; i < N_CONSULTAS; ++i) {
+    c->resultado += alcancavel(c->g, c->u[i], c->v[i]);
+  }
+}
+
+static void _arborescencia_caminhos_minimos(struct contexto *c) {
+  destroi_grafo(arborescencia_caminhos_minimos(c->g, c->u[0]));
+}
+
+static void _distancias(struct contexto *c) {
+  destroi_grafo(distancias(c->g));
+}
+
+static void _percorre_distancias(struct contexto *c) {
+  struct resumo_distancias r;
+
+  r.excentricidade = NULL;
+  c->resultado = percorre_distancias(c->g, NULL, &r, 0, NULL) ? r.diametro : -1;
+}
+
+static void _diametro(struct contexto *c) {
+  c->resultado = diametro(c->g);
+}
+
+static void _calcula_distancias(struct contexto *c) {
+  if(c->tabela != NULL) {
+    destroi_tabela_distancias(c->tabela);
+  }
+
+  c->tabela = calcula_distancias(c->g);
+}
+
+static void _distancia(struct contexto *c) {
+  unsigned int i;
+
+  if(c->tabela != NULL) {
+    for(i = 0; i < N_CONSULTAS; ++i) {
+      c->resultado += distancia(c->tabela, c->u[i], c->v[i]);
+    }
+  }
+}
+
+static void _atualiza_distancias(struct contexto *c) {
+  if(c->tabela != NULL) {
+    atualiza_distancias(c->tabela, TAMANHO_LOTE, c->u, c->v, c->peso);
+  }
+}
+
+static void _insere_aresta(struct contexto *c) {
+  unsigned int i;
+
+  for(i = 0; i < N_CONSULTAS; ++i) {
+    insere_aresta(c->g, c->u[i], c->v[i], c->peso[i]);
+  }
+}
+
+static void _remove_aresta(struct contexto *c) {
+  unsigned int i;
+
+  for(i = 0; i < N_CONSULTAS; ++i) {
+    remove_aresta(c->g, c->u[i], c->v[i]);
+  }
+}
+
+static void _insere_remove_vertice(struct contexto *c) {
+  /* insere_vertice pode mover os vértices na memória: esta é a última
+     função medida em cada grafo */
+  remove_vertice(c->g, insere_vertice(c->g, "novo"));
+}
+
+/* Funções medidas, na ordem de execução; as que dependem de estado
+   (tabela de distâncias, alterações) vêm depois das que o criam */
+static struct funcao funcoes[] = {
+  { "escreve_grafo", LINEAR, QUALQUER, 1, _escreve_grafo },
+  { "le_grafo", V_E, QUALQUER, 1, _le_grafo },
+  { "n_arestas", LINEAR, QUALQUER, 1, _n_arestas },
+  { "conexo", LINEAR, NAO_DIRECIONADO, 1, _conexo },
+  { "componentes", V_E, NAO_DIRECIONADO, 1, _componentes },
+  { "arvore_geradora_minima", V_E, NAO_DIRECIONADO, 1, _arvore_geradora_minima },
+  { "ordena", LINEAR, DIRECIONADO, 1, _ordena },
+  { "fortemente_conexo", LINEAR, DIRECIONADO, 1, _fortemente_conexo },
+  { "alcancavel", LINEAR, QUALQUER, N_CONSULTAS, _alcancavel },
+  { "arborescencia_caminhos_minimos", V_E, QUALQUER, 1, _arborescencia_caminhos_minimos },
+  { "distancias", V_V_E, QUALQUER, 1, _distancias },
+  { "percorre_distancias", V_V_E, QUALQUER, 1, _percorre_distancias },
+  { "diametro", V_V_E, QUALQUER, 1, _diametro },
+  { "calcula_distancias", V_V, QUALQUER, 1, _calcula_distancias },
+  { "distancia", V_V, QUALQUER, N_CONSULTAS, _distancia },
+  { "atualiza_distancias", V_V, QUALQUER, 1, _atualiza_distancias },
+  { "insere_aresta", LINEAR, QUALQUER, N_CONSULTAS, _insere_aresta },
+  { "remove_aresta", LINEAR, QUALQUER, N_CONSULTAS, _remove_aresta },
+  { "insere_remove_vertice", LINEAR, QUALQUER, 1, _insere_remove_vertice },
+  { NULL, LINEAR, QUALQUER, 0, NULL }
+};
+
+//------------------------------------------------------------------------------
+static double custo_estimado(enum custo custo, double v, double e) {
+  switch(custo) {
+    case LINEAR: return v + e;
+    case V_E: return v * (v + e);
+    case V_V: return v * (v + e) * 4;
+    default: return v * v * (v + e);
+  }
+}
+
+//------------------------------------------------------------------------------
+// os grafos dos experimentos não guardam resultados (veja
+// define_memoria_resultados): as repetições de uma função sobre o mesmo
+// grafo medem o cálculo, e não a consulta ao resultado guardado
+
+static grafo sem_guardados(grafo g) {
+  if(g != NULL) {
+    define_memoria_resultados(g, 0);
+  }
+
+  return g;
+}
+
+//------------------------------------------------------------------------------
+static grafo gera_familia(const char *familia, unsigned int escala, unsigned int semente) {
+  unsigned int n, lado;
+
+  n = 1u << escala;
+  lado = 1u << (escala / 2);
+
+  if(strcmp(familia, "erdos_renyi") == 0) {
+    return sem_guardados(gera_erdos_renyi(n, 4 * n, 1, 1, semente));
+  } else if(strcmp(familia, "erdos_renyi_nao_direcionado") == 0) {
+    return sem_guardados(gera_erdos_renyi(n, 4 * n, 0, 1, semente));
+  } else if(strcmp(familia, "rmat") == 0) {
+    return sem_guardados(gera_rmat(escala, 8 * n, 1, 1, semente));
+  } else if(strcmp(familia, "grade") == 0) {
+    return sem_guardados(gera_grade(lado, n / lado, 1, semente));
+  } else if(strcmp(familia, "caminho") == 0) {
+    return sem_guardados(gera_caminho(n, 0, 0, semente));
+  } else if(strcmp(familia, "arvore") == 0) {
+    return sem_guardados(gera_arvore(n, 1, semente));
+  } else if(strcmp(familia, "dag") == 0) {
+    return sem_guardados(gera_dag(n, 4 * n, 1, semente));
+  }
+
+  return NULL;
+}
+
+static const char *familias[] = {
+  "erdos_renyi", "erdos_renyi_nao_direcionado", "rmat", "grade", "caminho", "arvore", "dag", NULL
+};
+
+//------------------------------------------------------------------------------
+static void sorteia_vertices(grafo g, struct contexto *c, unsigned int semente) {
+  char nome_vertice[16];
+  unsigned int i;
+
+  srand(semente);
+
+  for(i = 0; i < N_CONSULTAS; ++i) {
+    sprintf(nome_vertice, "v%u", (unsigned int) rand() % n_vertices(g));
+    c->u[i] = busca_vertice(g, nome_vertice);
+    sprintf(nome_vertice, "v%u", (unsigned int) rand() % n_vertices(g));
+    c->v[i] = busca_vertice(g, nome_vertice);
+    c->peso[i] = 1 + rand() % 100;
+  }
+}
+
+//------------------------------------------------------------------------------
+// confere que percorre_distancias escreve exatamente o que escreve_grafo
+// escreve para distancias(g): os vértices em ordem, o nome (null) do grafo
+// de distâncias e os destinos de cada linha em ordem crescente
+
+static void confere_saida_distancias(const char *familia, grafo g) {
+  FILE *f;
+  grafo d;
+  char *percorrida, *escrita;
+  size_t tamanho_percorrida, tamanho_escrita;
+  int mesma;
+
+  percorrida = escrita = NULL;
+  tamanho_percorrida = tamanho_escrita = 0;
+
+  if((f = open_memstream(&percorrida, &tamanho_percorrida)) != NULL) {
+    percorre_distancias(g, f, NULL, 0, NULL);
+    fclose(f);
+  }
+
+  if((d = distancias(g)) != NULL && (f = open_memstream(&escrita, &tamanho_escrita)) != NULL) {
+    escreve_grafo(f, d);
+    fclose(f);
+  }
+
+  mesma = percorrida != NULL && escrita != NULL && tamanho_percorrida == tamanho_escrita && memcmp(percorrida, escrita, tamanho_escrita) == 0;
+
+  abre_resultado("saida_distancias");
+  fprintf(stdout, ", \"familia\": \"%s\", \"vertices\": %u, \"bytes\": %lu, \"mesma_saida\": %d", familia, n_vertices(g), (unsigned long) tamanho_escrita, mesma);
+  fecha_resultado();
+
+  destroi_grafo(d);
+  free(percorrida);
+  free(escrita);
+}
+
+//------------------------------------------------------------------------------
+// confere que escreve_grafo escreve as n - 1 arestas da árvore geradora
+// mínima de um grafo conexo de n vértices, cada uma a partir da ponta de
+// menor índice, que também a tem na sua lista
+
+static void confere_saida_arvore(const char *familia, grafo g) {
+  FILE *f;
+  grafo t;
+  char *escrita, *p;
+  size_t tamanho;
+  unsigned int escritas;
+
+  escrita = NULL;
+  escritas = 0;
+
+  if((t = arvore_geradora_minima(g)) == NULL) {
+    return;
+  }
+
+  if((f = open_memstream(&escrita, &tamanho)) != NULL) {
+    escreve_grafo(f, t);
+    fclose(f);
+  }
+
+  for(p = escrita; p != NULL && (p = strstr(p, " -- ")) != NULL; p += 4) {
+    ++escritas;
+  }
+
+  abre_resultado("saida_arvore");
+  fprintf(stdout, ", \"familia\": \"%s\", \"vertices\": %u, \"arestas_escritas\": %u, \"arestas\": %u", familia, n_vertices(g), escritas, n_arestas(t));
+  fprintf(stdout, ", \"todas_escritas\": %d", escritas + 1 == n_vertices(g) && n_arestas(t) + 1 == n_vertices(g));
+  fecha_resultado();
+
+  destroi_grafo(t);
+  free(escrita);
+}
+
+//------------------------------------------------------------------------------
+// mede cada função pública em cada família de grafos, de 2^8 a 2^escala
+// vértices, pulando as combinações caras demais; a saída de
+// percorre_distancias e a da árvore geradora mínima são conferidas onde
+// elas são medidas
+
+static void mede_funcoes(unsigned int escala_maxima, unsigned int semente) {
+  struct contexto c;
+  struct medida m;
+  struct funcao *f;
+  unsigned int i, escala;
+
+  c.u = (vertice *) malloc(sizeof(vertice) * N_CONSULTAS);
+  c.v = (vertice *) malloc(sizeof(vertice) * N_CONSULTAS);
+  c.peso = (long int *) malloc(sizeof(long int) * N_CONSULTAS);
+  c.nulo = fopen("/dev/null", "w");
+
+  if(c.u == NULL || c.v == NULL || c.peso == NULL || c.nulo == NULL) {
+    fprintf(stderr, "erro de alocação\n");
+    exit(1);
+  }
+
+  for(escala = 8; escala <= escala_maxima; escala += 2) {
+    for(i = 0; familias[i] != NULL; ++i) {
+      comeca(&m);
+
+      if((c.g = gera_familia(familias[i], escala, semente)) == NULL) {
+        fprintf(stderr, "erro ao gerar %s com 2^%u vértices\n", familias[i], escala);
+        continue;
+      }
+
+      relata(familias[i], c.g, "gera", &m, 1);
+      fprintf(stderr, "%s: %u vértices, %u arestas\n", familias[i], n_vertices(c.g), n_arestas(c.g));
+
+      sorteia_vertices(c.g, &c, semente);
+      c.tabela = NULL;
+      c.resultado = 0;
+
+      for(f = funcoes; f->nome != NULL; ++f) {
+        if((f->exige == DIRECIONADO && !direcionado(c.g)) || (f->exige == NAO_DIRECIONADO && direcionado(c.g))) {
+          continue;
+        }
+
+        if(custo_estimado(f->custo, n_vertices(c.g), n_arestas(c.g)) > LIMITE_OPERACOES) {
+          continue;
+        }
+
+        comeca(&m);
+        f->executa(&c);
+        relata(familias[i], c.g, f->nome, &m, f->repeticoes);
+
+        if(f->executa == _percorre_distancias) {
+          confere_saida_distancias(familias[i], c.g);
+        } else if(f->executa == _arvore_geradora_minima) {
+          confere_saida_arvore(familias[i], c.g);
+        }
+      }
+
+      if(c.tabela != NULL) {
+        destroi_tabela_distancias(c.tabela);
+      }
+
+      destroi_grafo(c.g);
+    }
+  }
+
+  fclose(c.nulo);
+  free(c.u);
+  free(c.v);
+  free(c.peso);
+}
+
+//------------------------------------------------------------------------------
+// compara o reparo da tabela de distâncias (atualiza_distancias) com o seu
+// recálculo completo (calcula_distancias) numa grade ponderada, para lotes de
+// alterações de pesos de vários tamanhos, e confere que o diâmetro guardado
+// em g antes de cada lote não sobrevive às alterações e que a tabela reparada
+// é igual à recalculada, mesmo com uma aresta alterada duas vezes no lote
+
+static long int maior_distancia(grafo g, tabela_distancias t, vertice *vertices) {
+  unsigned int i, j;
+  long int d, maior;
+
+  for(i = 0, maior = 0; i < n_vertices(g); ++i) {
+    for(j = 0; j < n_vertices(g); ++j) {
+      if((d = distancia(t, vertices[i], vertices[j])) != infinito && d > maior) {
+        maior = d;
+      }
+    }
+  }
+
+  return maior;
+}
+
+static int mesma_tabela(grafo g, tabela_distancias t, tabela_distancias recalculada, vertice *vertices) {
+  unsigned int i, j;
+
+  for(i = 0; i < n_vertices(g); ++i) {
+    for(j = 0; j < n_vertices(g); ++j) {
+      if(distancia(t, vertices[i], vertices[j]) != distancia(recalculada, vertices[i], vertices[j])) {
+        return 0;
+      }
+    }
+  }
+
+  return 1;
+}
+
+static void mede_reparo(unsigned int escala_maxima, unsigned int semente) {
+  struct grafo *g;
+  struct tabela_distancias *t, *recalculada;
+  struct vertice **u, **v, **vertices;
+  long int *peso, d;
+  char nome_vertice[16];
+  unsigned int lado, i, k, tamanho_lote;
+  double inicio, reparo, recalculo;
+
+  /* A tabela tem V^2 entradas: a grade fica em no máximo 2^12 vértices */
+  lado = 1u << (((escala_maxima < 12) ? escala_maxima : 12) / 2);
+  srand(semente);
+
+  g = gera_grade(lado, lado, 1, semente);
+  t = (g != NULL) ? calcula_distancias(g) : NULL;
+
+  u = (vertice *) malloc(sizeof(vertice) * 1025);
+  v = (vertice *) malloc(sizeof(vertice) * 1025);
+  peso = (long int *) malloc(sizeof(long int) * 1025);
+  vertices = (vertice *) malloc(sizeof(vertice) * lado * lado);
+
+  if(t == NULL || u == NULL || v == NULL || peso == NULL || vertices == NULL) {
+    fprintf(stderr, "erro ao gerar a grade\n");
+    exit(1);
+  }
+
+  for(i = 0; i < lado * lado; ++i) {
+    sprintf(nome_vertice, "v%u", i);
+    vertices[i] = busca_vertice(g, nome_vertice);
+  }
+
+  for(tamanho_lote = 1; tamanho_lote <= 1024; tamanho_lote *= 4) {
+    /* Sorteia alterações de peso em arestas da grade (sempre entre
+       vizinhos na mesma linha) */
+    for(k = 0; k < tamanho_lote; ++k) {
+      i = rand() % (lado * lado);
+
+      if(i % lado == lado - 1) {
+        --i;
+      }
+
+      sprintf(nome_vertice, "v%u", i);
+      u[k] = busca_vertice(g, nome_vertice);
+      sprintf(nome_vertice, "v%u", i + 1);
+      v[k] = busca_vertice(g, nome_vertice);
+      peso[k] = 1 + rand() % 100;
+    }
+
+    /* A primeira aresta do lote é alterada de novo no fim, no sentido
+       inverso e com outro peso: vale o último */
+    u[tamanho_lote] = v[0];
+    v[tamanho_lote] = u[0];
+    peso[tamanho_lote] = peso[0] + 1 + rand() % 100;
+
+    /* O diâmetro fica guardado em g e tem de ser descartado pelo lote */
+    diametro(g);
+
+    inicio = agora();
+    atualiza_distancias(t, tamanho_lote + 1, u, v, peso);
+    reparo = agora() - inicio;
+
+    inicio = agora();
+    recalculada = calcula_distancias(g);
+    recalculo = agora() - inicio;
+    d = diametro(g);
+
+    abre_resultado("reparo");
+    fprintf(stdout, ", \"vertices\": %u, \"lote\": %u, \"reparo_segundos\": %.9f, \"recalculo_segundos\": %.9f, \"ganho\": %.3f", n_vertices(g), tamanho_lote, reparo, recalculo, recalculo / reparo);
+    fprintf(stdout, ", \"mesmo_diametro\": %d", recalculada != NULL && d == maior_distancia(g, recalculada, vertices));
+    fprintf(stdout, ", \"mesma_tabela\": %d", recalculada != NULL && mesma_tabela(g, t, recalculada, vertices));
+    fecha_resultado();
+    destroi_tabela_distancias(recalculada);
+  }
+
+  destroi_tabela_distancias(t);
+  destroi_grafo(g);
+  free(u);
+  free(v);
+  free(peso);
+  free(vertices);
+}
+
+//------------------------------------------------------------------------------
+// compara as listas de adjacência com a representação compacta
+// (compacta_grafo): bytes por aresta e tempo das funções que percorrem as
+// arestas, em grafos de 2^escala vértices gerados com a mesma semente
+
+static double percorre(grafo g, FILE *nulo, const char *funcao) {
+  tabela_distancias t;
+  double inicio;
+
+  inicio = agora();
+
+  if(strcmp(funcao, "componentes") == 0) {
+    destroi_lista(subgrafos_componentes(g), destroi_subgrafo);
+  } else if(strcmp(funcao, "fortemente_conexo") == 0) {
+    fortemente_conexo(g);
+  } else if(strcmp(funcao, "escreve_grafo") == 0) {
+    escreve_grafo(nulo, g);
+  } else if((t = calcula_distancias(g)) != NULL) {
+    destroi_tabela_distancias(t);
+  }
+
+  return agora() - inicio;
+}
+
+static void mede_compactacao(unsigned int escala_maxima, unsigned int semente) {
+  static const char *percursos[] = { "componentes", "fortemente_conexo", "escreve_grafo", "calcula_distancias", NULL };
+  struct grafo *listas, *compacto;
+  FILE *nulo;
+  size_t memoria_listas;
+  unsigned int i, k, arestas;
+  double inicio, compactacao, tempo_listas, tempo_compacto;
+
+  if((nulo = fopen("/dev/null", "w")) == NULL) {
+    fprintf(stderr, "erro ao abrir /dev/null\n");
+    exit(1);
+  }
+
+  for(i = 0; familias[i] != NULL; ++i) {
+    listas = gera_familia(familias[i], escala_maxima, semente);
+    compacto = gera_familia(familias[i], escala_maxima, semente);
+
+    if(listas == NULL || compacto == NULL) {
+      fprintf(stderr, "erro ao gerar %s com 2^%u vértices\n", familias[i], escala_maxima);
+      destroi_grafo(listas);
+      destroi_grafo(compacto);
+      continue;
+    }
+
+    arestas = n_arestas(listas);
+    memoria_listas = memoria_arestas(compacto);
+    inicio = agora();
+
+    if(!compacta_grafo(compacto)) {
+      fprintf(stderr, "erro ao compactar %s\n", familias[i]);
+      destroi_grafo(listas);
+      destroi_grafo(compacto);
+      continue;
+    }
+
+    compactacao = agora() - inicio;
+
+    abre_resultado("compactacao");
+    fprintf(stdout, ", \"familia\": \"%s\", \"vertices\": %u, \"arestas\": %u, \"compactacao_segundos\": %.9f", familias[i], n_vertices(listas), arestas, compactacao);
+    fprintf(stdout, ", \"bytes_por_aresta_listas\": %.3f, \"bytes_por_aresta_compacto\": %.3f", (double) memoria_listas / (arestas ? arestas : 1), (double) memoria_arestas(compacto) / (arestas ? arestas : 1));
+    fecha_resultado();
+
+    for(k = 0; percursos[k] != NULL; ++k) {
+      /* A tabela de distâncias tem V^2 entradas */
+      if(strcmp(percursos[k], "calcula_distancias") == 0 && custo_estimado(V_E, n_vertices(listas), arestas) > LIMITE_OPERACOES) {
+        continue;
+      }
+
+      tempo_listas = percorre(listas, nulo, percursos[k]);
+      tempo_compacto = percorre(compacto, nulo, percursos[k]);
+
+      abre_resultado("compactacao");
+      fprintf(stdout, ", \"familia\": \"%s\", \"funcao\": \"%s\", \"listas_segundos\": %.9f, \"compacto_segundos\": %.9f", familias[i], percursos[k], tempo_listas, tempo_compacto);
+      fprintf(stdout, ", \"ns_por_aresta_listas\": %.3f, \"ns_por_aresta_compacto\": %.3f, \"ganho\": %.3f", tempo_listas * 1e9 / (arestas ? arestas : 1), tempo_compacto * 1e9 / (arestas ? arestas : 1), tempo_listas / tempo_compacto);
+      fecha_resultado();
+    }
+
+    destroi_grafo(listas);
+    destroi_grafo(compacto);
+  }
+
+  fclose(nulo);
+}
+
+//------------------------------------------------------------------------------
+// compara as listas de adjacência com as arestas em disco
+// (le_grafo_externo): tempo das funções que percorrem as arestas em
+// passadas sequenciais, com as arestas em memória e num arquivo temporário
+// lido com um orçamento de ORCAMENTO_EXTERNO bytes
+
+static double percorre_externo(grafo g, FILE *nulo, const char *funcao) {
+  double inicio;
+  long int inferior, superior;
+
+  inicio = agora();
+
+  if(strcmp(funcao, "conexo") == 0) {
+    conexo(g);
+  } else if(strcmp(funcao, "componentes") == 0) {
+    destroi_lista(subgrafos_componentes(g), destroi_subgrafo);
+  } else if(strcmp(funcao, "fortemente_conexo") == 0) {
+    fortemente_conexo(g);
+  } else if(strcmp(funcao, "limites_diametro") == 0) {
+    limites_diametro(g, &inferior, &superior);
+  } else {
+    escreve_grafo(nulo, g);
+  }
+
+  return agora() - inicio;
+}
+
+static void mede_externo(unsigned int escala_maxima, unsigned int semente) {
+  static const char *percursos[] = { "conexo", "componentes", "fortemente_conexo", "limites_diametro", "escreve_grafo", NULL };
+  struct grafo *listas, *externo;
+  FILE *nulo;
+  char caminho[] = "/tmp/grafo_externoXXXXXX";
+  unsigned int i, k, arestas;
+  int arquivo;
+  double inicio, gravacao, leitura, tempo_listas, tempo_externo;
+
+  if((nulo = fopen("/dev/null", "w")) == NULL || (arquivo = mkstemp(caminho)) < 0) {
+    fprintf(stderr, "erro ao criar os arquivos temporários\n");
+    exit(1);
+  }
+
+  close(arquivo);
+
+  for(i = 0; familias[i] != NULL; ++i) {
+    if((listas = gera_familia(familias[i], escala_maxima, semente)) == NULL) {
+      fprintf(stderr, "erro ao gerar %s com 2^%u vértices\n", familias[i], escala_maxima);
+      continue;
+    }
+
+    inicio = agora();
+
+    if(!grava_grafo_externo(listas, caminho)) {
+      fprintf(stderr, "erro ao gravar %s em %s\n", familias[i], caminho);
+      destroi_grafo(listas);
+      continue;
+    }
+
+    gravacao = agora() - inicio;
+    inicio = agora();
+
+    if((externo = sem_guardados(le_grafo_externo(caminho, ORCAMENTO_EXTERNO))) == NULL) {
+      fprintf(stderr, "erro ao ler %s\n", caminho);
+      destroi_grafo(listas);
+      continue;
+    }
+
+    leitura = agora() - inicio;
+    arestas = n_arestas(listas);
+
+    abre_resultado("externo");
+    fprintf(stdout, ", \"familia\": \"%s\", \"vertices\": %u, \"arestas\": %u, \"bytes_arquivo\": %lu", familias[i], n_vertices(listas), arestas, (unsigned long) memoria_arestas(externo));
+    fprintf(stdout, ", \"orcamento\": %d, \"gravacao_segundos\": %.9f, \"leitura_segundos\": %.9f", ORCAMENTO_EXTERNO, gravacao, leitura);
+    fecha_resultado();
+
+    for(k = 0; percursos[k] != NULL; ++k) {
+      if(strcmp(percursos[k], "conexo") == 0 && direcionado(listas)) {
+        continue;
+      }
+
+      tempo_listas = percorre_externo(listas, nulo, percursos[k]);
+      tempo_externo = percorre_externo(externo, nulo, percursos[k]);
+
+      abre_resultado("externo");
+      fprintf(stdout, ", \"familia\": \"%s\", \"funcao\": \"%s\", \"listas_segundos\": %.9f, \"externo_segundos\": %.9f", familias[i], percursos[k], tempo_listas, tempo_externo);
+      fprintf(stdout, ", \"ns_por_aresta_externo\": %.3f, \"rss_maximo_kb\": %ld", tempo_externo * 1e9 / (arestas ? arestas : 1), rss_maximo());
+      fecha_resultado();
+    }
+
+    destroi_grafo(listas);
+    destroi_grafo(externo);
+  }
+
+  unlink(caminho);
+  fclose(nulo);
+}
+
+//------------------------------------------------------------------------------
+// compara as estimativas de amostra_distancias e funcao_vizinhanca com as
+// distâncias exatas (calcula_distancias) em grafos de até 2^10 vértices:
+// erros e se os valores exatos caem nos intervalos de confiança
+
+static grafo gera_sem_pesos(const char *familia, unsigned int escala, unsigned int semente) {
+  unsigned int n, lado;
+
+  n = 1u << escala;
+  lado = 1u << (escala / 2);
+
+  if(strcmp(familia, "erdos_renyi") == 0) {
+    return sem_guardados(gera_erdos_renyi(n, 4 * n, 1, 0, semente));
+  } else if(strcmp(familia, "erdos_renyi_nao_direcionado") == 0) {
+    return sem_guardados(gera_erdos_renyi(n, 4 * n, 0, 0, semente));
+  } else if(strcmp(familia, "rmat") == 0) {
+    return sem_guardados(gera_rmat(escala, 8 * n, 1, 0, semente));
+  } else if(strcmp(familia, "grade") == 0) {
+    return sem_guardados(gera_grade(lado, n / lado, 0, semente));
+  } else if(strcmp(familia, "caminho") == 0) {
+    return sem_guardados(gera_caminho(n, 0, 0, semente));
+  }
+
+  return NULL;
+}
+
+static int no_intervalo(double estimativa, double erro, double exato) {
+  return (estimativa - erro <= exato + 1e-9 * exato) && (exato - 1e-9 * exato <= estimativa + erro);
+}
+
+static void compara_amostra(const char *familia, grafo g, vertice *vertices, tabela_distancias t, int por_grau, unsigned int semente) {
+  struct amostra_distancias a;
+  double inicio, segundos, soma, pares, maior_erro;
+  double *faixa;
+  long int d, diametro;
+  unsigned int n, u, v, i, cobertas;
+
+  n = n_vertices(g);
+  inicio = agora();
+
+  if(!amostra_distancias(g, FONTES_AMOSTRA, por_grau, semente, &a)) {
+    fprintf(stderr, "erro em amostra_distancias em %s\n", familia);
+    return;
+  }
+
+  segundos = agora() - inicio;
+
+  if((faixa = (double *) calloc(FAIXAS_DISTANCIAS, sizeof(double))) == NULL) {
+    return;
+  }
+
+  /* Os valores exatos, com as distâncias de todos os pares */
+  for(u = 0, soma = 0, pares = 0, diametro = 0; u < n; ++u) {
+    for(v = 0; v < n; ++v) {
+      if(u != v && (d = distancia(t, vertices[u], vertices[v])) != infinito) {
+        soma += d;
+        pares += 1;
+        diametro = (d > diametro) ? d : diametro;
+        faixa[(d / a.largura_faixa < FAIXAS_DISTANCIAS) ? d / a.largura_faixa : FAIXAS_DISTANCIAS - 1] += 1;
+      }
+    }
+  }
+
+  for(i = 0, cobertas = 0, maior_erro = 0; i < FAIXAS_DISTANCIAS; ++i) {
+    faixa[i] = (pares > 0) ? faixa[i] / pares : 0;
+    cobertas += no_intervalo(a.fracao[i], a.erro_fracao[i], faixa[i]);
+    maior_erro = (a.fracao[i] - faixa[i] > maior_erro) ? a.fracao[i] - faixa[i] : (faixa[i] - a.fracao[i] > maior_erro) ? faixa[i] - a.fracao[i] : maior_erro;
+  }
+
+  abre_resultado("aproximacao");
+  fprintf(stdout, ", \"familia\": \"%s\", \"vertices\": %u, \"arestas\": %u, \"metodo\": \"%s\", \"fontes\": %u, \"segundos\": %.9f", familia, n, n_arestas(g), por_grau ? "amostra_por_grau" : "amostra_uniforme", a.fontes, segundos);
+  fprintf(stdout, ", \"media\": %.6f, \"erro_media\": %.6f, \"media_exata\": %.6f, \"media_no_intervalo\": %d", a.media, a.erro_media, (pares > 0) ? soma / pares : 0, no_intervalo(a.media, a.erro_media, (pares > 0) ? soma / pares : 0));
+  fprintf(stdout, ", \"pares\": %.1f, \"erro_pares\": %.1f, \"pares_exatos\": %.0f, \"pares_no_intervalo\": %d", a.pares_alcancaveis, a.erro_pares_alcancaveis, pares, no_intervalo(a.pares_alcancaveis, a.erro_pares_alcancaveis, pares));
+  fprintf(stdout, ", \"diametro_inferior\": %ld, \"diametro_superior\": %ld, \"diametro_exato\": %ld", a.diametro_inferior, a.diametro_superior, diametro);
+  fprintf(stdout, ", \"diametro_nos_limites\": %d, \"faixas_no_intervalo\": %.3f, \"maior_erro_faixa\": %.6f", a.diametro_inferior <= diametro && diametro <= a.diametro_superior, (double) cobertas / FAIXAS_DISTANCIAS, maior_erro);
+  fecha_resultado();
+  free(faixa);
+}
+
+static void compara_vizinhanca(const char *familia, grafo g, vertice *vertices, tabela_distancias t, unsigned int semente) {
+  double *vizinhanca, *exata;
+  double inicio, segundos, erro, maior_erro;
+  long int d;
+  unsigned int n, u, v, i, n_valores, n_exatos;
+
+  n = n_vertices(g);
+  vizinhanca = (double *) malloc(sizeof(double) * (n + 1));
+  exata = (double *) calloc(n + 1, sizeof(double));
+
+  if(vizinhanca == NULL || exata == NULL) {
+    free(vizinhanca);
+    free(exata);
+    return;
+  }
+
+  inicio = agora();
+  n_valores = funcao_vizinhanca(g, BITS_VIZINHANCA, semente, vizinhanca, n + 1);
+  segundos = agora() - inicio;
+
+  /* Sem pesos, as distâncias exatas são números de arestas */
+  for(u = 0, n_exatos = 1; u < n; ++u) {
+    for(v = 0; v < n; ++v) {
+      if((d = distancia(t, vertices[u], vertices[v])) != infinito) {
+        exata[d] += 1;
+        n_exatos = ((unsigned int) d + 1 > n_exatos) ? (unsigned int) d + 1 : n_exatos;
+      }
+    }
+  }
+
+  for(i = 1; i < n_exatos; ++i) {
+    exata[i] += exata[i - 1];
+  }
+
+  for(i = 0, maior_erro = 0; i < n_exatos && n_valores > 0; ++i) {
+    erro = ((i < n_valores) ? vizinhanca[i] : vizinhanca[n_valores - 1]) / exata[i] - 1;
+    erro = (erro < 0) ? -erro : erro;
+    maior_erro = (erro > maior_erro) ? erro : maior_erro;
+  }
+
+  abre_resultado("aproximacao");
+  fprintf(stdout, ", \"familia\": \"%s\", \"vertices\": %u, \"arestas\": %u, \"metodo\": \"funcao_vizinhanca\", \"bits\": %u, \"segundos\": %.9f", familia, n, n_arestas(g), BITS_VIZINHANCA, segundos);
+  fprintf(stdout, ", \"diametro_estimado\": %u, \"diametro_exato\": %u, \"maior_erro_relativo\": %.6f", (n_valores > 0) ? n_valores - 1 : 0, n_exatos - 1, maior_erro);
+  fecha_resultado();
+  free(vizinhanca);
+  free(exata);
+}
+
+static void mede_aproximacao(unsigned int escala_maxima, unsigned int semente) {
+  static const char *comparadas[] = { "erdos_renyi", "erdos_renyi_nao_direcionado", "rmat", "grade", "caminho", NULL };
+  struct grafo *g;
+  struct tabela_distancias *t;
+  vertice *vertices;
+  char nome_vertice[16];
+  unsigned int escala, i, v, sem_pesos;
+
+  for(escala = 8; escala <= escala_maxima && escala <= 10; ++escala) {
+    for(i = 0; comparadas[i] != NULL; ++i) {
+      for(sem_pesos = 0; sem_pesos < 2; ++sem_pesos) {
+        g = sem_pesos ? gera_sem_pesos(comparadas[i], escala, semente) : gera_familia(comparadas[i], escala, semente);
+        t = (g != NULL) ? calcula_distancias(g) : NULL;
+        vertices = (g != NULL) ? (vertice *) malloc(sizeof(vertice) * n_vertices(g)) : NULL;
+
+        if(t == NULL || vertices == NULL) {
+          fprintf(stderr, "erro ao gerar %s com 2^%u vértices\n", comparadas[i], escala);
+          exit(1);
+        }
+
+        for(v = 0; v < n_vertices(g); ++v) {
+          sprintf(nome_vertice, "v%u", v);
+          vertices[v] = busca_vertice(g, nome_vertice);
+        }
+
+        /* Os pesos valem nas amostras; a função de vizinhança conta
+           arestas, então é comparada nos grafos sem pesos */
+        if(!sem_pesos) {
+          compara_amostra(comparadas[i], g, vertices, t, 0, semente);
+          compara_amostra(comparadas[i], g, vertices, t, 1, semente);
+        } else {
+          compara_vizinhanca(comparadas[i], g, vertices, t, semente);
+        }
+
+        destroi_tabela_distancias(t);
+        destroi_grafo(g);
+        free(vertices);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// compara as filas de prioridade de Dijkstra (define_fila) no diâmetro,
+// uma busca a partir de cada vértice, em grafos de até 2^ESCALA_FILAS
+// vértices, nas listas e na representação compacta: numa grade com pesos
+// de 1 a 100 e numa malha semelhante a uma rede de estradas, com tempos de
+// 100 a 10000 nas ruas, de 20 a 200 nas vias rápidas (uma linha e uma
+// coluna a cada 16) e cerca de 10% das ruas ausentes
+
+static grafo gera_estradas(unsigned int escala, unsigned int semente) {
+  struct grafo *g;
+  vertice *vertices;
+  char nome_vertice[16];
+  unsigned int lado, colunas, i, j, v;
+  long int peso;
+
+  lado = 1u << (escala / 2);
+  colunas = (1u << escala) / lado;
+
+  if((g = cria_grafo("estradas", 0, 1)) == NULL || (vertices = (vertice *) malloc(sizeof(vertice) * lado * colunas)) == NULL) {
+    destroi_grafo(g);
+    return NULL;
+  }
+
+  srand(semente);
+
+  /* Os vértices são buscados depois de todos inseridos, pois a inserção
+     pode mudá-los de lugar */
+  for(v = 0; v < lado * colunas; ++v) {
+    sprintf(nome_vertice, "v%u", v);
+    insere_vertice(g, nome_vertice);
+  }
+
+  for(v = 0; v < lado * colunas; ++v) {
+    sprintf(nome_vertice, "v%u", v);
+    vertices[v] = busca_vertice(g, nome_vertice);
+  }
+
+  for(i = 0; i < lado; ++i) {
+    for(j = 0; j < colunas; ++j) {
+      v = i * colunas + j;
+
+      if(j + 1 < colunas && (i % 16 == 0 || rand() % 10 != 0)) {
+        peso = (i % 16 == 0) ? 20 + rand() % 181 : 100 + rand() % 9901;
+        insere_aresta(g, vertices[v], vertices[v + 1], peso);
+      }
+
+      if(i + 1 < lado && (j % 16 == 0 || rand() % 10 != 0)) {
+        peso = (j % 16 == 0) ? 20 + rand() % 181 : 100 + rand() % 9901;
+        insere_aresta(g, vertices[v], vertices[v + colunas], peso);
+      }
+    }
+  }
+
+  free(vertices);
+  return sem_guardados(g);
+}
+
+static void mede_filas(unsigned int escala_maxima, unsigned int semente) {
+  static const char *nomes_filas[] = { "automatica", "heap", "dial", "radix" };
+  struct grafo *g;
+  const char *familia;
+  unsigned int i, escala, fila, compacto, arestas;
+  long int d, d_heap;
+  double inicio, segundos, segundos_heap;
+
+  escala = (escala_maxima < ESCALA_FILAS) ? escala_maxima : ESCALA_FILAS;
+
+  for(i = 0; i < 2; ++i) {
+    familia = (i == 0) ? "grade" : "estradas";
+    g = (i == 0) ? gera_familia("grade", escala, semente) : gera_estradas(escala, semente);
+
+    if(g == NULL) {
+      fprintf(stderr, "erro ao gerar %s com 2^%u vértices\n", familia, escala);
+      continue;
+    }
+
+    arestas = n_arestas(g);
+
+    for(compacto = 0; compacto < 2; ++compacto) {
+      if(compacto && !compacta_grafo(g)) {
+        fprintf(stderr, "erro ao compactar %s\n", familia);
+        break;
+      }
+
+      segundos_heap = 0;
+      d_heap = 0;
+
+      /* O heap binário primeiro, para o ganho das demais e para conferir
+         o diâmetro que elas encontram */
+      for(fila = FILA_HEAP; ; fila = (fila + 1) % 4) {
+        define_fila(g, (int) fila);
+        inicio = agora();
+        d = diametro(g);
+        segundos = agora() - inicio;
+
+        if(fila == FILA_HEAP) {
+          segundos_heap = segundos;
+          d_heap = d;
+        }
+
+        abre_resultado("filas");
+        fprintf(stdout, ", \"familia\": \"%s\", \"representacao\": \"%s\", \"vertices\": %u, \"arestas\": %u", familia, compacto ? "compacta" : "listas", n_vertices(g), arestas);
+        fprintf(stdout, ", \"fila\": \"%s\", \"segundos\": %.9f, \"ns_por_aresta\": %.3f", nomes_filas[fila], segundos, segundos * 1e9 / n_vertices(g) / (arestas ? arestas : 1));
+        fprintf(stdout, ", \"ganho\": %.3f, \"mesmo_diametro\": %d", segundos_heap / segundos, d == d_heap);
+        fecha_resultado();
+
+        if(fila == FILA_AUTOMATICA) {
+          break;
+        }
+      }
+    }
+
+    destroi_grafo(g);
+  }
+}
+
+//------------------------------------------------------------------------------
+// mede as buscas em largura em GTEPS (bilhões de arestas percorridas por
+// segundo, como no Graph500) num R-MAT não direcionado, de diâmetro
+// pequeno, e numa grade, de diâmetro grande, sem pesos: os componentes
+// (subgrafos_componentes) percorrem todas as arestas, e as buscas a
+// partir de FONTES_LARGURA fontes sorteadas no maior componente
+// (arborescencia_caminhos_minimos) as dele, com a busca em largura e com
+// a fila de Dial, que fixa os vértices na mesma ordem só pelos arcos da
+// fronteira; a taxa das fontes é combinada pela média harmônica
+
+static void mede_largura(unsigned int escala_maxima, unsigned int semente) {
+  static const int filas[] = { FILA_DIAL, FILA_LARGURA };
+  struct grafo *g;
+  lista l;
+  no n;
+  subgrafo maior;
+  vertice fontes[FONTES_LARGURA];
+  const char *familia;
+  unsigned int i, j, k, compacto, arestas, arestas_maior;
+  double inicio, segundos, total, inversos;
+
+  for(i = 0; i < 2; ++i) {
+    familia = (i == 0) ? "rmat" : "grade";
+    g = (i == 0) ? sem_guardados(gera_rmat(escala_maxima, FATOR_LARGURA << escala_maxima, 0, 0, semente)) : gera_sem_pesos("grade", escala_maxima, semente);
+
+    if(g == NULL) {
+      fprintf(stderr, "erro ao gerar %s com 2^%u vértices\n", familia, escala_maxima);
+      continue;
+    }
+
+    arestas = n_arestas(g);
+
+    for(compacto = 0; compacto < 2; ++compacto) {
+      if(compacto && !compacta_grafo(g)) {
+        fprintf(stderr, "erro ao compactar %s\n", familia);
+        break;
+      }
+
+      inicio = agora();
+      l = subgrafos_componentes(g);
+      segundos = agora() - inicio;
+
+      if(l == NULL) {
+        fprintf(stderr, "erro nos componentes de %s\n", familia);
+        break;
+      }
+
+      abre_resultado("largura");
+      fprintf(stdout, ", \"familia\": \"%s\", \"representacao\": \"%s\", \"vertices\": %u, \"arestas\": %u", familia, compacto ? "compacta" : "listas", n_vertices(g), arestas);
+      fprintf(stdout, ", \"busca\": \"componentes\", \"segundos\": %.9f, \"gteps\": %.6f", segundos, arestas / segundos / 1e9);
+      fecha_resultado();
+
+      /* As fontes e as arestas percorridas a partir delas são as do maior
+         componente (cada aresta conta uma vez, embora seja examinada nos
+         dois sentidos) */
+      for(maior = NULL, n = primeiro_no(l); n != NULL; n = proximo_no(n)) {
+        if(maior == NULL || n_vertices_subgrafo((subgrafo) conteudo(n)) > n_vertices_subgrafo(maior)) {
+          maior = (subgrafo) conteudo(n);
+        }
+      }
+
+      for(k = 0, arestas_maior = 0; k < n_vertices_subgrafo(maior); ++k) {
+        arestas_maior += grau_saida(g, vertice_subgrafo(maior, k));
+      }
+
+      arestas_maior /= 2;
+      srand(semente);
+
+      for(k = 0; k < FONTES_LARGURA; ++k) {
+        fontes[k] = vertice_subgrafo(maior, (unsigned int) rand() % n_vertices_subgrafo(maior));
+      }
+
+      destroi_lista(l, destroi_subgrafo);
+
+      for(j = 0; j < sizeof(filas) / sizeof(filas[0]); ++j) {
+        define_fila(g, filas[j]);
+
+        for(k = 0, inversos = 0, total = 0; k < FONTES_LARGURA; ++k) {
+          inicio = agora();
+          destroi_grafo(arborescencia_caminhos_minimos(g, fontes[k]));
+          segundos = agora() - inicio;
+          total += segundos;
+          inversos += segundos / (arestas_maior ? arestas_maior : 1);
+        }
+
+        abre_resultado("largura");
+        fprintf(stdout, ", \"familia\": \"%s\", \"representacao\": \"%s\", \"vertices\": %u, \"arestas\": %u", familia, compacto ? "compacta" : "listas", n_vertices(g), arestas);
+        fprintf(stdout, ", \"busca\": \"%s\", \"fontes\": %u, \"arestas_percorridas\": %u", (filas[j] == FILA_LARGURA) ? "largura" : "dial", FONTES_LARGURA, arestas_maior);
+        fprintf(stdout, ", \"segundos\": %.9f, \"gteps\": %.6f", total / FONTES_LARGURA, FONTES_LARGURA / inversos / 1e9);
+        fecha_resultado();
+      }
+
+      define_fila(g, FILA_AUTOMATICA);
+    }
+
+    destroi_grafo(g);
+  }
+}
+
+//------------------------------------------------------------------------------
+// mede a curva de escalabilidade dos componentes fortemente conexos
+// (subgrafos_fortemente_conexos) num R-MAT direcionado, com um componente
+// gigante e muitos triviais, e num Erdős–Rényi direcionado, com 1, 2, 4,
+// ... threads (define_threads) até o número de processadores (ao menos 2):
+// com um thread a condensação usa o algoritmo de Tarjan, com mais a
+// decomposição paralela (a partir de 2^14 vértices), e a aceleração é
+// relativa a um thread; a condensação guardada em g é descartada antes de
+// cada medida pela inserção e remoção de um laço
+
+static void mede_fortes(unsigned int escala_maxima, unsigned int semente) {
+  struct grafo *g;
+  lista l;
+  no n;
+  vertice v;
+  const char *familia;
+  unsigned int i, threads, maximo, componentes, maior;
+  double inicio, segundos, base;
+  long int processadores;
+
+  processadores = sysconf(_SC_NPROCESSORS_ONLN);
+  maximo = (processadores > 2) ? (unsigned int) processadores : 2;
+
+  for(i = 0; i < 2; ++i) {
+    familia = (i == 0) ? "rmat" : "erdos_renyi";
+    g = (i == 0) ? sem_guardados(gera_rmat(escala_maxima, FATOR_LARGURA << escala_maxima, 1, 0, semente)) : gera_sem_pesos("erdos_renyi", escala_maxima, semente);
+
+    if(g == NULL || (v = busca_vertice(g, "v0")) == NULL) {
+      fprintf(stderr, "erro ao gerar %s com 2^%u vértices\n", familia, escala_maxima);
+      continue;
+    }
+
+    for(threads = 1, base = 0; threads <= maximo; threads = (threads < maximo && 2 * threads > maximo) ? maximo : 2 * threads) {
+      define_threads(threads);
+
+      if(!insere_aresta(g, v, v, 0) || !remove_aresta(g, v, v)) {
+        fprintf(stderr, "erro ao alterar %s\n", familia);
+        break;
+      }
+
+      inicio = agora();
+      l = subgrafos_fortemente_conexos(g);
+      segundos = agora() - inicio;
+
+      if(l == NULL) {
+        fprintf(stderr, "erro nos componentes fortemente conexos de %s\n", familia);
+        break;
+      }
+
+      for(componentes = 0, maior = 0, n = primeiro_no(l); n != NULL; n = proximo_no(n), ++componentes) {
+        if(n_vertices_subgrafo((subgrafo) conteudo(n)) > maior) {
+          maior = n_vertices_subgrafo((subgrafo) conteudo(n));
+        }
+      }
+
+      destroi_lista(l, destroi_subgrafo);
+
+      if(threads == 1) {
+        base = segundos;
+      }
+
+      abre_resultado("fortes");
+      fprintf(stdout, ", \"familia\": \"%s\", \"vertices\": %u, \"arestas\": %u, \"threads\": %u", familia, n_vertices(g), n_arestas(g), threads);
+      fprintf(stdout, ", \"segundos\": %.9f, \"aceleracao\": %.3f, \"componentes\": %u, \"maior\": %u", segundos, base / segundos, componentes, maior);
+      fecha_resultado();
+
+      if(threads == maximo) {
+        break;
+      }
+    }
+
+    define_threads(0);
+    destroi_grafo(g);
+  }
+}
+
+//------------------------------------------------------------------------------
+// mede o custo do controle das chamadas demoradas (define_controle) em
+// distancias e diametro, numa grade e num Erdős–Rényi ponderados de até
+// 2^ESCALA_RETOMADA vértices: sem controle, com um controle só com prazo
+// e com retomada, com as linhas forçadas ao disco a cada uma e a cada
+// segundo; a sobrecarga é relativa à chamada sem controle
+
+static void mede_retomada(unsigned int escala_maxima, unsigned int semente) {
+  static const char *modos[] = { "sem_controle", "prazo", "retomada_cada_linha", "retomada_1s", NULL };
+  static const char *funcoes_retomada[] = { "distancias", "diametro", NULL };
+  struct grafo *g;
+  controle c;
+  const char *familia;
+  char caminho[] = "/tmp/retomadaXXXXXX";
+  unsigned int i, k, modo, escala;
+  int arquivo, completa;
+  double inicio, segundos, base;
+
+  if((arquivo = mkstemp(caminho)) < 0) {
+    fprintf(stderr, "erro ao criar o arquivo de retomada\n");
+    exit(1);
+  }
+
+  /* A chamada cria o arquivo; o nome só é reservado aqui */
+  close(arquivo);
+  unlink(caminho);
+  escala = (escala_maxima < ESCALA_RETOMADA) ? escala_maxima : ESCALA_RETOMADA;
+
+  for(i = 0; i < 2; ++i) {
+    familia = (i == 0) ? "grade" : "erdos_renyi";
+
+    if((g = gera_familia(familia, escala, semente)) == NULL) {
+      fprintf(stderr, "erro ao gerar %s com 2^%u vértices\n", familia, escala);
+      continue;
+    }
+
+    for(k = 0; funcoes_retomada[k] != NULL; ++k) {
+      for(modo = 0, base = 0; modos[modo] != NULL; ++modo) {
+        c = NULL;
+
+        if(modo > 0 && (c = cria_controle(0, (modo > 1) ? caminho : NULL, (modo == 3) ? 1.0 : 0)) == NULL) {
+          fprintf(stderr, "erro ao criar o controle\n");
+          break;
+        }
+
+        define_controle(g, c);
+        inicio = agora();
+
+        if(k == 0) {
+          destroi_grafo(distancias(g));
+        } else {
+          diametro(g);
+        }
+
+        segundos = agora() - inicio;
+        completa = (c == NULL || !interrompido(c));
+        define_controle(g, NULL);
+        destroi_controle(c);
+
+        if(modo == 0) {
+          base = segundos;
+        }
+
+        abre_resultado("retomada");
+        fprintf(stdout, ", \"familia\": \"%s\", \"vertices\": %u, \"arestas\": %u, \"funcao\": \"%s\"", familia, n_vertices(g), n_arestas(g), funcoes_retomada[k]);
+        fprintf(stdout, ", \"modo\": \"%s\", \"segundos\": %.9f, \"sobrecarga\": %.3f, \"completa\": %d", modos[modo], segundos, segundos / base, completa);
+        fecha_resultado();
+      }
+    }
+
+    destroi_grafo(g);
+  }
+
+  unlink(caminho);
+}
+
+//------------------------------------------------------------------------------
+static struct {
+  const char *nome;
+  void (*executa)(unsigned int escala, unsigned int semente);
+} experimentos[] = {
+  { "funcoes", mede_funcoes },
+  { "reparo", mede_reparo },
+  { "compactacao", mede_compactacao },
+  { "externo", mede_externo },
+  { "aproximacao", mede_aproximacao },
+  { "filas", mede_filas },
+  { "largura", mede_largura },
+  { "fortes", mede_fortes },
+  { "retomada", mede_retomada },
+  { NULL, NULL }
+};
+
+//------------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+  const char *experimento;
+  unsigned int escala, semente, i, executados;
+
+  experimento = (argc > 1) ? argv[1] : "todos";
+  escala = (argc > 2) ? (unsigned int) atoi(argv[2]) : 14;
+  semente = (argc > 3) ? (unsigned int) atoi(argv[3]) : 42;
+
+  if(escala < 8 || escala > 24) {
+    fprintf(stderr, "escala deve estar entre 8 e 24\n");
+    return 1;
+  }
+
+  fprintf(stdout, "{\"semente\": %u, \"escala\": %u, \"resultados\": [", semente, escala);
+
+  for(i = 0, executados = 0; experimentos[i].nome != NULL; ++i) {
+    if(strcmp(experimento, "todos") == 0 || strcmp(experimento, experimentos[i].nome) == 0) {
+      experimentos[i].executa(escala, semente);
+      ++executados;
+    }
+  }
+
+  fprintf(stdout, "\n]}\n");
+
+  if(executados == 0) {
+    fprintf(stderr, "experimento desconhecido: %s\n", experimento);
+    return 1;
+  }
+
+  return 0;
+}
@@ -1,9 +1,59 @@
+#define _GNU_SOURCE
 #include <stdlib.h>
+#include <stdint.h>
 #include <limits.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
 #include <graphviz/cgraph.h>
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
 #include "string.h"
 #include "grafo.h"
 
+/* Fases em que se divide o tempo das chamadas medidas */
+enum fase {
+  FASE_CARGA,
+  FASE_CONVERSAO,
+  FASE_INDICE,
+  FASE_CALCULO,
+  FASE_SAIDA,
+  N_FASES
+};
+
+/* Tipos dos resultados guardados em um grafo entre as chamadas (struct
+   guardado), um de cada */
+enum tipo_guardado {
+  GUARDADO_COMPONENTES,
+  GUARDADO_ARVORE,
+  GUARDADO_DISTANCIAS,
+  GUARDADO_DIAMETRO,
+  N_GUARDADOS
+};
+
+/* Contadores de desempenho de um grafo, somados atomicamente; os laços
+   acumulam em variáveis locais e somam uma vez por busca ou chamada. Os
+   reusos e cálculos dos resultados guardados são contados sempre, mesmo
+   sem a instrumentação */
+struct contadores {
+  unsigned long chamadas;
+  unsigned long arestas_examinadas;
+  unsigned long vertices_fixados;
+  unsigned long operacoes_heap;
+  unsigned long alocacoes;
+  unsigned long bytes_alocados;
+  unsigned long nanossegundos[N_FASES];
+  unsigned long resultados_reusados;
+  unsigned long resultados_calculados;
+};
+
 struct lista {
   struct no *primeiro;
 };
@@ -13,6 +63,9 @@ struct no {
   struct no *proximo;
 };
 
+/* arestas é a lista dos arcos que saem do vértice, num grafo direcionado,
+   ou das suas arestas, num não direcionado; os arcos que entram ficam em
+   struct entrada_listas, construída apenas quando usada */
 struct vertice {
   char *nome;
   lista arestas;
@@ -30,10 +83,613 @@ struct grafo {
   int ponderado;
   vertice vertices;
   unsigned int n_vertices;
+  unsigned int capacidade;
+  struct condensacao *condensacao;
+  struct alcancabilidade *alcancabilidade;
+  struct conectividade *conectividade;
+  struct entrada_listas *entrada;
+  struct compacto *compacto;
+  struct externo *externo;
+  struct contadores contadores;
+  void (*progresso)(void *dados, unsigned int feitos, unsigned int total);
+  void *dados_progresso;
+  pthread_mutex_t trava;
+  pthread_mutex_t trava_areas;
+  struct area_trabalho *areas;
+  struct controle *controle;
+  int fila;
+  int pesos_conhecidos;
+  long int peso_minimo;
+  long int peso_maximo;
+  size_t n_arcos;
+  unsigned long versao;
+  pthread_mutex_t trava_guardados;
+  struct guardado *guardados[N_GUARDADOS];
+  size_t memoria_guardados;
+  size_t limite_guardados;
+  unsigned long uso_guardados;
+};
+
+/* Componentes fortemente conexos de um grafo numerados em ordem topológica
+   (todo arco entre componentes distintos vai de um componente de número
+   menor para um de número maior) e o DAG formado por eles, sem arcos
+   repetidos. Num grafo não direcionado são os componentes conexos */
+struct condensacao {
+  unsigned int n_componentes;
+  unsigned int *componente;
+  unsigned int *inicio_membros;
+  unsigned int *membros;
+  unsigned int *inicio_sucessores;
+  unsigned int *sucessores;
+  int circuito;
+};
+
+/* Componentes conexos de um grafo não direcionado mantidos por union-find,
+   atualizados a cada aresta ou vértice inserido */
+struct conectividade {
+  unsigned int *pai;
+  unsigned char *posto;
+  unsigned int capacidade;
+  unsigned int n_componentes;
+};
+
+/* Arcos que entram em cada vértice de um grafo direcionado representado
+   por listas (prepara_entrada): os que entram em v são arco[inicio[v]],
+   ..., arco[inicio[v + 1] - 1], na ordem das origens. Os arcos são os
+   mesmos das listas, então as alterações de peso valem também aqui; as
+   inserções e remoções descartam a estrutura */
+struct entrada_listas {
+  size_t *inicio;
+  struct aresta **arco;
+};
+
+/* Vetores auxiliares de uma chamada, para até capacidade vértices,
+   guardados na reserva do grafo (pega_area e devolve_area) e reaproveitados
+   pelas chamadas seguintes em vez de alocados a cada uma; uma área é usada
+   por um único thread até ser devolvida. Enquanto está na reserva,
+   posicao vale -1 em todos os vértices e baldes em todos os baldes (o
+   heap e as filas de baldes estão vazios) */
+struct area_trabalho {
+  unsigned int capacidade;
+  unsigned int no;
+  long int *distancia;
+  unsigned int *pai;
+  unsigned int *heap;
+  unsigned int *posicao;
+  unsigned int *rotulo;
+  unsigned int *inicio;
+  unsigned int *membros;
+  unsigned int *anterior;
+  unsigned int *baldes;
+  uint64_t *marcas;
+  struct area_trabalho *proxima;
+};
+
+/* Prazo (instante de relogio, 0 se não há), cancelamento e arquivo de
+   retomada das chamadas demoradas (define_controle); interrompido diz se a
+   última chamada parou pelo prazo ou pelo cancelamento */
+struct controle {
+  unsigned long prazo;
+  unsigned long intervalo;
+  char *arquivo;
+  int cancelado;
+  int interrompido;
+};
+
+/* Início do arquivo de retomada: o tipo dos registros (linhas inteiras de
+   distâncias, apenas o maior valor de cada uma ou linhas esparsas, só com
+   os vértices alcançados) e uma impressão digital dos arcos do grafo, para
+   que um arquivo de outra chamada ou de outro grafo não seja retomado.
+   Cada registro seguinte é o índice da fonte e os seus valores; numa linha
+   esparsa, o número de vértices, os seus índices e as suas distâncias */
+struct cabecalho_retomada {
+  char marca[8];
+  uint32_t tipo;
+  uint32_t n_vertices;
+  uint64_t impressao;
+};
+
+/* Índice de alcançabilidade sobre a condensação: fecho transitivo em bits
+   quando há poucos componentes, ou rótulos de intervalos (GRAIL) de
+   n_rotulos buscas em profundidade aleatórias quando há muitos */
+struct alcancabilidade {
+  unsigned int n_palavras;
+  uint64_t *fecho;
+  unsigned int n_rotulos;
+  unsigned int *baixo;
+  unsigned int *pos;
+};
+
+/* Representação compacta das arestas (compacta_grafo), que substitui as
+   listas: a lista de vizinhos de cada vértice, ordenada, guardada como as
+   diferenças entre vizinhos consecutivos (a primeira é o próprio vizinho)
+   em stream VByte, isto é, um byte de controle com o tamanho (1 a 4
+   bytes) de cada grupo de quatro valores, seguido dos bytes dos valores.
+   Os pesos ficam num vetor à parte com a menor largura que comporta todos
+   eles (nenhuma, se são todos iguais). A aresta e da lista de v tem índice
+   primeira[v] + e e a lista começa em dados + inicio[v] */
+struct adjacencia_compacta {
+  size_t *primeira;
+  size_t *inicio;
+  unsigned char *dados;
+  unsigned int grau_maximo;
+  unsigned int largura_peso;
+  long int peso_constante;
+  void *pesos;
+};
+
+/* Arcos que saem de cada vértice (as arestas, num grafo não direcionado)
+   e, num grafo direcionado, os que entram, sem os pesos */
+struct compacto {
+  struct adjacencia_compacta saida;
+  struct adjacencia_compacta entrada;
+};
+
+/* Arestas em disco (le_grafo_externo): o arquivo inteiro é mapeado com
+   mmap e os arcos que saem de (ou entram em) v são destino[inicio[v]],
+   ..., destino[inicio[v + 1] - 1], com os pesos no mesmo índice de pesos
+   (ou todos iguais a peso_constante, se pesos é NULL) */
+struct adjacencia_externa {
+  const uint64_t *inicio;
+  const uint32_t *destino;
+  const int64_t *pesos;
+  long int peso_constante;
+};
+
+/* Mapeamento do arquivo de arestas; as passadas sequenciais mantêm
+   residentes no máximo duas janelas de arcos_janela arcos */
+struct externo {
+  unsigned char *mapa;
+  size_t tamanho;
+  size_t arcos_janela;
+  struct adjacencia_externa saida;
+  struct adjacencia_externa entrada;
+};
+
+/* Cabeçalho do arquivo de arestas, seguido dos nomes (o do grafo e os dos
+   vértices, terminados por '\0'), dos vetores inicio de saída e de entrada,
+   dos pesos e dos vetores destino de saída e de entrada, cada um alinhado
+   em 8 bytes; a entrada só existe em grafos direcionados */
+struct cabecalho_externo {
+  char magica[8];
+  uint32_t direcionado;
+  uint32_t ponderado;
+  uint32_t n_vertices;
+  uint32_t tem_pesos;
+  uint64_t n_arcos;
+  uint64_t n_arcos_entrada;
+  int64_t peso_constante;
+  uint64_t tamanho_nomes;
+};
+
+/* Posição no arquivo de arestas de cada parte que segue o cabeçalho */
+struct disposicao_externa {
+  size_t nomes;
+  size_t inicio_saida;
+  size_t inicio_entrada;
+  size_t pesos;
+  size_t destino_saida;
+  size_t destino_entrada;
+  size_t tamanho;
+};
+
+/* Janela residente (intervalo de arcos) de uma passada sequencial pelas
+   arestas em disco */
+struct passada {
+  grafo g;
+  int entrada;
+  size_t inicio;
+  size_t fim;
+};
+
+/* Percorre os arcos que saem de (ou entram em) um vértice nas listas, na
+   representação compacta, decodificada em blocos de quatro vizinhos, ou
+   no arquivo de arestas */
+struct cursor {
+  struct no *n;
+  struct aresta **arco;
+  struct aresta **fim_arco;
+  const uint32_t *destino;
+  const uint32_t *fim_destino;
+  const int64_t *peso_arco;
+  long int peso_constante;
+  const struct adjacencia_compacta *adjacencia;
+  const void *pesos;
+  const unsigned char *controle;
+  const unsigned char *dados;
+  size_t aresta;
+  unsigned int v;
+  unsigned int restantes;
+  unsigned int anterior;
+  unsigned int n_bloco;
+  unsigned int i_bloco;
+  unsigned int bloco[4];
+};
+
+/* Modos de percurso das arestas dos núcleos especializados (Dijkstra, a
+   busca em largura e a de Tarjan): cada núcleo é escrito uma vez,
+   com o modo como parâmetro, e DESPACHA_PERCURSO o instancia com cada
+   modo constante. Como inicia_percurso e proximo_percurso são sempre
+   expandidas, cada instância percorre só uma representação, sem testar a
+   cada arco a representação nem o sentido, e lê os pesos na largura em
+   que estão guardados (ou não os lê, se são todos iguais ou não usados) */
+enum percurso {
+  PERCURSO_ARESTAS,
+  PERCURSO_SAIDA,
+  PERCURSO_ENTRADA,
+  PERCURSO_COMPACTO,
+  PERCURSO_COMPACTO_8,
+  PERCURSO_COMPACTO_16,
+  PERCURSO_COMPACTO_32,
+  PERCURSO_COMPACTO_64,
+  PERCURSO_EXTERNO,
+  PERCURSO_EXTERNO_64
+};
+
+#define SEMPRE_EXPANDIDA static inline __attribute__((always_inline))
+
+/* Modo dos arcos que entram, para os núcleos que seguem os dois sentidos */
+#define PERCURSO_INVERSO(modo) (((modo) == PERCURSO_SAIDA) ? PERCURSO_ENTRADA : (modo))
+
+/* Instancia o núcleo com cada modo (o último argumento); chamada pode
+   incluir a atribuição do resultado, como em c = nucleo */
+#define DESPACHA_PERCURSO(modo, chamada, ...) \
+  switch(modo) { \
+    case PERCURSO_ARESTAS: chamada(__VA_ARGS__, PERCURSO_ARESTAS); break; \
+    case PERCURSO_SAIDA: chamada(__VA_ARGS__, PERCURSO_SAIDA); break; \
+    case PERCURSO_ENTRADA: chamada(__VA_ARGS__, PERCURSO_ENTRADA); break; \
+    case PERCURSO_COMPACTO: chamada(__VA_ARGS__, PERCURSO_COMPACTO); break; \
+    case PERCURSO_COMPACTO_8: chamada(__VA_ARGS__, PERCURSO_COMPACTO_8); break; \
+    case PERCURSO_COMPACTO_16: chamada(__VA_ARGS__, PERCURSO_COMPACTO_16); break; \
+    case PERCURSO_COMPACTO_32: chamada(__VA_ARGS__, PERCURSO_COMPACTO_32); break; \
+    case PERCURSO_COMPACTO_64: chamada(__VA_ARGS__, PERCURSO_COMPACTO_64); break; \
+    case PERCURSO_EXTERNO: chamada(__VA_ARGS__, PERCURSO_EXTERNO); break; \
+    case PERCURSO_EXTERNO_64: chamada(__VA_ARGS__, PERCURSO_EXTERNO_64); break; \
+  }
+
+/* O mesmo, para os núcleos que não usam os pesos e seguem os arcos que
+   saem, com o modo de modo_percurso(g, 0, 0) */
+#define DESPACHA_PERCURSO_SEM_PESO(modo, chamada, ...) \
+  switch(modo) { \
+    case PERCURSO_ARESTAS: chamada(__VA_ARGS__, PERCURSO_ARESTAS); break; \
+    case PERCURSO_SAIDA: chamada(__VA_ARGS__, PERCURSO_SAIDA); break; \
+    case PERCURSO_COMPACTO: chamada(__VA_ARGS__, PERCURSO_COMPACTO); break; \
+    default: chamada(__VA_ARGS__, PERCURSO_EXTERNO); break; \
+  }
+
+/* Máscara de embaralhamento e número de bytes de cada grupo de quatro
+   valores para cada byte de controle do stream VByte */
+static unsigned char mascara_embaralhamento[256][16];
+static unsigned char tamanho_grupo[256];
+static pthread_once_t tabelas_iniciadas = PTHREAD_ONCE_INIT;
+
+/* Relógio monotônico em nanossegundos, das medidas e dos prazos */
+static unsigned long relogio(void) {
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (unsigned long) t.tv_sec * 1000000000UL + (unsigned long) t.tv_nsec;
+}
+
+#ifdef GRAFO_ESTATISTICAS
+/* Instrumentação, compilada apenas com -DGRAFO_ESTATISTICAS: as alocações
+   são contadas por thread e atribuídas ao grafo no fim da medida mais
+   externa, que conta como uma chamada; o tempo de uma medida não inclui o
+   das medidas aninhadas nela (o índice construído durante um cálculo) */
+static __thread unsigned long alocacoes_thread, bytes_thread, nanossegundos_thread;
+static __thread unsigned int profundidade_thread;
+
+#define ESTATISTICAS_COLETADAS 1
+
+struct medida {
+  unsigned long inicio;
+  unsigned long alocacoes;
+  unsigned long bytes;
+  unsigned long aninhado;
+};
+
+static void *aloca(size_t tamanho) {
+  ++alocacoes_thread;
+  bytes_thread += tamanho;
+  return (malloc)(tamanho);
+}
+
+static void *aloca_zerado(size_t n, size_t tamanho) {
+  ++alocacoes_thread;
+  bytes_thread += n * tamanho;
+  return (calloc)(n, tamanho);
+}
+
+static void *realoca(void *p, size_t tamanho) {
+  ++alocacoes_thread;
+  bytes_thread += tamanho;
+  return (realloc)(p, tamanho);
+}
+
+static char *duplica(const char *s) {
+  ++alocacoes_thread;
+  bytes_thread += strlen(s) + 1;
+  return (strdup)(s);
+}
+
+#define malloc(tamanho) aloca(tamanho)
+#define calloc(n, tamanho) aloca_zerado(n, tamanho)
+#define realloc(p, tamanho) realoca(p, tamanho)
+#define strdup(s) duplica(s)
+
+static void inicia_medida(struct medida *m) {
+  m->alocacoes = alocacoes_thread;
+  m->bytes = bytes_thread;
+  m->aninhado = nanossegundos_thread;
+  ++profundidade_thread;
+  m->inicio = relogio();
+}
+
+#define CONTA(g, campo, n) __atomic_add_fetch(&(g)->contadores.campo, (unsigned long) (n), __ATOMIC_RELAXED)
+
+static void termina_medida(grafo g, struct medida *m, enum fase f) {
+  unsigned long exclusivo;
+
+  exclusivo = relogio() - m->inicio - (nanossegundos_thread - m->aninhado);
+  nanossegundos_thread += exclusivo;
+
+  if(g != NULL) {
+    CONTA(g, nanossegundos[f], exclusivo);
+  }
+
+  if(--profundidade_thread == 0 && g != NULL) {
+    CONTA(g, chamadas, 1);
+    CONTA(g, alocacoes, alocacoes_thread - m->alocacoes);
+    CONTA(g, bytes_alocados, bytes_thread - m->bytes);
+  }
+}
+#else
+struct medida {
+  char vazia;
 };
 
+#define ESTATISTICAS_COLETADAS 0
+#define inicia_medida(m) ((void) (m))
+#define termina_medida(g, m, f) ((void) (m))
+#define CONTA(g, campo, n) ((void) (n))
+#endif
+
 const long int infinito = LONG_MAX;
 
+/* Maior número de componentes fortemente conexos para o qual o índice de
+   alcançabilidade guarda o fecho transitivo completo em bits (32MB) */
+#define LIMITE_FECHO_TRANSITIVO 16384
+
+/* Número de rotulações por intervalos do índice de alcançabilidade
+   usado acima deste limite */
+#define N_ROTULOS 4
+
+/* O reparo de uma linha da tabela de distâncias é abandonado (e a linha
+   recalculada) quando toca mais de 1/FRACAO_REPARO dos vértices */
+#define FRACAO_REPARO 4
+
+/* Número de baldes circulares da fila de Dial (potência de 2): com pesos
+   inteiros de 0 a BALDES_DIAL - 1 Dijkstra usa a fila de Dial, com pesos
+   maiores o heap radix (que usa 65 deles) */
+#define BALDES_DIAL 1024
+
+/* "Fila" dos grafos direcionados acíclicos, além das de grafo.h: sem fila,
+   os vértices são fixados na ordem topológica da condensação */
+#define FILA_TOPOLOGICA 5
+
+/* Com pesos negativos e sem circuito negativo, o heap radix sobre os pesos
+   reduzidos pelos potenciais de Johnson (escolhe_fila) */
+#define FILA_JOHNSON 6
+
+/* Sentidos dos arcos seguidos pela busca em largura (busca_largura) */
+#define LARGURA_SAIDA 1
+#define LARGURA_ENTRADA 2
+
+/* Troca de passo: o ascendente começa quando os arcos estimados da próxima
+   fronteira passam de 1/ALFA_LARGURA dos arcos dos vértices ainda não
+   visitados, e volta ao descendente quando a fronteira tem menos de
+   1/BETA_LARGURA dos candidatos */
+#define ALFA_LARGURA 14
+#define BETA_LARGURA 24
+
+/* Menor número de candidatos para valer o passo ascendente, e de vértices
+   de um nível (da fronteira ou dos candidatos) para dividi-lo em threads */
+#define LARGURA_ASCENDENTE 1024
+#define LARGURA_PARALELA 4096
+
+/* Vértices descobertos guardados por thread antes de irem para a fila */
+#define BLOCO_LARGURA 256
+
+/* Componentes fortemente conexos em paralelo (condensacao_paralela): menor
+   número de vértices para usá-los, máximo de rodadas da poda dos
+   componentes triviais e ativos examinados na escolha do pivô */
+#define FORTES_PARALELA (1 << 14)
+#define RODADAS_PODA 8
+#define AMOSTRA_PIVO 32
+
+/* Posicionamento NUMA: máximo de nós considerados (a máscara de nós de
+   mbind cabe num unsigned long) e menor vetor espalhado entre os nós e
+   com páginas grandes (distribui_memoria) */
+#define MAXIMO_NOS 64
+#define LIMIAR_PAGINAS_GRANDES (4 << 20)
+
+/* Política e opção de mbind, de linux/mempolicy.h */
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE 3
+#endif
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE (1 << 1)
+#endif
+
+/* Bytes de controle que o malloc acrescenta a cada bloco, somados a cada
+   vetor nas estimativas de memória (estima_memoria) */
+#define SOBRECARGA_MALLOC 16
+
+/* Tipos dos registros do arquivo de retomada (struct cabecalho_retomada) */
+#define RETOMADA_LINHAS 0
+#define RETOMADA_MAXIMOS 1
+#define RETOMADA_ESPARSA 2
+
+/* Orçamento padrão de memória residente das arestas em disco (64MB) */
+#define ORCAMENTO_EXTERNO ((size_t) 64 << 20)
+
+/* Limite padrão da memória dos resultados guardados em um grafo (256MB) */
+#define LIMITE_GUARDADOS ((size_t) 256 << 20)
+
+static const char magica_externa[8] = { 'G', 'R', 'A', 'F', 'O', 'E', 'X', '1' };
+
+/* Tamanho mínimo de cada pedaço da leitura paralela de DOT (1MB) */
+#define TAMANHO_PEDACO_DOT ((size_t) 1 << 20)
+
+/* A tabela de nomes da leitura paralela é dividida em 2^BITS_FATIAS_NOMES
+   fatias, cada uma com a sua trava */
+#define BITS_FATIAS_NOMES 8
+#define N_FATIAS_NOMES (1 << BITS_FATIAS_NOMES)
+
+#define NOMES_POR_BLOCO 1024
+
+/* Nomes lidos recentemente que cada pedaço guarda para não consultar a
+   tabela compartilhada (deve ser uma potência de 2) */
+#define N_NOMES_RECENTES 1024
+
+/* Estados do autômato léxico da leitura paralela de DOT: o modo e, no bit
+   LEX_COLCHETE, se a posição está dentro de uma lista de atributos */
+enum lexico {
+  LEX_NORMAL,
+  LEX_BARRA,
+  LEX_ASPAS,
+  LEX_ESCAPE,
+  LEX_BLOCO,
+  LEX_ASTERISCO,
+  LEX_LINHA,
+  LEX_COLCHETE = 8,
+  N_LEXICOS = 16
+};
+
+enum token_dot {
+  TOK_FIM,
+  TOK_NOME,
+  TOK_PALAVRA,
+  TOK_ARCO,
+  TOK_ARESTA,
+  TOK_ABRE,
+  TOK_FECHA,
+  TOK_ABRE_CHAVE,
+  TOK_FECHA_CHAVE,
+  TOK_IGUAL,
+  TOK_SEPARADOR,
+  TOK_INVALIDO
+};
+
+struct token {
+  enum token_dot tipo;
+  const unsigned char *texto;
+  size_t tamanho;
+  size_t posicao;
+  int escapes;
+};
+
+/* Nome de vértice internado pela leitura paralela; primeira é a posição
+   da sua primeira ocorrência no arquivo, que define a numeração */
+struct nome_lido {
+  const unsigned char *texto;
+  char *copia;
+  size_t tamanho;
+  uint64_t hash;
+  size_t primeira;
+  unsigned int indice;
+};
+
+struct bloco_nomes {
+  struct bloco_nomes *anterior;
+  unsigned int n;
+  struct nome_lido nomes[NOMES_POR_BLOCO];
+};
+
+/* Posição da tabela de nomes; o hash ao lado do ponteiro evita visitar
+   o nome nas colisões */
+struct posicao_nome {
+  uint64_t hash;
+  struct nome_lido *nome;
+};
+
+struct fatia_nomes {
+  pthread_mutex_t trava;
+  struct posicao_nome *posicoes;
+  unsigned int capacidade;
+  unsigned int n;
+};
+
+struct aresta_lida {
+  struct nome_lido *origem;
+  struct nome_lido *destino;
+  long int peso;
+  int peso_definido;
+};
+
+/* Estado compartilhado da leitura paralela: o arquivo mapeado, com o corpo
+   do grafo (depois do '{') entre inicio e fim, e a tabela de nomes */
+struct leitura_dot {
+  const unsigned char *texto;
+  size_t inicio;
+  size_t fim;
+  int direcionado;
+  int estrito;
+  unsigned char lexico[N_LEXICOS][256];
+  struct fatia_nomes fatias[N_FATIAS_NOMES];
+};
+
+/* Pedaço do corpo lido por um thread, com as arestas que ele leu; base é
+   o número de arestas dos pedaços anteriores */
+struct pedaco_dot {
+  struct leitura_dot *leitura;
+  size_t inicio;
+  size_t fim;
+  unsigned char transicao[N_LEXICOS];
+  unsigned char estado;
+  int encontrada;
+  size_t pos;
+  struct token devolvido;
+  int tem_devolvido;
+  struct bloco_nomes *nomes;
+  struct posicao_nome recentes[N_NOMES_RECENTES];
+  struct aresta_lida *arestas;
+  size_t n_arestas;
+  size_t capacidade;
+  size_t base;
+  int ponderado;
+  int erro;
+  int vazio;
+  int fechado;
+  size_t fim_grafo;
+};
+
+/* Arco na ordenação por contagem da montagem das listas */
+struct arco_lido {
+  unsigned int destino;
+  int peso_definido;
+  long int peso;
+  size_t ordem;
+};
+
+struct montagem {
+  grafo g;
+  int estrito;
+  int erro;
+  struct nome_lido **nomes;
+  size_t *inicio;
+  size_t *posicao;
+  size_t *grau;
+  struct arco_lido *arcos;
+};
+
+struct parte_montagem {
+  struct montagem *m;
+  struct pedaco_dot *pedaco;
+  unsigned int primeiro;
+  unsigned int ultimo;
+};
+
 //------------------------------------------------------------------------------
 static void inicializa_lista(lista *l) {
   *l = (struct lista *) malloc(sizeof(struct lista));
@@ -43,6 +699,44 @@ static void inicializa_lista(lista *l) {
   }
 }
 
+//------------------------------------------------------------------------------
+static void inicializa_grafo(grafo *g) {
+  *g = (struct grafo *) malloc(sizeof(struct grafo));
+
+  if(*g != NULL) {
+    (*g)->nome = (char *) NULL;
+    (*g)->direcionado = 0;
+    (*g)->ponderado = 0;
+    (*g)->vertices = (struct vertice *) NULL;
+    (*g)->n_vertices = 0;
+    (*g)->capacidade = 0;
+    (*g)->condensacao = (struct condensacao *) NULL;
+    (*g)->alcancabilidade = (struct alcancabilidade *) NULL;
+    (*g)->conectividade = (struct conectividade *) NULL;
+    (*g)->entrada = (struct entrada_listas *) NULL;
+    (*g)->compacto = (struct compacto *) NULL;
+    (*g)->externo = (struct externo *) NULL;
+    (*g)->progresso = NULL;
+    (*g)->dados_progresso = NULL;
+    (*g)->areas = (struct area_trabalho *) NULL;
+    (*g)->controle = (struct controle *) NULL;
+    (*g)->fila = FILA_AUTOMATICA;
+    (*g)->pesos_conhecidos = 0;
+    (*g)->peso_minimo = 0;
+    (*g)->peso_maximo = 0;
+    (*g)->n_arcos = 0;
+    (*g)->versao = 0;
+    memset((*g)->guardados, 0, sizeof((*g)->guardados));
+    (*g)->memoria_guardados = 0;
+    (*g)->limite_guardados = LIMITE_GUARDADOS;
+    (*g)->uso_guardados = 0;
+    pthread_mutex_init(&(*g)->trava, NULL);
+    pthread_mutex_init(&(*g)->trava_areas, NULL);
+    pthread_mutex_init(&(*g)->trava_guardados, NULL);
+    memset(&(*g)->contadores, 0, sizeof(struct contadores));
+  }
+}
+
 //------------------------------------------------------------------------------
 static void insere_cabeca(lista l, no n) {
   /* Insere o nó na cabeça (começo) da lista */
@@ -51,31 +745,20 @@ static void insere_cabeca(lista l, no n) {
 }
 
 //------------------------------------------------------------------------------
-static void insere_cabeca_conteudo(lista l, void *conteudo) {
+static int insere_cabeca_conteudo(lista l, void *conteudo) {
   struct no *n;
 
-  /* Aloca o nó para o conteúdo e o insere no começo da lista */
+  /* Aloca o nó para o conteúdo e o insere no começo da lista; devolve 0 se
+     não há memória para o nó */
   n = (struct no *) malloc(sizeof(struct no));
 
-  if(n != NULL) {
-    n->conteudo = conteudo;
-    insere_cabeca(l, n);
-  }
-}
-
-//------------------------------------------------------------------------------
-static int lista_contem(lista l, void *conteudo) {
-  struct no *n;
-
-  /* Percorre os nós da lista até encontrar algum que tenha o conteúdo, se não
-     existir, retorna 0 */
-  for(n = l->primeiro; n != NULL; n = n->proximo) {
-    if(n->conteudo == conteudo) {
-      return 1;
-    }
+  if(n == NULL) {
+    return 0;
   }
 
-  return 0;
+  n->conteudo = conteudo;
+  insere_cabeca(l, n);
+  return 1;
 }
 
 //------------------------------------------------------------------------------
@@ -104,13 +787,6 @@ int _destroi(void *p) {
   return 1;
 }
 
-//------------------------------------------------------------------------------
-static int _mantem(void *p) {
-  /* Mantém p, função utilizada para remover apenas a lista, mas manter
-     os conteúdos alocados */
-  return 1;
-}
-
 //------------------------------------------------------------------------------
 int destroi_lista(lista l, int destroi(void *)) {
   struct no *n, *prox;
@@ -155,935 +831,9774 @@ static unsigned int encontra_vertice_indice(struct vertice *vertices, unsigned i
 }
 
 //------------------------------------------------------------------------------
-grafo le_grafo(FILE *input) {
-  Agraph_t *g;
-  Agnode_t *v;
-  Agedge_t *e;
-  struct grafo *grafo_lido;
-  struct aresta *a;
-  char *peso;
-  char peso_string[] = "peso";
+vertice busca_vertice(grafo g, char *nome) {
   unsigned int i;
 
-  /* Aloca a estrutura do grafo */
-  grafo_lido = (struct grafo *) malloc(sizeof(struct grafo));
-
-  if(grafo_lido != NULL) {
-    /* Inicializa a estrutura do grafo */
-    grafo_lido->nome = (char *) NULL;
-    grafo_lido->vertices = (struct vertice *) NULL;
-
-    /* Armazena em g o grafo lido da entrada */
-    if((g = agread(input, NULL)) == NULL) {
-      destroi_grafo(grafo_lido);
-      return NULL;
-    }
+  /* Devolve o vértice de g com o nome dado, se existir */
+  if((i = encontra_vertice_indice(g->vertices, g->n_vertices, nome)) == (unsigned int) -1) {
+    return NULL;
+  }
 
-    /* Define o nome do grafo e se ele é direcionado */
-    grafo_lido->direcionado = agisdirected(g);
-    grafo_lido->nome = strdup(agnameof(g));
-    grafo_lido->n_vertices = agnnodes(g);
+  return g->vertices + i;
+}
 
-    /* Verifica se g é um grafo ponderado ou não */
-    if(agattr(g, AGEDGE, peso_string, (char *) NULL) != NULL) {
-      grafo_lido->ponderado = 1;
-    } else {
-      grafo_lido->ponderado = 0;
-    }
+/* Nós NUMA da máquina, lidos de /sys/devices/system/node: os processadores
+   de cada nó (entre os permitidos ao processo), o nó de cada processador
+   e a máscara dos nós com memória. Sem sysfs, ou com um único nó, n_nos
+   é 1 e nada é fixado nem intercalado */
+struct topologia {
+  unsigned int n_nos;
+  cpu_set_t cpus[MAXIMO_NOS];
+  unsigned char no_da_cpu[CPU_SETSIZE];
+  unsigned long mascara;
+};
 
-    /* Aloca a quantidade de memória necessária para armazenar todos os vértices */
-    grafo_lido->vertices = (struct vertice *) malloc(sizeof(struct vertice) * grafo_lido->n_vertices);
+static struct topologia topologia;
+static pthread_once_t topologia_descoberta = PTHREAD_ONCE_INIT;
 
-    if(grafo_lido->vertices != NULL) {
-      /* Percorre todos os vértices do grafo */
-      for(i = 0, v = agfstnode(g); i < grafo_lido->n_vertices; ++i, v = agnxtnode(g, v)) {
-        /* Duplica na memória o nome do vértice e o atribui na estrutura.
-           A duplicação é feita para evitar erros (por exemplo, se o espaço for desalocado) */
-        grafo_lido->vertices[i].nome = strdup(agnameof(v));
+//------------------------------------------------------------------------------
+static unsigned int le_intervalos(const char *caminho, unsigned char *membro, unsigned int maximo) {
+  FILE *arquivo;
+  unsigned int a, b, n;
+  int c;
+
+  /* Lê uma lista de intervalos do sysfs, como "0-3,8-11", marcando em
+     membro os números menores que maximo; devolve quantos foram marcados */
+  if((arquivo = fopen(caminho, "r")) == NULL) {
+    return 0;
+  }
 
-        /* Aloca a lista de adjacência do vértice */
-        grafo_lido->vertices[i].arestas = (struct lista *) malloc(sizeof(struct lista));
+  for(n = 0; fscanf(arquivo, "%u", &a) == 1; ) {
+    b = a;
 
-        /* Coloca como nulo o primeiro elemento da lista de arestas (vazio) */
-        if(grafo_lido->vertices[i].arestas != NULL) {
-          grafo_lido->vertices[i].arestas->primeiro = NULL;
-        }
+    if((c = fgetc(arquivo)) == '-') {
+      if(fscanf(arquivo, "%u", &b) != 1) {
+        break;
       }
 
-      /* Percorre todos os vértices do grafo */
-      for(v = agfstnode(g); v != NULL; v = agnxtnode(g, v)) {
-        i = encontra_vertice_indice(grafo_lido->vertices, grafo_lido->n_vertices, agnameof(v));
+      c = fgetc(arquivo);
+    }
 
-        if(grafo_lido->vertices[i].arestas != NULL) {
-          /* Percorre todas as arestas adjacentes do vértice */
-          for(e = agfstedge(g, v); e != NULL; e = agnxtedge(g, e, v)) {
-            peso = agget(e, "peso");
+    for(; a <= b && a < maximo; ++a, ++n) {
+      membro[a] = 1;
+    }
 
-            /* Se o grafo não é direcionado, insere na lista de adjacência
-               de v definindo v como a origem */
-            if(!grafo_lido->direcionado) {
-              /* Inicializa aresta */
-              a = (struct aresta *) malloc(sizeof(struct aresta));
-              a->peso = (peso != NULL && *peso != '\0') ? atoi(peso) : 1;
-              a->origem = i;
+    if(c != ',') {
+      break;
+    }
+  }
 
-              /* Define destino da aresta */
-              if(v == aghead(e)) {
-                a->destino = encontra_vertice_indice(grafo_lido->vertices, grafo_lido->n_vertices, agnameof(agtail(e)));
-              } else {
-                a->destino = encontra_vertice_indice(grafo_lido->vertices, grafo_lido->n_vertices, agnameof(aghead(e)));
-              }
+  fclose(arquivo);
+  return n;
+}
 
-              /* Insere a aresta na lista de adjacência de v */
-              insere_cabeca_conteudo(grafo_lido->vertices[i].arestas, a);
+//------------------------------------------------------------------------------
+static void descobre_topologia(void) {
+  unsigned char online[MAXIMO_NOS], cpus[CPU_SETSIZE];
+  char caminho[64];
+  cpu_set_t permitidas;
+  unsigned int i, cpu, k;
+
+  memset(online, 0, sizeof(online));
+  topologia.n_nos = 0;
+  topologia.mascara = 0;
+
+  if(sched_getaffinity(0, sizeof(cpu_set_t), &permitidas) != 0) {
+    CPU_ZERO(&permitidas);
+  }
 
-            /* Se o grafo é direcionado, insere na lista de adjacência de v apenas se
-               v é origem (ou cauda) do arco */
-            } else {
-              if(v == agtail(e)) {
-                /* Inicializa aresta */
-                a = (struct aresta *) malloc(sizeof(struct aresta));
-                a->peso = (peso != NULL && *peso != '\0') ? atoi(peso) : 1;
-                a->origem = i;
-                a->destino = encontra_vertice_indice(grafo_lido->vertices, grafo_lido->n_vertices, agnameof(aghead(e)));
+  /* Os nós só de memória entram na máscara da intercalação, mas não
+     recebem threads */
+  if(le_intervalos("/sys/devices/system/node/online", online, MAXIMO_NOS) > 1) {
+    for(i = 0; i < MAXIMO_NOS; ++i) {
+      if(!online[i]) {
+        continue;
+      }
 
-                /* Insere a aresta na lista de adjacência de v e do destino do arco */
-                insere_cabeca_conteudo(grafo_lido->vertices[i].arestas, a);
-                insere_cabeca_conteudo(grafo_lido->vertices[a->destino].arestas, a);
-              }
-            }
-          }
+      topologia.mascara |= 1UL << i;
+      sprintf(caminho, "/sys/devices/system/node/node%u/cpulist", i);
+      memset(cpus, 0, sizeof(cpus));
+      le_intervalos(caminho, cpus, CPU_SETSIZE);
+      k = topologia.n_nos;
+      CPU_ZERO(&topologia.cpus[k]);
+
+      for(cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if(cpus[cpu] && CPU_ISSET(cpu, &permitidas)) {
+          CPU_SET(cpu, &topologia.cpus[k]);
+          topologia.no_da_cpu[cpu] = (unsigned char) k;
         }
       }
+
+      if(CPU_COUNT(&topologia.cpus[k]) > 0) {
+        ++topologia.n_nos;
+      }
     }
+  }
 
-    agclose(g);
+  if(topologia.n_nos < 2) {
+    topologia.n_nos = 1;
+    topologia.mascara = 0;
+    memset(topologia.no_da_cpu, 0, sizeof(topologia.no_da_cpu));
   }
+}
 
-  return grafo_lido;
+//------------------------------------------------------------------------------
+static unsigned int no_atual(void) {
+  int cpu;
+
+  /* Nó (índice em topologia) do processador em que o thread está */
+  pthread_once(&topologia_descoberta, descobre_topologia);
+
+  if(topologia.n_nos < 2 || (cpu = sched_getcpu()) < 0 || cpu >= CPU_SETSIZE) {
+    return 0;
+  }
+
+  return topologia.no_da_cpu[cpu];
 }
 
 //------------------------------------------------------------------------------
-int destroi_grafo(void *g) {
-  struct grafo *g_ptr;
+static void distribui_memoria(void *p, size_t tamanho, int intercala) {
+  uintptr_t inicio, fim, pagina;
+  unsigned long mascara;
 
-  g_ptr = (grafo) g;
+  if(p == NULL || tamanho < LIMIAR_PAGINAS_GRANDES) {
+    return;
+  }
 
-  if(g_ptr != NULL) {
-    /* Libera a região de memória ocupada pelo nome do grafo, se não for nula */
-    if(g_ptr->nome != NULL) {
-      free(g_ptr->nome);
-    }
+  /* Nas páginas inteiras de um vetor grande, pede páginas grandes
+     transparentes e, se intercala e há mais de um nó, distribui as páginas
+     entre os nós (movendo as já tocadas); sem intercalação cada página
+     fica no nó do thread que a toca primeiro. Os avisos que o sistema não
+     aceita são ignorados */
+  pthread_once(&topologia_descoberta, descobre_topologia);
+  pagina = (uintptr_t) sysconf(_SC_PAGESIZE);
+  inicio = ((uintptr_t) p + pagina - 1) & ~(pagina - 1);
+  fim = ((uintptr_t) p + tamanho) & ~(pagina - 1);
+
+  if(fim <= inicio) {
+    return;
+  }
 
-    /* Libera a região de memória ocupada pelos vértices do grafo, se não for nula */
-    if(g_ptr->vertices != NULL) {
-      unsigned int i;
+#ifdef MADV_HUGEPAGE
+  madvise((void *) inicio, fim - inicio, MADV_HUGEPAGE);
+#endif
 
-      /* Percorre todos os vértices e arestas liberando a região de memória ocupada
-         pelos mesmos */
-      for(i = 0; i < g_ptr->n_vertices; ++i) {
-        if(g_ptr->vertices[i].nome != NULL) {
-          free(g_ptr->vertices[i].nome);
-        }
+#ifdef SYS_mbind
+  if(intercala && topologia.n_nos > 1) {
+    mascara = topologia.mascara;
+    syscall(SYS_mbind, (void *) inicio, (unsigned long) (fim - inicio), MPOL_INTERLEAVE, &mascara, (unsigned long) MAXIMO_NOS + 1, MPOL_MF_MOVE);
+  }
+#else
+  (void) mascara;
+  (void) intercala;
+#endif
+}
 
-        if(g_ptr->vertices[i].arestas != NULL) {
-          destroi_lista(g_ptr->vertices[i].arestas, _destroi);
-        }
-      }
+/* Número de threads dos algoritmos paralelos definido por define_threads,
+   ou 0 para um por processador */
+static unsigned int threads_definidos;
 
-      /* Libera a array de vértices */
-      free(g_ptr->vertices);
-    }
+//------------------------------------------------------------------------------
+static unsigned int numero_threads(void) {
+  long int n;
 
-    /* Libera a região de memória ocupada pela estrutura do grafo */
-    free(g_ptr);
+  if((n = __atomic_load_n(&threads_definidos, __ATOMIC_RELAXED)) > 0) {
+    return (unsigned int) n;
   }
 
-  return 1;
+  /* Usa um thread por processador disponível */
+  n = sysconf(_SC_NPROCESSORS_ONLN);
+  return (n > 0) ? (unsigned int) n : 1;
 }
 
 //------------------------------------------------------------------------------
-grafo escreve_grafo(FILE *output, grafo g) {
-  struct no *n;
-  struct aresta *a;
-  char caractere_aresta;
+static int cria_thread(pthread_t *thread, unsigned int i, void *rotina(void *), void *argumento) {
+  pthread_attr_t atributos;
+  int criada;
+
+  /* Com mais de um nó NUMA, o i-ésimo thread fica nos processadores do nó
+     i mod n_nos, e a memória que ele toca primeiro (as suas áreas de
+     trabalho, as suas linhas da tabela) fica no seu nó; sem a afinidade
+     o thread é criado livre */
+  pthread_once(&topologia_descoberta, descobre_topologia);
+
+  if(topologia.n_nos > 1 && pthread_attr_init(&atributos) == 0) {
+    criada = (pthread_attr_setaffinity_np(&atributos, sizeof(cpu_set_t), topologia.cpus + i % topologia.n_nos) == 0 &&
+              pthread_create(thread, &atributos, rotina, argumento) == 0);
+    pthread_attr_destroy(&atributos);
+
+    if(criada) {
+      return 1;
+    }
+  }
+
+  return pthread_create(thread, NULL, rotina, argumento) == 0;
+}
+
+//------------------------------------------------------------------------------
+static void executa_paralelo(void *rotina(void *), void *argumentos, size_t tamanho, unsigned int n) {
+  pthread_t *threads;
+  unsigned char *criada;
   unsigned int i;
 
-  /* Imprime na saida a definição do grafo, caso seja um grafo direcionado,
-     é adicionado o prefixo "di" */
-  fprintf(output, "strict %sgraph \"%s\" {\n\n", (g->direcionado) ? "di" : "", g->nome);
+  threads = (pthread_t *) malloc(sizeof(pthread_t) * n);
+  criada = (unsigned char *) malloc(sizeof(unsigned char) * n);
 
-  /* Imprime os nomes dos vértices */
-  for(i = 0; i < g->n_vertices; ++i) {
-    fprintf(output, "    \"%s\"\n", g->vertices[i].nome);
-  }
+  /* Sem memória para os threads, executa todas as partes em sequência */
+  if(threads == NULL || criada == NULL) {
+    for(i = 0; i < n; ++i) {
+      rotina((char *) argumentos + i * tamanho);
+    }
+  } else {
+    /* Executa a rotina em um thread para cada argumento, ou no próprio
+       thread chamador se não for possível criar um novo */
+    for(i = 0; i < n; ++i) {
+      criada[i] = cria_thread(threads + i, i, rotina, (char *) argumentos + i * tamanho);
+
+      if(!criada[i]) {
+        rotina((char *) argumentos + i * tamanho);
+      }
+    }
 
-  fprintf(output, "\n");
+    for(i = 0; i < n; ++i) {
+      if(criada[i]) {
+        pthread_join(threads[i], NULL);
+      }
+    }
+  }
 
-  /* Se o grafo é direcionado, representamos as arestas por v -> u,
-     sendo v o vértice de origem e u o vértice de destino de cada aresta.
-     Caso contrário, representamos as arestas por v -- u */
-  caractere_aresta = (g->direcionado) ? '>' : '-';
+  free(threads);
+  free(criada);
+}
 
-  /* Imprime as arestas */
-  for(i = 0; i < g->n_vertices; ++i) {
-    for(n = primeiro_no(g->vertices[i].arestas); n != NULL; n = proximo_no(n)) {
-      a = (struct aresta *) n->conteudo;
+//------------------------------------------------------------------------------
+static void inicia_lexico(unsigned char lexico[N_LEXICOS][256]) {
+  unsigned int e, c, modo, colchete;
+
+  /* Tabela de transição do autômato que separa, em DOT, o texto comum das
+     strings entre aspas e dos comentários, e as listas de atributos do
+     resto; o modo fica nos três bits baixos do estado */
+  for(e = 0; e < N_LEXICOS; ++e) {
+    modo = e & ~LEX_COLCHETE;
+    colchete = e & LEX_COLCHETE;
+
+    for(c = 0; c < 256; ++c) {
+      switch(modo) {
+        case LEX_BARRA:
+          if(c == '*') {
+            lexico[e][c] = LEX_BLOCO | colchete;
+            break;
+          }
 
-      /* Se g é direcionado mostra o arco apenas se o vértice i é a origem, caso contrário
-         imprime apenas se origem < destino, isto garante que ela será impressa apenas uma vez */
-      if((g->direcionado && a->origem == i) || (!g->direcionado && a->origem < a->destino)) {
-        fprintf(output, "    \"%s\" -%c \"%s\"", g->vertices[a->origem].nome, caractere_aresta, g->vertices[a->destino].nome);
+          if(c == '/') {
+            lexico[e][c] = LEX_LINHA | colchete;
+            break;
+          }
 
-        /* Se g é um grafo ponderado, imprime o peso da aresta */
-        if(g->ponderado == 1) {
-          if(a->peso == infinito) {
-            fprintf(output, " [peso=oo]");
+          /* Uma barra isolada é texto comum */
+          /* fall through */
+        case LEX_NORMAL:
+          if(c == '"') {
+            lexico[e][c] = LEX_ASPAS | colchete;
+          } else if(c == '/') {
+            lexico[e][c] = LEX_BARRA | colchete;
+          } else if(c == '#') {
+            lexico[e][c] = LEX_LINHA | colchete;
+          } else if(c == '[') {
+            lexico[e][c] = LEX_NORMAL | LEX_COLCHETE;
+          } else if(c == ']') {
+            lexico[e][c] = LEX_NORMAL;
           } else {
-            fprintf(output, " [peso=%ld]", a->peso);
+            lexico[e][c] = LEX_NORMAL | colchete;
           }
-        }
+          break;
 
-        fprintf(output, "\n");
+        case LEX_ASPAS:
+          lexico[e][c] = ((c == '"') ? LEX_NORMAL : (c == '\\') ? LEX_ESCAPE : LEX_ASPAS) | colchete;
+          break;
+
+        case LEX_ESCAPE:
+          lexico[e][c] = LEX_ASPAS | colchete;
+          break;
+
+        case LEX_BLOCO:
+        case LEX_ASTERISCO:
+          lexico[e][c] = ((c == '*') ? LEX_ASTERISCO : (c == '/' && modo == LEX_ASTERISCO) ? LEX_NORMAL : LEX_BLOCO) | colchete;
+          break;
+
+        default:
+          lexico[e][c] = ((c == '\n') ? LEX_NORMAL : LEX_LINHA) | colchete;
+          break;
       }
     }
   }
-
-  fprintf(output, "}\n");
-  return g;
 }
 
 //------------------------------------------------------------------------------
-char *nome(grafo g) {
-  return g->nome;
+static void *transicoes_pedaco(void *argumento) {
+  struct pedaco_dot *p;
+  const unsigned char *s;
+  unsigned char atual[N_LEXICOS], trilha[N_LEXICOS], nova[N_LEXICOS];
+  unsigned int e, k, j, n_trilhas, n_novas;
+  size_t i, fim;
+
+  p = (struct pedaco_dot *) argumento;
+  s = p->leitura->texto;
+
+  /* Simula o autômato sobre o pedaço a partir de todos os estados ao mesmo
+     tempo; as simulações que chegam ao mesmo estado são fundidas a cada
+     bloco, de modo que quase sempre restam só duas (dentro e fora de aspas) */
+  for(e = 0; e < N_LEXICOS; ++e) {
+    atual[e] = e;
+    trilha[e] = e;
+  }
+
+  n_trilhas = N_LEXICOS;
+
+  for(i = p->inicio; i < p->fim; ) {
+    fim = (p->fim - i > 4096) ? i + 4096 : p->fim;
+
+    for(; i < fim; ++i) {
+      for(k = 0; k < n_trilhas; ++k) {
+        atual[k] = p->leitura->lexico[atual[k]][s[i]];
+      }
+    }
+
+    /* Funde as simulações que estão no mesmo estado */
+    for(k = 0, n_novas = 0; k < n_trilhas; ++k) {
+      for(j = 0; j < n_novas && atual[j] != atual[k]; ++j);
+
+      if(j == n_novas) {
+        atual[n_novas++] = atual[k];
+      }
+
+      nova[k] = j;
+    }
+
+    for(e = 0; e < N_LEXICOS; ++e) {
+      trilha[e] = nova[trilha[e]];
+    }
+
+    n_trilhas = n_novas;
+  }
+
+  for(e = 0; e < N_LEXICOS; ++e) {
+    p->transicao[e] = atual[trilha[e]];
+  }
+
+  return NULL;
 }
 
 //------------------------------------------------------------------------------
-unsigned int n_vertices(grafo g) {
-  return g->n_vertices;
+static int caractere_nome(unsigned char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c >= 0x80;
 }
 
 //------------------------------------------------------------------------------
-int direcionado(grafo g) {
-  return g->direcionado;
+static int espaco(unsigned char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
 }
 
 //------------------------------------------------------------------------------
-int conexo(grafo g) {
-  struct lista *comp;
-  int retorno;
+static int fronteira_segura(struct leitura_dot *l, size_t i) {
+  const unsigned char *s;
+  size_t j;
 
-  retorno = 0;
+  s = l->texto;
 
-  /* Se g é direcionado, então retorna 0 conforme especificação */
-  if(g->direcionado) {
+  /* Um ';' fora de aspas, comentários e listas de atributos sempre
+     termina um comando */
+  if(s[i] == ';') {
+    return 1;
+  }
+
+  /* Uma quebra de linha só termina o comando se ele acaba num nome (ou numa
+     lista de atributos) e o próximo começa com um; qualquer outra coisa de
+     um lado ou do outro (um operador de aresta, '=', um comentário) pode
+     continuar o comando, e a quebra é evitada */
+  for(j = i; j > l->inicio && espaco(s[j - 1]); --j);
+
+  if(j == l->inicio || !(caractere_nome(s[j - 1]) || s[j - 1] == '"' || s[j - 1] == ']' || s[j - 1] == '.')) {
     return 0;
   }
 
-  /* Caso contrário, processa os componentes de g e verifica se a lista
-     tem apenas o primeiro elemento definido, ou seja, se g tem apenas um
-     componente (e consequentemente é conexo) */
-  comp = componentes(g);
+  for(j = i + 1; j < l->fim && espaco(s[j]); ++j);
 
-  if(comp->primeiro != NULL && comp->primeiro->proximo == NULL) {
-    retorno = 1;
+  return j < l->fim && (caractere_nome(s[j]) || s[j] == '"' || s[j] == '}');
+}
+
+//------------------------------------------------------------------------------
+static void *fronteira_pedaco(void *argumento) {
+  struct pedaco_dot *p;
+  const unsigned char *s;
+  unsigned char e;
+  size_t i;
+
+  p = (struct pedaco_dot *) argumento;
+  s = p->leitura->texto;
+  p->encontrada = 0;
+
+  /* Procura, a partir do estado em que o pedaço começa, o primeiro ';' ou
+     quebra de linha fora de aspas, comentários e listas de atributos que
+     separe dois comandos */
+  for(i = p->inicio, e = p->estado; i < p->fim; ++i) {
+    if(e == LEX_NORMAL && (s[i] == ';' || s[i] == '\n') && fronteira_segura(p->leitura, i)) {
+      p->inicio = i + 1;
+      p->encontrada = 1;
+      break;
+    }
+
+    e = p->leitura->lexico[e][s[i]];
   }
 
-  destroi_lista(comp, destroi_grafo);
-  return retorno;
+  return NULL;
 }
 
 //------------------------------------------------------------------------------
-grafo arvore_geradora_minima(grafo g) {
-  struct grafo *t;
-  struct aresta *a, *aresta_selecionada;
-  struct no *n;
-  long int menor_peso;
-  unsigned int i, vertices_processados;
-  unsigned int *vertice_processado;
+static int palavra_reservada(const unsigned char *s, size_t n) {
+  static const char *palavras[] = { "node", "edge", "graph", "digraph", "subgraph", "strict" };
+  unsigned int i;
+  size_t j;
 
-  /* Se g é direcionado, retorna NULL conforme especificação */
-  if(g->direcionado) {
-    return NULL;
+  /* As palavras reservadas de DOT não distinguem maiúsculas */
+  for(i = 0; i < sizeof(palavras) / sizeof(palavras[0]); ++i) {
+    for(j = 0; j < n && palavras[i][j] != '\0' && (s[j] | 0x20) == palavras[i][j]; ++j);
+
+    if(j == n && palavras[i][j] == '\0') {
+      return 1;
+    }
   }
 
-  /* Aloca a árvore t */
-  t = (struct grafo *) malloc(sizeof(struct grafo));
+  return 0;
+}
 
-  if(t != NULL) {
-    /* Aloca os vértices da árvore e seus estados (processado ou não) */
-    t->vertices = (struct vertice *) malloc(sizeof(struct vertice) * g->n_vertices);
-    vertice_processado = (unsigned int *) malloc(sizeof(unsigned int) * g->n_vertices);
+//------------------------------------------------------------------------------
+static enum token_dot proximo_token(struct pedaco_dot *p, struct token *t) {
+  const unsigned char *s;
+  size_t i, j, k;
+
+  if(p->tem_devolvido) {
+    p->tem_devolvido = 0;
+    *t = p->devolvido;
+    return t->tipo;
+  }
 
-    if(t->vertices != NULL && vertice_processado != NULL) {
-      /* Inicializa árvore */
-      t->nome = NULL;
-      t->n_vertices = g->n_vertices;
-      t->ponderado = g->ponderado;
-      t->direcionado = 0;
+  s = p->leitura->texto;
+  i = p->pos;
 
-      /* Adiciona todos os vértices do grafo na árvore */
-      for(i = 0; i < g->n_vertices; ++i) {
-        t->vertices[i].nome = strdup(g->vertices[i].nome);
-        t->vertices[i].arestas = (struct lista *) malloc(sizeof(struct lista));
-        t->vertices[i].arestas->primeiro = NULL;
+  /* Pula espaços e comentários; '#' começa um comentário de linha, como as
+     linhas do pré-processador que a libcgraph ignora */
+  for(;;) {
+    for(; i < p->fim && espaco(s[i]); ++i);
 
-        vertice_processado[i] = 0;
+    if(i < p->fim && (s[i] == '#' || (s[i] == '/' && i + 1 < p->fim && s[i + 1] == '/'))) {
+      for(; i < p->fim && s[i] != '\n'; ++i);
+    } else if(i + 1 < p->fim && s[i] == '/' && s[i + 1] == '*') {
+      for(i += 2; i + 1 < p->fim && !(s[i] == '*' && s[i + 1] == '/'); ++i);
+
+      if(i + 1 >= p->fim) {
+        p->pos = p->fim;
+        return t->tipo = TOK_INVALIDO;
       }
 
-      /* Começa busca a partir do vértice de id 0 */
-      vertice_processado[0] = 1;
-      vertices_processados = 1;
+      i += 2;
+    } else {
+      break;
+    }
+  }
 
-      do {
-        aresta_selecionada = NULL;
-        menor_peso = infinito;
+  t->posicao = i;
+  t->texto = s + i;
+  t->tamanho = 1;
+  t->escapes = 0;
+
+  if(i >= p->fim) {
+    t->tipo = TOK_FIM;
+  } else if(s[i] == '"') {
+    /* String entre aspas; a fronteira de um pedaço nunca cai dentro de
+       uma, então ela termina antes do fim do pedaço */
+    for(j = i + 1; j < p->fim && s[j] != '"'; ++j) {
+      if(s[j] == '\\') {
+        t->escapes = 1;
+        ++j;
+      }
+    }
 
-        /* Varre todas as arestas da fronteira da árvore e seleciona
-           a que têm o menor peso */
-        for(i = 0; i < g->n_vertices; ++i) {
-          if(vertice_processado[i] == 1) {
-            for(n = g->vertices[i].arestas->primeiro; n != NULL; n = n->proximo) {
-              a = (struct aresta *) n->conteudo;
+    if(j >= p->fim) {
+      t->tipo = TOK_INVALIDO;
+    } else {
+      t->tipo = TOK_NOME;
+      t->texto = s + i + 1;
+      t->tamanho = j - i - 1;
+      i = j;
+    }
+  } else if(s[i] == '-' && i + 1 < p->fim && (s[i + 1] == '>' || s[i + 1] == '-')) {
+    t->tipo = (s[i + 1] == '>') ? TOK_ARCO : TOK_ARESTA;
+    t->tamanho = 2;
+    ++i;
+  } else if(s[i] == '-' || s[i] == '.' || (s[i] >= '0' && s[i] <= '9')) {
+    /* Numeral: -?(.[0-9]+|[0-9]+(.[0-9]*)?) */
+    for(j = i + (s[i] == '-'), k = 0; j < p->fim && s[j] >= '0' && s[j] <= '9'; ++j, ++k);
+
+    if(j < p->fim && s[j] == '.') {
+      for(++j; j < p->fim && s[j] >= '0' && s[j] <= '9'; ++j, ++k);
+    }
 
-              /* Se o destino não foi processado ainda, ou seja, se ele
-                 está na fronteira da árvore t */
-              if(vertice_processado[a->destino] == 0) {
-                /* Apenas seleciona a aresta se seu peso for menor */
-                if(menor_peso > a->peso) {
-                  menor_peso = a->peso;
-                  aresta_selecionada = a;
-                }
-              }
-            }
-          }
-        }
+    /* Um '-' ou '.' sozinho não é um numeral, e um numeral colado num nome
+       é ambíguo (a libcgraph o separa com um aviso) */
+    if(k == 0 || (j < p->fim && (caractere_nome(s[j]) || s[j] == '.'))) {
+      t->tipo = TOK_INVALIDO;
+    } else {
+      t->tipo = TOK_NOME;
+      t->tamanho = j - i;
+      i = j - 1;
+    }
+  } else if(caractere_nome(s[i])) {
+    for(j = i + 1; j < p->fim && caractere_nome(s[j]); ++j);
+
+    t->tipo = palavra_reservada(s + i, j - i) ? TOK_PALAVRA : TOK_NOME;
+    t->tamanho = j - i;
+    i = j - 1;
+  } else {
+    switch(s[i]) {
+      case '[': t->tipo = TOK_ABRE; break;
+      case ']': t->tipo = TOK_FECHA; break;
+      case '{': t->tipo = TOK_ABRE_CHAVE; break;
+      case '}': t->tipo = TOK_FECHA_CHAVE; break;
+      case '=': t->tipo = TOK_IGUAL; break;
+      case ',': t->tipo = TOK_SEPARADOR; break;
+      case ';': t->tipo = TOK_SEPARADOR; break;
+      default: t->tipo = TOK_INVALIDO; break;
+    }
+  }
 
-        /* Adiciona a aresta selecionada na árvore */
-        if(aresta_selecionada != NULL) {
-          /* Marca o vértice de destino da aresta como processado */
-          vertice_processado[aresta_selecionada->destino] = 1;
-          ++vertices_processados;
+  p->pos = i + 1;
+  return t->tipo;
+}
 
-          /* Aloca a aresta a ser adicionada na origem */
-          a = (struct aresta *) malloc(sizeof(struct aresta));
+//------------------------------------------------------------------------------
+static void devolve_token(struct pedaco_dot *p, struct token *t) {
+  p->devolvido = *t;
+  p->tem_devolvido = 1;
+}
 
-          if(a != NULL) {
-            /* Define os dados da aresta */
-            a->origem = aresta_selecionada->origem;
-            a->destino = aresta_selecionada->destino;
-            a->peso = aresta_selecionada->peso;
+//------------------------------------------------------------------------------
+static char *texto_token(struct token *t, size_t *tamanho) {
+  char *texto;
+  size_t i, n;
 
-            /* Insere a aresta no vértice de origem em t */
-            insere_cabeca_conteudo(t->vertices[aresta_selecionada->origem].arestas, a);
-          }
+  texto = (char *) malloc(t->tamanho + 1);
 
-          /* Aloca a aresta a ser adicionada no destino */
-          a = (struct aresta *) malloc(sizeof(struct aresta));
+  if(texto == NULL) {
+    return NULL;
+  }
 
-          if(a != NULL) {
-            /* Define os dados da aresta */
-            a->origem = aresta_selecionada->destino;
-            a->destino = aresta_selecionada->origem;
-            a->peso = aresta_selecionada->peso;
+  /* Copia o nome desfazendo os escapes como a libcgraph: \" vira " e uma
+     barra antes da quebra de linha a remove; as demais barras ficam */
+  for(i = 0, n = 0; i < t->tamanho; ++i) {
+    if(t->escapes && t->texto[i] == '\\' && i + 1 < t->tamanho && (t->texto[i + 1] == '"' || t->texto[i + 1] == '\n')) {
+      if(t->texto[++i] == '"') {
+        texto[n++] = '"';
+      }
+    } else {
+      texto[n++] = (char) t->texto[i];
+    }
+  }
 
-            /* Insere a aresta no vértice de destino em t */
-            insere_cabeca_conteudo(t->vertices[aresta_selecionada->origem].arestas, a);
-          }
-        }
+  texto[n] = '\0';
+  *tamanho = n;
+  return texto;
+}
 
-        /* Se não foi selecionada nenhuma aresta, então encerra a busca */
-      } while(aresta_selecionada != NULL);
+//------------------------------------------------------------------------------
+static uint64_t hash_nome(const unsigned char *texto, size_t tamanho) {
+  uint64_t h;
+  size_t i;
+
+  /* FNV-1a, com a mistura final do splitmix64 para espalhar os bits altos,
+     que escolhem a fatia da tabela */
+  for(i = 0, h = 0xcbf29ce484222325ULL; i < tamanho; ++i) {
+    h = (h ^ texto[i]) * 0x100000001b3ULL;
+  }
+
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+  return h ^ (h >> 31);
+}
+
+//------------------------------------------------------------------------------
+static struct nome_lido *interna_nome(struct leitura_dot *l, struct nome_lido *novo) {
+  struct fatia_nomes *f;
+  struct posicao_nome *posicoes;
+  struct nome_lido *e;
+  unsigned int i, j, capacidade;
+
+  f = l->fatias + (novo->hash >> (64 - BITS_FATIAS_NOMES));
+  pthread_mutex_lock(&f->trava);
+
+  /* Dobra a fatia quando ela passa de 3/4 de ocupação */
+  if((f->n + 1) * 4 > f->capacidade * 3) {
+    capacidade = (f->capacidade > 0) ? 2 * f->capacidade : 64;
+    posicoes = (struct posicao_nome *) calloc(capacidade, sizeof(struct posicao_nome));
+
+    if(posicoes == NULL) {
+      pthread_mutex_unlock(&f->trava);
+      return NULL;
+    }
 
-      free(vertice_processado);
+    for(i = 0; i < f->capacidade; ++i) {
+      if(f->posicoes[i].nome != NULL) {
+        for(j = f->posicoes[i].hash & (capacidade - 1); posicoes[j].nome != NULL; j = (j + 1) & (capacidade - 1));
+        posicoes[j] = f->posicoes[i];
+      }
     }
 
-    /* Se não foram processados todos os vértices, o grafo é desconexo e
-       então retorna NULL conforme especificação */
-    if(vertices_processados != g->n_vertices) {
-      destroi_grafo(t);
+    free(f->posicoes);
+    f->posicoes = posicoes;
+    f->capacidade = capacidade;
+  }
+
+  /* Devolve o nome já internado, guardando nele a primeira ocorrência no
+     arquivo, ou interna o novo */
+  for(i = novo->hash & (f->capacidade - 1); (e = f->posicoes[i].nome) != NULL; i = (i + 1) & (f->capacidade - 1)) {
+    if(f->posicoes[i].hash == novo->hash && e->tamanho == novo->tamanho && memcmp(e->texto, novo->texto, novo->tamanho) == 0) {
+      if(novo->primeira < e->primeira) {
+        e->primeira = novo->primeira;
+      }
+
+      pthread_mutex_unlock(&f->trava);
+      return e;
+    }
+  }
+
+  f->posicoes[i].hash = novo->hash;
+  f->posicoes[i].nome = novo;
+  ++f->n;
+  pthread_mutex_unlock(&f->trava);
+  return novo;
+}
+
+//------------------------------------------------------------------------------
+static struct nome_lido *vertice_lido(struct pedaco_dot *p, struct token *t) {
+  struct bloco_nomes *b;
+  struct nome_lido *n, *r;
+
+  /* Os nomes internados por um pedaço ficam em blocos dele, liberados no
+     fim da leitura */
+  if(p->nomes == NULL || p->nomes->n == NOMES_POR_BLOCO) {
+    if((b = (struct bloco_nomes *) malloc(sizeof(struct bloco_nomes))) == NULL) {
+      return NULL;
+    }
+
+    b->anterior = p->nomes;
+    b->n = 0;
+    p->nomes = b;
+  }
+
+  n = p->nomes->nomes + p->nomes->n;
+  n->copia = NULL;
+  n->primeira = t->posicao;
+
+  /* Nomes sem escapes são usados direto do arquivo mapeado */
+  if(t->escapes) {
+    if((n->copia = texto_token(t, &n->tamanho)) == NULL) {
       return NULL;
     }
+
+    n->texto = (const unsigned char *) n->copia;
+  } else {
+    n->texto = t->texto;
+    n->tamanho = t->tamanho;
+  }
+
+  n->hash = hash_nome(n->texto, n->tamanho);
+
+  /* Um nome já visto pelo pedaço tem a primeira ocorrência antes desta */
+  r = p->recentes[n->hash & (N_NOMES_RECENTES - 1)].nome;
+
+  if(r == NULL || p->recentes[n->hash & (N_NOMES_RECENTES - 1)].hash != n->hash || r->tamanho != n->tamanho || memcmp(r->texto, n->texto, n->tamanho) != 0) {
+    if((r = interna_nome(p->leitura, n)) == NULL) {
+      free(n->copia);
+      return NULL;
+    }
+
+    p->recentes[n->hash & (N_NOMES_RECENTES - 1)].hash = n->hash;
+    p->recentes[n->hash & (N_NOMES_RECENTES - 1)].nome = r;
+  }
+
+  if(r == n) {
+    ++p->nomes->n;
+  } else {
+    free(n->copia);
+  }
+
+  return r;
+}
+
+//------------------------------------------------------------------------------
+static int aresta_lida(struct pedaco_dot *p, struct nome_lido *u, struct nome_lido *v) {
+  struct aresta_lida *arestas;
+  size_t capacidade;
+
+  if(p->n_arestas == p->capacidade) {
+    capacidade = (p->capacidade > 0) ? 2 * p->capacidade : 1024;
+    arestas = (struct aresta_lida *) realloc(p->arestas, sizeof(struct aresta_lida) * capacidade);
+
+    if(arestas == NULL) {
+      return 0;
+    }
+
+    p->arestas = arestas;
+    p->capacidade = capacidade;
+  }
+
+  p->arestas[p->n_arestas].origem = u;
+  p->arestas[p->n_arestas].destino = v;
+  p->arestas[p->n_arestas].peso = 1;
+  p->arestas[p->n_arestas].peso_definido = 0;
+  ++p->n_arestas;
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static int le_atributos(struct pedaco_dot *p, size_t primeira) {
+  struct token chave, valor;
+  char numero[64];
+  long int peso;
+  size_t i;
+
+  /* Lê uma lista de atributos (o '[' já foi lido), guardando o "peso" nas
+     arestas do comando a partir de primeira; os demais são desconsiderados */
+  for(;;) {
+    switch(proximo_token(p, &chave)) {
+      case TOK_FECHA:
+        return 1;
+
+      case TOK_SEPARADOR:
+        continue;
+
+      case TOK_NOME:
+        break;
+
+      default:
+        return 0;
+    }
+
+    if(proximo_token(p, &valor) != TOK_IGUAL || proximo_token(p, &valor) != TOK_NOME) {
+      return 0;
+    }
+
+    if(primeira < p->n_arestas && chave.tamanho == 4 && memcmp(chave.texto, "peso", 4) == 0) {
+      /* O peso é convertido com atoi, como na leitura pela libcgraph */
+      i = (valor.tamanho < sizeof(numero)) ? valor.tamanho : sizeof(numero) - 1;
+      memcpy(numero, valor.texto, i);
+      numero[i] = '\0';
+      peso = (numero[0] != '\0') ? atoi(numero) : 1;
+      p->ponderado = 1;
+
+      for(i = primeira; i < p->n_arestas; ++i) {
+        p->arestas[i].peso = peso;
+        p->arestas[i].peso_definido = 1;
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static int le_comando(struct pedaco_dot *p, struct token *t) {
+  struct token u;
+  struct nome_lido *v, *w;
+  enum token_dot tipo;
+  size_t primeira;
+
+  /* Atribuição de atributo do grafo (nome = valor), desconsiderada */
+  if((tipo = proximo_token(p, &u)) == TOK_IGUAL) {
+    return proximo_token(p, &u) == TOK_NOME;
+  }
+
+  if((v = vertice_lido(p, t)) == NULL) {
+    return 0;
+  }
+
+  /* Comando de vértice ou cadeia de arestas v -> w -> ... */
+  for(primeira = p->n_arestas; tipo == TOK_ARCO || tipo == TOK_ARESTA; v = w, tipo = proximo_token(p, &u)) {
+    if((tipo == TOK_ARCO) != p->leitura->direcionado || proximo_token(p, &u) != TOK_NOME) {
+      return 0;
+    }
+
+    if((w = vertice_lido(p, &u)) == NULL || !aresta_lida(p, v, w)) {
+      return 0;
+    }
+  }
+
+  for(; tipo == TOK_ABRE; tipo = proximo_token(p, &u)) {
+    if(!le_atributos(p, primeira)) {
+      return 0;
+    }
+  }
+
+  devolve_token(p, &u);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static void *le_pedaco(void *argumento) {
+  struct pedaco_dot *p;
+  struct token t;
+
+  p = (struct pedaco_dot *) argumento;
+  p->pos = p->inicio;
+
+  /* Lê os comandos do pedaço; qualquer construção que a leitura paralela
+     não trata (subgrafos, atributos padrão, portas, strings HTML) é erro,
+     e o arquivo é lido de novo pela libcgraph */
+  while(!p->erro) {
+    switch(proximo_token(p, &t)) {
+      case TOK_FIM:
+        return NULL;
+
+      case TOK_SEPARADOR:
+        if(t.texto[0] != ';') {
+          p->erro = 1;
+        }
+        break;
+
+      case TOK_FECHA_CHAVE:
+        p->erro = p->fechado;
+        p->fechado = 1;
+        p->fim_grafo = t.posicao + 1;
+        break;
+
+      case TOK_NOME:
+        p->erro = p->fechado || !le_comando(p, &t);
+        break;
+
+      default:
+        p->erro = 1;
+        break;
+    }
+
+    p->vazio = 0;
+  }
+
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static int compara_primeira(const void *a, const void *b) {
+  const struct nome_lido *x, *y;
+
+  x = *(const struct nome_lido * const *) a;
+  y = *(const struct nome_lido * const *) b;
+  return (x->primeira < y->primeira) ? -1 : (x->primeira > y->primeira);
+}
+
+//------------------------------------------------------------------------------
+static int compara_ordem(const void *a, const void *b) {
+  const struct arco_lido *x, *y;
+
+  x = (const struct arco_lido *) a;
+  y = (const struct arco_lido *) b;
+  return (x->ordem < y->ordem) ? -1 : (x->ordem > y->ordem);
+}
+
+//------------------------------------------------------------------------------
+static int compara_destino_ordem(const void *a, const void *b) {
+  const struct arco_lido *x, *y;
+
+  x = (const struct arco_lido *) a;
+  y = (const struct arco_lido *) b;
+
+  if(x->destino != y->destino) {
+    return (x->destino < y->destino) ? -1 : 1;
+  }
+
+  return (x->ordem < y->ordem) ? -1 : (x->ordem > y->ordem);
+}
+
+//------------------------------------------------------------------------------
+static void *conta_arcos_lidos(void *argumento) {
+  struct parte_montagem *p;
+  struct aresta_lida *a;
+  size_t i;
+
+  p = (struct parte_montagem *) argumento;
+
+  /* Primeira fase da ordenação por contagem: o grau de saída de cada
+     vértice (nos dois sentidos, se o grafo não é direcionado) */
+  for(i = 0; i < p->pedaco->n_arestas; ++i) {
+    a = p->pedaco->arestas + i;
+    __atomic_add_fetch(p->m->inicio + a->origem->indice + 1, 1, __ATOMIC_RELAXED);
+
+    if(!p->m->g->direcionado && a->origem != a->destino) {
+      __atomic_add_fetch(p->m->inicio + a->destino->indice + 1, 1, __ATOMIC_RELAXED);
+    }
+  }
+
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void *distribui_arcos_lidos(void *argumento) {
+  struct parte_montagem *p;
+  struct aresta_lida *a;
+  struct arco_lido *arco;
+  unsigned int u, v;
+  size_t i;
+
+  p = (struct parte_montagem *) argumento;
+
+  /* Segunda fase: cada arco vai para uma posição livre do trecho da sua
+     origem, e leva o seu número de ordem no arquivo para que o trecho
+     possa depois ser posto na ordem da entrada */
+  for(i = 0; i < p->pedaco->n_arestas; ++i) {
+    a = p->pedaco->arestas + i;
+    u = a->origem->indice;
+    v = a->destino->indice;
+
+    arco = p->m->arcos + __atomic_fetch_add(p->m->posicao + u, 1, __ATOMIC_RELAXED);
+    arco->destino = v;
+    arco->peso = a->peso;
+    arco->peso_definido = a->peso_definido;
+    arco->ordem = p->pedaco->base + i;
+
+    if(!p->m->g->direcionado && u != v) {
+      arco = p->m->arcos + __atomic_fetch_add(p->m->posicao + v, 1, __ATOMIC_RELAXED);
+      arco->destino = u;
+      arco->peso = a->peso;
+      arco->peso_definido = a->peso_definido;
+      arco->ordem = p->pedaco->base + i;
+    }
+  }
+
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static int insere_no_lido(lista l, struct aresta *a) {
+  struct no *n;
+
+  if((n = (struct no *) malloc(sizeof(struct no))) == NULL) {
+    return 0;
+  }
+
+  n->conteudo = a;
+  insere_cabeca(l, n);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static void *monta_saida(void *argumento) {
+  struct parte_montagem *p;
+  struct montagem *m;
+  struct arco_lido *arcos;
+  struct aresta *a;
+  struct vertice *vertice;
+  size_t j, k, n;
+  unsigned int v;
+
+  p = (struct parte_montagem *) argumento;
+  m = p->m;
+
+  for(v = p->primeiro; v < p->ultimo && !m->erro; ++v) {
+    arcos = m->arcos + m->inicio[v];
+    n = m->inicio[v + 1] - m->inicio[v];
+
+    /* Num grafo estrito os arcos repetidos são um só, que fica com o
+       último peso definido para ele */
+    if(m->estrito && n > 1) {
+      qsort(arcos, n, sizeof(struct arco_lido), compara_destino_ordem);
+
+      for(j = 0, k = 0; j < n; ++j) {
+        if(k > 0 && arcos[k - 1].destino == arcos[j].destino) {
+          if(arcos[j].peso_definido) {
+            arcos[k - 1].peso = arcos[j].peso;
+            arcos[k - 1].peso_definido = 1;
+          }
+        } else {
+          arcos[k++] = arcos[j];
+        }
+      }
+
+      n = k;
+    }
+
+    /* Põe os arcos na ordem do arquivo, independente da ordem em que os
+       threads os distribuíram */
+    if(n > 1) {
+      qsort(arcos, n, sizeof(struct arco_lido), compara_ordem);
+    }
+
+    m->grau[v] = n;
+
+    vertice = m->g->vertices + v;
+
+    if((vertice->nome = (char *) malloc(m->nomes[v]->tamanho + 1)) == NULL) {
+      m->erro = 1;
+      break;
+    }
+
+    memcpy(vertice->nome, m->nomes[v]->texto, m->nomes[v]->tamanho);
+    vertice->nome[m->nomes[v]->tamanho] = '\0';
+    inicializa_lista(&vertice->arestas);
+
+    if(vertice->arestas == NULL) {
+      m->erro = 1;
+      break;
+    }
+
+    /* Insere de trás para frente para a lista ficar na ordem do arquivo */
+    for(j = n; j-- > 0; ) {
+      if((a = (struct aresta *) malloc(sizeof(struct aresta))) == NULL) {
+        m->erro = 1;
+        break;
+      }
+
+      a->origem = v;
+      a->destino = arcos[j].destino;
+      a->peso = arcos[j].peso;
+
+      if(!insere_no_lido(vertice->arestas, a)) {
+        free(a);
+        m->erro = 1;
+        break;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void divide_vertices(struct montagem *m, struct parte_montagem *partes, unsigned int n_partes) {
+  unsigned int i, v, baixo, alto;
+  size_t alvo, total;
+
+  /* Divide os vértices em faixas com aproximadamente o mesmo número de
+     vértices mais arcos */
+  total = m->inicio[m->g->n_vertices] + m->g->n_vertices;
+
+  for(i = 0, v = 0; i < n_partes; ++i) {
+    partes[i].m = m;
+    partes[i].primeiro = v;
+
+    for(alvo = total / n_partes * (i + 1), baixo = v, alto = m->g->n_vertices; baixo < alto; ) {
+      v = baixo + (alto - baixo) / 2;
+
+      if(m->inicio[v] + v < alvo) {
+        baixo = v + 1;
+      } else {
+        alto = v;
+      }
+    }
+
+    v = (i + 1 == n_partes) ? m->g->n_vertices : baixo;
+    partes[i].ultimo = v;
+  }
+}
+
+//------------------------------------------------------------------------------
+static size_t soma_prefixos(size_t *v, unsigned int n) {
+  unsigned int i;
+
+  for(i = 0; i < n; ++i) {
+    v[i + 1] += v[i];
+  }
+
+  return v[n];
+}
+
+//------------------------------------------------------------------------------
+static int monta_grafo_lido(grafo g, struct leitura_dot *l, struct pedaco_dot *pedacos, unsigned int n_pedacos) {
+  struct montagem m;
+  struct parte_montagem *partes;
+  struct nome_lido *e;
+  size_t n, n_arestas;
+  unsigned int i, j, n_partes;
+
+  memset(&m, 0, sizeof(struct montagem));
+  m.g = g;
+  m.estrito = l->estrito;
+
+  /* Numera os vértices na ordem da primeira ocorrência de cada nome no
+     arquivo, a mesma da libcgraph, e independente dos threads */
+  for(i = 0, n = 0; i < N_FATIAS_NOMES; ++i) {
+    n += l->fatias[i].n;
+  }
+
+  for(i = 0, n_arestas = 0; i < n_pedacos; ++i) {
+    pedacos[i].base = n_arestas;
+    n_arestas += pedacos[i].n_arestas;
+  }
+
+  if(n >= UINT_MAX || (n > 0 && (m.nomes = (struct nome_lido **) malloc(sizeof(struct nome_lido *) * n)) == NULL)) {
+    return 0;
+  }
+
+  for(i = 0, n = 0; i < N_FATIAS_NOMES; ++i) {
+    for(j = 0; j < l->fatias[i].capacidade; ++j) {
+      if((e = l->fatias[i].posicoes[j].nome) != NULL) {
+        m.nomes[n++] = e;
+      }
+    }
+  }
+
+  qsort(m.nomes, n, sizeof(struct nome_lido *), compara_primeira);
+
+  for(i = 0; i < n; ++i) {
+    m.nomes[i]->indice = i;
+  }
+
+  g->n_vertices = g->capacidade = (unsigned int) n;
+  n_partes = numero_threads();
+
+  if(n_partes > n_pedacos) {
+    n_partes = n_pedacos;
+  }
+
+  partes = (struct parte_montagem *) calloc(n_pedacos, sizeof(struct parte_montagem));
+  m.inicio = (size_t *) calloc(n + 1, sizeof(size_t));
+  m.posicao = (size_t *) malloc(sizeof(size_t) * (n + 1));
+  m.grau = (size_t *) malloc(sizeof(size_t) * (n + 1));
+  g->vertices = (struct vertice *) calloc(n + 1, sizeof(struct vertice));
+
+  if(partes == NULL || m.inicio == NULL || m.posicao == NULL || m.grau == NULL || g->vertices == NULL) {
+    m.erro = 1;
+  } else {
+    /* Ordenação por contagem dos arcos pela origem, com os pedaços
+       contando e distribuindo os seus arcos em paralelo */
+    for(i = 0; i < n_pedacos; ++i) {
+      partes[i].m = &m;
+      partes[i].pedaco = pedacos + i;
+    }
+
+    executa_paralelo(conta_arcos_lidos, partes, sizeof(struct parte_montagem), n_pedacos);
+    soma_prefixos(m.inicio, n);
+    memcpy(m.posicao, m.inicio, sizeof(size_t) * (n + 1));
+
+    if((m.arcos = (struct arco_lido *) malloc(sizeof(struct arco_lido) * (m.inicio[n] + 1))) == NULL) {
+      m.erro = 1;
+    }
+  }
+
+  if(!m.erro) {
+    executa_paralelo(distribui_arcos_lidos, partes, sizeof(struct parte_montagem), n_pedacos);
+
+    /* As listas são montadas por faixas de vértices */
+    divide_vertices(&m, partes, n_partes);
+    executa_paralelo(monta_saida, partes, sizeof(struct parte_montagem), n_partes);
+  }
+
+  free(partes);
+  free(m.nomes);
+  free(m.inicio);
+  free(m.posicao);
+  free(m.grau);
+  free(m.arcos);
+  return !m.erro;
+}
+
+//------------------------------------------------------------------------------
+static int le_cabecalho(struct pedaco_dot *p, grafo g) {
+  struct token t;
+  size_t tamanho;
+
+  /* [strict] (graph | digraph) nome '{'; grafos sem nome ficam para a
+     libcgraph, que lhes dá um nome interno */
+  if(proximo_token(p, &t) == TOK_PALAVRA && t.tamanho == 6) {
+    p->leitura->estrito = 1;
+    proximo_token(p, &t);
+  }
+
+  if(t.tipo != TOK_PALAVRA || !((t.tamanho == 5 && (t.texto[0] | 0x20) == 'g') || t.tamanho == 7)) {
+    return 0;
+  }
+
+  p->leitura->direcionado = g->direcionado = (t.tamanho == 7);
+
+  if(proximo_token(p, &t) != TOK_NOME || (g->nome = texto_token(&t, &tamanho)) == NULL) {
+    return 0;
+  }
+
+  return proximo_token(p, &t) == TOK_ABRE_CHAVE;
+}
+
+//------------------------------------------------------------------------------
+static grafo le_grafo_paralelo(FILE *input) {
+  struct stat estado;
+  struct leitura_dot *l;
+  struct pedaco_dot *pedacos, cabecalho;
+  struct bloco_nomes *b, *anterior;
+  struct grafo *g;
+  struct medida conversao, carga;
+  long int posicao;
+  unsigned int i, n_pedacos, fechado;
+  unsigned char e;
+  size_t tamanho;
+  void *mapa;
+  int ok;
+
+  /* Só arquivos comuns podem ser mapeados; o resto fica para a libcgraph */
+  if(fstat(fileno(input), &estado) != 0 || !S_ISREG(estado.st_mode) || (posicao = ftell(input)) < 0 || (size_t) posicao >= (size_t) estado.st_size) {
+    return NULL;
+  }
+
+  tamanho = (size_t) estado.st_size;
+
+  if((mapa = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, fileno(input), 0)) == MAP_FAILED) {
+    return NULL;
+  }
+
+  madvise(mapa, tamanho, MADV_SEQUENTIAL);
+
+  inicia_medida(&conversao);
+  inicia_medida(&carga);
+  inicializa_grafo(&g);
+  l = (struct leitura_dot *) calloc(1, sizeof(struct leitura_dot));
+  pedacos = NULL;
+  n_pedacos = 0;
+  ok = 0;
+
+  if(g != NULL && l != NULL) {
+    l->texto = (const unsigned char *) mapa;
+    l->fim = tamanho;
+    inicia_lexico(l->lexico);
+
+    for(i = 0; i < N_FATIAS_NOMES; ++i) {
+      pthread_mutex_init(&l->fatias[i].trava, NULL);
+    }
+
+    memset(&cabecalho, 0, sizeof(struct pedaco_dot));
+    cabecalho.leitura = l;
+    cabecalho.pos = (size_t) posicao;
+    cabecalho.fim = tamanho;
+
+    if(le_cabecalho(&cabecalho, g)) {
+      /* Um pedaço por thread, de pelo menos TAMANHO_PEDACO_DOT bytes */
+      l->inicio = cabecalho.pos;
+      n_pedacos = numero_threads();
+
+      if(n_pedacos > (tamanho - l->inicio) / TAMANHO_PEDACO_DOT) {
+        n_pedacos = (tamanho - l->inicio) / TAMANHO_PEDACO_DOT;
+      }
+
+      if(n_pedacos == 0) {
+        n_pedacos = 1;
+      }
+
+      pedacos = (struct pedaco_dot *) calloc(n_pedacos, sizeof(struct pedaco_dot));
+    }
+  }
+
+  if(pedacos != NULL) {
+    for(i = 0; i < n_pedacos; ++i) {
+      pedacos[i].leitura = l;
+      pedacos[i].inicio = l->inicio + (tamanho - l->inicio) / n_pedacos * i;
+      pedacos[i].fim = (i + 1 == n_pedacos) ? tamanho : l->inicio + (tamanho - l->inicio) / n_pedacos * (i + 1);
+      pedacos[i].vazio = 1;
+    }
+
+    /* Estado léxico no começo de cada pedaço, composto das transições de
+       todos os anteriores: é o que permite reconhecer, em paralelo, as
+       strings entre aspas e comentários que atravessam os pedaços */
+    if(n_pedacos > 1) {
+      executa_paralelo(transicoes_pedaco, pedacos, sizeof(struct pedaco_dot), n_pedacos);
+    }
+
+    for(i = 0, e = LEX_NORMAL; i < n_pedacos; e = pedacos[i++].transicao[e]) {
+      pedacos[i].estado = e;
+    }
+
+    /* Move o começo de cada pedaço para a primeira fronteira entre
+       comandos; um pedaço sem nenhuma fica vazio, absorvido pelo anterior */
+    if(n_pedacos > 1) {
+      executa_paralelo(fronteira_pedaco, pedacos + 1, sizeof(struct pedaco_dot), n_pedacos - 1);
+    }
+
+    for(i = n_pedacos - 1; i > 0; --i) {
+      if(!pedacos[i].encontrada) {
+        pedacos[i].inicio = (i + 1 < n_pedacos) ? pedacos[i + 1].inicio : tamanho;
+      }
+    }
+
+    for(i = 0; i < n_pedacos; ++i) {
+      pedacos[i].fim = (i + 1 < n_pedacos) ? pedacos[i + 1].inicio : tamanho;
+    }
+
+    executa_paralelo(le_pedaco, pedacos, sizeof(struct pedaco_dot), n_pedacos);
+
+    /* O grafo termina no único '}' lido, e depois dele só pode haver
+       espaços e comentários */
+    for(i = 0, ok = 1, fechado = 0; i < n_pedacos; ++i) {
+      if(pedacos[i].erro || (fechado && !pedacos[i].vazio)) {
+        ok = 0;
+      }
+
+      if(pedacos[i].fechado) {
+        fechado = 1;
+        posicao = (long int) pedacos[i].fim_grafo;
+      }
+
+      g->ponderado |= pedacos[i].ponderado;
+    }
+
+    ok = ok && fechado;
+  }
+
+  termina_medida(ok ? g : NULL, &carga, FASE_CARGA);
+
+  if(ok) {
+    ok = monta_grafo_lido(g, l, pedacos, n_pedacos);
+  }
+
+  termina_medida(ok ? g : NULL, &conversao, FASE_CONVERSAO);
+
+  /* Libera os nomes internados e os vetores de arestas dos pedaços */
+  for(i = 0; i < n_pedacos; ++i) {
+    for(b = pedacos[i].nomes; b != NULL; b = anterior) {
+      anterior = b->anterior;
+
+      while(b->n > 0) {
+        free(b->nomes[--b->n].copia);
+      }
+
+      free(b);
+    }
+
+    free(pedacos[i].arestas);
+  }
+
+  if(l != NULL) {
+    for(i = 0; i < N_FATIAS_NOMES; ++i) {
+      free(l->fatias[i].posicoes);
+      pthread_mutex_destroy(&l->fatias[i].trava);
+    }
+  }
+
+  free(pedacos);
+  free(l);
+  munmap(mapa, tamanho);
+
+  if(!ok) {
+    destroi_grafo(g);
+    return NULL;
+  }
+
+  /* Deixa a entrada logo depois do grafo lido, como a libcgraph */
+  fseek(input, posicao, SEEK_SET);
+  return g;
+}
+
+//------------------------------------------------------------------------------
+grafo le_grafo(FILE *input) {
+  Agraph_t *g;
+  Agnode_t *v;
+  Agedge_t *e;
+  struct grafo *grafo_lido;
+  struct aresta *a;
+  char *peso;
+  char peso_string[] = "peso";
+  unsigned int i;
+  struct medida conversao, carga;
+
+  /* Arquivos comuns são lidos em paralelo; a libcgraph fica para as
+     entradas que não podem ser mapeadas (como tubos) e para as construções
+     de DOT que a leitura paralela não trata */
+  if((grafo_lido = le_grafo_paralelo(input)) != NULL) {
+    distribui_memoria(grafo_lido->vertices, sizeof(struct vertice) * grafo_lido->n_vertices, 1);
+    return grafo_lido;
+  }
+
+  /* Aloca a estrutura do grafo */
+  inicia_medida(&conversao);
+  inicializa_grafo(&grafo_lido);
+
+  if(grafo_lido != NULL) {
+    /* Armazena em g o grafo lido da entrada */
+    inicia_medida(&carga);
+
+    if((g = agread(input, NULL)) == NULL) {
+      termina_medida(NULL, &carga, FASE_CARGA);
+      termina_medida(NULL, &conversao, FASE_CONVERSAO);
+      destroi_grafo(grafo_lido);
+      return NULL;
+    }
+
+    termina_medida(grafo_lido, &carga, FASE_CARGA);
+
+    /* Define o nome do grafo e se ele é direcionado */
+    grafo_lido->direcionado = agisdirected(g);
+    grafo_lido->nome = strdup(agnameof(g));
+    grafo_lido->n_vertices = agnnodes(g);
+    grafo_lido->capacidade = grafo_lido->n_vertices;
+
+    /* Verifica se g é um grafo ponderado ou não */
+    if(agattr(g, AGEDGE, peso_string, (char *) NULL) != NULL) {
+      grafo_lido->ponderado = 1;
+    } else {
+      grafo_lido->ponderado = 0;
+    }
+
+    /* Aloca a quantidade de memória necessária para armazenar todos os vértices */
+    grafo_lido->vertices = (struct vertice *) malloc(sizeof(struct vertice) * grafo_lido->n_vertices);
+
+    if(grafo_lido->vertices != NULL) {
+      /* Percorre todos os vértices do grafo */
+      for(i = 0, v = agfstnode(g); i < grafo_lido->n_vertices; ++i, v = agnxtnode(g, v)) {
+        /* Duplica na memória o nome do vértice e o atribui na estrutura.
+           A duplicação é feita para evitar erros (por exemplo, se o espaço for desalocado) */
+        grafo_lido->vertices[i].nome = strdup(agnameof(v));
+
+        /* Aloca a lista de adjacência do vértice */
+        grafo_lido->vertices[i].arestas = (struct lista *) malloc(sizeof(struct lista));
+
+        /* Coloca como nulo o primeiro elemento da lista de arestas (vazio) */
+        if(grafo_lido->vertices[i].arestas != NULL) {
+          grafo_lido->vertices[i].arestas->primeiro = NULL;
+        }
+      }
+
+      /* Percorre todos os vértices do grafo */
+      for(v = agfstnode(g); v != NULL; v = agnxtnode(g, v)) {
+        i = encontra_vertice_indice(grafo_lido->vertices, grafo_lido->n_vertices, agnameof(v));
+
+        if(grafo_lido->vertices[i].arestas != NULL) {
+          /* Percorre todas as arestas adjacentes do vértice */
+          for(e = agfstedge(g, v); e != NULL; e = agnxtedge(g, e, v)) {
+            peso = agget(e, "peso");
+
+            /* Se o grafo não é direcionado, insere na lista de adjacência
+               de v definindo v como a origem */
+            if(!grafo_lido->direcionado) {
+              /* Inicializa aresta */
+              a = (struct aresta *) malloc(sizeof(struct aresta));
+              a->peso = (peso != NULL && *peso != '\0') ? atoi(peso) : 1;
+              a->origem = i;
+
+              /* Define destino da aresta */
+              if(v == aghead(e)) {
+                a->destino = encontra_vertice_indice(grafo_lido->vertices, grafo_lido->n_vertices, agnameof(agtail(e)));
+              } else {
+                a->destino = encontra_vertice_indice(grafo_lido->vertices, grafo_lido->n_vertices, agnameof(aghead(e)));
+              }
+
+              /* Insere a aresta na lista de adjacência de v */
+              insere_cabeca_conteudo(grafo_lido->vertices[i].arestas, a);
+
+            /* Se o grafo é direcionado, insere na lista de adjacência de v apenas se
+               v é origem (ou cauda) do arco */
+            } else {
+              if(v == agtail(e)) {
+                /* Inicializa aresta */
+                a = (struct aresta *) malloc(sizeof(struct aresta));
+                a->peso = (peso != NULL && *peso != '\0') ? atoi(peso) : 1;
+                a->origem = i;
+                a->destino = encontra_vertice_indice(grafo_lido->vertices, grafo_lido->n_vertices, agnameof(aghead(e)));
+
+                /* Insere o arco na lista de adjacência de v; os arcos que
+                   entram em cada vértice são montados quando usados */
+                insere_cabeca_conteudo(grafo_lido->vertices[i].arestas, a);
+              }
+            }
+          }
+        }
+      }
+    }
+
+    agclose(g);
+    distribui_memoria(grafo_lido->vertices, sizeof(struct vertice) * grafo_lido->n_vertices, 1);
+  }
+
+  termina_medida(grafo_lido, &conversao, FASE_CONVERSAO);
+  return grafo_lido;
+}
+
+//------------------------------------------------------------------------------
+static void destroi_condensacao(struct condensacao *c) {
+  /* Libera os vetores da condensação e a própria estrutura */
+  if(c != NULL) {
+    free(c->componente);
+    free(c->inicio_membros);
+    free(c->membros);
+    free(c->inicio_sucessores);
+    free(c->sucessores);
+    free(c);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void destroi_alcancabilidade(struct alcancabilidade *a) {
+  /* Libera o fecho transitivo e os rótulos do índice */
+  if(a != NULL) {
+    free(a->fecho);
+    free(a->baixo);
+    free(a->pos);
+    free(a);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void destroi_conectividade(struct conectividade *c) {
+  /* Libera os vetores do union-find */
+  if(c != NULL) {
+    free(c->pai);
+    free(c->posto);
+    free(c);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void destroi_adjacencia(struct adjacencia_compacta *c) {
+  free(c->primeira);
+  free(c->inicio);
+  free(c->dados);
+  free(c->pesos);
+}
+
+//------------------------------------------------------------------------------
+static void destroi_compacto(struct compacto *c) {
+  if(c != NULL) {
+    destroi_adjacencia(&c->saida);
+    destroi_adjacencia(&c->entrada);
+    free(c);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void destroi_externo(struct externo *e) {
+  if(e != NULL) {
+    munmap(e->mapa, e->tamanho);
+    free(e);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void destroi_entrada(struct entrada_listas *e) {
+  if(e != NULL) {
+    free(e->inicio);
+    free(e->arco);
+    free(e);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void destroi_area(struct area_trabalho *a) {
+  if(a != NULL) {
+    free(a->distancia);
+    free(a->pai);
+    free(a->heap);
+    free(a->posicao);
+    free(a->rotulo);
+    free(a->inicio);
+    free(a->membros);
+    free(a->anterior);
+    free(a->baldes);
+    free(a->marcas);
+    free(a);
+  }
+}
+
+//------------------------------------------------------------------------------
+static struct area_trabalho *cria_area(unsigned int capacidade) {
+  struct area_trabalho *a;
+  unsigned int i;
+
+  if((a = (struct area_trabalho *) calloc(1, sizeof(struct area_trabalho))) == NULL) {
+    return NULL;
+  }
+
+  a->capacidade = capacidade;
+  a->no = no_atual();
+  a->distancia = (long int *) malloc(sizeof(long int) * (capacidade + 2));
+  a->pai = (unsigned int *) malloc(sizeof(unsigned int) * (capacidade + 2));
+  a->heap = (unsigned int *) malloc(sizeof(unsigned int) * (capacidade + 2));
+  a->posicao = (unsigned int *) malloc(sizeof(unsigned int) * (capacidade + 2));
+  a->rotulo = (unsigned int *) malloc(sizeof(unsigned int) * (capacidade + 2));
+  a->inicio = (unsigned int *) malloc(sizeof(unsigned int) * (capacidade + 2));
+  a->membros = (unsigned int *) malloc(sizeof(unsigned int) * (capacidade + 2));
+  a->anterior = (unsigned int *) malloc(sizeof(unsigned int) * (capacidade + 2));
+  a->baldes = (unsigned int *) malloc(sizeof(unsigned int) * BALDES_DIAL);
+  a->marcas = (uint64_t *) malloc(sizeof(uint64_t) * (capacidade / 64 + 1));
+
+  if(a->distancia == NULL || a->pai == NULL || a->heap == NULL || a->posicao == NULL || a->rotulo == NULL ||
+     a->inicio == NULL || a->membros == NULL || a->anterior == NULL || a->baldes == NULL || a->marcas == NULL) {
+    destroi_area(a);
+    return NULL;
+  }
+
+  for(i = 0; i < capacidade + 2; ++i) {
+    a->posicao[i] = (unsigned int) -1;
+  }
+
+  for(i = 0; i < BALDES_DIAL; ++i) {
+    a->baldes[i] = (unsigned int) -1;
+  }
+
+  return a;
+}
+
+//------------------------------------------------------------------------------
+static struct area_trabalho *pega_area(grafo g) {
+  struct area_trabalho *a, **anterior;
+  unsigned int no;
+
+  /* Tira uma área da reserva de g, de preferência uma criada no nó NUMA
+     do thread (cujas páginas ele tocou primeiro); a trava é mantida só
+     durante a retirada, e a área é criada fora dela se a reserva está
+     vazia (ou se a área retirada é pequena demais, depois de inserções de
+     vértices) */
+  no = no_atual();
+  pthread_mutex_lock(&g->trava_areas);
+
+  for(anterior = &g->areas; *anterior != NULL && (*anterior)->no != no; anterior = &(*anterior)->proxima);
+
+  if(*anterior == NULL) {
+    anterior = &g->areas;
+  }
+
+  if((a = *anterior) != NULL) {
+    *anterior = a->proxima;
+  }
+
+  pthread_mutex_unlock(&g->trava_areas);
+
+  if(a != NULL && a->capacidade < g->n_vertices) {
+    destroi_area(a);
+    a = NULL;
+  }
+
+  return (a != NULL) ? a : cria_area((g->capacidade > g->n_vertices) ? g->capacidade : g->n_vertices);
+}
+
+//------------------------------------------------------------------------------
+static void devolve_area(grafo g, struct area_trabalho *a) {
+  if(a != NULL) {
+    pthread_mutex_lock(&g->trava_areas);
+    a->proxima = g->areas;
+    g->areas = a;
+    pthread_mutex_unlock(&g->trava_areas);
+  }
+}
+
+//------------------------------------------------------------------------------
+int reserva_areas_trabalho(grafo g, unsigned int n) {
+  struct area_trabalho *a;
+  unsigned int i;
+
+  /* Conta as áreas já reservadas e cria as que faltam */
+  pthread_mutex_lock(&g->trava_areas);
+
+  for(a = g->areas, i = 0; a != NULL && i < n; a = a->proxima, ++i);
+
+  pthread_mutex_unlock(&g->trava_areas);
+
+  for(; i < n; ++i) {
+    if((a = cria_area((g->capacidade > g->n_vertices) ? g->capacidade : g->n_vertices)) == NULL) {
+      return 0;
+    }
+
+    devolve_area(g, a);
+  }
+
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+// resultados derivados guardados em um grafo entre as chamadas: cada um vale
+// para a versão do grafo em que foi calculado, que muda a cada alteração, e
+// quando a memória deles passa do limite os menos usados são descartados
+
+/* Um resultado guardado, com o seu tamanho estimado em bytes e o seu
+   último uso; as referências são a do grafo e as das chamadas que o estão
+   lendo, e a última a soltá-lo o destrói */
+struct guardado {
+  unsigned long versao;
+  size_t tamanho;
+  unsigned long uso;
+  unsigned int referencias;
+  void *dados;
+  int (*destroi)(void *dados);
+};
+
+//------------------------------------------------------------------------------
+static void solta_guardado(struct guardado *r) {
+  if(r != NULL && __atomic_sub_fetch(&r->referencias, 1, __ATOMIC_ACQ_REL) == 0) {
+    r->destroi(r->dados);
+    free(r);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void conta_resultado(grafo g, int reusado) {
+  __atomic_add_fetch(reusado ? &g->contadores.resultados_reusados : &g->contadores.resultados_calculados, 1, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+static struct guardado *busca_guardado(grafo g, enum tipo_guardado tipo) {
+  struct guardado *r;
+
+  /* O resultado do tipo, se é da versão atual de g, com uma referência a
+     mais para quem o pediu e deve soltá-lo */
+  pthread_mutex_lock(&g->trava_guardados);
+
+  if((r = g->guardados[tipo]) != NULL && r->versao == g->versao) {
+    r->uso = ++g->uso_guardados;
+    __atomic_add_fetch(&r->referencias, 1, __ATOMIC_RELAXED);
+  } else {
+    r = NULL;
+  }
+
+  pthread_mutex_unlock(&g->trava_guardados);
+  return r;
+}
+
+//------------------------------------------------------------------------------
+static void descarta_guardado(grafo g, enum tipo_guardado tipo) {
+  /* Chamada com a trava dos resultados guardados */
+  if(g->guardados[tipo] != NULL) {
+    g->memoria_guardados -= g->guardados[tipo]->tamanho;
+    solta_guardado(g->guardados[tipo]);
+    g->guardados[tipo] = NULL;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void descarta_guardados(grafo g) {
+  unsigned int i;
+
+  pthread_mutex_lock(&g->trava_guardados);
+
+  for(i = 0; i < N_GUARDADOS; ++i) {
+    descarta_guardado(g, (enum tipo_guardado) i);
+  }
+
+  pthread_mutex_unlock(&g->trava_guardados);
+}
+
+//------------------------------------------------------------------------------
+static void reduz_guardados(grafo g, size_t limite) {
+  unsigned int i, menos_usado;
+
+  /* Chamada com a trava dos resultados guardados; descarta os usados há
+     mais tempo até que a memória deles caiba no limite */
+  while(g->memoria_guardados > limite) {
+    for(i = 0, menos_usado = N_GUARDADOS; i < N_GUARDADOS; ++i) {
+      if(g->guardados[i] != NULL && (menos_usado == N_GUARDADOS || g->guardados[i]->uso < g->guardados[menos_usado]->uso)) {
+        menos_usado = i;
+      }
+    }
+
+    descarta_guardado(g, (enum tipo_guardado) menos_usado);
+  }
+}
+
+//------------------------------------------------------------------------------
+static int guarda_resultado(grafo g, enum tipo_guardado tipo, unsigned long versao, void *dados, size_t tamanho, int destroi(void *dados)) {
+  struct guardado *r;
+
+  /* Guarda dados como o resultado do tipo calculado na versão dada de g,
+     se g não mudou desde então e se ele cabe no limite, descartando os
+     menos usados até que caiba; se não guarda devolve 0, e os dados
+     continuam de quem chamou */
+  if((r = (struct guardado *) malloc(sizeof(struct guardado))) == NULL) {
+    return 0;
+  }
+
+  pthread_mutex_lock(&g->trava_guardados);
+
+  if(g->versao != versao || tamanho > g->limite_guardados) {
+    pthread_mutex_unlock(&g->trava_guardados);
+    free(r);
+    return 0;
+  }
+
+  descarta_guardado(g, tipo);
+  reduz_guardados(g, g->limite_guardados - tamanho);
+
+  r->versao = versao;
+  r->tamanho = tamanho;
+  r->uso = ++g->uso_guardados;
+  r->referencias = 1;
+  r->dados = dados;
+  r->destroi = destroi;
+  g->guardados[tipo] = r;
+  g->memoria_guardados += tamanho;
+  pthread_mutex_unlock(&g->trava_guardados);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+int destroi_grafo(void *g) {
+  struct grafo *g_ptr;
+  struct area_trabalho *a;
+
+  g_ptr = (grafo) g;
+
+  if(g_ptr != NULL) {
+    /* Libera a região de memória ocupada pelo nome do grafo, se não for nula */
+    if(g_ptr->nome != NULL) {
+      free(g_ptr->nome);
+    }
+
+    /* Libera a região de memória ocupada pelos vértices do grafo, se não for nula */
+    if(g_ptr->vertices != NULL) {
+      unsigned int i;
+
+      /* Percorre todos os vértices e arestas liberando a região de memória ocupada
+         pelos mesmos */
+      for(i = 0; i < g_ptr->n_vertices; ++i) {
+        if(g_ptr->vertices[i].nome != NULL) {
+          free(g_ptr->vertices[i].nome);
+        }
+
+        if(g_ptr->vertices[i].arestas != NULL) {
+          destroi_lista(g_ptr->vertices[i].arestas, _destroi);
+        }
+      }
+
+      /* Libera a array de vértices */
+      free(g_ptr->vertices);
+    }
+
+    /* Libera as estruturas derivadas e os resultados guardados no grafo */
+    descarta_guardados(g_ptr);
+    destroi_condensacao(g_ptr->condensacao);
+    destroi_alcancabilidade(g_ptr->alcancabilidade);
+    destroi_conectividade(g_ptr->conectividade);
+    destroi_entrada(g_ptr->entrada);
+    destroi_compacto(g_ptr->compacto);
+    destroi_externo(g_ptr->externo);
+
+    /* Libera as áreas de trabalho da reserva e as travas */
+    while((a = g_ptr->areas) != NULL) {
+      g_ptr->areas = a->proxima;
+      destroi_area(a);
+    }
+
+    pthread_mutex_destroy(&g_ptr->trava);
+    pthread_mutex_destroy(&g_ptr->trava_areas);
+    pthread_mutex_destroy(&g_ptr->trava_guardados);
+
+    /* Libera a região de memória ocupada pela estrutura do grafo */
+    free(g_ptr);
+  }
+
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static void inicia_tabelas_embaralhamento(void) {
+  unsigned int controle, j, b, posicao, tamanho;
+
+  /* Para cada byte de controle, a máscara de _mm_shuffle_epi8 que leva os
+     bytes de cada valor para o seu inteiro de 32 bits (0x80 zera o byte) */
+  for(controle = 0; controle < 256; ++controle) {
+    for(j = 0, posicao = 0; j < 4; ++j) {
+      tamanho = ((controle >> (2 * j)) & 3) + 1;
+
+      for(b = 0; b < 4; ++b) {
+        mascara_embaralhamento[controle][4 * j + b] = (b < tamanho) ? (unsigned char) (posicao + b) : 0x80;
+      }
+
+      posicao += tamanho;
+    }
+
+    tamanho_grupo[controle] = (unsigned char) posicao;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void decodifica_bloco(struct cursor *c) {
+  unsigned int k, j, b, tamanho, valor;
+  unsigned char controle;
+#ifdef __SSSE3__
+  __m128i x;
+#endif
+
+  /* Decodifica o próximo grupo de até quatro diferenças e soma cada uma ao
+     vizinho anterior */
+  k = (c->restantes < 4) ? c->restantes : 4;
+  controle = *c->controle++;
+
+#ifdef __SSSE3__
+  if(k == 4) {
+    x = _mm_loadu_si128((const __m128i *) c->dados);
+    x = _mm_shuffle_epi8(x, _mm_loadu_si128((const __m128i *) mascara_embaralhamento[controle]));
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi32(x, _mm_set1_epi32((int) c->anterior));
+    _mm_storeu_si128((__m128i *) c->bloco, x);
+    c->dados += tamanho_grupo[controle];
+    c->anterior = c->bloco[3];
+  } else
+#endif
+  for(j = 0; j < k; ++j) {
+    tamanho = ((controle >> (2 * j)) & 3) + 1;
+
+    for(b = 0, valor = 0; b < tamanho; ++b) {
+      valor |= (unsigned int) c->dados[b] << (8 * b);
+    }
+
+    c->dados += tamanho;
+    c->anterior += valor;
+    c->bloco[j] = c->anterior;
+  }
+
+  c->restantes -= k;
+  c->n_bloco = k;
+  c->i_bloco = 0;
+}
+
+//------------------------------------------------------------------------------
+static long int peso_compacto(const struct adjacencia_compacta *c, size_t aresta) {
+  switch(c->largura_peso) {
+    case 1: return ((const int8_t *) c->pesos)[aresta];
+    case 2: return ((const int16_t *) c->pesos)[aresta];
+    case 4: return ((const int32_t *) c->pesos)[aresta];
+    case 8: return (long int) ((const int64_t *) c->pesos)[aresta];
+    default: return c->peso_constante;
+  }
+}
+
+//------------------------------------------------------------------------------
+static struct entrada_listas *monta_entrada_listas(grafo g) {
+  struct entrada_listas *e;
+  struct no *n;
+  struct aresta *a;
+  unsigned int v;
+
+  if((e = (struct entrada_listas *) calloc(1, sizeof(struct entrada_listas))) == NULL ||
+     (e->inicio = (size_t *) calloc(g->n_vertices + 1, sizeof(size_t))) == NULL) {
+    destroi_entrada(e);
+    return NULL;
+  }
+
+  /* Ordenação por contagem dos arcos pelo destino; como as origens são
+     percorridas em ordem, os arcos que entram em cada vértice ficam na
+     ordem das origens */
+  for(v = 0; v < g->n_vertices; ++v) {
+    for(n = g->vertices[v].arestas->primeiro; n != NULL; n = n->proximo) {
+      ++e->inicio[((struct aresta *) n->conteudo)->destino + 1];
+    }
+  }
+
+  if((e->arco = (struct aresta **) malloc(sizeof(struct aresta *) * (soma_prefixos(e->inicio, g->n_vertices) + 1))) == NULL) {
+    destroi_entrada(e);
+    return NULL;
+  }
+
+  for(v = 0; v < g->n_vertices; ++v) {
+    for(n = g->vertices[v].arestas->primeiro; n != NULL; n = n->proximo) {
+      a = (struct aresta *) n->conteudo;
+      e->arco[e->inicio[a->destino]++] = a;
+    }
+  }
+
+  for(v = g->n_vertices; v > 0; --v) {
+    e->inicio[v] = e->inicio[v - 1];
+  }
+
+  /* Lidos por todos os threads das buscas: intercalados entre os nós */
+  e->inicio[0] = 0;
+  distribui_memoria(e->inicio, sizeof(size_t) * (g->n_vertices + 1), 1);
+  distribui_memoria(e->arco, sizeof(struct aresta *) * e->inicio[g->n_vertices], 1);
+  return e;
+}
+
+//------------------------------------------------------------------------------
+static int prepara_entrada(grafo g) {
+  /* Só os grafos direcionados representados por listas guardam os arcos
+     que entram em cada vértice à parte, e apenas a partir do primeiro
+     algoritmo que os percorre; consultas simultâneas os montam uma única
+     vez, sob a trava de g */
+  if(!g->direcionado || g->compacto != NULL || g->externo != NULL || __atomic_load_n(&g->entrada, __ATOMIC_ACQUIRE) != NULL) {
+    return 1;
+  }
+
+  pthread_mutex_lock(&g->trava);
+
+  if(g->entrada == NULL) {
+    __atomic_store_n(&g->entrada, monta_entrada_listas(g), __ATOMIC_RELEASE);
+  }
+
+  pthread_mutex_unlock(&g->trava);
+  return g->entrada != NULL;
+}
+
+//------------------------------------------------------------------------------
+static void inicia_cursor(grafo g, unsigned int v, int entrada, struct cursor *c) {
+  const struct adjacencia_compacta *adjacencia;
+  const struct adjacencia_externa *externa;
+
+  c->v = v;
+  c->n_bloco = c->i_bloco = 0;
+  c->destino = NULL;
+  c->arco = NULL;
+
+  if(g->compacto == NULL && g->externo != NULL) {
+    externa = entrada ? &g->externo->entrada : &g->externo->saida;
+    c->adjacencia = NULL;
+    c->n = NULL;
+    c->destino = externa->destino + externa->inicio[v];
+    c->fim_destino = externa->destino + externa->inicio[v + 1];
+    c->peso_arco = (externa->pesos != NULL) ? externa->pesos + externa->inicio[v] : NULL;
+    c->peso_constante = externa->peso_constante;
+    return;
+  }
+
+  /* Os arcos que entram em v nas listas vêm de prepara_entrada */
+  if(g->compacto == NULL) {
+    c->adjacencia = NULL;
+
+    if(entrada && g->direcionado) {
+      c->n = NULL;
+      c->arco = g->entrada->arco + g->entrada->inicio[v];
+      c->fim_arco = g->entrada->arco + g->entrada->inicio[v + 1];
+    } else {
+      c->n = g->vertices[v].arestas->primeiro;
+    }
+
+    return;
+  }
+
+  adjacencia = entrada ? &g->compacto->entrada : &g->compacto->saida;
+  c->adjacencia = adjacencia;
+  c->n = NULL;
+  c->aresta = adjacencia->primeira[v];
+  c->restantes = (unsigned int) (adjacencia->primeira[v + 1] - adjacencia->primeira[v]);
+  c->controle = adjacencia->dados + adjacencia->inicio[v];
+  c->dados = c->controle + (c->restantes + 3) / 4;
+  c->anterior = 0;
+}
+
+//------------------------------------------------------------------------------
+static int proximo_arco(struct cursor *c, unsigned int *w, long int *peso) {
+  struct aresta *a;
+
+  /* No arquivo de arestas os arcos de v são contíguos */
+  if(c->destino != NULL) {
+    if(c->destino == c->fim_destino) {
+      return 0;
+    }
+
+    *w = *c->destino++;
+    *peso = (c->peso_arco != NULL) ? (long int) *c->peso_arco++ : c->peso_constante;
+    return 1;
+  }
+
+  if(c->arco != NULL) {
+    if(c->arco == c->fim_arco) {
+      return 0;
+    }
+
+    a = *c->arco++;
+    *w = a->origem;
+    *peso = a->peso;
+    return 1;
+  }
+
+  if(c->adjacencia == NULL) {
+    if(c->n == NULL) {
+      return 0;
+    }
+
+    a = (struct aresta *) c->n->conteudo;
+    c->n = c->n->proximo;
+    *w = a->destino;
+    *peso = a->peso;
+    return 1;
+  }
+
+  if(c->i_bloco == c->n_bloco) {
+    if(c->restantes == 0) {
+      return 0;
+    }
+
+    decodifica_bloco(c);
+  }
+
+  *w = c->bloco[c->i_bloco++];
+  *peso = peso_compacto(c->adjacencia, c->aresta++);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static enum percurso modo_percurso(grafo g, int entrada, int com_peso) {
+  const struct adjacencia_compacta *c;
+  const struct adjacencia_externa *e;
+
+  /* Escolhe, uma vez por chamada, o modo de percurso das arestas de g;
+     sem peso (ou com todos os pesos iguais) os pesos não são lidos */
+  if(g->compacto != NULL) {
+    c = entrada ? &g->compacto->entrada : &g->compacto->saida;
+
+    switch(com_peso ? c->largura_peso : 0) {
+      case 1: return PERCURSO_COMPACTO_8;
+      case 2: return PERCURSO_COMPACTO_16;
+      case 4: return PERCURSO_COMPACTO_32;
+      case 8: return PERCURSO_COMPACTO_64;
+      default: return PERCURSO_COMPACTO;
+    }
+  }
+
+  if(g->externo != NULL) {
+    e = entrada ? &g->externo->entrada : &g->externo->saida;
+    return (com_peso && e->pesos != NULL) ? PERCURSO_EXTERNO_64 : PERCURSO_EXTERNO;
+  }
+
+  if(!g->direcionado) {
+    return PERCURSO_ARESTAS;
+  }
+
+  return entrada ? PERCURSO_ENTRADA : PERCURSO_SAIDA;
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA void inicia_percurso(grafo g, unsigned int v, int entrada, const enum percurso modo, struct cursor *c) {
+  const struct adjacencia_compacta *adjacencia;
+  const struct adjacencia_externa *externa;
+
+  c->v = v;
+
+  switch(modo) {
+    case PERCURSO_ARESTAS:
+    case PERCURSO_SAIDA:
+      c->n = g->vertices[v].arestas->primeiro;
+      break;
+
+    case PERCURSO_ENTRADA:
+      c->arco = g->entrada->arco + g->entrada->inicio[v];
+      c->fim_arco = g->entrada->arco + g->entrada->inicio[v + 1];
+      break;
+
+    case PERCURSO_EXTERNO:
+    case PERCURSO_EXTERNO_64:
+      externa = entrada ? &g->externo->entrada : &g->externo->saida;
+      c->destino = externa->destino + externa->inicio[v];
+      c->fim_destino = externa->destino + externa->inicio[v + 1];
+      c->peso_arco = (modo == PERCURSO_EXTERNO_64) ? externa->pesos + externa->inicio[v] : NULL;
+      c->peso_constante = externa->peso_constante;
+      break;
+
+    default:
+      adjacencia = entrada ? &g->compacto->entrada : &g->compacto->saida;
+      c->adjacencia = adjacencia;
+      c->pesos = adjacencia->pesos;
+      c->peso_constante = adjacencia->peso_constante;
+      c->aresta = adjacencia->primeira[v];
+      c->restantes = (unsigned int) (adjacencia->primeira[v + 1] - adjacencia->primeira[v]);
+      c->controle = adjacencia->dados + adjacencia->inicio[v];
+      c->dados = c->controle + (c->restantes + 3) / 4;
+      c->anterior = 0;
+      c->n_bloco = c->i_bloco = 0;
+      break;
+  }
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA int proximo_percurso(struct cursor *c, const enum percurso modo, unsigned int *w, long int *peso) {
+  struct aresta *a;
+
+  switch(modo) {
+    case PERCURSO_ARESTAS:
+    case PERCURSO_SAIDA:
+      /* A lista de v tem só os arcos que saem de v, ou as cópias das
+         arestas de v com ele como origem: não há o que pular */
+      if(c->n == NULL) {
+        return 0;
+      }
+
+      a = (struct aresta *) c->n->conteudo;
+      c->n = c->n->proximo;
+      *w = a->destino;
+      *peso = a->peso;
+      return 1;
+
+    case PERCURSO_ENTRADA:
+      if(c->arco == c->fim_arco) {
+        return 0;
+      }
+
+      a = *c->arco++;
+      *w = a->origem;
+      *peso = a->peso;
+      return 1;
+
+    case PERCURSO_EXTERNO:
+    case PERCURSO_EXTERNO_64:
+      if(c->destino == c->fim_destino) {
+        return 0;
+      }
+
+      *w = *c->destino++;
+      *peso = (modo == PERCURSO_EXTERNO_64) ? (long int) *c->peso_arco++ : c->peso_constante;
+      return 1;
+
+    default:
+      if(c->i_bloco == c->n_bloco) {
+        if(c->restantes == 0) {
+          return 0;
+        }
+
+        decodifica_bloco(c);
+      }
+
+      *w = c->bloco[c->i_bloco++];
+
+      switch(modo) {
+        case PERCURSO_COMPACTO_8: *peso = ((const int8_t *) c->pesos)[c->aresta++]; break;
+        case PERCURSO_COMPACTO_16: *peso = ((const int16_t *) c->pesos)[c->aresta++]; break;
+        case PERCURSO_COMPACTO_32: *peso = ((const int32_t *) c->pesos)[c->aresta++]; break;
+        case PERCURSO_COMPACTO_64: *peso = (long int) ((const int64_t *) c->pesos)[c->aresta++]; break;
+        default: *peso = c->peso_constante; break;
+      }
+
+      return 1;
+  }
+}
+
+//------------------------------------------------------------------------------
+// orçamento de memória (define_orcamento): as operações cobertas estimam,
+// pelos números de vértices e de arcos, o pico de memória que vão alocar,
+// trocam de estratégia quando a preferida não cabe e, quando nenhuma cabe,
+// falham antes de alocar, com a causa em ultimo_erro
+
+/* Orçamento das operações em bytes, ou 0 se não há */
+static size_t orcamento_memoria;
+
+/* Causa da falha da última operação coberta chamada pelo thread */
+static __thread int erro_thread;
+
+//------------------------------------------------------------------------------
+static void falha(int erro) {
+  /* Vale a primeira causa registrada: a falta de memória que segue uma
+     recusa do orçamento ou um circuito é consequência deles */
+  if(erro_thread == ERRO_NENHUM) {
+    erro_thread = erro;
+  }
+}
+
+//------------------------------------------------------------------------------
+static int cabe_orcamento(size_t bytes) {
+  size_t orcamento;
+
+  orcamento = __atomic_load_n(&orcamento_memoria, __ATOMIC_RELAXED);
+  return orcamento == 0 || bytes <= orcamento;
+}
+
+//------------------------------------------------------------------------------
+static int orcamento_operacao(grafo g, int operacao) {
+  /* Se a estimativa da operação (com a estratégia que ela escolheria)
+     cabe no orçamento; se não, a operação falha antes de alocar */
+  if(cabe_orcamento(estima_memoria(g, operacao))) {
+    return 1;
+  }
+
+  falha(ERRO_ORCAMENTO);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static size_t soma_memoria(size_t a, size_t b) {
+  /* Soma saturada das estimativas, que nos grafos enormes passam do
+     tamanho de size_t (e de qualquer orçamento) */
+  return (a > SIZE_MAX - b) ? SIZE_MAX : a + b;
+}
+
+//------------------------------------------------------------------------------
+static size_t bloco(size_t n, size_t tamanho) {
+  /* Um vetor de n elementos de tamanho bytes, com o controle do malloc */
+  if(tamanho > 0 && n > (SIZE_MAX - SOBRECARGA_MALLOC) / tamanho) {
+    return SIZE_MAX;
+  }
+
+  return n * tamanho + SOBRECARGA_MALLOC;
+}
+
+//------------------------------------------------------------------------------
+static size_t memoria_area(grafo g) {
+  size_t capacidade;
+
+  /* Os vetores de cria_area */
+  capacidade = ((g->capacidade > g->n_vertices) ? g->capacidade : g->n_vertices) + 2;
+  return bloco(1, sizeof(struct area_trabalho)) + bloco(capacidade, sizeof(long int)) +
+         7 * bloco(capacidade, sizeof(unsigned int)) + bloco(BALDES_DIAL, sizeof(unsigned int)) +
+         bloco(capacidade / 64 + 1, sizeof(uint64_t));
+}
+
+//------------------------------------------------------------------------------
+static size_t memoria_areas(grafo g, unsigned int n) {
+  struct area_trabalho *a;
+  unsigned int reservadas;
+
+  /* n áreas tomadas ao mesmo tempo, descontadas as da reserva de g que
+     ainda servem (pega_area as reaproveita sem alocar) */
+  pthread_mutex_lock(&g->trava_areas);
+
+  for(a = g->areas, reservadas = 0; a != NULL && reservadas < n; a = a->proxima) {
+    reservadas += (a->capacidade >= g->n_vertices);
+  }
+
+  pthread_mutex_unlock(&g->trava_areas);
+  return (size_t) (n - reservadas) * memoria_area(g);
+}
+
+//------------------------------------------------------------------------------
+static void faixa_pesos(grafo g, long int *minimo, long int *maximo) {
+  struct cursor c;
+  long int peso;
+  size_t arcos = 0;
+  unsigned int v, w;
+  int primeiro = 1;
+
+  /* O menor e o maior peso dos arcos de g (0 e 0 sem arcos), guardados em
+     g até a próxima alteração com o número de arcos: sem eles, uma única
+     busca em largura (ou estimativa de memória) custaria uma passada por
+     todos os arcos. Consultas simultâneas podem calculá-los juntas, com o
+     mesmo resultado */
+  if(__atomic_load_n(&g->pesos_conhecidos, __ATOMIC_ACQUIRE)) {
+    *minimo = __atomic_load_n(&g->peso_minimo, __ATOMIC_RELAXED);
+    *maximo = __atomic_load_n(&g->peso_maximo, __ATOMIC_RELAXED);
+    return;
+  }
+
+  *minimo = 0;
+  *maximo = 0;
+
+  for(v = 0; v < g->n_vertices; ++v) {
+    for(inicia_cursor(g, v, 0, &c); proximo_arco(&c, &w, &peso); primeiro = 0, ++arcos) {
+      *minimo = (primeiro || peso < *minimo) ? peso : *minimo;
+      *maximo = (primeiro || peso > *maximo) ? peso : *maximo;
+    }
+  }
+
+  __atomic_store_n(&g->peso_minimo, *minimo, __ATOMIC_RELAXED);
+  __atomic_store_n(&g->peso_maximo, *maximo, __ATOMIC_RELAXED);
+  __atomic_store_n(&g->n_arcos, arcos, __ATOMIC_RELAXED);
+  __atomic_store_n(&g->pesos_conhecidos, 1, __ATOMIC_RELEASE);
+}
+
+//------------------------------------------------------------------------------
+static size_t n_arcos(grafo g) {
+  long int minimo, maximo;
+
+  /* Os arcos percorridos pelos cursores a partir das origens (cada aresta
+     não direcionada conta uma vez em cada ponta); nas listas eles são
+     contados com os pesos */
+  if(g->compacto != NULL) {
+    return g->compacto->saida.primeira[g->n_vertices];
+  }
+
+  if(g->externo != NULL) {
+    return g->externo->saida.inicio[g->n_vertices];
+  }
+
+  faixa_pesos(g, &minimo, &maximo);
+  return __atomic_load_n(&g->n_arcos, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+static size_t memoria_entrada(grafo g) {
+  /* Os arcos que entram em cada vértice, se prepara_entrada ainda vai
+     montá-los */
+  if(!g->direcionado || g->compacto != NULL || g->externo != NULL || __atomic_load_n(&g->entrada, __ATOMIC_ACQUIRE) != NULL) {
+    return 0;
+  }
+
+  return bloco(1, sizeof(struct entrada_listas)) + bloco(g->n_vertices + 1, sizeof(size_t)) + bloco(n_arcos(g) + 1, sizeof(struct aresta *));
+}
+
+//------------------------------------------------------------------------------
+static size_t memoria_listas(size_t n, size_t tamanho) {
+  /* n conteúdos de tamanho bytes inseridos em listas, cada um com o seu nó */
+  return soma_memoria(bloco(n, bloco(1, sizeof(struct no))), bloco(n, bloco(1, tamanho)));
+}
+
+//------------------------------------------------------------------------------
+static size_t memoria_vertices(grafo g) {
+  size_t total;
+  unsigned int v;
+
+  /* Um grafo novo com os vértices de g, sem arestas: os nomes e as listas
+     vazias */
+  total = bloco(1, sizeof(struct grafo)) + bloco(g->n_vertices + 1, sizeof(struct vertice)) + bloco(g->n_vertices, bloco(1, sizeof(struct lista)));
+
+  for(v = 0; v < g->n_vertices; ++v) {
+    total = soma_memoria(total, bloco(strlen(g->vertices[v].nome) + 1, 1));
+  }
+
+  return total;
+}
+
+//------------------------------------------------------------------------------
+static int compara_vizinhos(const void *a, const void *b) {
+  const struct aresta *x, *y;
+
+  x = (const struct aresta *) a;
+  y = (const struct aresta *) b;
+  return (x->destino < y->destino) ? -1 : (x->destino > y->destino);
+}
+
+//------------------------------------------------------------------------------
+static unsigned int largura_pesos(long int menor, long int maior) {
+  /* A menor largura que comporta os pesos de menor a maior, ou 0 se são
+     todos iguais */
+  if(menor >= maior) {
+    return 0;
+  } else if(menor >= INT8_MIN && maior <= INT8_MAX) {
+    return 1;
+  } else if(menor >= INT16_MIN && maior <= INT16_MAX) {
+    return 2;
+  } else if(menor >= INT32_MIN && maior <= INT32_MAX) {
+    return 4;
+  }
+
+  return 8;
+}
+
+//------------------------------------------------------------------------------
+static void grava_peso(struct adjacencia_compacta *c, size_t aresta, long int peso) {
+  switch(c->largura_peso) {
+    case 1: ((int8_t *) c->pesos)[aresta] = (int8_t) peso; break;
+    case 2: ((int16_t *) c->pesos)[aresta] = (int16_t) peso; break;
+    case 4: ((int32_t *) c->pesos)[aresta] = (int32_t) peso; break;
+    case 8: ((int64_t *) c->pesos)[aresta] = (int64_t) peso; break;
+  }
+}
+
+//------------------------------------------------------------------------------
+static unsigned char *codifica_valor(unsigned char *controle, unsigned int k, unsigned int valor, unsigned char *d) {
+  unsigned int tamanho_valor;
+
+  /* Grava em d o k-ésimo valor de uma lista cujos bytes de controle
+     (zerados antes) começam em controle; devolve o fim dos bytes gravados */
+  tamanho_valor = (valor < (1u << 8)) ? 1 : (valor < (1u << 16)) ? 2 : (valor < (1u << 24)) ? 3 : 4;
+  controle[k / 4] |= (unsigned char) ((tamanho_valor - 1) << (2 * (k % 4)));
+
+  for(; tamanho_valor > 0; --tamanho_valor, valor >>= 8) {
+    *d++ = (unsigned char) (valor & 0xff);
+  }
+
+  return d;
+}
+
+//------------------------------------------------------------------------------
+static int codifica_adjacencia(grafo g, int entrada, struct adjacencia_compacta *c) {
+  struct cursor cursor;
+  struct aresta *vizinhos;
+  unsigned char *controle, *d;
+  size_t tamanho, capacidade, e;
+  long int menor, maior, peso;
+  unsigned int v, w, k, grau;
+
+  c->primeira = (size_t *) malloc(sizeof(size_t) * (g->n_vertices + 1));
+  c->inicio = (size_t *) malloc(sizeof(size_t) * (g->n_vertices + 1));
+  c->dados = NULL;
+  c->pesos = NULL;
+  c->grau_maximo = 0;
+
+  if(c->primeira == NULL || c->inicio == NULL) {
+    return 0;
+  }
+
+  /* Primeira passada: graus, faixa dos pesos e o maior tamanho possível
+     dos dados (todos os valores com 4 bytes), alocado de uma vez para que
+     o pico de memória seja o estimado; as páginas que sobram não são
+     tocadas e voltam ao sistema no fim */
+  menor = LONG_MAX;
+  maior = LONG_MIN;
+  capacidade = 16;
+  c->primeira[0] = 0;
+
+  for(v = 0; v < g->n_vertices; ++v) {
+    inicia_cursor(g, v, entrada, &cursor);
+
+    for(grau = 0; proximo_arco(&cursor, &w, &peso); ++grau) {
+      menor = (peso < menor) ? peso : menor;
+      maior = (peso > maior) ? peso : maior;
+    }
+
+    c->primeira[v + 1] = c->primeira[v] + grau;
+    c->grau_maximo = (grau > c->grau_maximo) ? grau : c->grau_maximo;
+    capacidade += (grau + 3) / 4 + 4 * (size_t) grau;
+  }
+
+  /* A largura dos pesos é a menor que comporta todos eles; os arcos de
+     entrada não guardam pesos */
+  c->peso_constante = (menor == maior) ? menor : 1;
+  c->largura_peso = entrada ? 0 : largura_pesos(menor, maior);
+
+  vizinhos = (struct aresta *) malloc(sizeof(struct aresta) * (c->grau_maximo + 1));
+  c->dados = (unsigned char *) malloc(capacidade);
+  c->pesos = (c->largura_peso > 0) ? malloc(c->largura_peso * (c->primeira[g->n_vertices] + 1)) : NULL;
+
+  if(vizinhos == NULL || c->dados == NULL || (c->largura_peso > 0 && c->pesos == NULL)) {
+    free(vizinhos);
+    return 0;
+  }
+
+  /* Segunda passada: ordena e codifica os vizinhos de cada vértice; o
+     vetor de dados tem sempre 16 bytes de folga para as leituras de 128
+     bits da decodificação */
+  for(v = 0, tamanho = 0, e = 0; v < g->n_vertices; ++v) {
+    inicia_cursor(g, v, entrada, &cursor);
+
+    for(grau = 0; proximo_arco(&cursor, &vizinhos[grau].destino, &vizinhos[grau].peso); ++grau);
+
+    qsort(vizinhos, grau, sizeof(struct aresta), compara_vizinhos);
+
+    c->inicio[v] = tamanho;
+    controle = c->dados + tamanho;
+    d = controle + (grau + 3) / 4;
+    memset(controle, 0, (grau + 3) / 4);
+
+    for(k = 0; k < grau; ++k, ++e) {
+      d = codifica_valor(controle, k, vizinhos[k].destino - ((k > 0) ? vizinhos[k - 1].destino : 0), d);
+      grava_peso(c, e, vizinhos[k].peso);
+    }
+
+    tamanho = (size_t) (d - c->dados);
+  }
+
+  c->inicio[g->n_vertices] = tamanho;
+  free(vizinhos);
+
+  /* Devolve a memória que sobrou, mantendo a folga */
+  if((d = (unsigned char *) realloc(c->dados, tamanho + 16)) != NULL) {
+    c->dados = d;
+  }
+
+  memset(c->dados + tamanho, 0, 16);
+
+  /* Lidos por todos os threads das buscas: intercalados entre os nós */
+  distribui_memoria(c->primeira, sizeof(size_t) * (g->n_vertices + 1), 1);
+  distribui_memoria(c->inicio, sizeof(size_t) * (g->n_vertices + 1), 1);
+  distribui_memoria(c->dados, tamanho + 16, 1);
+  distribui_memoria(c->pesos, c->largura_peso * c->primeira[g->n_vertices], 1);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static size_t memoria_adjacencia(grafo g, int entrada, size_t arcos) {
+  long int minimo, maximo;
+
+  /* Os vetores de codifica_adjacencia para arcos arcos, com os dados no
+     tamanho máximo e o vetor dos vizinhos no maior grau possível */
+  faixa_pesos(g, &minimo, &maximo);
+  return soma_memoria(2 * bloco(g->n_vertices + 1, sizeof(size_t)) + bloco((arcos + 3) / 4 + 4 * arcos + 16, 1) +
+                      bloco(((arcos < g->n_vertices) ? arcos : g->n_vertices) + 1, sizeof(struct aresta)), entrada ? 0 : bloco(arcos + 1, largura_pesos(minimo, maximo)));
+}
+
+//------------------------------------------------------------------------------
+static void libera_listas(grafo g) {
+  struct no *n, *proximo;
+  unsigned int i;
+
+  destroi_entrada(g->entrada);
+  g->entrada = NULL;
+
+  /* Libera os nós e as arestas, mantendo as listas (vazias) */
+  for(i = 0; i < g->n_vertices; ++i) {
+    for(n = g->vertices[i].arestas->primeiro; n != NULL; n = proximo) {
+      proximo = n->proximo;
+      free(n->conteudo);
+      free(n);
+    }
+
+    g->vertices[i].arestas->primeiro = NULL;
+  }
+}
+
+//------------------------------------------------------------------------------
+static size_t memoria_compacta(grafo g) {
+  size_t total;
+
+  /* Os arcos que saem de cada vértice e, num grafo direcionado, os que
+     entram, montados nas listas antes de codificados */
+  total = soma_memoria(bloco(1, sizeof(struct compacto)), memoria_adjacencia(g, 0, n_arcos(g)));
+
+  if(g->direcionado) {
+    total = soma_memoria(total, soma_memoria(memoria_entrada(g), memoria_adjacencia(g, 1, n_arcos(g))));
+  }
+
+  return total;
+}
+
+//------------------------------------------------------------------------------
+int compacta_grafo(grafo g) {
+  struct compacto *c;
+  struct medida m;
+
+  erro_thread = ERRO_NENHUM;
+
+  if(g->compacto != NULL) {
+    return 1;
+  }
+
+  if(!cabe_orcamento(memoria_compacta(g))) {
+    falha(ERRO_ORCAMENTO);
+    return 0;
+  }
+
+  inicia_medida(&m);
+  pthread_once(&tabelas_iniciadas, inicia_tabelas_embaralhamento);
+  c = (struct compacto *) calloc(1, sizeof(struct compacto));
+
+  /* Os arcos que entram em cada vértice só são guardados em grafos
+     direcionados */
+  if(c == NULL || !codifica_adjacencia(g, 0, &c->saida) ||
+     (g->direcionado && (!prepara_entrada(g) || !codifica_adjacencia(g, 1, &c->entrada)))) {
+    destroi_compacto(c);
+    falha(ERRO_MEMORIA);
+    termina_medida(g, &m, FASE_INDICE);
+    return 0;
+  }
+
+  /* Um grafo em disco passa a ter as arestas em memória */
+  libera_listas(g);
+  g->compacto = c;
+  destroi_externo(g->externo);
+  g->externo = NULL;
+  termina_medida(g, &m, FASE_INDICE);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+int descompacta_grafo(grafo g) {
+  struct compacto *c;
+  struct cursor cursor;
+  struct aresta *a;
+  long int peso;
+  unsigned int v, w;
+
+  if((c = g->compacto) == NULL && g->externo == NULL) {
+    return 1;
+  }
+
+  /* Os cursores leem da representação compacta (ou do arquivo de arestas)
+     até que ela seja retirada de g; cada arco é colocado na lista da sua
+     origem e cada cópia de uma aresta não direcionada na do seu vértice */
+  for(v = 0; v < g->n_vertices; ++v) {
+    inicia_cursor(g, v, 0, &cursor);
+
+    while(proximo_arco(&cursor, &w, &peso)) {
+      if((a = (struct aresta *) malloc(sizeof(struct aresta))) == NULL || !insere_cabeca_conteudo(g->vertices[v].arestas, a)) {
+        free(a);
+        g->compacto = NULL;
+        libera_listas(g);
+        g->compacto = c;
+        return 0;
+      }
+
+      a->origem = v;
+      a->destino = w;
+      a->peso = peso;
+    }
+  }
+
+  g->compacto = NULL;
+  destroi_compacto(c);
+  destroi_externo(g->externo);
+  g->externo = NULL;
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+size_t memoria_arestas(grafo g) {
+  struct adjacencia_compacta *c;
+  struct no *n;
+  size_t total;
+  unsigned int i;
+
+  /* Representação compacta: vetores de índices, dados e pesos */
+  if(g->compacto != NULL) {
+    total = sizeof(struct compacto);
+
+    for(i = 0; i < 2; ++i) {
+      c = i ? &g->compacto->entrada : &g->compacto->saida;
+
+      if(c->primeira != NULL) {
+        total += 2 * sizeof(size_t) * (g->n_vertices + 1) + c->inicio[g->n_vertices] + 16 + c->largura_peso * c->primeira[g->n_vertices];
+      }
+    }
+
+    return total;
+  }
+
+  /* Arquivo de arestas: vetores de índices, destinos e pesos */
+  if(g->externo != NULL) {
+    return g->externo->tamanho - (size_t) ((const unsigned char *) g->externo->saida.inicio - g->externo->mapa);
+  }
+
+  /* Listas: a lista de cada vértice, um nó e uma aresta por arco ou por
+     cópia de aresta, e os arcos que entram em cada vértice, se montados */
+  for(i = 0, total = 0; i < g->n_vertices; ++i) {
+    total += sizeof(struct lista);
+
+    for(n = g->vertices[i].arestas->primeiro; n != NULL; n = n->proximo) {
+      total += sizeof(struct no) + sizeof(struct aresta);
+    }
+  }
+
+  if(g->entrada != NULL) {
+    total += sizeof(struct entrada_listas) + sizeof(size_t) * (g->n_vertices + 1) + sizeof(struct aresta *) * (g->entrada->inicio[g->n_vertices] + 1);
+  }
+
+  return total;
+}
+
+//------------------------------------------------------------------------------
+static void dispoe_externo(const struct cabecalho_externo *c, struct disposicao_externa *d) {
+  size_t n;
+
+  /* Calcula a posição de cada parte do arquivo de arestas a partir do
+     cabeçalho, alinhando cada vetor em 8 bytes */
+  n = (size_t) c->n_vertices + 1;
+  d->nomes = sizeof(struct cabecalho_externo);
+  d->inicio_saida = (d->nomes + c->tamanho_nomes + 7) & ~(size_t) 7;
+  d->inicio_entrada = d->inicio_saida + sizeof(uint64_t) * n;
+  d->pesos = d->inicio_entrada + (c->direcionado ? sizeof(uint64_t) * n : 0);
+  d->destino_saida = d->pesos + (c->tem_pesos ? sizeof(int64_t) * c->n_arcos : 0);
+  d->destino_entrada = d->destino_saida + sizeof(uint32_t) * c->n_arcos;
+  d->tamanho = d->destino_entrada + sizeof(uint32_t) * c->n_arcos_entrada;
+}
+
+//------------------------------------------------------------------------------
+static void aconselha(const void *base, size_t tamanho_arco, size_t de, size_t ate, int conselho) {
+  uintptr_t inicio, fim, pagina;
+
+  /* madvise sobre as páginas que contêm os arcos [de, ate) do vetor base */
+  if(base == NULL || de >= ate) {
+    return;
+  }
+
+  pagina = (uintptr_t) sysconf(_SC_PAGESIZE);
+  inicio = ((uintptr_t) base + de * tamanho_arco) & ~(pagina - 1);
+  fim = (uintptr_t) base + ate * tamanho_arco;
+  madvise((void *) inicio, fim - inicio, conselho);
+}
+
+//------------------------------------------------------------------------------
+static void aconselha_janela(const struct adjacencia_externa *a, size_t de, size_t ate, int conselho) {
+  aconselha(a->destino, sizeof(uint32_t), de, ate, conselho);
+  aconselha(a->pesos, sizeof(int64_t), de, ate, conselho);
+}
+
+//------------------------------------------------------------------------------
+static void inicia_passada(grafo g, int entrada, struct passada *p) {
+  p->g = g;
+  p->entrada = entrada;
+  p->inicio = 0;
+  p->fim = 0;
+}
+
+//------------------------------------------------------------------------------
+static void avanca_passada(struct passada *p, unsigned int v) {
+  const struct adjacencia_externa *a;
+  size_t primeiro, ultimo, total, janela;
+
+  if(p->g->externo == NULL || p->g->compacto != NULL) {
+    return;
+  }
+
+  a = p->entrada ? &p->g->externo->entrada : &p->g->externo->saida;
+  primeiro = a->inicio[v];
+  ultimo = a->inicio[v + 1];
+
+  if(primeiro >= p->inicio && ultimo <= p->fim) {
+    return;
+  }
+
+  /* Os arcos de v saíram da janela: devolve ao sistema as páginas da
+     janela anterior e traz a próxima no sentido da passada (crescente se v
+     está depois da janela), pedindo também a leitura antecipada da seguinte */
+  aconselha_janela(a, p->inicio, p->fim, MADV_DONTNEED);
+  total = a->inicio[p->g->n_vertices];
+  janela = p->g->externo->arcos_janela;
+
+  if(ultimo - primeiro >= janela) {
+    p->inicio = primeiro;
+    p->fim = ultimo;
+  } else if(primeiro >= p->fim) {
+    p->inicio = primeiro;
+    p->fim = (total - primeiro > janela) ? primeiro + janela : total;
+    aconselha_janela(a, p->fim, (total - p->fim > janela) ? p->fim + janela : total, MADV_WILLNEED);
+  } else {
+    p->fim = ultimo;
+    p->inicio = (ultimo > janela) ? ultimo - janela : 0;
+    aconselha_janela(a, (p->inicio > janela) ? p->inicio - janela : 0, p->inicio, MADV_WILLNEED);
+  }
+
+  aconselha_janela(a, p->inicio, p->fim, MADV_WILLNEED);
+}
+
+//------------------------------------------------------------------------------
+static void termina_passada(struct passada *p) {
+  const struct adjacencia_externa *a;
+
+  if(p->g->externo != NULL && p->g->compacto == NULL) {
+    a = p->entrada ? &p->g->externo->entrada : &p->g->externo->saida;
+    aconselha_janela(a, p->inicio, p->fim, MADV_DONTNEED);
+  }
+}
+
+//------------------------------------------------------------------------------
+int grava_grafo_externo(grafo g, const char *caminho) {
+  struct cabecalho_externo c;
+  struct disposicao_externa d;
+  struct cursor cursor;
+  unsigned char *mapa;
+  uint64_t *inicio_saida, *inicio_entrada, *posicao;
+  uint32_t *destino_saida, *destino_entrada;
+  int64_t *pesos;
+  char *nomes;
+  long int peso, menor, maior;
+  size_t k;
+  unsigned int v, w;
+  int arquivo, sucesso;
+
+  /* Primeira passada: número de arcos, graus de entrada e faixa dos pesos */
+  memset(&c, 0, sizeof(struct cabecalho_externo));
+  memcpy(c.magica, magica_externa, sizeof(c.magica));
+  c.direcionado = (uint32_t) g->direcionado;
+  c.ponderado = (uint32_t) g->ponderado;
+  c.n_vertices = g->n_vertices;
+  c.tamanho_nomes = strlen(g->nome != NULL ? g->nome : "") + 1;
+
+  posicao = (uint64_t *) calloc((size_t) g->n_vertices + 1, sizeof(uint64_t));
+
+  if(posicao == NULL) {
+    return 0;
+  }
+
+  menor = LONG_MAX;
+  maior = LONG_MIN;
+
+  for(v = 0; v < g->n_vertices; ++v) {
+    c.tamanho_nomes += strlen(g->vertices[v].nome) + 1;
+
+    for(inicia_cursor(g, v, 0, &cursor); proximo_arco(&cursor, &w, &peso); ++c.n_arcos) {
+      menor = (peso < menor) ? peso : menor;
+      maior = (peso > maior) ? peso : maior;
+
+      if(g->direcionado) {
+        ++posicao[w];
+      }
+    }
+  }
+
+  c.n_arcos_entrada = g->direcionado ? c.n_arcos : 0;
+  c.tem_pesos = (menor < maior);
+  c.peso_constante = (menor == maior) ? menor : 1;
+  dispoe_externo(&c, &d);
+
+  /* O arquivo é preenchido pelo mapeamento, pois os arcos de entrada são
+     escritos fora de ordem */
+  if((arquivo = open(caminho, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0) {
+    free(posicao);
+    return 0;
+  }
+
+  if(ftruncate(arquivo, (off_t) d.tamanho) != 0 ||
+     (mapa = (unsigned char *) mmap(NULL, d.tamanho, PROT_READ | PROT_WRITE, MAP_SHARED, arquivo, 0)) == MAP_FAILED) {
+    close(arquivo);
+    free(posicao);
+    return 0;
+  }
+
+  memcpy(mapa, &c, sizeof(struct cabecalho_externo));
+  nomes = (char *) mapa + d.nomes;
+  strcpy(nomes, g->nome != NULL ? g->nome : "");
+  nomes += strlen(nomes) + 1;
+
+  for(v = 0; v < g->n_vertices; ++v) {
+    strcpy(nomes, g->vertices[v].nome);
+    nomes += strlen(nomes) + 1;
+  }
+
+  inicio_saida = (uint64_t *) (mapa + d.inicio_saida);
+  inicio_entrada = (uint64_t *) (mapa + d.inicio_entrada);
+  pesos = c.tem_pesos ? (int64_t *) (mapa + d.pesos) : NULL;
+  destino_saida = (uint32_t *) (mapa + d.destino_saida);
+  destino_entrada = (uint32_t *) (mapa + d.destino_entrada);
+
+  /* Os arcos que entram em cada vértice começam depois dos que entram nos
+     anteriores; posicao passa a ser a próxima posição livre de cada um */
+  if(g->direcionado) {
+    for(v = 0, k = 0; v < g->n_vertices; ++v) {
+      inicio_entrada[v] = k;
+      k += posicao[v];
+      posicao[v] = inicio_entrada[v];
+    }
+
+    inicio_entrada[g->n_vertices] = k;
+  }
+
+  /* Segunda passada: os arcos de saída em ordem, e os de entrada nas
+     posições de suas pontas */
+  for(v = 0, k = 0; v < g->n_vertices; ++v) {
+    inicio_saida[v] = k;
+
+    for(inicia_cursor(g, v, 0, &cursor); proximo_arco(&cursor, &w, &peso); ++k) {
+      destino_saida[k] = w;
+
+      if(pesos != NULL) {
+        pesos[k] = peso;
+      }
+
+      if(g->direcionado) {
+        destino_entrada[posicao[w]++] = v;
+      }
+    }
+  }
+
+  inicio_saida[g->n_vertices] = k;
+  free(posicao);
+
+  sucesso = (msync(mapa, d.tamanho, MS_SYNC) == 0);
+  munmap(mapa, d.tamanho);
+  return (close(arquivo) == 0) && sucesso;
+}
+
+//------------------------------------------------------------------------------
+grafo le_grafo_externo(const char *caminho, size_t orcamento) {
+  struct grafo *g;
+  struct externo *e;
+  struct cabecalho_externo c;
+  struct disposicao_externa d;
+  struct stat estado;
+  struct medida m;
+  const char *nomes, *fim_nomes;
+  unsigned int i;
+  int arquivo;
+
+  inicia_medida(&m);
+
+  if((arquivo = open(caminho, O_RDONLY)) < 0) {
+    termina_medida(NULL, &m, FASE_CARGA);
+    return NULL;
+  }
+
+  e = (struct externo *) malloc(sizeof(struct externo));
+
+  /* Confere o cabeçalho e o tamanho do arquivo antes de mapeá-lo; o
+     mapeamento continua válido depois de fechado o arquivo */
+  if(e == NULL || fstat(arquivo, &estado) != 0 || (size_t) estado.st_size < sizeof(struct cabecalho_externo) ||
+     read(arquivo, &c, sizeof(struct cabecalho_externo)) != (ssize_t) sizeof(struct cabecalho_externo) ||
+     memcmp(c.magica, magica_externa, sizeof(c.magica)) != 0) {
+    free(e);
+    close(arquivo);
+    termina_medida(NULL, &m, FASE_CARGA);
+    return NULL;
+  }
+
+  dispoe_externo(&c, &d);
+  e->tamanho = d.tamanho;
+
+  if((size_t) estado.st_size != d.tamanho ||
+     (e->mapa = (unsigned char *) mmap(NULL, d.tamanho, PROT_READ, MAP_SHARED, arquivo, 0)) == MAP_FAILED) {
+    free(e);
+    close(arquivo);
+    termina_medida(NULL, &m, FASE_CARGA);
+    return NULL;
+  }
+
+  close(arquivo);
+
+  /* Duas janelas (a atual e a lida antecipadamente) cabem no orçamento */
+  if(orcamento == 0) {
+    orcamento = ORCAMENTO_EXTERNO;
+  }
+
+  e->arcos_janela = orcamento / (2 * (sizeof(uint32_t) + (c.tem_pesos ? sizeof(int64_t) : 0)));
+  e->arcos_janela = (e->arcos_janela > 1024) ? e->arcos_janela : 1024;
+
+  e->saida.inicio = (const uint64_t *) (e->mapa + d.inicio_saida);
+  e->saida.destino = (const uint32_t *) (e->mapa + d.destino_saida);
+  e->saida.pesos = c.tem_pesos ? (const int64_t *) (e->mapa + d.pesos) : NULL;
+  e->saida.peso_constante = (long int) c.peso_constante;
+  e->entrada.inicio = c.direcionado ? (const uint64_t *) (e->mapa + d.inicio_entrada) : NULL;
+  e->entrada.destino = c.direcionado ? (const uint32_t *) (e->mapa + d.destino_entrada) : NULL;
+  e->entrada.pesos = NULL;
+  e->entrada.peso_constante = 1;
+
+  /* Apenas os vértices (nomes e listas vazias) ficam em memória */
+  nomes = (const char *) e->mapa + d.nomes;
+  fim_nomes = nomes + c.tamanho_nomes;
+
+  if((g = cria_grafo((char *) nomes, (int) c.direcionado, (int) c.ponderado)) == NULL ||
+     (g->vertices = (struct vertice *) malloc(sizeof(struct vertice) * ((size_t) c.n_vertices + 1))) == NULL) {
+    destroi_grafo(g);
+    destroi_externo(e);
+    termina_medida(NULL, &m, FASE_CARGA);
+    return NULL;
+  }
+
+  for(i = 0, nomes += strlen(nomes) + 1; i < c.n_vertices; ++i, nomes += strlen(nomes) + 1) {
+    g->vertices[i].nome = (nomes < fim_nomes) ? strdup(nomes) : NULL;
+    inicializa_lista(&g->vertices[i].arestas);
+    g->n_vertices = i + 1;
+
+    if(g->vertices[i].nome == NULL || g->vertices[i].arestas == NULL) {
+      destroi_grafo(g);
+      destroi_externo(e);
+      termina_medida(NULL, &m, FASE_CARGA);
+      return NULL;
+    }
+  }
+
+  g->capacidade = g->n_vertices;
+  g->externo = e;
+  aconselha(e->mapa + d.nomes, 1, 0, c.tamanho_nomes, MADV_DONTNEED);
+  termina_medida(g, &m, FASE_CARGA);
+  return g;
+}
+
+//------------------------------------------------------------------------------
+static void escreve_cabecalho(FILE *output, grafo g, char *nome, unsigned int *membros, unsigned int n_membros) {
+  unsigned int i;
+
+  /* Imprime na saida a definição do grafo, caso seja um grafo direcionado,
+     é adicionado o prefixo "di"; um grafo sem nome, como o de distancias,
+     sai com o nome (null) */
+  fprintf(output, "strict %sgraph \"%s\" {\n\n", (g->direcionado) ? "di" : "", (nome != NULL) ? nome : "(null)");
+
+  /* Imprime os nomes dos vértices */
+  for(i = 0; i < n_membros; ++i) {
+    fprintf(output, "    \"%s\"\n", g->vertices[membros ? membros[i] : i].nome);
+  }
+
+  fprintf(output, "\n");
+}
+
+//------------------------------------------------------------------------------
+static void escreve_vertices(FILE *output, grafo g, unsigned int *membros, unsigned int n_membros, unsigned int *rotulo, unsigned int parte) {
+  struct cursor c;
+  struct passada p;
+  char caractere_aresta;
+  long int peso;
+  unsigned int i, v, w;
+
+  /* Escreve os vértices membros[0], ..., membros[n_membros - 1] de g (todos,
+     em ordem, se membros é NULL) e as arestas entre eles, isto é, com as
+     duas pontas na parte indicada de rotulo (todas, se rotulo é NULL) */
+  escreve_cabecalho(output, g, g->nome, membros, n_membros);
+
+  /* Se o grafo é direcionado, representamos as arestas por v -> u,
+     sendo v o vértice de origem e u o vértice de destino de cada aresta.
+     Caso contrário, representamos as arestas por v -- u */
+  caractere_aresta = (g->direcionado) ? '>' : '-';
+
+  /* Imprime as arestas; o grafo inteiro é escrito numa passada sequencial */
+  inicia_passada(g, 0, &p);
+
+  for(i = 0; i < n_membros; ++i) {
+    v = membros ? membros[i] : i;
+
+    if(membros == NULL) {
+      avanca_passada(&p, v);
+    }
+
+    /* O cursor percorre apenas os arcos que saem de v (ou as arestas de v) */
+    for(inicia_cursor(g, v, 0, &c); proximo_arco(&c, &w, &peso); ) {
+      if(rotulo != NULL && rotulo[w] != parte) {
+        continue;
+      }
+
+      /* Se g não é direcionado imprime a aresta apenas se v < w, isto garante
+         que ela será impressa apenas uma vez */
+      if(g->direcionado || v < w) {
+        fprintf(output, "    \"%s\" -%c \"%s\"", g->vertices[v].nome, caractere_aresta, g->vertices[w].nome);
+
+        /* Se g é um grafo ponderado, imprime o peso da aresta */
+        if(g->ponderado == 1) {
+          if(peso == infinito) {
+            fprintf(output, " [peso=oo]");
+          } else {
+            fprintf(output, " [peso=%ld]", peso);
+          }
+        }
+
+        fprintf(output, "\n");
+      }
+    }
+  }
+
+  termina_passada(&p);
+  fprintf(output, "}\n");
+}
+
+//------------------------------------------------------------------------------
+grafo escreve_grafo(FILE *output, grafo g) {
+  struct medida m;
+
+  inicia_medida(&m);
+  escreve_vertices(output, g, NULL, g->n_vertices, NULL, 0);
+  termina_medida(g, &m, FASE_SAIDA);
+  return g;
+}
+
+//------------------------------------------------------------------------------
+char *nome(grafo g) {
+  return g->nome;
+}
+
+//------------------------------------------------------------------------------
+unsigned int n_vertices(grafo g) {
+  return g->n_vertices;
+}
+
+//------------------------------------------------------------------------------
+unsigned int n_arestas(grafo g) {
+  struct cursor c;
+  long int peso;
+  unsigned int i, w, total;
+
+  /* Cada arco é contado a partir da origem e cada aresta, que tem uma cópia
+     em cada ponta, a partir da ponta de menor índice */
+  if(g->compacto != NULL && g->direcionado) {
+    return (unsigned int) g->compacto->saida.primeira[g->n_vertices];
+  }
+
+  for(i = 0, total = 0; i < g->n_vertices; ++i) {
+    for(inicia_cursor(g, i, 0, &c); proximo_arco(&c, &w, &peso); ) {
+      if(g->direcionado || i <= w) {
+        ++total;
+      }
+    }
+  }
+
+  return total;
+}
+
+//------------------------------------------------------------------------------
+int direcionado(grafo g) {
+  return g->direcionado;
+}
+
+//------------------------------------------------------------------------------
+static unsigned int encontra_representante(struct conectividade *c, unsigned int v) {
+  /* Sobe até a raiz do conjunto de v, encurtando o caminho pela metade */
+  while(c->pai[v] != v) {
+    c->pai[v] = c->pai[c->pai[v]];
+    v = c->pai[v];
+  }
+
+  return v;
+}
+
+//------------------------------------------------------------------------------
+static void une_componentes(struct conectividade *c, unsigned int u, unsigned int v) {
+  u = encontra_representante(c, u);
+  v = encontra_representante(c, v);
+
+  /* Se u e v estavam em componentes distintos, une pelo posto */
+  if(u != v) {
+    if(c->posto[u] < c->posto[v]) {
+      c->pai[u] = v;
+    } else {
+      c->pai[v] = u;
+
+      if(c->posto[u] == c->posto[v]) {
+        ++c->posto[u];
+      }
+    }
+
+    --c->n_componentes;
+  }
+}
+
+//------------------------------------------------------------------------------
+static struct conectividade *gera_conectividade(grafo g) {
+  struct conectividade *c;
+  struct cursor cursor;
+  struct passada p;
+  long int peso;
+  unsigned long examinadas;
+  unsigned int i, w;
+
+  c = (struct conectividade *) malloc(sizeof(struct conectividade));
+
+  if(c != NULL) {
+    c->capacidade = (g->capacidade > g->n_vertices) ? g->capacidade : g->n_vertices;
+    c->n_componentes = g->n_vertices;
+    c->pai = (unsigned int *) malloc(sizeof(unsigned int) * (c->capacidade + 1));
+    c->posto = (unsigned char *) malloc(sizeof(unsigned char) * (c->capacidade + 1));
+
+    if(c->pai == NULL || c->posto == NULL) {
+      destroi_conectividade(c);
+      return NULL;
+    }
+
+    /* Começa com cada vértice em seu próprio componente e une as
+       pontas de todas as arestas */
+    for(i = 0; i < g->n_vertices; ++i) {
+      c->pai[i] = i;
+      c->posto[i] = 0;
+    }
+
+    /* Uma única passada sequencial pelas arestas */
+    inicia_passada(g, 0, &p);
+
+    for(i = 0, examinadas = 0; i < g->n_vertices; ++i) {
+      avanca_passada(&p, i);
+
+      for(inicia_cursor(g, i, 0, &cursor); proximo_arco(&cursor, &w, &peso); ++examinadas) {
+        une_componentes(c, i, w);
+      }
+    }
+
+    termina_passada(&p);
+    CONTA(g, arestas_examinadas, examinadas);
+  }
+
+  return c;
+}
+
+//------------------------------------------------------------------------------
+int conexo(grafo g) {
+  struct medida m;
+
+  /* Se g é direcionado, então retorna 0 conforme especificação */
+  if(g->direcionado) {
+    return 0;
+  }
+
+  /* Os componentes são mantidos em g a cada inserção, e recalculados em
+     O(V+E) apenas na primeira consulta e depois de uma remoção */
+  conta_resultado(g, __atomic_load_n(&g->conectividade, __ATOMIC_ACQUIRE) != NULL);
+
+  if(__atomic_load_n(&g->conectividade, __ATOMIC_ACQUIRE) == NULL) {
+    pthread_mutex_lock(&g->trava);
+
+    if(g->conectividade == NULL) {
+      inicia_medida(&m);
+      __atomic_store_n(&g->conectividade, gera_conectividade(g), __ATOMIC_RELEASE);
+      termina_medida(g, &m, FASE_INDICE);
+    }
+
+    pthread_mutex_unlock(&g->trava);
+
+    if(g->conectividade == NULL) {
+      return 0;
+    }
+  }
+
+  /* g é conexo se tem exatamente um componente */
+  return (g->conectividade->n_componentes == 1) ? 1 : 0;
+}
+
+//------------------------------------------------------------------------------
+static size_t memoria_grafo_listas(grafo g) {
+  /* Os vértices de um grafo nas listas e um nó com a sua aresta por arco */
+  return soma_memoria(memoria_vertices(g), memoria_listas(n_arcos(g), sizeof(struct aresta)));
+}
+
+//------------------------------------------------------------------------------
+static grafo copia_grafo(grafo g) {
+  struct grafo *c;
+  struct aresta *a;
+  struct no *n, **fim;
+  unsigned int v;
+
+  /* Cópia de um grafo nas listas, com as arestas na mesma ordem; sem
+     memória para alguma parte, a cópia inteira é descartada */
+  inicializa_grafo(&c);
+
+  if(c == NULL) {
+    return NULL;
+  }
+
+  c->direcionado = g->direcionado;
+  c->ponderado = g->ponderado;
+
+  if((g->nome != NULL && (c->nome = strdup(g->nome)) == NULL) ||
+     (c->vertices = (struct vertice *) calloc(g->n_vertices + 1, sizeof(struct vertice))) == NULL) {
+    destroi_grafo(c);
+    return NULL;
+  }
+
+  for(v = 0; v < g->n_vertices; ++v) {
+    c->n_vertices = v + 1;
+    c->vertices[v].nome = strdup(g->vertices[v].nome);
+    inicializa_lista(&c->vertices[v].arestas);
+
+    if(c->vertices[v].nome == NULL || c->vertices[v].arestas == NULL) {
+      destroi_grafo(c);
+      return NULL;
+    }
+
+    fim = &c->vertices[v].arestas->primeiro;
+
+    for(n = g->vertices[v].arestas->primeiro; n != NULL; n = n->proximo) {
+      if((a = (struct aresta *) malloc(sizeof(struct aresta))) == NULL || (*fim = (struct no *) malloc(sizeof(struct no))) == NULL) {
+        free(a);
+        destroi_grafo(c);
+        return NULL;
+      }
+
+      *a = *(struct aresta *) n->conteudo;
+      (*fim)->conteudo = a;
+      (*fim)->proximo = NULL;
+      fim = &(*fim)->proximo;
+    }
+  }
+
+  c->capacidade = c->n_vertices;
+  return c;
+}
+
+//------------------------------------------------------------------------------
+static grafo grafo_guardado(grafo g, enum tipo_guardado tipo) {
+  struct guardado *r;
+  struct grafo *c;
+
+  /* Uma cópia do grafo guardado do tipo, se há um da versão atual de g */
+  if((r = busca_guardado(g, tipo)) == NULL) {
+    return NULL;
+  }
+
+  if((c = copia_grafo((grafo) r->dados)) != NULL) {
+    conta_resultado(g, 1);
+  }
+
+  solta_guardado(r);
+  return c;
+}
+
+//------------------------------------------------------------------------------
+static grafo guarda_grafo(grafo g, enum tipo_guardado tipo, unsigned long versao, grafo t) {
+  struct grafo *c;
+  size_t tamanho;
+
+  /* Guarda o grafo t, calculado na versão dada de g, e devolve uma cópia
+     dele; na representação compacta, acima do limite dos guardados ou do
+     orçamento, ou sem memória para a cópia, devolve t sem guardá-lo */
+  conta_resultado(g, 0);
+
+  if(t == NULL || t->compacto != NULL || t->externo != NULL) {
+    return t;
+  }
+
+  tamanho = memoria_grafo_listas(t);
+
+  if(tamanho > __atomic_load_n(&g->limite_guardados, __ATOMIC_RELAXED) || !cabe_orcamento(tamanho) || (c = copia_grafo(t)) == NULL) {
+    return t;
+  }
+
+  if(!guarda_resultado(g, tipo, versao, t, tamanho, destroi_grafo)) {
+    destroi_grafo(c);
+    return t;
+  }
+
+  return c;
+}
+
+//------------------------------------------------------------------------------
+static grafo _arvore_geradora_minima(grafo g) {
+  struct grafo *t;
+  struct area_trabalho *area;
+  struct aresta *a;
+  struct cursor c;
+  long int menor_peso, peso;
+  unsigned long examinadas = 0;
+  unsigned int i, w, origem, destino, vertices_processados = 0;
+  unsigned int *vertice_processado;
+
+  /* Se g é direcionado, retorna NULL conforme especificação; os estados dos
+     vértices ficam numa área de trabalho da reserva de g */
+  if(g->direcionado || (area = pega_area(g)) == NULL) {
+    return NULL;
+  }
+
+  vertice_processado = area->rotulo;
+
+  /* Aloca a árvore t */
+  inicializa_grafo(&t);
+
+  if(t != NULL) {
+    /* Aloca os vértices da árvore */
+    t->vertices = (struct vertice *) malloc(sizeof(struct vertice) * g->n_vertices);
+
+    if(t->vertices != NULL) {
+      /* Inicializa árvore */
+      t->nome = NULL;
+      t->n_vertices = g->n_vertices;
+      t->ponderado = g->ponderado;
+      t->direcionado = 0;
+
+      /* Adiciona todos os vértices do grafo na árvore */
+      for(i = 0; i < g->n_vertices; ++i) {
+        t->vertices[i].nome = strdup(g->vertices[i].nome);
+        t->vertices[i].arestas = (struct lista *) malloc(sizeof(struct lista));
+        t->vertices[i].arestas->primeiro = NULL;
+
+        vertice_processado[i] = 0;
+      }
+
+      /* Começa busca a partir do vértice de id 0 */
+      vertice_processado[0] = 1;
+      vertices_processados = 1;
+
+      do {
+        origem = destino = (unsigned int) -1;
+        menor_peso = infinito;
+
+        /* Varre todas as arestas da fronteira da árvore e seleciona
+           a que têm o menor peso, em qualquer representação de g */
+        for(i = 0; i < g->n_vertices; ++i) {
+          if(vertice_processado[i] == 1) {
+            for(inicia_cursor(g, i, 0, &c); proximo_arco(&c, &w, &peso); ++examinadas) {
+              /* Se o destino não foi processado ainda, ou seja, se ele
+                 está na fronteira da árvore t */
+              if(vertice_processado[w] == 0) {
+                /* Apenas seleciona a aresta se seu peso for menor */
+                if(menor_peso > peso) {
+                  menor_peso = peso;
+                  origem = i;
+                  destino = w;
+                }
+              }
+            }
+          }
+        }
+
+        /* Adiciona a aresta selecionada na árvore */
+        if(destino != (unsigned int) -1) {
+          /* Marca o vértice de destino da aresta como processado */
+          vertice_processado[destino] = 1;
+          ++vertices_processados;
+
+          /* Aloca a aresta a ser adicionada na origem */
+          a = (struct aresta *) malloc(sizeof(struct aresta));
+
+          if(a != NULL) {
+            /* Define os dados da aresta */
+            a->origem = origem;
+            a->destino = destino;
+            a->peso = menor_peso;
+
+            /* Insere a aresta no vértice de origem em t */
+            insere_cabeca_conteudo(t->vertices[origem].arestas, a);
+          }
+
+          /* Aloca a aresta a ser adicionada no destino */
+          a = (struct aresta *) malloc(sizeof(struct aresta));
+
+          if(a != NULL) {
+            /* Define os dados da aresta */
+            a->origem = destino;
+            a->destino = origem;
+            a->peso = menor_peso;
+
+            /* Insere a aresta no vértice de destino em t */
+            insere_cabeca_conteudo(t->vertices[destino].arestas, a);
+          }
+        }
+
+        /* Se não foi selecionada nenhuma aresta, então encerra a busca */
+      } while(destino != (unsigned int) -1);
+
+      CONTA(g, arestas_examinadas, examinadas);
+      CONTA(g, vertices_fixados, vertices_processados);
+    }
+
+    /* Se não foram processados todos os vértices, o grafo é desconexo e
+       então retorna NULL conforme especificação */
+    if(vertices_processados != g->n_vertices) {
+      destroi_grafo(t);
+      t = NULL;
+    }
+  }
+
+  devolve_area(g, area);
+  return t;
+}
+
+//------------------------------------------------------------------------------
+grafo arvore_geradora_minima(grafo g) {
+  struct grafo *t;
+  struct medida m;
+  unsigned long versao;
+
+  /* A árvore guardada em g, ou calculada e guardada */
+  inicia_medida(&m);
+  versao = g->versao;
+
+  if((t = grafo_guardado(g, GUARDADO_ARVORE)) == NULL) {
+    t = guarda_grafo(g, GUARDADO_ARVORE, versao, _arvore_geradora_minima(g));
+  }
+
+  termina_medida(g, &m, FASE_CALCULO);
+  return t;
+}
+
+//------------------------------------------------------------------------------
+static unsigned int indice_vertice(grafo g, vertice v) {
+  /* Se v é um vértice da estrutura de g o índice é imediato, caso contrário
+     (vértice alocado separadamente) procura pelo nome */
+  if(v >= g->vertices && v < g->vertices + g->n_vertices) {
+    return (unsigned int) (v - g->vertices);
+  }
+
+  return encontra_vertice_indice(g->vertices, g->n_vertices, v->nome);
+}
+
+//------------------------------------------------------------------------------
+unsigned int grau_saida(grafo g, vertice v) {
+  struct no *n;
+  unsigned int i, grau;
+
+  if((i = indice_vertice(g, v)) == (unsigned int) -1) {
+    return 0;
+  }
+
+  if(g->compacto != NULL) {
+    return (unsigned int) (g->compacto->saida.primeira[i + 1] - g->compacto->saida.primeira[i]);
+  }
+
+  if(g->externo != NULL) {
+    return (unsigned int) (g->externo->saida.inicio[i + 1] - g->externo->saida.inicio[i]);
+  }
+
+  for(n = g->vertices[i].arestas->primeiro, grau = 0; n != NULL; n = n->proximo, ++grau);
+
+  return grau;
+}
+
+//------------------------------------------------------------------------------
+unsigned int grau_entrada(grafo g, vertice v) {
+  struct no *n;
+  unsigned int i, j, grau;
+
+  if(!g->direcionado) {
+    return grau_saida(g, v);
+  }
+
+  if((i = indice_vertice(g, v)) == (unsigned int) -1) {
+    return 0;
+  }
+
+  if(g->compacto != NULL) {
+    return (unsigned int) (g->compacto->entrada.primeira[i + 1] - g->compacto->entrada.primeira[i]);
+  }
+
+  if(g->externo != NULL) {
+    return (unsigned int) (g->externo->entrada.inicio[i + 1] - g->externo->entrada.inicio[i]);
+  }
+
+  if(prepara_entrada(g)) {
+    return (unsigned int) (g->entrada->inicio[i + 1] - g->entrada->inicio[i]);
+  }
+
+  /* Sem memória para os arcos que entram, conta-os em todas as listas */
+  for(j = 0, grau = 0; j < g->n_vertices; ++j) {
+    for(n = g->vertices[j].arestas->primeiro; n != NULL; n = n->proximo) {
+      grau += (((struct aresta *) n->conteudo)->destino == i);
+    }
+  }
+
+  return grau;
+}
+
+//------------------------------------------------------------------------------
+// busca em largura por níveis a partir de um conjunto de fontes, que alterna
+// entre o passo descendente (cada vértice da fronteira percorre os seus
+// arcos) e o ascendente (cada vértice não visitado procura um vizinho na
+// fronteira), como em Beamer, Asanović e Patterson, "Direction-optimizing
+// breadth-first search"
+
+/* Estado de uma busca: distancia[v] é infinito até v ser visitado, e então
+   a distância do seu nível, em múltiplos de passo; pai[v] (se pai não é
+   NULL) é o vértice que o descobriu. Os visitados ficam em fila, nível a
+   nível: a fronteira é fila[inicio], ..., fila[fim - 1], e o nível seguinte
+   é posto a partir de fim em blocos reservados por fetch_and_add sobre
+   proximo. No passo descendente cada vértice é reivindicado por
+   compare_and_swap da sua distância, e só o vencedor grava o pai; no
+   ascendente a fronteira fica também em fronteira, um bit por vértice, e
+   cada candidato é examinado por um único thread. Os candidatos são
+   candidatos[0], ..., candidatos[n_candidatos - 1] (todos os vértices, se
+   candidatos é NULL), que contêm todos os alcançáveis das fontes, e
+   nao_visitados conta os ainda não visitados entre eles */
+struct busca_largura {
+  grafo g;
+  enum percurso modo;
+  int sentido;
+  long int *distancia;
+  unsigned int *pai;
+  unsigned int *fila;
+  unsigned int inicio, fim, proximo;
+  uint64_t *fronteira;
+  const unsigned int *candidatos;
+  unsigned int n_candidatos;
+  unsigned int nao_visitados;
+  long int nivel, passo;
+  unsigned long examinadas;
+};
+
+/* Parte de um nível, executada por um thread */
+struct tarefa_largura {
+  struct busca_largura *b;
+  unsigned int primeiro, ultimo;
+  int ascendente;
+};
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA void descarrega_largura(struct busca_largura *b, unsigned int *descobertos, unsigned int *n_descobertos) {
+  unsigned int k;
+
+  /* Reserva um bloco do próximo nível para os vértices descobertos */
+  k = __atomic_fetch_add(&b->proximo, *n_descobertos, __ATOMIC_RELAXED);
+  memcpy(b->fila + k, descobertos, sizeof(unsigned int) * *n_descobertos);
+  *n_descobertos = 0;
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA unsigned long expande_largura(struct busca_largura *b, unsigned int v, int entrada, unsigned int *descobertos, unsigned int *n_descobertos, const enum percurso modo) {
+  struct cursor c;
+  long int peso, esperado;
+  unsigned long examinadas = 0;
+  unsigned int w;
+
+  /* Reivindica os vizinhos de v ainda não visitados; num grafo não
+     direcionado os arcos que entram são os que saem */
+  for(inicia_percurso(b->g, v, entrada && b->g->direcionado, modo, &c); proximo_percurso(&c, modo, &w, &peso); ++examinadas) {
+    esperado = infinito;
+
+    if(__atomic_load_n(b->distancia + w, __ATOMIC_RELAXED) == infinito &&
+       __atomic_compare_exchange_n(b->distancia + w, &esperado, b->nivel, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+      if(b->pai != NULL) {
+        b->pai[w] = v;
+      }
+
+      descobertos[(*n_descobertos)++] = w;
+
+      if(*n_descobertos == BLOCO_LARGURA) {
+        descarrega_largura(b, descobertos, n_descobertos);
+      }
+    }
+  }
+
+  return examinadas;
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA void passo_descendente(struct busca_largura *b, unsigned int primeiro, unsigned int ultimo, const enum percurso modo) {
+  unsigned int descobertos[BLOCO_LARGURA];
+  unsigned long examinadas = 0;
+  unsigned int i, n_descobertos = 0;
+
+  for(i = primeiro; i < ultimo; ++i) {
+    if(b->sentido & LARGURA_SAIDA) {
+      examinadas += expande_largura(b, b->fila[i], 0, descobertos, &n_descobertos, modo);
+    }
+
+    if(b->sentido & LARGURA_ENTRADA) {
+      examinadas += expande_largura(b, b->fila[i], 1, descobertos, &n_descobertos, PERCURSO_INVERSO(modo));
+    }
+  }
+
+  if(n_descobertos > 0) {
+    descarrega_largura(b, descobertos, &n_descobertos);
+  }
+
+  __atomic_add_fetch(&b->examinadas, examinadas, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA unsigned int vizinho_fronteira(struct busca_largura *b, unsigned int v, int entrada, unsigned long *examinadas, const enum percurso modo) {
+  struct cursor c;
+  long int peso;
+  unsigned int w;
+
+  /* O primeiro vizinho de v na fronteira, ou -1: os demais arcos de v não
+     precisam ser examinados */
+  for(inicia_percurso(b->g, v, entrada && b->g->direcionado, modo, &c); proximo_percurso(&c, modo, &w, &peso); ) {
+    ++*examinadas;
+
+    if(b->fronteira[w / 64] & (UINT64_C(1) << (w % 64))) {
+      return w;
+    }
+  }
+
+  return (unsigned int) -1;
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA void passo_ascendente(struct busca_largura *b, unsigned int primeiro, unsigned int ultimo, const enum percurso modo) {
+  unsigned int descobertos[BLOCO_LARGURA];
+  unsigned long examinadas = 0;
+  unsigned int i, n_descobertos = 0, u, v;
+
+  /* Um candidato não visitado é descoberto por um vizinho na fronteira
+     pelos arcos no sentido contrário ao da busca */
+  for(i = primeiro; i < ultimo; ++i) {
+    v = (b->candidatos != NULL) ? b->candidatos[i] : i;
+
+    if(b->distancia[v] != infinito) {
+      continue;
+    }
+
+    u = (unsigned int) -1;
+
+    if(b->sentido & LARGURA_SAIDA) {
+      u = vizinho_fronteira(b, v, 1, &examinadas, PERCURSO_INVERSO(modo));
+    }
+
+    if(u == (unsigned int) -1 && (b->sentido & LARGURA_ENTRADA)) {
+      u = vizinho_fronteira(b, v, 0, &examinadas, modo);
+    }
+
+    if(u != (unsigned int) -1) {
+      b->distancia[v] = b->nivel;
+
+      if(b->pai != NULL) {
+        b->pai[v] = u;
+      }
+
+      descobertos[n_descobertos++] = v;
+
+      if(n_descobertos == BLOCO_LARGURA) {
+        descarrega_largura(b, descobertos, &n_descobertos);
+      }
+    }
+  }
+
+  if(n_descobertos > 0) {
+    descarrega_largura(b, descobertos, &n_descobertos);
+  }
+
+  __atomic_add_fetch(&b->examinadas, examinadas, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+static void *_passo_largura(void *p) {
+  struct tarefa_largura *t;
+
+  t = (struct tarefa_largura *) p;
+
+  if(t->ascendente) {
+    DESPACHA_PERCURSO_SEM_PESO(t->b->modo, passo_ascendente, t->b, t->primeiro, t->ultimo);
+  } else {
+    DESPACHA_PERCURSO_SEM_PESO(t->b->modo, passo_descendente, t->b, t->primeiro, t->ultimo);
+  }
+
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static unsigned int busca_largura(struct busca_largura *b, unsigned int n_fontes, unsigned int n_tarefas) {
+  struct tarefa_largura uma, *tarefas;
+  double arcos_expandidos = 0, expandidos = 0, arcos;
+  unsigned long antes;
+  unsigned int i, k, n, n_fronteira, n_proximo, n_partes;
+  int ascendente = 0, zerada = 0;
+
+  /* As fontes já estão em fila, com as suas distâncias; devolve o número
+     de vértices visitados, que ficam em fila na ordem dos níveis */
+  tarefas = (n_tarefas > 1) ? (struct tarefa_largura *) malloc(sizeof(struct tarefa_largura) * n_tarefas) : NULL;
+  n_tarefas = (tarefas != NULL) ? n_tarefas : 1;
+  tarefas = (tarefas != NULL) ? tarefas : &uma;
+
+  if(!b->g->direcionado) {
+    b->sentido = LARGURA_SAIDA;
+  }
+
+  b->inicio = 0;
+  b->fim = n_fontes;
+  b->examinadas = 0;
+  b->nao_visitados -= n_fontes;
+
+  while(b->inicio < b->fim) {
+    n_fronteira = b->fim - b->inicio;
+    b->nivel = b->distancia[b->fila[b->inicio]] + b->passo;
+    b->proximo = b->fim;
+    antes = b->examinadas;
+
+    /* O bitmap é zerado uma única vez, no primeiro passo ascendente, e a
+       fronteira é apagada dele ao fim de cada um */
+    if(ascendente) {
+      if(!zerada) {
+        memset(b->fronteira, 0, sizeof(uint64_t) * (b->g->n_vertices / 64 + 1));
+        zerada = 1;
+      }
+
+      for(i = b->inicio; i < b->fim; ++i) {
+        b->fronteira[b->fila[i] / 64] |= UINT64_C(1) << (b->fila[i] % 64);
+      }
+    }
+
+    n = ascendente ? b->n_candidatos : n_fronteira;
+    n_partes = (n >= LARGURA_PARALELA) ? n_tarefas : 1;
+
+    for(k = 0; k < n_partes; ++k) {
+      tarefas[k].b = b;
+      tarefas[k].primeiro = (ascendente ? 0 : b->inicio) + (unsigned int) ((unsigned long) n * k / n_partes);
+      tarefas[k].ultimo = (ascendente ? 0 : b->inicio) + (unsigned int) ((unsigned long) n * (k + 1) / n_partes);
+      tarefas[k].ascendente = ascendente;
+    }
+
+    if(n_partes > 1) {
+      executa_paralelo(_passo_largura, tarefas, sizeof(struct tarefa_largura), n_partes);
+    } else {
+      _passo_largura(tarefas);
+    }
+
+    if(ascendente) {
+      for(i = b->inicio; i < b->fim; ++i) {
+        b->fronteira[b->fila[i] / 64] = 0;
+      }
+    }
+
+    arcos = (double) (b->examinadas - antes);
+    n_proximo = b->proximo - b->fim;
+    b->nao_visitados -= n_proximo;
+
+    /* Os arcos da próxima fronteira e os dos não visitados são estimados
+       pelo grau médio dos vértices já expandidos pelo passo descendente */
+    if(!ascendente) {
+      expandidos += n_fronteira;
+      arcos_expandidos += arcos;
+      ascendente = (b->n_candidatos >= LARGURA_ASCENDENTE && n_proximo > 0 &&
+                    arcos / n_fronteira * n_proximo * ALFA_LARGURA > arcos_expandidos / expandidos * b->nao_visitados);
+    } else {
+      ascendente = (n_proximo >= b->n_candidatos / BETA_LARGURA);
+    }
+
+    b->inicio = b->fim;
+    b->fim = b->proximo;
+  }
+
+  if(tarefas != &uma) {
+    free(tarefas);
+  }
+
+  CONTA(b->g, arestas_examinadas, b->examinadas);
+  CONTA(b->g, vertices_fixados, b->fim);
+  return b->fim;
+}
+
+//------------------------------------------------------------------------------
+// partição dos vértices de um grafo em partes (os componentes, ou um único
+// subconjunto), compartilhada pelos subgrafos que a referenciam: o vértice
+// v está na parte rotulo[v] (ou em nenhuma, se rotulo[v] é -1) e os vértices
+// da parte p são membros[inicio[p]], ..., membros[inicio[p + 1] - 1]
+
+struct particao {
+  grafo g;
+  unsigned int n_partes;
+  unsigned int *rotulo;
+  unsigned int *inicio;
+  unsigned int *membros;
+  struct area_trabalho *area;
+  unsigned int referencias;
+};
+
+struct subgrafo {
+  struct particao *p;
+  unsigned int parte;
+};
+
+//------------------------------------------------------------------------------
+static void libera_particao(struct particao *p) {
+  if(p != NULL && __atomic_sub_fetch(&p->referencias, 1, __ATOMIC_ACQ_REL) == 0) {
+    if(p->area != NULL) {
+      devolve_area(p->g, p->area);
+    } else {
+      free(p->rotulo);
+      free(p->inicio);
+      free(p->membros);
+    }
+
+    free(p);
+  }
+}
+
+//------------------------------------------------------------------------------
+static struct particao *aloca_particao(grafo g, unsigned int n_membros) {
+  struct particao *p;
+  unsigned int i;
+
+  p = (struct particao *) malloc(sizeof(struct particao));
+
+  if(p != NULL) {
+    p->g = g;
+    p->n_partes = 0;
+    p->referencias = 1;
+
+    /* Os vetores vêm de uma área de trabalho da reserva de g, devolvida
+       quando a partição é liberada, exceto quando há mais membros do que
+       vértices (em subgrafo_induzido, com vértices repetidos) */
+    if(n_membros <= g->n_vertices && (p->area = pega_area(g)) != NULL) {
+      p->rotulo = p->area->rotulo;
+      p->inicio = p->area->inicio;
+      p->membros = p->area->membros;
+    } else {
+      p->area = NULL;
+      p->rotulo = (unsigned int *) malloc(sizeof(unsigned int) * (g->n_vertices + 1));
+      p->inicio = (unsigned int *) malloc(sizeof(unsigned int) * (g->n_vertices + 2));
+      p->membros = (unsigned int *) malloc(sizeof(unsigned int) * (n_membros + 1));
+    }
+
+    if(p->rotulo == NULL || p->inicio == NULL || p->membros == NULL) {
+      libera_particao(p);
+      return NULL;
+    }
+
+    for(i = 0; i < g->n_vertices; ++i) {
+      p->rotulo[i] = (unsigned int) -1;
+    }
+  }
+
+  return p;
+}
+
+//------------------------------------------------------------------------------
+static struct particao *particao_externa(grafo g) {
+  struct particao *p;
+  struct conectividade *c;
+  unsigned int v, r;
+
+  /* Com as arestas em disco a busca em largura faria acessos aleatórios ao
+     arquivo: os componentes saem do union-find, numa passada sequencial,
+     e são numerados pelo seu menor vértice, como na busca */
+  if((c = gera_conectividade(g)) == NULL) {
+    return NULL;
+  }
+
+  if((p = aloca_particao(g, g->n_vertices)) == NULL) {
+    destroi_conectividade(c);
+    return NULL;
+  }
+
+  for(v = 0; v < g->n_vertices; ++v) {
+    r = encontra_representante(c, v);
+
+    if(p->rotulo[r] == (unsigned int) -1) {
+      p->rotulo[r] = p->n_partes++;
+      p->inicio[p->n_partes] = 0;
+    }
+
+    p->rotulo[v] = p->rotulo[r];
+    ++p->inicio[p->rotulo[v] + 1];
+  }
+
+  destroi_conectividade(c);
+
+  /* Agrupa os membros de cada componente (ordenação por contagem) */
+  for(p->inicio[0] = 0, r = 0; r < p->n_partes; ++r) {
+    p->inicio[r + 1] += p->inicio[r];
+  }
+
+  for(v = 0; v < g->n_vertices; ++v) {
+    p->membros[p->inicio[p->rotulo[v]]++] = v;
+  }
+
+  for(r = p->n_partes; r > 0; --r) {
+    p->inicio[r] = p->inicio[r - 1];
+  }
+
+  p->inicio[0] = 0;
+  return p;
+}
+
+//------------------------------------------------------------------------------
+static int busca_componentes(grafo g, struct particao *p) {
+  struct area_trabalho *area;
+  struct busca_largura b;
+  unsigned int r, v, k, fim, n_tarefas;
+
+  /* As distâncias e o bitmap da busca vêm da área da partição, que só usa
+     os seus rótulos, inícios e membros */
+  if((area = (p->area != NULL) ? p->area : pega_area(g)) == NULL) {
+    return 0;
+  }
+
+  b.g = g;
+  b.modo = modo_percurso(g, 0, 0);
+  b.sentido = LARGURA_SAIDA | LARGURA_ENTRADA;
+  b.distancia = area->distancia;
+  b.pai = NULL;
+  b.fronteira = area->marcas;
+  b.candidatos = NULL;
+  b.n_candidatos = g->n_vertices;
+  b.passo = 1;
+  n_tarefas = numero_threads();
+
+  for(v = 0; v < g->n_vertices; ++v) {
+    b.distancia[v] = infinito;
+  }
+
+  /* Busca em largura a partir de cada vértice ainda não visitado, usando
+     os membros do próprio componente como fila; num grafo direcionado os
+     arcos são seguidos nos dois sentidos (componentes fracamente conexos) */
+  for(r = 0, fim = 0; r < g->n_vertices; ++r) {
+    if(b.distancia[r] != infinito) {
+      continue;
+    }
+
+    b.fila = p->membros + fim;
+    b.fila[0] = r;
+    b.distancia[r] = 0;
+    b.nao_visitados = g->n_vertices - fim;
+    k = busca_largura(&b, 1, n_tarefas);
+
+    for(v = fim; v < fim + k; ++v) {
+      p->rotulo[p->membros[v]] = p->n_partes;
+    }
+
+    p->inicio[p->n_partes++] = fim;
+    fim += k;
+  }
+
+  p->inicio[p->n_partes] = fim;
+
+  if(area != p->area) {
+    devolve_area(g, area);
+  }
+
+  /* A ordem da busca paralela varia de uma execução para outra: os
+     membros de cada componente são postos em ordem crescente (ordenação
+     por contagem), como na partição externa */
+  for(v = 0; v < g->n_vertices; ++v) {
+    p->membros[p->inicio[p->rotulo[v]]++] = v;
+  }
+
+  for(r = p->n_partes; r > 0; --r) {
+    p->inicio[r] = p->inicio[r - 1];
+  }
+
+  p->inicio[0] = 0;
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static size_t memoria_particao(grafo g, int externa) {
+  size_t capacidade;
+
+  /* A área de trabalho da partição e os arcos de entrada da busca em
+     largura, ou o union-find da partição externa */
+  if(!externa) {
+    return soma_memoria(memoria_areas(g, 1), memoria_entrada(g));
+  }
+
+  capacidade = ((g->capacidade > g->n_vertices) ? g->capacidade : g->n_vertices) + 1;
+  return memoria_areas(g, 1) + bloco(1, sizeof(struct conectividade)) + bloco(capacidade, sizeof(unsigned int)) + bloco(capacidade, 1);
+}
+
+//------------------------------------------------------------------------------
+static int particao_preferida(grafo g, size_t reservada) {
+  /* A partição que cabe no orçamento com os reservada bytes do resultado:
+     0 para a busca em largura, 1 para a externa (sempre, com as arestas em
+     disco), ou -1 se nenhuma cabe */
+  if((g->externo == NULL || g->compacto != NULL) && cabe_orcamento(soma_memoria(reservada, memoria_particao(g, 0)))) {
+    return 0;
+  }
+
+  return cabe_orcamento(soma_memoria(reservada, memoria_particao(g, 1))) ? 1 : -1;
+}
+
+//------------------------------------------------------------------------------
+static struct particao *particao_componentes(grafo g, size_t reservada) {
+  struct particao *p;
+  int externa;
+
+  /* Sem memória para os arcos de entrada, a partição externa dispensa
+     também a busca em largura */
+  if((externa = particao_preferida(g, reservada)) < 0) {
+    falha(ERRO_ORCAMENTO);
+    return NULL;
+  }
+
+  if(externa) {
+    return particao_externa(g);
+  }
+
+  /* Num grafo direcionado a busca também segue os arcos que entram */
+  if(!prepara_entrada(g) || (p = aloca_particao(g, g->n_vertices)) == NULL) {
+    return NULL;
+  }
+
+  if(!busca_componentes(g, p)) {
+    libera_particao(p);
+    return NULL;
+  }
+
+  return p;
+}
+
+//------------------------------------------------------------------------------
+static int solta_particao(void *p) {
+  libera_particao((struct particao *) p);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static struct particao *componentes_guardados(grafo g, size_t reservada) {
+  struct guardado *r;
+  struct particao *p;
+  unsigned int *rotulo, *inicio, *membros;
+  unsigned long versao;
+  size_t tamanho;
+
+  /* A partição em componentes guardada em g, com uma referência a mais, ou
+     calculada e guardada; para ser guardada ela passa a ter vetores
+     próprios, e a área de trabalho de onde veio volta para a reserva */
+  if((r = busca_guardado(g, GUARDADO_COMPONENTES)) != NULL) {
+    p = (struct particao *) r->dados;
+    __atomic_add_fetch(&p->referencias, 1, __ATOMIC_RELAXED);
+    solta_guardado(r);
+    conta_resultado(g, 1);
+    return p;
+  }
+
+  versao = g->versao;
+  conta_resultado(g, 0);
+
+  if((p = particao_componentes(g, reservada)) == NULL) {
+    return NULL;
+  }
+
+  tamanho = bloco(1, sizeof(struct particao)) + 2 * bloco(g->n_vertices + 1, sizeof(unsigned int)) + bloco(p->n_partes + 1, sizeof(unsigned int));
+
+  if(p->area != NULL) {
+    rotulo = (unsigned int *) malloc(sizeof(unsigned int) * (g->n_vertices + 1));
+    inicio = (unsigned int *) malloc(sizeof(unsigned int) * (p->n_partes + 1));
+    membros = (unsigned int *) malloc(sizeof(unsigned int) * (g->n_vertices + 1));
+
+    if(rotulo == NULL || inicio == NULL || membros == NULL) {
+      free(rotulo);
+      free(inicio);
+      free(membros);
+      return p;
+    }
+
+    memcpy(rotulo, p->rotulo, sizeof(unsigned int) * g->n_vertices);
+    memcpy(inicio, p->inicio, sizeof(unsigned int) * (p->n_partes + 1));
+    memcpy(membros, p->membros, sizeof(unsigned int) * g->n_vertices);
+    devolve_area(g, p->area);
+    p->area = NULL;
+    p->rotulo = rotulo;
+    p->inicio = inicio;
+    p->membros = membros;
+  }
+
+  /* A referência de g, solta de novo se ela não for guardada */
+  __atomic_add_fetch(&p->referencias, 1, __ATOMIC_RELAXED);
+
+  if(!guarda_resultado(g, GUARDADO_COMPONENTES, versao, p, tamanho, solta_particao)) {
+    libera_particao(p);
+  }
+
+  return p;
+}
+
+//------------------------------------------------------------------------------
+static size_t memoria_subgrafos(grafo g) {
+  /* Um subgrafo por componente (no máximo um por vértice) e a lista deles */
+  return soma_memoria(bloco(1, sizeof(struct lista)), memoria_listas(g->n_vertices, sizeof(struct subgrafo)));
+}
+
+//------------------------------------------------------------------------------
+static subgrafo cria_subgrafo(struct particao *p, unsigned int parte) {
+  struct subgrafo *s;
+
+  if((s = (struct subgrafo *) malloc(sizeof(struct subgrafo))) != NULL) {
+    s->p = p;
+    s->parte = parte;
+    __atomic_add_fetch(&p->referencias, 1, __ATOMIC_RELAXED);
+  }
+
+  return s;
+}
+
+//------------------------------------------------------------------------------
+lista subgrafos_componentes(grafo g) {
+  struct lista *l;
+  struct particao *p;
+  struct subgrafo *s;
+  unsigned int i;
+
+  erro_thread = ERRO_NENHUM;
+
+  if((p = componentes_guardados(g, memoria_subgrafos(g))) == NULL) {
+    falha(ERRO_MEMORIA);
+    return NULL;
+  }
+
+  /* Os componentes são inseridos na cabeça da lista na ordem em que foram
+     encontrados, como em componentes */
+  inicializa_lista(&l);
+
+  for(i = 0; l != NULL && i < p->n_partes; ++i) {
+    if((s = cria_subgrafo(p, i)) == NULL || !insere_cabeca_conteudo(l, s)) {
+      destroi_subgrafo(s);
+      destroi_lista(l, destroi_subgrafo);
+      l = NULL;
+    }
+  }
+
+  if(l == NULL) {
+    falha(ERRO_MEMORIA);
+  }
+
+  libera_particao(p);
+  return l;
+}
+
+//------------------------------------------------------------------------------
+subgrafo subgrafo_induzido(grafo g, unsigned int n, vertice *vertices) {
+  struct particao *p;
+  struct subgrafo *s;
+  unsigned int i, v;
+
+  if((p = aloca_particao(g, n)) == NULL) {
+    return NULL;
+  }
+
+  /* Uma única parte com os vértices dados, sem repetições */
+  p->n_partes = 1;
+  p->inicio[0] = 0;
+  p->inicio[1] = 0;
+
+  for(i = 0; i < n; ++i) {
+    if((v = indice_vertice(g, vertices[i])) != (unsigned int) -1 && p->rotulo[v] == (unsigned int) -1) {
+      p->rotulo[v] = 0;
+      p->membros[p->inicio[1]++] = v;
+    }
+  }
+
+  s = cria_subgrafo(p, 0);
+  libera_particao(p);
+  return s;
+}
+
+//------------------------------------------------------------------------------
+unsigned int n_vertices_subgrafo(subgrafo s) {
+  return s->p->inicio[s->parte + 1] - s->p->inicio[s->parte];
+}
+
+//------------------------------------------------------------------------------
+vertice vertice_subgrafo(subgrafo s, unsigned int i) {
+  if(i >= n_vertices_subgrafo(s)) {
+    return NULL;
+  }
+
+  return s->p->g->vertices + s->p->membros[s->p->inicio[s->parte] + i];
+}
+
+//------------------------------------------------------------------------------
+int pertence_subgrafo(subgrafo s, vertice v) {
+  unsigned int x;
+
+  if((x = indice_vertice(s->p->g, v)) == (unsigned int) -1) {
+    return 0;
+  }
+
+  return s->p->rotulo[x] == s->parte;
+}
+
+//------------------------------------------------------------------------------
+subgrafo escreve_subgrafo(FILE *output, subgrafo s) {
+  struct medida m;
+
+  inicia_medida(&m);
+  escreve_vertices(output, s->p->g, s->p->membros + s->p->inicio[s->parte], n_vertices_subgrafo(s), s->p->rotulo, s->parte);
+  termina_medida(s->p->g, &m, FASE_SAIDA);
+  return s;
+}
+
+//------------------------------------------------------------------------------
+static grafo copia_subgrafo(subgrafo s, unsigned int *posicao) {
+  struct grafo *g, *h;
+  struct cursor c;
+  struct aresta *copia;
+  long int peso;
+  unsigned int *membros;
+  unsigned int i, v, w, n_membros;
+
+  g = s->p->g;
+  membros = s->p->membros + s->p->inicio[s->parte];
+  n_membros = n_vertices_subgrafo(s);
+
+  /* A posição de cada vértice no novo grafo é guardada em posicao,
+     indexado pelos vértices de g */
+  if((h = cria_grafo(g->nome, g->direcionado, g->ponderado)) == NULL) {
+    return NULL;
+  }
+
+  h->vertices = (struct vertice *) malloc(sizeof(struct vertice) * (n_membros + 1));
+
+  if(h->vertices == NULL) {
+    destroi_grafo(h);
+    return NULL;
+  }
+
+  for(i = 0; i < n_membros; ++i) {
+    posicao[membros[i]] = i;
+    h->vertices[i].nome = strdup(g->vertices[membros[i]].nome);
+    inicializa_lista(&h->vertices[i].arestas);
+    h->n_vertices = i + 1;
+
+    if(h->vertices[i].nome == NULL || h->vertices[i].arestas == NULL) {
+      destroi_grafo(h);
+      return NULL;
+    }
+  }
+
+  h->capacidade = n_membros;
+
+  /* Copia as arestas entre vértices do subgrafo; um arco é copiado a partir
+     da origem, para a lista da origem, e cada cópia de uma aresta não
+     direcionada é copiada a partir da sua lista */
+  for(i = 0; i < n_membros; ++i) {
+    v = membros[i];
+
+    for(inicia_cursor(g, v, 0, &c); proximo_arco(&c, &w, &peso); ) {
+      if(s->p->rotulo[w] != s->parte) {
+        continue;
+      }
+
+      if((copia = (struct aresta *) malloc(sizeof(struct aresta))) == NULL || !insere_cabeca_conteudo(h->vertices[i].arestas, copia)) {
+        free(copia);
+        destroi_grafo(h);
+        return NULL;
+      }
+
+      copia->origem = i;
+      copia->destino = posicao[w];
+      copia->peso = peso;
+    }
+  }
+
+  return h;
+}
+
+//------------------------------------------------------------------------------
+grafo materializa_subgrafo(subgrafo s) {
+  struct grafo *h;
+  struct area_trabalho *area;
+
+  if((area = pega_area(s->p->g)) == NULL) {
+    return NULL;
+  }
+
+  h = copia_subgrafo(s, area->pai);
+  devolve_area(s->p->g, area);
+  return h;
+}
+
+//------------------------------------------------------------------------------
+int destroi_subgrafo(void *s) {
+  if(s != NULL) {
+    libera_particao(((struct subgrafo *) s)->p);
+    free(s);
+  }
+
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static size_t memoria_componentes(grafo g) {
+  /* As cópias dos componentes (no máximo um por vértice), que juntas têm
+     os vértices e os arcos de g, e a lista delas */
+  return soma_memoria(soma_memoria(memoria_vertices(g), memoria_listas(n_arcos(g), sizeof(struct aresta))),
+                      soma_memoria(memoria_listas(g->n_vertices, sizeof(struct grafo)),
+                                   bloco(g->n_vertices, bloco(strlen(g->nome) + 1, 1) + bloco(1, sizeof(struct vertice)))));
+}
+
+//------------------------------------------------------------------------------
+static lista _componentes(grafo g) {
+  struct lista *lista_componentes;
+  struct particao *p;
+  struct subgrafo s;
+  struct grafo *componente;
+  unsigned int i;
+  unsigned int *posicao;
+
+  if((p = componentes_guardados(g, memoria_componentes(g))) == NULL) {
+    return NULL;
+  }
+
+  /* Inicializa a lista de componentes; as posições dos vértices nos
+     componentes usam os pais da área de trabalho da partição, livres
+     depois da busca */
+  inicializa_lista(&lista_componentes);
+
+  if(p->area != NULL) {
+    posicao = p->area->pai;
+  } else if((posicao = (unsigned int *) malloc(sizeof(unsigned int) * (g->n_vertices + 1))) == NULL) {
+    destroi_lista(lista_componentes, NULL);
+    lista_componentes = NULL;
+  }
+
+  /* Materializa cada componente e o insere na cabeça da lista; sem
+     memória para algum, descarta os já feitos */
+  for(s.p = p, i = 0; lista_componentes != NULL && i < p->n_partes; ++i) {
+    s.parte = i;
+
+    if((componente = copia_subgrafo(&s, posicao)) == NULL || !insere_cabeca_conteudo(lista_componentes, componente)) {
+      destroi_grafo(componente);
+      destroi_lista(lista_componentes, destroi_grafo);
+      lista_componentes = NULL;
+    }
+  }
+
+  if(p->area == NULL) {
+    free(posicao);
+  }
+
+  libera_particao(p);
+  return lista_componentes;
+}
+
+//------------------------------------------------------------------------------
+lista componentes(grafo g) {
+  struct lista *l;
+  struct medida m;
+
+  inicia_medida(&m);
+  erro_thread = ERRO_NENHUM;
+
+  if((l = _componentes(g)) == NULL) {
+    falha(ERRO_MEMORIA);
+  }
+
+  termina_medida(g, &m, FASE_CALCULO);
+  return l;
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA int agrupa_condensacao(grafo g, struct condensacao *c, unsigned int *marca, const enum percurso modo) {
+  struct cursor sucessor;
+  long int peso;
+  unsigned int i, r, t, v, w, n_sucessores;
+
+  /* Com o componente de cada vértice em c->componente, agrupa os membros
+     e monta os sucessores de cada componente no DAG, marcando circuito
+     se algum componente tem mais de um vértice ou um laço; marca tem
+     espaço para um valor por componente. Os vetores de uma chamada
+     anterior (com outra numeração) são reaproveitados */
+  if(c->inicio_membros == NULL) {
+    c->inicio_membros = (unsigned int *) malloc(sizeof(unsigned int) * (c->n_componentes + 1));
+    c->membros = (unsigned int *) malloc(sizeof(unsigned int) * (g->n_vertices + 1));
+    c->inicio_sucessores = (unsigned int *) malloc(sizeof(unsigned int) * (c->n_componentes + 1));
+  }
+
+  free(c->sucessores);
+  c->sucessores = NULL;
+
+  if(c->inicio_membros == NULL || c->membros == NULL || c->inicio_sucessores == NULL) {
+    return 0;
+  }
+
+  /* Agrupa os vértices por componente (ordenação por contagem) */
+  for(i = 0; i <= c->n_componentes; ++i) {
+    c->inicio_membros[i] = 0;
+  }
+
+  for(i = 0; i < g->n_vertices; ++i) {
+    ++c->inicio_membros[c->componente[i] + 1];
+  }
+
+  for(i = 0; i < c->n_componentes; ++i) {
+    c->inicio_membros[i + 1] += c->inicio_membros[i];
+    marca[i] = c->inicio_membros[i];
+    c->circuito |= (c->inicio_membros[i + 1] - c->inicio_membros[i] > 1);
+  }
+
+  for(i = 0; i < g->n_vertices; ++i) {
+    c->membros[marca[c->componente[i]]++] = i;
+  }
+
+  /* Conta (r = 0) e depois preenche (r = 1) os sucessores de cada
+     componente no DAG, usando marca para não repetir um mesmo arco */
+  for(r = 0; r < 2; ++r) {
+    for(i = 0; i < c->n_componentes; ++i) {
+      marca[i] = (unsigned int) -1;
+    }
+
+    for(i = 0, n_sucessores = 0; i < c->n_componentes; ++i) {
+      c->inicio_sucessores[i] = n_sucessores;
+
+      for(t = c->inicio_membros[i]; t < c->inicio_membros[i + 1]; ++t) {
+        v = c->membros[t];
+
+        for(inicia_percurso(g, v, 0, modo, &sucessor); proximo_percurso(&sucessor, modo, &w, &peso); ) {
+          c->circuito |= (w == v);
+          w = c->componente[w];
+
+          if(w != i && marca[w] != i) {
+            marca[w] = i;
+
+            if(c->sucessores != NULL) {
+              c->sucessores[n_sucessores] = w;
+            }
+
+            ++n_sucessores;
+          }
+        }
+      }
+    }
+
+    c->inicio_sucessores[c->n_componentes] = n_sucessores;
+
+    if(r == 0 && (c->sucessores = (unsigned int *) malloc(sizeof(unsigned int) * (n_sucessores + 1))) == NULL) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA struct condensacao *nucleo_condensacao(grafo g, const enum percurso modo) {
+  struct condensacao *c;
+  struct cursor *cursor, *novo;
+  long int peso;
+  unsigned int *indice, *menor, *pilha, *chamada, *marca;
+  unsigned char *na_pilha;
+  unsigned long examinadas = 0;
+  unsigned int i, r, v, w, t, topo_pilha, topo_chamada, tamanho;
+  unsigned int capacidade_cursores;
+
+  c = (struct condensacao *) malloc(sizeof(struct condensacao));
+
+  if(c == NULL) {
+    return NULL;
+  }
+
+  c->n_componentes = 0;
+  c->circuito = 0;
+  c->componente = (unsigned int *) malloc(sizeof(unsigned int) * g->n_vertices);
+  c->inicio_membros = NULL;
+  c->membros = NULL;
+  c->inicio_sucessores = NULL;
+  c->sucessores = NULL;
+
+  /* Um cursor por nível da pilha de chamadas (e não por vértice), que
+     cresce sob demanda com a profundidade da busca */
+  capacidade_cursores = g->n_vertices < 1024 ? g->n_vertices : 1024;
+  cursor = (struct cursor *) malloc(sizeof(struct cursor) * (capacidade_cursores + 1));
+  indice = (unsigned int *) malloc(sizeof(unsigned int) * g->n_vertices);
+  menor = (unsigned int *) malloc(sizeof(unsigned int) * g->n_vertices);
+  pilha = (unsigned int *) malloc(sizeof(unsigned int) * g->n_vertices);
+  chamada = (unsigned int *) malloc(sizeof(unsigned int) * g->n_vertices);
+  na_pilha = (unsigned char *) malloc(sizeof(unsigned char) * g->n_vertices);
+
+  if(c->componente == NULL || cursor == NULL || indice == NULL || menor == NULL ||
+     pilha == NULL || chamada == NULL || na_pilha == NULL) {
+    free(cursor); free(indice); free(menor); free(pilha); free(chamada); free(na_pilha);
+    destroi_condensacao(c);
+    return NULL;
+  }
+
+  for(i = 0; i < g->n_vertices; ++i) {
+    indice[i] = 0;
+    na_pilha[i] = 0;
+  }
+
+  /* Algoritmo de Tarjan com a pilha de chamadas explícita (chamada e
+     cursor), para não estourar a pilha do programa em grafos grandes */
+  t = 0;
+  topo_pilha = 0;
+
+  for(r = 0; r < g->n_vertices; ++r) {
+    if(indice[r] != 0) {
+      continue;
+    }
+
+    indice[r] = menor[r] = ++t;
+    inicia_percurso(g, r, 0, modo, cursor);
+    pilha[topo_pilha++] = r;
+    na_pilha[r] = 1;
+    chamada[0] = r;
+    topo_chamada = 1;
+
+    while(topo_chamada > 0) {
+      v = chamada[topo_chamada - 1];
+
+      if(proximo_percurso(cursor + topo_chamada - 1, modo, &w, &peso)) {
+        ++examinadas;
+
+        if(w == v) {
+          c->circuito = 1;
+        } else if(indice[w] == 0) {
+          if(topo_chamada == capacidade_cursores) {
+            novo = (struct cursor *) realloc(cursor, sizeof(struct cursor) * 2 * capacidade_cursores);
+
+            if(novo == NULL) {
+              free(cursor); free(indice); free(menor); free(pilha); free(chamada); free(na_pilha);
+              destroi_condensacao(c);
+              return NULL;
+            }
+
+            cursor = novo;
+            capacidade_cursores *= 2;
+          }
+
+          /* Desce na busca a partir de w */
+          indice[w] = menor[w] = ++t;
+          inicia_percurso(g, w, 0, modo, cursor + topo_chamada);
+          pilha[topo_pilha++] = w;
+          na_pilha[w] = 1;
+          chamada[topo_chamada++] = w;
+        } else if(na_pilha[w] && indice[w] < menor[v]) {
+          menor[v] = indice[w];
+        }
+      } else {
+        /* Terminou a busca a partir de v, propaga o menor índice ao pai */
+        --topo_chamada;
+
+        if(topo_chamada > 0 && menor[v] < menor[chamada[topo_chamada - 1]]) {
+          menor[chamada[topo_chamada - 1]] = menor[v];
+        }
+
+        /* v é raiz de um componente, que é desempilhado inteiro */
+        if(menor[v] == indice[v]) {
+          tamanho = 0;
+
+          do {
+            w = pilha[--topo_pilha];
+            na_pilha[w] = 0;
+            c->componente[w] = c->n_componentes;
+            ++tamanho;
+          } while(w != v);
+
+          if(tamanho > 1) {
+            c->circuito = 1;
+          }
+
+          ++c->n_componentes;
+        }
+      }
+    }
+  }
+
+  free(cursor);
+  free(indice);
+  free(menor);
+  free(pilha);
+  free(na_pilha);
+  CONTA(g, arestas_examinadas, examinadas);
+
+  /* Tarjan termina os componentes em ordem topológica inversa, então
+     inverte a numeração para que os arcos vão de números menores para maiores */
+  for(i = 0; i < g->n_vertices; ++i) {
+    c->componente[i] = c->n_componentes - 1 - c->componente[i];
+  }
+
+  marca = chamada;
+
+  if(!agrupa_condensacao(g, c, marca, modo)) {
+    free(marca);
+    destroi_condensacao(c);
+    return NULL;
+  }
+
+  free(marca);
+  return c;
+}
+
+//------------------------------------------------------------------------------
+// componentes fortemente conexos em paralelo: poda dos componentes
+// triviais, busca para frente e para trás a partir de um pivô (que acha o
+// componente gigante) e coloração por propagação de rótulos para o resto,
+// como em Slota, Rajamanickam e Madduri, "BFS and coloring-based parallel
+// algorithms for strongly connected components and related problems"
+
+/* Estado da decomposição: rotulo[v] é o componente de v, ou -1 enquanto v
+   está ativo, e os ativos são ativos[0], ..., ativos[n_ativos - 1]. Na
+   coloração, cor[v] é o maior índice de um ativo que alcança v pelos
+   ativos; cada vértice com a própria cor é a raiz de um componente,
+   formado pelos ativos da sua cor que o alcançam. Os componentes são
+   numerados na ordem em que são achados (n_componentes) */
+struct decomposicao {
+  grafo g;
+  enum percurso modo;
+  unsigned int *rotulo;
+  unsigned int *cor;
+  unsigned int *ativos;
+  unsigned int n_ativos;
+  unsigned int n_componentes;
+  int mudou;
+  int erro;
+};
+
+/* Parte dos ativos processada por um thread */
+struct tarefa_fortes {
+  struct decomposicao *d;
+  unsigned int primeiro, ultimo;
+};
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA int vizinho_ativo(struct decomposicao *d, unsigned int v, int entrada, const enum percurso modo) {
+  struct cursor c;
+  long int peso;
+  unsigned int w;
+
+  /* Se há um arco no sentido dado entre v e outro vértice ativo */
+  for(inicia_percurso(d->g, v, entrada && d->g->direcionado, modo, &c); proximo_percurso(&c, modo, &w, &peso); ) {
+    if(w != v && __atomic_load_n(d->rotulo + w, __ATOMIC_RELAXED) == (unsigned int) -1) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA void poda_fortes(struct decomposicao *d, unsigned int primeiro, unsigned int ultimo, const enum percurso modo) {
+  unsigned int i, v;
+
+  /* Um ativo sem arco que venha de outro ativo, ou sem arco que vá para
+     outro, não está em circuito com eles: é sozinho um componente. Os
+     que já têm componente (o do pivô) ainda não foram descartados */
+  for(i = primeiro; i < ultimo; ++i) {
+    v = d->ativos[i];
+
+    if(d->rotulo[v] != (unsigned int) -1) {
+      continue;
+    }
+
+    if(!vizinho_ativo(d, v, 0, modo) || !vizinho_ativo(d, v, 1, PERCURSO_INVERSO(modo))) {
+      __atomic_store_n(d->rotulo + v, __atomic_fetch_add(&d->n_componentes, 1, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+      __atomic_store_n(&d->mudou, 1, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA void propaga_cores(struct decomposicao *d, unsigned int primeiro, unsigned int ultimo, const enum percurso modo) {
+  struct cursor c;
+  long int peso;
+  unsigned int i, v, w, cor_v, cor_w;
+  int mudou = 0;
+
+  /* Cada ativo passa a sua cor aos sucessores ativos de cor menor; as
+     cores só aumentam, então as atualizações simultâneas (por
+     compare_and_swap) convergem para o mesmo resultado */
+  for(i = primeiro; i < ultimo; ++i) {
+    v = d->ativos[i];
+    cor_v = __atomic_load_n(d->cor + v, __ATOMIC_RELAXED);
+
+    for(inicia_percurso(d->g, v, 0, modo, &c); proximo_percurso(&c, modo, &w, &peso); ) {
+      if(d->rotulo[w] != (unsigned int) -1) {
+        continue;
+      }
+
+      cor_w = __atomic_load_n(d->cor + w, __ATOMIC_RELAXED);
+
+      while(cor_w < cor_v) {
+        if(__atomic_compare_exchange_n(d->cor + w, &cor_w, cor_v, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+          mudou = 1;
+          break;
+        }
+      }
+    }
+  }
+
+  if(mudou) {
+    __atomic_store_n(&d->mudou, 1, __ATOMIC_RELAXED);
+  }
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA void colhe_fortes(struct decomposicao *d, unsigned int primeiro, unsigned int ultimo, const enum percurso modo) {
+  struct cursor c;
+  long int peso;
+  unsigned int *fila, *nova;
+  unsigned int i, k, n_fila, capacidade, r, u, w, componente;
+
+  /* Busca para trás a partir de cada raiz pelos ativos da sua cor; como
+     cada cor é percorrida por um único thread, os rótulos são gravados
+     sem disputa */
+  capacidade = 1024;
+
+  if((fila = (unsigned int *) malloc(sizeof(unsigned int) * capacidade)) == NULL) {
+    __atomic_store_n(&d->erro, 1, __ATOMIC_RELAXED);
+    return;
+  }
+
+  for(i = primeiro; i < ultimo; ++i) {
+    r = d->ativos[i];
+
+    if(d->cor[r] != r) {
+      continue;
+    }
+
+    componente = __atomic_fetch_add(&d->n_componentes, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(d->rotulo + r, componente, __ATOMIC_RELAXED);
+    fila[0] = r;
+
+    for(k = 0, n_fila = 1; k < n_fila; ++k) {
+      u = fila[k];
+
+      for(inicia_percurso(d->g, u, d->g->direcionado, PERCURSO_INVERSO(modo), &c); proximo_percurso(&c, PERCURSO_INVERSO(modo), &w, &peso); ) {
+        if(d->cor[w] != r || __atomic_load_n(d->rotulo + w, __ATOMIC_RELAXED) != (unsigned int) -1) {
+          continue;
+        }
+
+        if(n_fila == capacidade) {
+          if((nova = (unsigned int *) realloc(fila, sizeof(unsigned int) * 2 * capacidade)) == NULL) {
+            __atomic_store_n(&d->erro, 1, __ATOMIC_RELAXED);
+            free(fila);
+            return;
+          }
+
+          fila = nova;
+          capacidade *= 2;
+        }
+
+        __atomic_store_n(d->rotulo + w, componente, __ATOMIC_RELAXED);
+        fila[n_fila++] = w;
+      }
+    }
+  }
+
+  free(fila);
+}
+
+//------------------------------------------------------------------------------
+static void *_poda_fortes(void *p) {
+  struct tarefa_fortes *t;
+
+  t = (struct tarefa_fortes *) p;
+  DESPACHA_PERCURSO_SEM_PESO(t->d->modo, poda_fortes, t->d, t->primeiro, t->ultimo);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void *_propaga_cores(void *p) {
+  struct tarefa_fortes *t;
+
+  t = (struct tarefa_fortes *) p;
+  DESPACHA_PERCURSO_SEM_PESO(t->d->modo, propaga_cores, t->d, t->primeiro, t->ultimo);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void *_colhe_fortes(void *p) {
+  struct tarefa_fortes *t;
+
+  t = (struct tarefa_fortes *) p;
+  DESPACHA_PERCURSO_SEM_PESO(t->d->modo, colhe_fortes, t->d, t->primeiro, t->ultimo);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void passo_fortes(struct decomposicao *d, struct tarefa_fortes *tarefas, unsigned int n_tarefas, void *rotina(void *)) {
+  unsigned int i, k, n_partes;
+
+  /* Divide os ativos entre os threads e depois descarta os que ganharam
+     componente */
+  n_partes = (d->n_ativos >= LARGURA_PARALELA) ? n_tarefas : 1;
+
+  for(k = 0; k < n_partes; ++k) {
+    tarefas[k].d = d;
+    tarefas[k].primeiro = (unsigned int) ((unsigned long) d->n_ativos * k / n_partes);
+    tarefas[k].ultimo = (unsigned int) ((unsigned long) d->n_ativos * (k + 1) / n_partes);
+  }
+
+  if(n_partes > 1) {
+    executa_paralelo(rotina, tarefas, sizeof(struct tarefa_fortes), n_partes);
+  } else {
+    rotina(tarefas);
+  }
+
+  for(i = 0, k = 0; i < d->n_ativos; ++i) {
+    if(d->rotulo[d->ativos[i]] == (unsigned int) -1) {
+      d->ativos[k++] = d->ativos[i];
+    }
+  }
+
+  d->n_ativos = k;
+}
+
+//------------------------------------------------------------------------------
+static unsigned int escolhe_pivo(struct decomposicao *d) {
+  struct cursor c;
+  long int peso;
+  unsigned long grau_saida, grau_entrada, maior;
+  unsigned int k, v, w, pivo;
+
+  /* Entre até AMOSTRA_PIVO ativos espaçados, o de maior produto dos graus
+     de saída e de entrada, que provavelmente está no componente gigante */
+  for(k = 0, maior = 0, pivo = d->ativos[0]; k < AMOSTRA_PIVO && k < d->n_ativos; ++k) {
+    v = d->ativos[(unsigned int) ((unsigned long) d->n_ativos * k / AMOSTRA_PIVO)];
+
+    for(grau_saida = 0, inicia_cursor(d->g, v, 0, &c); proximo_arco(&c, &w, &peso); ++grau_saida);
+    for(grau_entrada = 0, inicia_cursor(d->g, v, d->g->direcionado, &c); proximo_arco(&c, &w, &peso); ++grau_entrada);
+
+    if(grau_saida * grau_entrada > maior) {
+      maior = grau_saida * grau_entrada;
+      pivo = v;
+    }
+  }
+
+  return pivo;
+}
+
+//------------------------------------------------------------------------------
+static int numera_topologica(grafo g, struct condensacao *c, struct area_trabalho *area) {
+  unsigned int *novo, *grau, *fila;
+  unsigned int i, k, n_fila, v;
+  int sucesso;
+
+  novo = area->rotulo;
+  grau = area->inicio;
+  fila = area->membros;
+
+  /* Renumera os componentes pelo seu menor vértice, para que o resultado
+     não dependa da ordem em que os threads os acharam */
+  for(i = 0; i < c->n_componentes; ++i) {
+    novo[i] = (unsigned int) -1;
+  }
+
+  for(v = 0, k = 0; v < g->n_vertices; ++v) {
+    if(novo[c->componente[v]] == (unsigned int) -1) {
+      novo[c->componente[v]] = k++;
+    }
+
+    c->componente[v] = novo[c->componente[v]];
+  }
+
+  DESPACHA_PERCURSO_SEM_PESO(modo_percurso(g, 0, 0), sucesso = agrupa_condensacao, g, c, area->pai);
+
+  if(!sucesso) {
+    return 0;
+  }
+
+  /* Numera os componentes em ordem topológica do DAG (algoritmo de Kahn,
+     com os componentes sem predecessores tomados em ordem crescente) e
+     agrupa de novo com a numeração final */
+  for(i = 0; i < c->n_componentes; ++i) {
+    grau[i] = 0;
+  }
+
+  for(i = 0; i < c->inicio_sucessores[c->n_componentes]; ++i) {
+    ++grau[c->sucessores[i]];
+  }
+
+  for(i = 0, n_fila = 0; i < c->n_componentes; ++i) {
+    if(grau[i] == 0) {
+      fila[n_fila++] = i;
+    }
+  }
+
+  for(k = 0; k < n_fila; ++k) {
+    novo[fila[k]] = k;
+
+    for(i = c->inicio_sucessores[fila[k]]; i < c->inicio_sucessores[fila[k] + 1]; ++i) {
+      if(--grau[c->sucessores[i]] == 0) {
+        fila[n_fila++] = c->sucessores[i];
+      }
+    }
+  }
+
+  for(v = 0; v < g->n_vertices; ++v) {
+    c->componente[v] = novo[c->componente[v]];
+  }
+
+  DESPACHA_PERCURSO_SEM_PESO(modo_percurso(g, 0, 0), sucesso = agrupa_condensacao, g, c, area->pai);
+  return sucesso;
+}
+
+//------------------------------------------------------------------------------
+static struct condensacao *condensacao_paralela(grafo g, unsigned int n_tarefas) {
+  struct condensacao *c;
+  struct decomposicao d;
+  struct tarefa_fortes *tarefas;
+  struct area_trabalho *frente, *tras;
+  struct busca_largura b;
+  unsigned int i, v, rodada, pivo;
+  int sucesso;
+
+  c = (struct condensacao *) malloc(sizeof(struct condensacao));
+  tarefas = (struct tarefa_fortes *) malloc(sizeof(struct tarefa_fortes) * n_tarefas);
+  d.cor = (unsigned int *) malloc(sizeof(unsigned int) * g->n_vertices);
+  d.ativos = (unsigned int *) malloc(sizeof(unsigned int) * g->n_vertices);
+  frente = pega_area(g);
+  tras = pega_area(g);
+
+  if(c != NULL) {
+    c->n_componentes = 0;
+    c->circuito = 0;
+    c->componente = (unsigned int *) malloc(sizeof(unsigned int) * g->n_vertices);
+    c->inicio_membros = NULL;
+    c->membros = NULL;
+    c->inicio_sucessores = NULL;
+    c->sucessores = NULL;
+  }
+
+  sucesso = (c != NULL && c->componente != NULL && tarefas != NULL && d.cor != NULL && d.ativos != NULL && frente != NULL && tras != NULL);
+
+  if(sucesso) {
+    d.g = g;
+    d.modo = modo_percurso(g, 0, 0);
+    d.rotulo = c->componente;
+    d.n_ativos = g->n_vertices;
+    d.n_componentes = 0;
+    d.erro = 0;
+
+    for(v = 0; v < g->n_vertices; ++v) {
+      d.rotulo[v] = (unsigned int) -1;
+      d.ativos[v] = v;
+    }
+
+    /* Poda dos componentes triviais, enquanto ela acha algum */
+    for(rodada = 0, d.mudou = 1; rodada < RODADAS_PODA && d.mudou && d.n_ativos > 0; ++rodada) {
+      d.mudou = 0;
+      passo_fortes(&d, tarefas, n_tarefas, _poda_fortes);
+    }
+  }
+
+  /* O componente do pivô é o dos vértices alcançados por ele e que o
+     alcançam: duas buscas em largura, que podem passar pelos vértices já
+     podados (nenhum deles está nas duas) */
+  if(sucesso && d.n_ativos > 0) {
+    pivo = escolhe_pivo(&d);
+    b.g = g;
+    b.modo = d.modo;
+    b.pai = NULL;
+    b.candidatos = NULL;
+    b.n_candidatos = g->n_vertices;
+    b.passo = 1;
+
+    for(i = 0; i < 2; ++i) {
+      b.sentido = (i == 0) ? LARGURA_SAIDA : LARGURA_ENTRADA;
+      b.distancia = (i == 0) ? frente->distancia : tras->distancia;
+      b.fila = (i == 0) ? frente->heap : tras->heap;
+      b.fronteira = (i == 0) ? frente->marcas : tras->marcas;
+      b.nao_visitados = g->n_vertices;
+
+      for(v = 0; v < g->n_vertices; ++v) {
+        b.distancia[v] = infinito;
+      }
+
+      b.distancia[pivo] = 0;
+      b.fila[0] = pivo;
+      busca_largura(&b, 1, n_tarefas);
+    }
+
+    for(i = 0; i < d.n_ativos; ++i) {
+      v = d.ativos[i];
+
+      if(frente->distancia[v] != infinito && tras->distancia[v] != infinito) {
+        d.rotulo[v] = d.n_componentes;
+      }
+    }
+
+    /* Descarta os vértices do componente e poda de novo os que ficaram
+       triviais sem ele */
+    ++d.n_componentes;
+    passo_fortes(&d, tarefas, n_tarefas, _poda_fortes);
+  }
+
+  /* Coloração: cada ativo começa com a própria cor, as cores se propagam
+     pelos arcos até estabilizar e cada raiz colhe o seu componente */
+  while(sucesso && d.n_ativos > 0) {
+    for(i = 0; i < d.n_ativos; ++i) {
+      d.cor[d.ativos[i]] = d.ativos[i];
+    }
+
+    do {
+      d.mudou = 0;
+      passo_fortes(&d, tarefas, n_tarefas, _propaga_cores);
+    } while(d.mudou);
+
+    passo_fortes(&d, tarefas, n_tarefas, _colhe_fortes);
+    sucesso = !d.erro;
+  }
+
+  if(sucesso) {
+    c->n_componentes = d.n_componentes;
+    sucesso = numera_topologica(g, c, frente);
+  }
+
+  free(tarefas);
+  free(d.cor);
+  free(d.ativos);
+
+  if(frente != NULL) {
+    devolve_area(g, frente);
+  }
+
+  if(tras != NULL) {
+    devolve_area(g, tras);
+  }
+
+  if(!sucesso) {
+    destroi_condensacao(c);
+    return NULL;
+  }
+
+  return c;
+}
+
+//------------------------------------------------------------------------------
+static struct condensacao *gera_condensacao(grafo g, unsigned int n_tarefas) {
+  struct condensacao *c;
+
+  /* Com n_tarefas > 0, a decomposição paralela; se ela falha (memória), ou
+     com 0, o algoritmo de Tarjan */
+  if(n_tarefas > 0 && (c = condensacao_paralela(g, n_tarefas)) != NULL) {
+    return c;
+  }
+
+  DESPACHA_PERCURSO_SEM_PESO(modo_percurso(g, 0, 0), c = nucleo_condensacao, g);
+  return c;
+}
+
+//------------------------------------------------------------------------------
+static size_t memoria_condensacao(grafo g, int paralela) {
+  size_t n, total;
+
+  /* O resultado, com no máximo um sucessor por arco, e os vetores de cada
+     algoritmo: na decomposição paralela os arcos de entrada, as cores, os
+     ativos, as filas da colheita (dobradas a cada realloc) e duas áreas
+     de trabalho; no de Tarjan os índices, as pilhas e um cursor por nível
+     da busca, que pode descer por todos os vértices */
+  if(__atomic_load_n(&g->condensacao, __ATOMIC_ACQUIRE) != NULL) {
+    return 0;
+  }
+
+  n = g->n_vertices + 1;
+  total = bloco(1, sizeof(struct condensacao)) + 4 * bloco(n, sizeof(unsigned int));
+  total = soma_memoria(total, bloco(n_arcos(g) + 1, sizeof(unsigned int)));
+
+  if(paralela) {
+    return soma_memoria(total, soma_memoria(memoria_entrada(g), memoria_areas(g, 2) + 2 * bloco(n, sizeof(unsigned int)) +
+                                            bloco(3 * n, sizeof(unsigned int)) + bloco(numero_threads(), sizeof(struct tarefa_fortes))));
+  }
+
+  return soma_memoria(total, 4 * bloco(n, sizeof(unsigned int)) + bloco(n, 1) + bloco(3 * n, sizeof(struct cursor)));
+}
+
+//------------------------------------------------------------------------------
+static int condensacao_preferida(grafo g) {
+  int paralela;
+
+  /* 1 para a decomposição paralela, 0 para o algoritmo de Tarjan ou -1
+     se nenhum cabe no orçamento: a paralela nos grafos grandes com mais
+     de um thread e Tarjan nos demais, ou o outro, se o preferido não cabe */
+  paralela = (g->n_vertices >= FORTES_PARALELA && numero_threads() > 1);
+
+  if(cabe_orcamento(memoria_condensacao(g, paralela))) {
+    return paralela;
+  }
+
+  return cabe_orcamento(memoria_condensacao(g, !paralela)) ? !paralela : -1;
+}
+
+//------------------------------------------------------------------------------
+static struct condensacao *condensacao(grafo g) {
+  struct medida m;
+  unsigned int n_tarefas;
+  int paralela;
+
+  /* A condensação é calculada uma única vez e guardada em g, sendo
+     compartilhada por ordena, fortemente_conexo e alcancavel; com
+     consultas simultâneas, apenas uma a calcula e as demais esperam. Os
+     grafos grandes são decompostos em paralelo, o que exige os arcos de
+     entrada, montados antes da trava (prepara_entrada também a toma) */
+  if(__atomic_load_n(&g->condensacao, __ATOMIC_ACQUIRE) == NULL) {
+    if((paralela = condensacao_preferida(g)) < 0) {
+      falha(ERRO_ORCAMENTO);
+      return NULL;
+    }
+
+    n_tarefas = (paralela && prepara_entrada(g)) ? numero_threads() : 0;
+
+    pthread_mutex_lock(&g->trava);
+
+    if(g->condensacao == NULL) {
+      inicia_medida(&m);
+      __atomic_store_n(&g->condensacao, gera_condensacao(g, n_tarefas), __ATOMIC_RELEASE);
+      termina_medida(g, &m, FASE_INDICE);
+    }
+
+    pthread_mutex_unlock(&g->trava);
+  }
+
+  return g->condensacao;
+}
+
+//------------------------------------------------------------------------------
+static lista _ordena(grafo g) {
+  struct lista *l;
+  struct condensacao *c;
+  unsigned int i;
+
+  /* Se o grafo não é direcionado, retorna NULL conforme especificação */
+  if(!g->direcionado) {
+    return NULL;
+  }
+
+  /* Se algum componente fortemente conexo tem mais de um vértice (ou um
+     laço), g tem circuito direcionado e não pode ser ordenado */
+  if((c = condensacao(g)) == NULL || c->circuito) {
+    return NULL;
+  }
+
+  /* Aloca a lista dos vértices ordenados */
+  inicializa_lista(&l);
+
+  if(l != NULL) {
+    /* Sem circuitos cada componente é um vértice e a numeração dos
+       componentes já é uma ordem topológica; insere do último ao primeiro */
+    for(i = c->n_componentes; i > 0; --i) {
+      insere_cabeca_conteudo(l, g->vertices + c->membros[c->inicio_membros[i - 1]]);
+    }
+  }
+
+  return l;
+}
+
+//------------------------------------------------------------------------------
+lista ordena(grafo g) {
+  struct lista *l;
+  struct medida m;
+
+  /* A ordem vem da condensação, guardada em g até a próxima alteração */
+  inicia_medida(&m);
+  conta_resultado(g, __atomic_load_n(&g->condensacao, __ATOMIC_ACQUIRE) != NULL);
+  l = _ordena(g);
+  termina_medida(g, &m, FASE_CALCULO);
+  return l;
+}
+
+//------------------------------------------------------------------------------
+static void informa_progresso(grafo g, unsigned int feitos, unsigned int total) {
+  if(g->progresso != NULL) {
+    g->progresso(g->dados_progresso, feitos, total);
+  }
+}
+
+//------------------------------------------------------------------------------
+// heap binário de vértices com chave em um vetor externo (as distâncias),
+// com a posição de cada vértice para diminuir sua chave
+
+/* Fila de prioridade do algoritmo de Dijkstra (FILA_HEAP, FILA_DIAL,
+   FILA_RADIX ou FILA_LARGURA, de grafo.h). Com pesos inteiros não
+   negativos (escolhe_fila) os vértices podem ficar em listas duplamente
+   encadeadas de baldes em vez do heap: na fila de Dial o balde de v é a
+   sua distância módulo o número de baldes, maior que o peso máximo, e os
+   baldes são percorridos em círculo; no heap radix o balde é o número de
+   bits da diferença entre a distância de v e a última removida, e o
+   primeiro balde não vazio é redistribuído quando o balde 0 se esvazia.
+   Nos dois casos vertices guarda o próximo vértice do balde, anterior o
+   anterior e posicao o balde de cada vértice (-1 fora da fila). Num grafo
+   direcionado acíclico (FILA_TOPOLOGICA) a fila não é usada; com pesos
+   negativos (FILA_JOHNSON) o heap radix ordena as distâncias com os pesos
+   reduzidos peso + potencial[v] - potencial[w], que não são negativos.
+   Com todos os pesos iguais a passo (FILA_LARGURA) a busca é em largura,
+   com vertices como fila, marcas como bitmap da fronteira e até tarefas
+   threads por nível. Se regiao não é NULL, as buscas só iniciam as
+   distâncias dos seus n_regiao vértices, que contêm todos os alcançáveis
+   a partir da raiz */
+struct heap {
+  unsigned int n;
+  unsigned int *vertices;
+  unsigned int *posicao;
+  long int *chave;
+  int fila;
+  unsigned int *anterior;
+  unsigned int *baldes;
+  unsigned int mascara;
+  const long int *potencial;
+  uint64_t *marcas;
+  long int passo;
+  unsigned int tarefas;
+  const unsigned int *regiao;
+  unsigned int n_regiao;
+};
+
+/* Fila das buscas de uma chamada, escolhida uma única vez (escolhe_fila) e
+   compartilhada pelos threads da chamada */
+struct fila_busca {
+  int fila;
+  unsigned int mascara;
+  long int passo;
+  long int *potencial;
+};
+
+//------------------------------------------------------------------------------
+static int inicializa_heap(struct heap *h, unsigned int n_vertices, long int *chave) {
+  unsigned int i;
+
+  h->n = 0;
+  h->chave = chave;
+  h->fila = FILA_HEAP;
+  h->anterior = NULL;
+  h->baldes = NULL;
+  h->mascara = 0;
+  h->potencial = NULL;
+  h->marcas = NULL;
+  h->passo = 0;
+  h->tarefas = 1;
+  h->regiao = NULL;
+  h->n_regiao = 0;
+  h->vertices = (unsigned int *) malloc(sizeof(unsigned int) * (n_vertices + 1));
+  h->posicao = (unsigned int *) malloc(sizeof(unsigned int) * (n_vertices + 1));
+
+  if(h->vertices == NULL || h->posicao == NULL) {
+    free(h->vertices);
+    free(h->posicao);
+    return 0;
+  }
+
+  /* Nenhum vértice está no heap */
+  for(i = 0; i < n_vertices; ++i) {
+    h->posicao[i] = (unsigned int) -1;
+  }
+
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static void destroi_heap(struct heap *h) {
+  free(h->vertices);
+  free(h->posicao);
+}
+
+//------------------------------------------------------------------------------
+static void heap_sobe(struct heap *h, unsigned int i) {
+  unsigned int v, pai;
+
+  v = h->vertices[i];
+
+  /* Sobe v enquanto sua chave for menor que a do pai */
+  while(i > 0 && h->chave[h->vertices[pai = (i - 1) / 2]] > h->chave[v]) {
+    h->vertices[i] = h->vertices[pai];
+    h->posicao[h->vertices[i]] = i;
+    i = pai;
+  }
+
+  h->vertices[i] = v;
+  h->posicao[v] = i;
+}
+
+//------------------------------------------------------------------------------
+static void heap_insere(struct heap *h, unsigned int v) {
+  /* Insere v, ou apenas o reposiciona se sua chave diminuiu */
+  if(h->posicao[v] == (unsigned int) -1) {
+    h->vertices[h->n] = v;
+    heap_sobe(h, h->n++);
+  } else {
+    heap_sobe(h, h->posicao[v]);
+  }
+}
+
+//------------------------------------------------------------------------------
+static unsigned int heap_remove(struct heap *h) {
+  unsigned int v, u, i, filho;
+
+  v = h->vertices[0];
+  h->posicao[v] = (unsigned int) -1;
+  u = h->vertices[--h->n];
+
+  /* Desce o último vértice a partir da raiz até achar sua posição */
+  if(h->n > 0) {
+    for(i = 0; (filho = 2 * i + 1) < h->n; i = filho) {
+      if(filho + 1 < h->n && h->chave[h->vertices[filho + 1]] < h->chave[h->vertices[filho]]) {
+        ++filho;
+      }
+
+      if(h->chave[h->vertices[filho]] >= h->chave[u]) {
+        break;
+      }
+
+      h->vertices[i] = h->vertices[filho];
+      h->posicao[h->vertices[i]] = i;
+    }
+
+    h->vertices[i] = u;
+    h->posicao[u] = i;
+  }
+
+  return v;
+}
+
+//------------------------------------------------------------------------------
+static void limpa_distancias(grafo g, long int *distancia, const struct heap *h) {
+  unsigned int i;
+
+  /* Só os vértices da região de h (todos, se não há) são alcançáveis */
+  if(h->regiao == NULL) {
+    for(i = 0; i < g->n_vertices; ++i) {
+      distancia[i] = infinito;
+    }
+  } else {
+    for(i = 0; i < h->n_regiao; ++i) {
+      distancia[h->regiao[i]] = infinito;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA void nucleo_dijkstra(grafo g, unsigned int r, long int *distancia, unsigned int *pai, struct heap *h, const enum percurso modo) {
+  struct cursor c;
+  long int peso;
+  unsigned long examinadas = 0, fixados = 0, operacoes = 1;
+  unsigned int v, w;
+
+  limpa_distancias(g, distancia, h);
+
+  /* Algoritmo de Dijkstra com heap binário a partir de r, considerando
+     apenas as arestas (arcos) que saem de cada vértice */
+  distancia[r] = 0;
+  heap_insere(h, r);
+
+  while(h->n > 0) {
+    v = heap_remove(h);
+    ++fixados;
+
+    for(inicia_percurso(g, v, 0, modo, &c); proximo_percurso(&c, modo, &w, &peso); ++examinadas) {
+      if(distancia[v] + peso < distancia[w]) {
+        distancia[w] = distancia[v] + peso;
+        heap_insere(h, w);
+
+        if(pai != NULL) {
+          pai[w] = v;
+        }
+
+        ++operacoes;
+      }
+    }
+  }
+
+  CONTA(g, arestas_examinadas, examinadas);
+  CONTA(g, vertices_fixados, fixados);
+  CONTA(g, operacoes_heap, operacoes + fixados);
+}
+
+//------------------------------------------------------------------------------
+static int aciclico(grafo g) {
+  struct condensacao *c;
+
+  /* Um grafo direcionado é acíclico se a sua condensação não tem circuito;
+     cada componente é então um vértice, e membros é uma ordem topológica */
+  return g->direcionado && g->n_vertices > 0 && (c = condensacao(g)) != NULL && !c->circuito;
+}
+
+//------------------------------------------------------------------------------
+static unsigned int circuito_pais(const unsigned int *pai, unsigned int *rotulo, unsigned int n) {
+  unsigned int s, u;
+
+  /* Procura um circuito no grafo dos pais (pai[w] -> w), seguindo os pais
+     a partir de cada vértice ainda não visitado e marcando com s + 1 os
+     vértices do caminho de s; devolve um vértice do circuito, ou -1 */
+  for(s = 0; s < n; ++s) {
+    rotulo[s] = 0;
+  }
+
+  for(s = 0; s < n; ++s) {
+    for(u = s; u != (unsigned int) -1 && rotulo[u] == 0; u = pai[u]) {
+      rotulo[u] = s + 1;
+    }
+
+    if(u != (unsigned int) -1 && rotulo[u] == s + 1) {
+      return u;
+    }
+  }
+
+  return (unsigned int) -1;
+}
+
+//------------------------------------------------------------------------------
+static int potenciais_johnson(grafo g, struct area_trabalho *area, long int *potencial, unsigned int *circuito) {
+  struct cursor c;
+  long int peso;
+  unsigned long relaxacoes = 0, examinadas = 0;
+  unsigned int *fila, *na_fila;
+  unsigned int i, v, w, inicio, n_fila;
+
+  /* Bellman-Ford com fila (SPFA) a partir de uma fonte virtual com arcos
+     de peso 0 para todos os vértices: todos começam na fila com potencial
+     0, e o potencial final de v é a menor distância de algum vértice a v.
+     O pai de cada vértice é o último que melhorou o seu potencial, e um
+     circuito no grafo dos pais é sempre negativo; ele é procurado a cada n
+     melhoras, e se g tem circuito negativo acaba aparecendo. Devolve 0 com
+     um vértice do circuito em *circuito, ou 1 com os potenciais */
+  fila = area->heap;
+  na_fila = area->membros;
+
+  for(i = 0; i < g->n_vertices; ++i) {
+    potencial[i] = 0;
+    area->pai[i] = (unsigned int) -1;
+    fila[i] = i;
+    na_fila[i] = 1;
+  }
+
+  for(inicio = 0, n_fila = g->n_vertices; n_fila > 0; ) {
+    v = fila[inicio];
+    inicio = (inicio + 1 == g->n_vertices) ? 0 : inicio + 1;
+    na_fila[v] = 0;
+    --n_fila;
+
+    for(inicia_cursor(g, v, 0, &c); proximo_arco(&c, &w, &peso); ++examinadas) {
+      if(potencial[v] + peso >= potencial[w]) {
+        continue;
+      }
+
+      potencial[w] = potencial[v] + peso;
+      area->pai[w] = v;
+
+      if(!na_fila[w]) {
+        fila[(inicio + n_fila) % g->n_vertices] = w;
+        na_fila[w] = 1;
+        ++n_fila;
+      }
+
+      if(++relaxacoes % g->n_vertices == 0 && (*circuito = circuito_pais(area->pai, area->rotulo, g->n_vertices)) != (unsigned int) -1) {
+        CONTA(g, arestas_examinadas, examinadas);
+        return 0;
+      }
+    }
+  }
+
+  CONTA(g, arestas_examinadas, examinadas);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static int usa_largura(grafo g) {
+  long int minimo, maximo;
+
+  /* Se escolhe_fila fica com a busca em largura: com os pesos iguais e
+     não negativos, se a fila definida a admite e se os arcos de entrada,
+     que o seu passo ascendente segue, cabem no orçamento */
+  faixa_pesos(g, &minimo, &maximo);
+  return minimo >= 0 && minimo == maximo && (g->fila == FILA_AUTOMATICA || g->fila == FILA_LARGURA) && cabe_orcamento(memoria_entrada(g));
+}
+
+//------------------------------------------------------------------------------
+static size_t memoria_fila(grafo g) {
+  long int minimo, maximo;
+
+  /* Os potenciais de Johnson ou os arcos de entrada da busca em largura;
+     a área de trabalho de potenciais_johnson volta à reserva antes das
+     buscas, que a reaproveitam */
+  faixa_pesos(g, &minimo, &maximo);
+  return (minimo < 0) ? bloco(g->n_vertices + 1, sizeof(long int)) : usa_largura(g) ? memoria_entrada(g) : 0;
+}
+
+//------------------------------------------------------------------------------
+static int escolhe_fila(grafo g, struct fila_busca *f) {
+  struct area_trabalho *area;
+  long int minimo, maximo;
+  unsigned int baldes, circuito;
+  int sucesso;
+
+  /* Num grafo direcionado acíclico os vértices são fixados em ordem
+     topológica, com qualquer peso e qualquer fila. Nos demais, uma passada
+     pelos pesos dos arcos: com algum peso negativo, os potenciais de
+     Johnson e o heap radix sobre os pesos reduzidos; com todos iguais, a
+     busca em largura (se os arcos de entrada cabem no orçamento); com
+     todos abaixo de BALDES_DIAL, a fila de Dial com a menor potência de 2
+     de baldes maior que o peso máximo; senão o heap radix. A fila de
+     define_fila é usada quando os pesos a permitem. Devolve 0 em caso de
+     erro ou se g tem circuito negativo */
+  f->fila = FILA_HEAP;
+  f->mascara = 0;
+  f->passo = 0;
+  f->potencial = NULL;
+
+  if(aciclico(g)) {
+    f->fila = FILA_TOPOLOGICA;
+    return 1;
+  }
+
+  faixa_pesos(g, &minimo, &maximo);
+
+  if(minimo < 0) {
+    f->fila = FILA_JOHNSON;
+    f->potencial = (long int *) malloc(sizeof(long int) * (g->n_vertices + 1));
+
+    if(f->potencial == NULL || (area = pega_area(g)) == NULL) {
+      free(f->potencial);
+      f->potencial = NULL;
+      return 0;
+    }
+
+    sucesso = potenciais_johnson(g, area, f->potencial, &circuito);
+    devolve_area(g, area);
+
+    if(!sucesso) {
+      free(f->potencial);
+      f->potencial = NULL;
+      falha(ERRO_CIRCUITO);
+    }
+
+    return sucesso;
+  }
+
+  if(g->fila == FILA_HEAP) {
+    return 1;
+  }
+
+  /* O passo ascendente da busca em largura segue os arcos que entram */
+  if(usa_largura(g)) {
+    f->fila = FILA_LARGURA;
+    f->passo = minimo;
+    return prepara_entrada(g);
+  }
+
+  if(maximo >= BALDES_DIAL || g->fila == FILA_RADIX) {
+    f->fila = FILA_RADIX;
+    return 1;
+  }
+
+  for(baldes = 1; baldes <= (unsigned long) maximo; baldes *= 2);
+
+  f->fila = FILA_DIAL;
+  f->mascara = baldes - 1;
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static void prepara_fila(struct heap *h, struct area_trabalho *a, long int *chave, const struct fila_busca *f) {
+  /* A fila de escolhe_fila sobre os vetores da área a */
+  h->n = 0;
+  h->vertices = a->heap;
+  h->posicao = a->posicao;
+  h->chave = chave;
+  h->fila = f->fila;
+  h->anterior = a->anterior;
+  h->baldes = a->baldes;
+  h->mascara = f->mascara;
+  h->potencial = f->potencial;
+  h->marcas = a->marcas;
+  h->passo = f->passo;
+  h->tarefas = 1;
+  h->regiao = NULL;
+  h->n_regiao = 0;
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA void balde_insere(struct heap *h, unsigned int v, unsigned int b) {
+  /* Põe v no início da lista do balde b */
+  h->anterior[v] = (unsigned int) -1;
+  h->vertices[v] = h->baldes[b];
+
+  if(h->baldes[b] != (unsigned int) -1) {
+    h->anterior[h->baldes[b]] = v;
+  }
+
+  h->baldes[b] = v;
+  h->posicao[v] = b;
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA void balde_retira(struct heap *h, unsigned int v) {
+  /* Tira v da lista do seu balde */
+  if(h->anterior[v] == (unsigned int) -1) {
+    h->baldes[h->posicao[v]] = h->vertices[v];
+  } else {
+    h->vertices[h->anterior[v]] = h->vertices[v];
+  }
+
+  if(h->vertices[v] != (unsigned int) -1) {
+    h->anterior[h->vertices[v]] = h->anterior[v];
+  }
+
+  h->posicao[v] = (unsigned int) -1;
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA void nucleo_dial(grafo g, unsigned int r, long int *distancia, unsigned int *pai, struct heap *h, const enum percurso modo) {
+  struct cursor c;
+  long int peso;
+  unsigned long examinadas = 0, fixados = 0, operacoes = 1;
+  unsigned int v, w, atual;
+
+  limpa_distancias(g, distancia, h);
+
+  /* Dijkstra com a fila de Dial: as distâncias na fila ficam entre a do
+     balde atual e ela mais o peso máximo, então cada balde guarda uma só
+     distância, e o balde atual só avança */
+  distancia[r] = 0;
+  balde_insere(h, r, 0);
+  h->n = 1;
+  atual = 0;
+
+  while(h->n > 0) {
+    while((v = h->baldes[atual]) == (unsigned int) -1) {
+      atual = (atual + 1) & h->mascara;
+    }
+
+    balde_retira(h, v);
+    --h->n;
+    ++fixados;
+
+    for(inicia_percurso(g, v, 0, modo, &c); proximo_percurso(&c, modo, &w, &peso); ++examinadas) {
+      if(distancia[v] + peso < distancia[w]) {
+        if(h->posicao[w] != (unsigned int) -1) {
+          balde_retira(h, w);
+        } else {
+          ++h->n;
+        }
+
+        distancia[w] = distancia[v] + peso;
+        balde_insere(h, w, (unsigned int) distancia[w] & h->mascara);
+
+        if(pai != NULL) {
+          pai[w] = v;
+        }
+
+        ++operacoes;
+      }
+    }
+  }
+
+  CONTA(g, arestas_examinadas, examinadas);
+  CONTA(g, vertices_fixados, fixados);
+  CONTA(g, operacoes_heap, operacoes + fixados);
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA unsigned int balde_radix(long int d, unsigned long ultima) {
+  /* Número de bits da diferença entre d e a última distância removida */
+  return ((unsigned long) d == ultima) ? 0 : (unsigned int) (8 * sizeof(unsigned long)) - (unsigned int) __builtin_clzl((unsigned long) d ^ ultima);
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA void nucleo_radix(grafo g, unsigned int r, long int *distancia, unsigned int *pai, struct heap *h, const int reduzido, const enum percurso modo) {
+  struct cursor c;
+  long int peso, menor;
+  unsigned long examinadas = 0, fixados = 0, operacoes = 1, ultima;
+  unsigned int i, b, u, v, w, seguinte;
+
+  limpa_distancias(g, distancia, h);
+
+  /* Dijkstra com o heap radix: o balde 0 guarda as distâncias iguais à
+     última removida; quando ele se esvazia, a menor distância do primeiro
+     balde não vazio passa a ser a última, e os vértices desse balde descem
+     para baldes menores. Com reduzido, distancia guarda durante a busca
+     as distâncias com os pesos reduzidos pelos potenciais de h */
+  distancia[r] = 0;
+  ultima = 0;
+  balde_insere(h, r, 0);
+  h->n = 1;
+
+  while(h->n > 0) {
+    if(h->baldes[0] == (unsigned int) -1) {
+      for(b = 1; h->baldes[b] == (unsigned int) -1; ++b);
+
+      for(u = h->baldes[b], menor = infinito; u != (unsigned int) -1; u = h->vertices[u]) {
+        if(distancia[u] < menor) {
+          menor = distancia[u];
+        }
+      }
+
+      ultima = (unsigned long) menor;
+
+      for(u = h->baldes[b], h->baldes[b] = (unsigned int) -1; u != (unsigned int) -1; u = seguinte) {
+        seguinte = h->vertices[u];
+        balde_insere(h, u, balde_radix(distancia[u], ultima));
+        ++operacoes;
+      }
+    }
+
+    v = h->baldes[0];
+    balde_retira(h, v);
+    --h->n;
+    ++fixados;
+
+    for(inicia_percurso(g, v, 0, modo, &c); proximo_percurso(&c, modo, &w, &peso); ++examinadas) {
+      if(reduzido) {
+        peso += h->potencial[v] - h->potencial[w];
+      }
+
+      if(distancia[v] + peso < distancia[w]) {
+        if(h->posicao[w] != (unsigned int) -1) {
+          balde_retira(h, w);
+        } else {
+          ++h->n;
+        }
+
+        distancia[w] = distancia[v] + peso;
+        balde_insere(h, w, balde_radix(distancia[w], ultima));
+
+        if(pai != NULL) {
+          pai[w] = v;
+        }
+
+        ++operacoes;
+      }
+    }
+  }
+
+  /* Desfaz a redução: a distância de r a w com os pesos originais é a
+     reduzida menos o potencial de r mais o de w */
+  if(reduzido) {
+    for(i = 0; i < ((h->regiao != NULL) ? h->n_regiao : g->n_vertices); ++i) {
+      if(distancia[u = (h->regiao != NULL) ? h->regiao[i] : i] != infinito) {
+        distancia[u] += h->potencial[u] - h->potencial[r];
+      }
+    }
+  }
+
+  CONTA(g, arestas_examinadas, examinadas);
+  CONTA(g, vertices_fixados, fixados);
+  CONTA(g, operacoes_heap, operacoes + fixados);
+}
+
+//------------------------------------------------------------------------------
+SEMPRE_EXPANDIDA void nucleo_topologico(grafo g, unsigned int r, long int *distancia, unsigned int *pai, const unsigned int *ordem, unsigned int n_ordem, int maximos, const enum percurso modo) {
+  struct cursor c;
+  long int peso;
+  unsigned long examinadas = 0, fixados = 0;
+  unsigned int i, t, v, w;
+
+  /* Caminhos mínimos (ou, com maximos, máximos) num grafo direcionado
+     acíclico: cada vértice de ordem, uma ordem topológica que contém os
+     alcançáveis a partir de r, é fixado depois de todos os que têm arco
+     para ele, e relaxa os arcos que saem dele uma única vez, o que vale
+     também com pesos negativos. Com r igual a -1, todos os vértices de
+     ordem são fontes, com distância 0 */
+  for(i = 0; i < n_ordem; ++i) {
+    distancia[ordem[i]] = infinito;
+  }
+
+  if(r != (unsigned int) -1) {
+    distancia[r] = 0;
+  } else {
+    for(i = 0; i < n_ordem; ++i) {
+      distancia[ordem[i]] = 0;
+
+      if(pai != NULL) {
+        pai[ordem[i]] = (unsigned int) -1;
+      }
+    }
+  }
+
+  for(t = 0; t < n_ordem; ++t) {
+    if(distancia[v = ordem[t]] == infinito) {
+      continue;
+    }
+
+    ++fixados;
+
+    for(inicia_percurso(g, v, 0, modo, &c); proximo_percurso(&c, modo, &w, &peso); ++examinadas) {
+      if(maximos ? (distancia[w] == infinito || distancia[v] + peso > distancia[w]) : (distancia[v] + peso < distancia[w])) {
+        distancia[w] = distancia[v] + peso;
+
+        if(pai != NULL) {
+          pai[w] = v;
+        }
+      }
+    }
+  }
+
+  CONTA(g, arestas_examinadas, examinadas);
+  CONTA(g, vertices_fixados, fixados);
+}
+
+//------------------------------------------------------------------------------
+static void caminhos_topologicos(grafo g, unsigned int r, long int *distancia, unsigned int *pai, const unsigned int *ordem, unsigned int n_ordem, int maximos) {
+  /* Sem ordem, todos os vértices na ordem da condensação, que já foi
+     calculada por aciclico e tem um vértice por componente */
+  if(ordem == NULL) {
+    ordem = condensacao(g)->membros;
+    n_ordem = g->n_vertices;
+  }
+
+  DESPACHA_PERCURSO(modo_percurso(g, 0, 1), nucleo_topologico, g, r, distancia, pai, ordem, n_ordem, maximos);
+}
+
+//------------------------------------------------------------------------------
+static void largura_fonte(grafo g, unsigned int r, long int *distancia, unsigned int *pai, struct heap *h) {
+  struct busca_largura b;
+
+  /* Com todos os pesos iguais a h->passo, os vértices são fixados na ordem
+     de uma busca em largura a partir de r */
+  limpa_distancias(g, distancia, h);
+  distancia[r] = 0;
+  h->vertices[0] = r;
+
+  b.g = g;
+  b.modo = modo_percurso(g, 0, 0);
+  b.sentido = LARGURA_SAIDA;
+  b.distancia = distancia;
+  b.pai = pai;
+  b.fila = h->vertices;
+  b.fronteira = h->marcas;
+  b.candidatos = h->regiao;
+  b.n_candidatos = (h->regiao != NULL) ? h->n_regiao : g->n_vertices;
+  b.nao_visitados = b.n_candidatos;
+  b.passo = h->passo;
+  busca_largura(&b, 1, h->tarefas);
+}
+
+//------------------------------------------------------------------------------
+static void dijkstra(grafo g, unsigned int r, long int *distancia, unsigned int *pai, struct heap *h) {
+  /* O núcleo da fila de h, instanciado com o modo de percurso de g */
+  switch(h->fila) {
+    case FILA_TOPOLOGICA:
+      caminhos_topologicos(g, r, distancia, pai, h->regiao, h->n_regiao, 0);
+      break;
+
+    case FILA_DIAL:
+      DESPACHA_PERCURSO(modo_percurso(g, 0, 1), nucleo_dial, g, r, distancia, pai, h);
+      break;
+
+    case FILA_RADIX:
+      DESPACHA_PERCURSO(modo_percurso(g, 0, 1), nucleo_radix, g, r, distancia, pai, h, 0);
+      break;
+
+    case FILA_JOHNSON:
+      DESPACHA_PERCURSO(modo_percurso(g, 0, 1), nucleo_radix, g, r, distancia, pai, h, 1);
+      break;
+
+    case FILA_LARGURA:
+      largura_fonte(g, r, distancia, pai, h);
+      break;
+
+    default:
+      DESPACHA_PERCURSO(modo_percurso(g, 0, 1), nucleo_dijkstra, g, r, distancia, pai, h);
+      break;
+  }
+}
+
+//------------------------------------------------------------------------------
+static size_t memoria_arborescencia(grafo g) {
+  /* A fila, uma área de trabalho e a arborescência: os vértices e um arco
+     por vértice alcançado */
+  return soma_memoria(soma_memoria(memoria_fila(g), memoria_areas(g, 1)), soma_memoria(memoria_vertices(g), memoria_listas(g->n_vertices, sizeof(struct aresta))));
+}
+
+//------------------------------------------------------------------------------
+static grafo _arborescencia_caminhos(grafo g, vertice r, int maximos) {
+  struct grafo *t;
+  struct area_trabalho *area;
+  struct aresta *a;
+  struct heap h;
+  struct fila_busca f;
+  unsigned int i, v;
+
+  /* Encontra o índice do vértice raiz r no grafo g */
+  if((v = indice_vertice(g, r)) == (unsigned int) -1) {
+    falha(ERRO_VERTICE);
+    return NULL;
+  }
+
+  if(!orcamento_operacao(g, OPERACAO_ARBORESCENCIA)) {
+    return NULL;
+  }
+
+  /* Os caminhos máximos só são definidos sem circuitos (a condensação diz
+     se há algum, a menos que falte memória para ela), e os mínimos sem
+     circuitos negativos */
+  if(maximos && !aciclico(g)) {
+    falha((g->direcionado && g->condensacao == NULL) ? ERRO_MEMORIA : ERRO_CIRCUITO);
+    return NULL;
+  }
+
+  if(!maximos && !escolhe_fila(g, &f)) {
+    return NULL;
+  }
+
+  /* Toma uma área de trabalho da reserva, para as distâncias, os pais e o
+     heap */
+  if((area = pega_area(g)) == NULL) {
+    if(!maximos) {
+      free(f.potencial);
+    }
+
+    return NULL;
+  }
+
+  /* Calcula as distâncias a partir de r e o pai de cada vértice alcançado
+     no caminho mínimo (ou máximo), seguindo os arcos que saem de cada
+     vértice, com a fila de prioridade adequada aos pesos de g */
+  if(maximos) {
+    caminhos_topologicos(g, v, area->distancia, area->pai, NULL, 0, 1);
+  } else {
+    /* Uma única busca: a busca em largura divide os níveis em threads */
+    prepara_fila(&h, area, area->distancia, &f);
+    h.tarefas = numero_threads();
+    dijkstra(g, v, area->distancia, area->pai, &h);
+    free(f.potencial);
+  }
+
+  /* Aloca a estrutura da arborescência e seus vértices */
+  inicializa_grafo(&t);
+
+  if(t != NULL) {
+    t->ponderado = g->ponderado;
+    t->direcionado = 1;
+
+    if((t->vertices = (struct vertice *) calloc(g->n_vertices + 1, sizeof(struct vertice))) == NULL) {
+      destroi_grafo(t);
+      t = NULL;
+    }
+  }
+
+  for(i = 0; t != NULL && i < g->n_vertices; ++i) {
+    t->n_vertices = i + 1;
+    t->vertices[i].nome = strdup(g->vertices[i].nome);
+    inicializa_lista(&t->vertices[i].arestas);
+
+    if(t->vertices[i].nome == NULL || t->vertices[i].arestas == NULL) {
+      destroi_grafo(t);
+      t = NULL;
+    }
+  }
+
+  /* Cada vértice alcançado, exceto a raiz, entra com o arco que vem do seu
+     pai, de peso igual à diferença entre as distâncias dos dois */
+  for(i = 0; t != NULL && i < g->n_vertices; ++i) {
+    if(i != v && area->distancia[i] != infinito) {
+      if((a = (struct aresta *) malloc(sizeof(struct aresta))) == NULL || !insere_cabeca_conteudo(t->vertices[area->pai[i]].arestas, a)) {
+        free(a);
+        destroi_grafo(t);
+        t = NULL;
+      } else {
+        a->origem = area->pai[i];
+        a->destino = i;
+        a->peso = area->distancia[i] - area->distancia[area->pai[i]];
+      }
+    }
+  }
+
+  if(t != NULL) {
+    t->capacidade = t->n_vertices;
+  }
+
+  devolve_area(g, area);
+  return t;
+}
+
+//------------------------------------------------------------------------------
+grafo arborescencia_caminhos_minimos(grafo g, vertice r) {
+  struct grafo *t;
+  struct medida m;
+
+  inicia_medida(&m);
+  erro_thread = ERRO_NENHUM;
+
+  if((t = _arborescencia_caminhos(g, r, 0)) == NULL) {
+    falha(ERRO_MEMORIA);
+  }
+
+  termina_medida(g, &m, FASE_CALCULO);
+  return t;
+}
+
+//------------------------------------------------------------------------------
+grafo arborescencia_caminhos_maximos(grafo g, vertice r) {
+  struct grafo *t;
+  struct medida m;
+
+  inicia_medida(&m);
+  erro_thread = ERRO_NENHUM;
+
+  if((t = _arborescencia_caminhos(g, r, 1)) == NULL) {
+    falha(ERRO_MEMORIA);
+  }
+
+  termina_medida(g, &m, FASE_CALCULO);
+  return t;
+}
+
+//------------------------------------------------------------------------------
+static lista _caminho_critico(grafo g, long int *comprimento) {
+  struct lista *l;
+  struct area_trabalho *area;
+  unsigned int v, w;
+
+  if(!aciclico(g) || (area = pega_area(g)) == NULL) {
+    return NULL;
+  }
+
+  /* O caminho mais longo que começa em qualquer vértice: todos partem com
+     distância 0, e o de maior distância ao fim é o último do caminho */
+  caminhos_topologicos(g, (unsigned int) -1, area->distancia, area->pai, NULL, 0, 1);
+
+  for(v = 0, w = 1; w < g->n_vertices; ++w) {
+    if(area->distancia[w] > area->distancia[v]) {
+      v = w;
+    }
+  }
+
+  if(comprimento != NULL) {
+    *comprimento = area->distancia[v];
+  }
+
+  /* Volta pelos pais do último vértice até o primeiro, que não tem pai,
+     inserindo cada um na cabeça da lista */
+  inicializa_lista(&l);
+
+  for(w = v; l != NULL && w != (unsigned int) -1; w = area->pai[w]) {
+    insere_cabeca_conteudo(l, g->vertices + w);
+  }
+
+  devolve_area(g, area);
+  return l;
+}
+
+//------------------------------------------------------------------------------
+lista caminho_critico(grafo g, long int *comprimento) {
+  struct lista *l;
+  struct medida m;
+
+  inicia_medida(&m);
+  l = _caminho_critico(g, comprimento);
+  termina_medida(g, &m, FASE_CALCULO);
+  return l;
+}
+
+//------------------------------------------------------------------------------
+static lista _circuito_negativo(grafo g) {
+  struct lista *l;
+  struct area_trabalho *area;
+  long int *potencial;
+  long int minimo, maximo;
+  unsigned int v, x;
+
+  /* Sem pesos negativos não há circuito negativo */
+  faixa_pesos(g, &minimo, &maximo);
+
+  if(minimo >= 0) {
+    return NULL;
+  }
+
+  potencial = (long int *) malloc(sizeof(long int) * (g->n_vertices + 1));
+
+  if(potencial == NULL || (area = pega_area(g)) == NULL) {
+    free(potencial);
+    return NULL;
+  }
+
+  /* O circuito dos pais achado pelos potenciais de Johnson é negativo;
+     voltando pelos pais a partir de um vértice dele e inserindo cada um na
+     cabeça da lista, os vértices ficam na ordem dos arcos */
+  l = NULL;
+
+  if(!potenciais_johnson(g, area, potencial, &x)) {
+    inicializa_lista(&l);
+
+    for(v = x; l != NULL; ) {
+      insere_cabeca_conteudo(l, g->vertices + v);
+
+      if((v = area->pai[v]) == x) {
+        break;
+      }
+    }
+  }
+
+  devolve_area(g, area);
+  free(potencial);
+  return l;
+}
+
+//------------------------------------------------------------------------------
+lista circuito_negativo(grafo g) {
+  struct lista *l;
+  struct medida m;
+
+  inicia_medida(&m);
+  l = _circuito_negativo(g);
+  termina_medida(g, &m, FASE_CALCULO);
+  return l;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t impressao_grafo(grafo g) {
+  struct cursor c;
+  long int peso;
+  unsigned int v, w;
+  uint64_t impressao, x;
+
+  /* Soma de um hash de cada arco, que não depende da ordem dos arcos nas
+     listas nem da representação de g */
+  impressao = ((uint64_t) g->n_vertices << 1) | (uint64_t) (g->direcionado != 0);
+
+  for(v = 0; v < g->n_vertices; ++v) {
+    for(inicia_cursor(g, v, 0, &c); proximo_arco(&c, &w, &peso); ) {
+      x = (((uint64_t) v << 32) | w) + (uint64_t) peso * 0x9e3779b97f4a7c15ULL;
+      x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+      impressao += x ^ (x >> 31);
+    }
+  }
+
+  return impressao;
+}
+
+//------------------------------------------------------------------------------
+static int interrompe(struct controle *c) {
+  if(c == NULL || (!__atomic_load_n(&c->cancelado, __ATOMIC_ACQUIRE) && (c->prazo == 0 || relogio() < c->prazo))) {
+    return 0;
+  }
+
+  __atomic_store_n(&c->interrompido, 1, __ATOMIC_RELAXED);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static int le_registro_esparso(FILE *arquivo, unsigned int n_vertices, long int *linha_lida, unsigned int *regiao_lida, unsigned int *n_regiao) {
+  unsigned int i;
+
+  /* Um registro de linha esparsa: o número de vértices alcançados, os
+     seus índices e as suas distâncias */
+  if(fread(n_regiao, sizeof(unsigned int), 1, arquivo) != 1 || *n_regiao > n_vertices ||
+     fread(regiao_lida, sizeof(unsigned int), *n_regiao, arquivo) != *n_regiao) {
+    return 0;
+  }
+
+  for(i = 0; i < *n_regiao; ++i) {
+    if(regiao_lida[i] >= n_vertices || fread(linha_lida + regiao_lida[i], sizeof(long int), 1, arquivo) != 1) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static FILE *abre_retomada(grafo g, int tipo, long int *tabela, long int *linha_lida, unsigned int *regiao_lida, unsigned char *feita, unsigned int *feitas, void linha(void *dados, unsigned int fonte, long int *registro, const unsigned int *regiao, unsigned int n_regiao), void *dados) {
+  struct cabecalho_retomada cabecalho, lido;
+  FILE *arquivo;
+  long int *registro;
+  long int maximo;
+  size_t largura;
+  off_t valido;
+  unsigned int fonte, n_regiao;
+
+  memset(&cabecalho, 0, sizeof(struct cabecalho_retomada));
+  memcpy(cabecalho.marca, "GRAFORET", 8);
+  cabecalho.tipo = (uint32_t) tipo;
+  cabecalho.n_vertices = g->n_vertices;
+  cabecalho.impressao = impressao_grafo(g);
+  largura = (tipo == RETOMADA_MAXIMOS) ? 1 : g->n_vertices;
+
+  /* Um arquivo de outra chamada, de outro grafo ou ilegível é refeito */
+  if((arquivo = fopen(g->controle->arquivo, "r+b")) != NULL &&
+     (fread(&lido, sizeof(struct cabecalho_retomada), 1, arquivo) != 1 || memcmp(&lido, &cabecalho, sizeof(struct cabecalho_retomada)) != 0)) {
+    fclose(arquivo);
+    arquivo = NULL;
+  }
+
+  if(arquivo == NULL) {
+    if((arquivo = fopen(g->controle->arquivo, "w+b")) != NULL && fwrite(&cabecalho, sizeof(struct cabecalho_retomada), 1, arquivo) != 1) {
+      fclose(arquivo);
+      arquivo = NULL;
+    }
+
+    return arquivo;
+  }
+
+  /* Retoma as linhas já gravadas; um registro incompleto no fim, de uma
+     gravação interrompida, é descartado para que os próximos o sucedam */
+  valido = (off_t) sizeof(struct cabecalho_retomada);
+
+  while(fread(&fonte, sizeof(unsigned int), 1, arquivo) == 1 && fonte < g->n_vertices) {
+    if(tipo == RETOMADA_ESPARSA) {
+      registro = linha_lida;
+
+      if(!le_registro_esparso(arquivo, g->n_vertices, linha_lida, regiao_lida, &n_regiao)) {
+        break;
+      }
+
+      valido += (off_t) (2 * sizeof(unsigned int) + (sizeof(unsigned int) + sizeof(long int)) * n_regiao);
+    } else {
+      registro = (tipo == RETOMADA_MAXIMOS) ? &maximo : tabela + (size_t) fonte * g->n_vertices;
+
+      if(fread(registro, sizeof(long int), largura, arquivo) != largura) {
+        break;
+      }
+
+      valido += (off_t) (sizeof(unsigned int) + sizeof(long int) * largura);
+    }
+
+    if(!feita[fonte]) {
+      feita[fonte] = 1;
+      ++*feitas;
+
+      if(linha != NULL) {
+        linha(dados, fonte, registro, (tipo == RETOMADA_ESPARSA) ? regiao_lida : NULL, (tipo == RETOMADA_ESPARSA) ? n_regiao : 0);
+      }
+    }
+  }
+
+  if(fflush(arquivo) != 0 || ftruncate(fileno(arquivo), valido) != 0 || fseeko(arquivo, valido, SEEK_SET) != 0) {
+    fclose(arquivo);
+    return NULL;
+  }
+
+  return arquivo;
+}
+
+//------------------------------------------------------------------------------
+static int grava_registro(FILE *arquivo, int tipo, unsigned int fonte, long int *registro, const unsigned int *regiao, unsigned int n_regiao, size_t largura) {
+  unsigned int i;
+
+  /* O registro da linha de fonte, no formato de abre_retomada */
+  if(fwrite(&fonte, sizeof(unsigned int), 1, arquivo) != 1) {
+    return 0;
+  }
+
+  if(tipo != RETOMADA_ESPARSA) {
+    return fwrite(registro, sizeof(long int), largura, arquivo) == largura;
+  }
+
+  if(fwrite(&n_regiao, sizeof(unsigned int), 1, arquivo) != 1 || fwrite(regiao, sizeof(unsigned int), n_regiao, arquivo) != n_regiao) {
+    return 0;
+  }
+
+  for(i = 0; i < n_regiao; ++i) {
+    if(fwrite(registro + regiao[i], sizeof(long int), 1, arquivo) != 1) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static int compara_componentes(const void *a, const void *b) {
+  const unsigned int *x, *y;
+
+  /* Pares (tamanho, componente): maiores primeiro, depois pelo número */
+  x = (const unsigned int *) a;
+  y = (const unsigned int *) b;
+
+  if(x[0] != y[0]) {
+    return (x[0] > y[0]) ? -1 : 1;
+  }
+
+  return (x[1] < y[1]) ? -1 : (x[1] > y[1]);
+}
+
+//------------------------------------------------------------------------------
+static int compara_indices(const void *a, const void *b) {
+  unsigned int x, y;
+
+  x = *(const unsigned int *) a;
+  y = *(const unsigned int *) b;
+  return (x < y) ? -1 : (x > y);
+}
+
+//------------------------------------------------------------------------------
+static unsigned int *ordem_componentes(grafo g, struct condensacao *k, int por_vertice) {
+  unsigned int *pares, *ordem;
+  unsigned int i, j, n;
+
+  /* Os vértices agrupados por componente fortemente conexo (conexo, sem
+     direção), os componentes do maior para o menor, para que as buscas
+     mais longas comecem primeiro e as menores equilibrem o fim; com
+     por_vertice, os vértices na ordem de g */
+  if(por_vertice) {
+    if((ordem = (unsigned int *) malloc(sizeof(unsigned int) * (g->n_vertices + 1))) != NULL) {
+      for(i = 0; i < g->n_vertices; ++i) {
+        ordem[i] = i;
+      }
+    }
+
+    return ordem;
+  }
+
+  pares = (unsigned int *) malloc(sizeof(unsigned int) * 2 * (k->n_componentes + 1));
+  ordem = (unsigned int *) malloc(sizeof(unsigned int) * (g->n_vertices + 1));
+
+  if(pares == NULL || ordem == NULL) {
+    free(pares);
+    free(ordem);
+    return NULL;
+  }
+
+  for(i = 0; i < k->n_componentes; ++i) {
+    pares[2 * i] = k->inicio_membros[i + 1] - k->inicio_membros[i];
+    pares[2 * i + 1] = i;
+  }
+
+  qsort(pares, k->n_componentes, 2 * sizeof(unsigned int), compara_componentes);
+
+  for(i = 0, n = 0; i < k->n_componentes; ++i) {
+    for(j = k->inicio_membros[pares[2 * i + 1]]; j < k->inicio_membros[pares[2 * i + 1] + 1]; ++j) {
+      ordem[n++] = k->membros[j];
+    }
+  }
+
+  free(pares);
+  return ordem;
+}
+
+//------------------------------------------------------------------------------
+static unsigned int regiao_componente(struct condensacao *k, unsigned int c, unsigned int *visto, unsigned int marca, unsigned int *componentes, unsigned int *regiao, int ordenada) {
+  unsigned int i, j, n, n_regiao;
+
+  /* Os componentes alcançáveis a partir de c no DAG da condensação, por
+     uma busca em largura que marca com marca os já vistos; os vértices
+     deles são os alcançáveis a partir de cada vértice de c. Ordenados, os
+     componentes ficam em ordem topológica */
+  componentes[0] = c;
+  visto[c] = marca;
+
+  for(i = 0, n = 1; i < n; ++i) {
+    for(j = k->inicio_sucessores[componentes[i]]; j < k->inicio_sucessores[componentes[i] + 1]; ++j) {
+      if(visto[k->sucessores[j]] != marca) {
+        visto[k->sucessores[j]] = marca;
+        componentes[n++] = k->sucessores[j];
+      }
+    }
+  }
+
+  if(ordenada) {
+    qsort(componentes, n, sizeof(unsigned int), compara_indices);
+  }
+
+  for(i = 0, n_regiao = 0; i < n; ++i) {
+    for(j = k->inicio_membros[componentes[i]]; j < k->inicio_membros[componentes[i] + 1]; ++j) {
+      regiao[n_regiao++] = k->membros[j];
+    }
+  }
+
+  return n_regiao;
+}
+
+struct tarefa_linhas {
+  grafo g;
+  struct controle *c;
+  struct condensacao *k;
+  unsigned int *ordem;
+  int tipo;
+  long int *tabela;
+  void (*linha)(void *dados, unsigned int fonte, long int *registro, const unsigned int *regiao, unsigned int n_regiao);
+  void *dados;
+  const struct fila_busca *fila;
+  unsigned char *feita;
+  FILE *arquivo;
+  size_t largura;
+  pthread_mutex_t trava;
+  unsigned long gravacao;
+  struct esteira *esteira;
+  unsigned int proxima;
+  unsigned int feitas;
+  int sucesso;
+};
+
+//------------------------------------------------------------------------------
+// esteira de percorre_distancias: fila circular limitada, sem travas, que
+// leva as linhas dos threads de busca a quem as consome, na ordem das fontes
+
+/* Vaga da esteira: os destinos de uma linha em ordem crescente, com suas
+   distâncias. O estado é 2j enquanto a vaga espera a linha j (a de índice
+   j na ordem das fontes) e 2j + 1 quando ela está lá; consumida, a vaga
+   passa a esperar a linha j + n_vagas */
+struct vaga_esteira {
+  unsigned long estado;
+  unsigned int fonte;
+  unsigned int n;
+  unsigned int capacidade;
+  unsigned int *destinos;
+  long int *distancias;
+};
+
+/* A esteira em si: quem escoa as linhas prontas é o thread que pega a vez
+   em escrevendo, seja o que acabou de entregar uma linha ou o que espera
+   uma vaga; escrita é a próxima linha a consumir */
+struct esteira {
+  struct vaga_esteira *vagas;
+  unsigned int n_vagas;
+  unsigned int escrita;
+  int escrevendo;
+  FILE *saida;
+  struct resumo_distancias *resumo;
+  unsigned int n_redutores;
+  struct redutor_distancias *redutores;
+  struct vertice **vizinhos;
+};
+
+//------------------------------------------------------------------------------
+static void resume_linha(struct resumo_distancias *r, unsigned int fonte, unsigned int n, const long int *distancias) {
+  long int maximo, d;
+  unsigned int i, k;
+
+  /* As faixas do histograma dobram de largura, somadas duas a duas, até
+     que a maior distância caiba na última */
+  for(i = 0, maximo = 0; i < n; ++i) {
+    d = distancias[i];
+    maximo = (d > maximo) ? d : maximo;
+
+    while(d / r->largura_faixa >= FAIXAS_DISTANCIAS) {
+      for(k = 0; k < FAIXAS_DISTANCIAS / 2; ++k) {
+        r->histograma[k] = r->histograma[2 * k] + r->histograma[2 * k + 1];
+      }
+
+      memset(r->histograma + FAIXAS_DISTANCIAS / 2, 0, sizeof(unsigned long) * (FAIXAS_DISTANCIAS / 2));
+      r->largura_faixa *= 2;
+    }
+
+    ++r->histograma[(d > 0) ? d / r->largura_faixa : 0];
+  }
+
+  r->pares += n;
+  r->diametro = (maximo > r->diametro) ? maximo : r->diametro;
+
+  if(r->excentricidade != NULL) {
+    r->excentricidade[fonte] = maximo;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void consome_linha(struct tarefa_linhas *t, struct vaga_esteira *v) {
+  struct esteira *e;
+  unsigned int i;
+
+  e = t->esteira;
+
+  /* A linha vai para a saída no formato de escreve_vertices (num grafo
+     não direcionado, cada aresta a partir da ponta de menor índice), para
+     o resumo e para os redutores */
+  if(e->saida != NULL) {
+    for(i = 0; i < v->n; ++i) {
+      if(t->g->direcionado || v->fonte < v->destinos[i]) {
+        fprintf(e->saida, "    \"%s\" -%c \"%s\" [peso=%ld]\n", t->g->vertices[v->fonte].nome, t->g->direcionado ? '>' : '-',
+                t->g->vertices[v->destinos[i]].nome, v->distancias[i]);
+      }
+    }
+  }
+
+  if(e->resumo != NULL) {
+    resume_linha(e->resumo, v->fonte, v->n, v->distancias);
+  }
+
+  if(e->n_redutores > 0) {
+    for(i = 0; i < v->n; ++i) {
+      e->vizinhos[i] = t->g->vertices + v->destinos[i];
+    }
+
+    for(i = 0; i < e->n_redutores; ++i) {
+      e->redutores[i].linha(e->redutores[i].dados, t->g->vertices + v->fonte, v->n, e->vizinhos, v->distancias);
+    }
+  }
+
+  informa_progresso(t->g, ++t->feitas, t->g->n_vertices);
+}
+
+//------------------------------------------------------------------------------
+static int linha_pronta(struct esteira *e, unsigned int n_vertices) {
+  unsigned int j;
+
+  j = __atomic_load_n(&e->escrita, __ATOMIC_SEQ_CST);
+  return j < n_vertices && __atomic_load_n(&e->vagas[j % e->n_vagas].estado, __ATOMIC_SEQ_CST) == 2 * (unsigned long) j + 1;
+}
+
+//------------------------------------------------------------------------------
+static void escoa_esteira(struct tarefa_linhas *t) {
+  struct esteira *e;
+  struct vaga_esteira *v;
+  unsigned int j;
+
+  e = t->esteira;
+
+  /* Consome, em ordem, as linhas já entregues, se nenhum outro thread
+     está com a vez. Quem devolve a vez olha de novo a próxima linha: se
+     ela foi entregue enquanto a vez estava tomada, ninguém mais a viu */
+  do {
+    if(__atomic_exchange_n(&e->escrevendo, 1, __ATOMIC_SEQ_CST)) {
+      return;
+    }
+
+    while(__atomic_load_n(&t->sucesso, __ATOMIC_RELAXED) && linha_pronta(e, t->g->n_vertices)) {
+      j = e->escrita;
+      v = e->vagas + j % e->n_vagas;
+      consome_linha(t, v);
+      __atomic_store_n(&e->escrita, j + 1, __ATOMIC_SEQ_CST);
+      __atomic_store_n(&v->estado, 2 * ((unsigned long) j + e->n_vagas), __ATOMIC_RELEASE);
+    }
+
+    __atomic_store_n(&e->escrevendo, 0, __ATOMIC_SEQ_CST);
+  } while(__atomic_load_n(&t->sucesso, __ATOMIC_RELAXED) && linha_pronta(e, t->g->n_vertices));
+}
+
+//------------------------------------------------------------------------------
+static void entrega_linha(struct tarefa_linhas *t, unsigned int j, unsigned int fonte, const long int *d, const unsigned int *regiao, unsigned int n_regiao) {
+  struct esteira *e;
+  struct vaga_esteira *v;
+  unsigned int i, n;
+
+  e = t->esteira;
+  v = e->vagas + j % e->n_vagas;
+
+  /* Espera a vaga da linha j ser liberada, escoando a esteira enquanto
+     isso: ela só está ocupada pela linha j - n_vagas, já tomada por algum
+     thread */
+  while(__atomic_load_n(&v->estado, __ATOMIC_ACQUIRE) != 2 * (unsigned long) j) {
+    if(!__atomic_load_n(&t->sucesso, __ATOMIC_RELAXED)) {
+      return;
+    }
+
+    escoa_esteira(t);
+
+    if(__atomic_load_n(&v->estado, __ATOMIC_ACQUIRE) != 2 * (unsigned long) j) {
+      sched_yield();
+    }
+  }
+
+  /* Os vértices alcançáveis da região, exceto a fonte, em ordem */
+  if(v->capacidade < n_regiao) {
+    free(v->destinos);
+    free(v->distancias);
+    v->destinos = (unsigned int *) malloc(sizeof(unsigned int) * n_regiao);
+    v->distancias = (long int *) malloc(sizeof(long int) * n_regiao);
+    v->capacidade = (v->destinos != NULL && v->distancias != NULL) ? n_regiao : 0;
+
+    if(v->capacidade == 0) {
+      __atomic_store_n(&t->sucesso, 0, __ATOMIC_RELAXED);
+      return;
+    }
+  }
+
+  for(i = 0, n = 0; i < n_regiao; ++i) {
+    if(regiao[i] != fonte && d[regiao[i]] != infinito) {
+      v->destinos[n++] = regiao[i];
+    }
+  }
+
+  qsort(v->destinos, n, sizeof(unsigned int), compara_indices);
+
+  for(i = 0; i < n; ++i) {
+    v->distancias[i] = d[v->destinos[i]];
+  }
+
+  v->fonte = fonte;
+  v->n = n;
+  __atomic_store_n(&v->estado, 2 * (unsigned long) j + 1, __ATOMIC_SEQ_CST);
+  escoa_esteira(t);
+}
+
+//------------------------------------------------------------------------------
+static void *_linhas_fontes(void *p) {
+  struct tarefa_linhas *t;
+  struct area_trabalho *area;
+  struct heap h;
+  long int *d, *registro;
+  long int maximo;
+  unsigned int i, j, w, atual, marca, limite;
+
+  t = (struct tarefa_linhas *) p;
+
+  if((area = pega_area(t->g)) == NULL) {
+    __atomic_store_n(&t->sucesso, 0, __ATOMIC_RELAXED);
+    return NULL;
+  }
+
+  prepara_fila(&h, area, area->distancia, t->fila);
+
+  for(i = 0; i < t->k->n_componentes; ++i) {
+    area->rotulo[i] = 0;
+  }
+
+  /* Cada thread toma a próxima fonte ainda não feita, na ordem dos
+     componentes, busca com a sua área e entrega a linha sob a trava, que
+     protege linha, o progresso e o arquivo de retomada. Sem tabela, as
+     buscas se limitam à região alcançável a partir do componente da
+     fonte, calculada quando o thread passa a um novo componente */
+  atual = (unsigned int) -1;
+  marca = 0;
+
+  while(__atomic_load_n(&t->sucesso, __ATOMIC_RELAXED) && (j = __atomic_fetch_add(&t->proxima, 1, __ATOMIC_RELAXED)) < t->g->n_vertices) {
+    if(t->feita[i = t->ordem[j]]) {
+      continue;
+    }
+
+    if(interrompe(t->c)) {
+      __atomic_store_n(&t->sucesso, 0, __ATOMIC_RELAXED);
+      break;
+    }
+
+    if(t->tabela == NULL && t->k->componente[i] != atual) {
+      atual = t->k->componente[i];
+      h.n_regiao = regiao_componente(t->k, atual, area->rotulo, ++marca, area->pai, area->membros, t->fila->fila == FILA_TOPOLOGICA);
+      h.regiao = area->membros;
+    }
+
+    d = (t->tabela != NULL) ? t->tabela + (size_t) i * t->g->n_vertices : area->distancia;
+    h.chave = d;
+    dijkstra(t->g, i, d, NULL, &h);
+    registro = d;
+
+    if(t->tipo == RETOMADA_MAXIMOS) {
+      limite = (h.regiao != NULL) ? h.n_regiao : t->g->n_vertices;
+
+      for(j = 0, maximo = 0; j < limite; ++j) {
+        w = (h.regiao != NULL) ? h.regiao[j] : j;
+
+        if(d[w] != infinito && d[w] > maximo) {
+          maximo = d[w];
+        }
+      }
+
+      registro = &maximo;
+    }
+
+    /* Na esteira, a linha é entregue na vaga da sua ordem, sem a trava */
+    if(t->esteira != NULL) {
+      entrega_linha(t, j, i, d, h.regiao, h.n_regiao);
+      continue;
+    }
+
+    pthread_mutex_lock(&t->trava);
+
+    if(t->linha != NULL) {
+      t->linha(t->dados, i, registro, h.regiao, h.n_regiao);
+    }
+
+    informa_progresso(t->g, ++t->feitas, t->g->n_vertices);
+
+    /* As linhas vão para o arquivo a cada busca, e são forçadas ao disco
+       a cada intervalo do controle */
+    if(t->arquivo != NULL) {
+      if(!grava_registro(t->arquivo, t->tipo, i, registro, h.regiao, h.n_regiao, t->largura)) {
+        __atomic_store_n(&t->sucesso, 0, __ATOMIC_RELAXED);
+      } else if(relogio() - t->gravacao >= t->c->intervalo) {
+        if(fflush(t->arquivo) != 0) {
+          __atomic_store_n(&t->sucesso, 0, __ATOMIC_RELAXED);
+        }
+
+        fsync(fileno(t->arquivo));
+        t->gravacao = relogio();
+      }
+    }
+
+    pthread_mutex_unlock(&t->trava);
+  }
+
+  devolve_area(t->g, area);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static size_t memoria_linhas(grafo g, size_t reservada, unsigned int *n_tarefas) {
+  size_t base;
+  unsigned int n;
+
+  /* As buscas de linhas_distancias, além dos reservada bytes do
+     resultado: a fila, as fontes feitas, a ordem dos componentes e uma
+     área de trabalho por thread. Os threads são reduzidos até que as
+     áreas de todos caibam no orçamento (com um só, pode não caber) */
+  base = bloco(g->n_vertices + 1, 1) + bloco(g->n_vertices + 1, sizeof(unsigned int)) + bloco(2 * (g->n_vertices + 1), sizeof(unsigned int));
+  base = soma_memoria(reservada, soma_memoria(base, memoria_fila(g)));
+  n = numero_threads();
+  n = (n < g->n_vertices) ? n : (g->n_vertices > 0) ? g->n_vertices : 1;
+
+  for(; n > 1 && !cabe_orcamento(soma_memoria(base, memoria_areas(g, n))); --n);
+
+  *n_tarefas = n;
+  return soma_memoria(base, memoria_areas(g, n));
+}
+
+//------------------------------------------------------------------------------
+static int linhas_distancias(grafo g, int so_maximo, long int *tabela, void linha(void *dados, unsigned int fonte, long int *registro, const unsigned int *regiao, unsigned int n_regiao), void *dados, struct esteira *esteira, size_t reservada) {
+  struct tarefa_linhas t;
+  struct area_trabalho *area;
+  struct fila_busca fila;
+  unsigned int n_tarefas, maximo_tarefas;
+
+  /* Uma busca de Dijkstra a partir de cada vértice, divididas entre os
+     threads; a linha de distâncias de cada fonte vai para tabela (se não é
+     NULL) e é passada a linha, inteira ou, com so_maximo, apenas a maior
+     distância finita dela. Sem tabela a linha só vale nos vértices da
+     região passada com ela, os alcançáveis a partir da fonte; os demais,
+     a distância infinita, não são escritos. Com um controle em g as buscas
+     param no prazo ou no cancelamento, e as linhas concluídas são
+     gravadas no arquivo de retomada, de onde uma chamada seguinte as lê
+     em vez de refazê-las. Com pesos negativos as buscas usam os
+     potenciais de Johnson, e se g tem circuito negativo não há distâncias.
+     Com um orçamento de memória, que já tem reservada bytes comprometidos
+     pelo chamador, as buscas usam só os threads cujas áreas cabem nele.
+     Com esteira, as linhas passam por ela em vez de ir a linha, e não há
+     retomada */
+  if(!cabe_orcamento(memoria_linhas(g, reservada, &maximo_tarefas))) {
+    falha(ERRO_ORCAMENTO);
+    return 0;
+  }
+
+  t.g = g;
+  t.c = g->controle;
+  t.tipo = so_maximo ? RETOMADA_MAXIMOS : (tabela != NULL) ? RETOMADA_LINHAS : RETOMADA_ESPARSA;
+  t.tabela = tabela;
+  t.linha = linha;
+  t.dados = dados;
+  t.esteira = esteira;
+  t.fila = &fila;
+  t.arquivo = NULL;
+  t.largura = so_maximo ? 1 : g->n_vertices;
+  t.proxima = 0;
+  t.feitas = 0;
+  t.sucesso = 1;
+
+  /* As fontes são agrupadas pelos componentes da condensação, que limitam
+     as regiões alcançáveis; a esteira consome as linhas na ordem em que
+     as fontes são tomadas, que para ela é a dos vértices de g */
+  if(!escolhe_fila(g, &fila)) {
+    return 0;
+  }
+
+  t.feita = (unsigned char *) calloc(g->n_vertices + 1, sizeof(unsigned char));
+  t.ordem = ((t.k = condensacao(g)) != NULL) ? ordem_componentes(g, t.k, esteira != NULL) : NULL;
+
+  if(t.feita == NULL || t.ordem == NULL || (area = pega_area(g)) == NULL) {
+    free(t.feita);
+    free(t.ordem);
+    free(fila.potencial);
+    return 0;
+  }
+
+  if(t.c != NULL) {
+    __atomic_store_n(&t.c->interrompido, 0, __ATOMIC_RELAXED);
+
+    if(t.c->arquivo != NULL && esteira == NULL && (t.arquivo = abre_retomada(g, t.tipo, tabela, area->distancia, area->membros, t.feita, &t.feitas, linha, dados)) == NULL) {
+      t.sucesso = 0;
+    }
+  }
+
+  devolve_area(g, area);
+
+  if(t.sucesso) {
+    n_tarefas = (maximo_tarefas < g->n_vertices - t.feitas) ? maximo_tarefas : g->n_vertices - t.feitas;
+    n_tarefas = (n_tarefas > 0) ? n_tarefas : 1;
+    t.gravacao = relogio();
+    pthread_mutex_init(&t.trava, NULL);
+    executa_paralelo(_linhas_fontes, &t, 0, n_tarefas);
+    pthread_mutex_destroy(&t.trava);
+
+    if(t.c != NULL && __atomic_load_n(&t.c->interrompido, __ATOMIC_RELAXED)) {
+      falha(ERRO_INTERROMPIDO);
+    }
+  }
+
+  /* Concluídas todas as linhas, o arquivo de retomada não serve mais */
+  if(t.arquivo != NULL) {
+    if(fclose(t.arquivo) == 0 && t.sucesso) {
+      unlink(t.c->arquivo);
+    }
+  }
+
+  free(t.feita);
+  free(t.ordem);
+  free(fila.potencial);
+  return t.sucesso;
+}
+
+//------------------------------------------------------------------------------
+// grafo de distâncias em listas ou, quando elas não cabem no orçamento de
+// memória, na representação compacta
+
+/* Linha de distâncias de uma fonte codificada como as listas da
+   representação compacta (codifica_adjacencia), com os pesos ainda em 64
+   bits: a largura final só é conhecida com todas as linhas */
+struct linha_compacta {
+  unsigned char *dados;
+  int64_t *pesos;
+  size_t tamanho;
+  unsigned int grau;
+};
+
+/* Grafo de distâncias em montagem (insere_linha_distancias): os arcos vão
+   para as listas de dis ou, com linhas, para as linhas compactas,
+   ordenados em destinos; falhou diz se faltou memória para alguma linha */
+struct montagem_distancias {
+  struct grafo *dis;
+  struct linha_compacta *linhas;
+  unsigned int *destinos;
+  int falhou;
+};
+
+//------------------------------------------------------------------------------
+static size_t pares_alcancaveis(grafo g) {
+  struct condensacao *c;
+  size_t pares, tamanho;
+  unsigned int i;
+
+  /* Um limite para os pares (u, v), u != v, com v alcançável a partir de
+     u: com a condensação calculada, os membros de um componente só
+     alcançam os dos componentes de número igual ou maior (num grafo não
+     direcionado, só os do seu); sem ela, todos os pares */
+  if((c = __atomic_load_n(&g->condensacao, __ATOMIC_ACQUIRE)) == NULL) {
+    return (g->n_vertices > 0) ? (size_t) g->n_vertices * (g->n_vertices - 1) : 0;
+  }
+
+  for(i = 0, pares = 0; i < c->n_componentes; ++i) {
+    tamanho = c->inicio_membros[i + 1] - c->inicio_membros[i];
+    pares += tamanho * ((g->direcionado ? g->n_vertices - c->inicio_membros[i] : tamanho) - 1);
+  }
+
+  return pares;
+}
+
+//------------------------------------------------------------------------------
+static size_t memoria_distancias(grafo g, int compacta) {
+  size_t pares, dados, total;
+
+  /* O grafo de distâncias: os vértices e um arco por par alcançável, nas
+     listas ou na representação compacta. Nesta, as linhas codificadas
+     (com os pesos em 64 bits), a saída montada a partir delas e, num
+     grafo direcionado, as origens dos arcos que entram e a entrada
+     codificada, com os dados sempre no tamanho máximo */
+  pares = pares_alcancaveis(g);
+  total = memoria_vertices(g);
+
+  if(!compacta) {
+    return soma_memoria(total, soma_memoria(memoria_listas(pares, sizeof(struct aresta)), bloco(g->n_vertices + 1, sizeof(unsigned int))));
+  }
+
+  dados = soma_memoria(bloco(pares, 4), pares / 4 + g->n_vertices + 16);
+  total = soma_memoria(total, bloco(1, sizeof(struct compacto)) + bloco(g->n_vertices + 1, sizeof(struct linha_compacta)) +
+                              bloco(g->n_vertices + 1, sizeof(unsigned int)) + 4 * bloco(g->n_vertices + 1, sizeof(size_t)));
+  total = soma_memoria(total, soma_memoria(soma_memoria(dados, bloco(pares, sizeof(int64_t))), bloco(g->n_vertices, 2 * SOBRECARGA_MALLOC)));
+  total = soma_memoria(total, soma_memoria(dados, bloco(pares + 1, sizeof(int64_t))));
+
+  if(g->direcionado) {
+    total = soma_memoria(total, soma_memoria(dados, bloco(pares + 1, sizeof(unsigned int))));
+  }
+
+  return total;
+}
+
+//------------------------------------------------------------------------------
+static void insere_linha_distancias(void *dados, unsigned int fonte, long int *d, const unsigned int *regiao, unsigned int n_regiao) {
+  struct montagem_distancias *m;
+  struct linha_compacta *l;
+  struct aresta *a;
+  unsigned char *fim;
+  unsigned int i, k, grau;
+
+  m = (struct montagem_distancias *) dados;
+
+  /* Um arco de fonte para cada outro vértice da região, todos alcançáveis
+     a partir dela, com os destinos em ordem crescente nas duas
+     representações (a de percorre_distancias); os pares sem caminho não
+     têm arco. Depois de uma falta de memória as linhas seguintes são
+     descartadas */
+  if(m->falhou) {
+    return;
+  }
+
+  for(i = 0, grau = 0; i < n_regiao; ++i) {
+    if(regiao[i] != fonte && d[regiao[i]] != infinito) {
+      m->destinos[grau++] = regiao[i];
+    }
+  }
+
+  qsort(m->destinos, grau, sizeof(unsigned int), compara_indices);
+
+  /* Nas listas, os arcos entram na cabeça do maior destino ao menor */
+  if(m->linhas == NULL) {
+    for(k = grau; k > 0; --k) {
+      if((a = (struct aresta *) malloc(sizeof(struct aresta))) == NULL || !insere_cabeca_conteudo(m->dis->vertices[fonte].arestas, a)) {
+        free(a);
+        m->falhou = 1;
+        return;
+      }
+
+      a->origem = fonte;
+      a->destino = m->destinos[k - 1];
+      a->peso = d[m->destinos[k - 1]];
+    }
+
+    return;
+  }
+
+  /* Na representação compacta, os destinos codificados pelas diferenças */
+  l = m->linhas + fonte;
+  l->dados = (unsigned char *) malloc((grau + 3) / 4 + 4 * (size_t) grau + 1);
+  l->pesos = (int64_t *) malloc(sizeof(int64_t) * (grau + 1));
+
+  if(l->dados == NULL || l->pesos == NULL) {
+    m->falhou = 1;
+    return;
+  }
+
+  memset(l->dados, 0, (grau + 3) / 4);
+  fim = l->dados + (grau + 3) / 4;
+
+  for(k = 0; k < grau; ++k) {
+    fim = codifica_valor(l->dados, k, m->destinos[k] - ((k > 0) ? m->destinos[k - 1] : 0), fim);
+    l->pesos[k] = d[m->destinos[k]];
+  }
+
+  l->tamanho = (size_t) (fim - l->dados);
+  l->grau = grau;
+}
+
+//------------------------------------------------------------------------------
+static int codifica_entrada_distancias(struct grafo *dis, struct adjacencia_compacta *a) {
+  struct cursor cursor;
+  unsigned int *origens;
+  unsigned char *controle, *d;
+  size_t capacidade, tamanho, e;
+  long int peso;
+  unsigned int v, w, k, grau;
+
+  a->primeira = (size_t *) calloc(dis->n_vertices + 1, sizeof(size_t));
+  a->inicio = (size_t *) malloc(sizeof(size_t) * (dis->n_vertices + 1));
+  origens = (unsigned int *) malloc(sizeof(unsigned int) * (dis->compacto->saida.primeira[dis->n_vertices] + 1));
+  a->peso_constante = 1;
+
+  if(a->primeira == NULL || a->inicio == NULL || origens == NULL) {
+    free(origens);
+    return 0;
+  }
+
+  /* Ordenação por contagem dos arcos da saída, já montada, pelo destino;
+     como as origens são percorridas em ordem, cada lista fica ordenada,
+     como monta_entrada_listas */
+  for(v = 0; v < dis->n_vertices; ++v) {
+    for(inicia_cursor(dis, v, 0, &cursor); proximo_arco(&cursor, &w, &peso); ) {
+      ++a->primeira[w + 1];
+    }
+  }
+
+  for(v = 0, capacidade = 16; v < dis->n_vertices; ++v) {
+    grau = (unsigned int) a->primeira[v + 1];
+    a->grau_maximo = (grau > a->grau_maximo) ? grau : a->grau_maximo;
+    capacidade += (grau + 3) / 4 + 4 * (size_t) grau;
+  }
+
+  soma_prefixos(a->primeira, dis->n_vertices);
+
+  for(v = 0; v < dis->n_vertices; ++v) {
+    for(inicia_cursor(dis, v, 0, &cursor); proximo_arco(&cursor, &w, &peso); ) {
+      origens[a->primeira[w]++] = v;
+    }
+  }
+
+  for(v = dis->n_vertices; v > 0; --v) {
+    a->primeira[v] = a->primeira[v - 1];
+  }
+
+  a->primeira[0] = 0;
+
+  if((a->dados = (unsigned char *) malloc(capacidade)) == NULL) {
+    free(origens);
+    return 0;
+  }
+
+  /* Codifica as origens de cada vértice, como codifica_adjacencia */
+  for(v = 0, tamanho = 0; v < dis->n_vertices; ++v) {
+    grau = (unsigned int) (a->primeira[v + 1] - a->primeira[v]);
+    a->inicio[v] = tamanho;
+    controle = a->dados + tamanho;
+    d = controle + (grau + 3) / 4;
+    memset(controle, 0, (grau + 3) / 4);
+
+    for(k = 0, e = a->primeira[v]; k < grau; ++k, ++e) {
+      d = codifica_valor(controle, k, origens[e] - ((k > 0) ? origens[e - 1] : 0), d);
+    }
+
+    tamanho = (size_t) (d - a->dados);
+  }
+
+  a->inicio[dis->n_vertices] = tamanho;
+  free(origens);
+
+  if((d = (unsigned char *) realloc(a->dados, tamanho + 16)) != NULL) {
+    a->dados = d;
+  }
+
+  memset(a->dados + tamanho, 0, 16);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static int monta_distancias_compactas(struct montagem_distancias *m) {
+  struct grafo *dis;
+  struct adjacencia_compacta *a;
+  struct linha_compacta *l;
+  long int menor, maior;
+  size_t e;
+  unsigned int v, k;
+
+  dis = m->dis;
+  pthread_once(&tabelas_iniciadas, inicia_tabelas_embaralhamento);
+
+  if((dis->compacto = (struct compacto *) calloc(1, sizeof(struct compacto))) == NULL) {
+    return 0;
+  }
+
+  a = &dis->compacto->saida;
+  a->primeira = (size_t *) malloc(sizeof(size_t) * (dis->n_vertices + 1));
+  a->inicio = (size_t *) malloc(sizeof(size_t) * (dis->n_vertices + 1));
+
+  if(a->primeira == NULL || a->inicio == NULL) {
+    return 0;
+  }
+
+  /* Posição de cada linha na saída e faixa dos pesos */
+  menor = LONG_MAX;
+  maior = LONG_MIN;
+  a->primeira[0] = 0;
+  a->inicio[0] = 0;
+
+  for(v = 0; v < dis->n_vertices; ++v) {
+    l = m->linhas + v;
+    a->primeira[v + 1] = a->primeira[v] + l->grau;
+    a->inicio[v + 1] = a->inicio[v] + l->tamanho;
+    a->grau_maximo = (l->grau > a->grau_maximo) ? l->grau : a->grau_maximo;
+
+    for(k = 0; k < l->grau; ++k) {
+      menor = (l->pesos[k] < menor) ? l->pesos[k] : menor;
+      maior = (l->pesos[k] > maior) ? l->pesos[k] : maior;
+    }
+  }
+
+  a->peso_constante = (menor == maior) ? menor : 1;
+  a->largura_peso = largura_pesos(menor, maior);
+  a->dados = (unsigned char *) malloc(a->inicio[dis->n_vertices] + 16);
+  a->pesos = (a->largura_peso > 0) ? malloc(a->largura_peso * (a->primeira[dis->n_vertices] + 1)) : NULL;
+
+  if(a->dados == NULL || (a->largura_peso > 0 && a->pesos == NULL)) {
+    return 0;
+  }
+
+  /* Junta as linhas, liberando cada uma, com a folga de 16 bytes da
+     decodificação; num grafo direcionado, monta os arcos que entram */
+  for(v = 0, e = 0; v < dis->n_vertices; ++v) {
+    l = m->linhas + v;
+    memcpy(a->dados + a->inicio[v], l->dados, l->tamanho);
+
+    for(k = 0; k < l->grau; ++k, ++e) {
+      grava_peso(a, e, l->pesos[k]);
+    }
+
+    free(l->dados);
+    free(l->pesos);
+    l->dados = NULL;
+    l->pesos = NULL;
+  }
+
+  memset(a->dados + a->inicio[dis->n_vertices], 0, 16);
+
+  if(dis->direcionado && !codifica_entrada_distancias(dis, &dis->compacto->entrada)) {
+    return 0;
+  }
+
+  /* Lidos por todos os threads das buscas: intercalados entre os nós */
+  distribui_memoria(a->primeira, sizeof(size_t) * (dis->n_vertices + 1), 1);
+  distribui_memoria(a->inicio, sizeof(size_t) * (dis->n_vertices + 1), 1);
+  distribui_memoria(a->dados, a->inicio[dis->n_vertices] + 16, 1);
+  distribui_memoria(a->pesos, a->largura_peso * a->primeira[dis->n_vertices], 1);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static grafo _distancias(grafo g) {
+  struct montagem_distancias m;
+  unsigned int i, n_tarefas;
+  int compacta, sucesso;
+
+  /* O resultado fica nas listas se elas cabem no orçamento com as buscas,
+     ou na representação compacta; os pares alcançáveis são limitados pela
+     condensação, calculada antes */
+  if(condensacao(g) == NULL) {
+    return NULL;
+  }
+
+  compacta = !cabe_orcamento(memoria_linhas(g, memoria_distancias(g, 0), &n_tarefas));
+
+  if(compacta && !cabe_orcamento(memoria_linhas(g, memoria_distancias(g, 1), &n_tarefas))) {
+    falha(ERRO_ORCAMENTO);
+    return NULL;
+  }
+
+  /* Aloca o grafo de distâncias */
+  inicializa_grafo(&m.dis);
+
+  if(m.dis == NULL) {
+    return NULL;
+  }
+
+  m.dis->direcionado = g->direcionado;
+  m.dis->ponderado = 1;
+  m.linhas = compacta ? (struct linha_compacta *) calloc(g->n_vertices + 1, sizeof(struct linha_compacta)) : NULL;
+  m.destinos = (unsigned int *) malloc(sizeof(unsigned int) * (g->n_vertices + 1));
+  m.falhou = 0;
+
+  if((m.dis->vertices = (struct vertice *) calloc(g->n_vertices + 1, sizeof(struct vertice))) == NULL ||
+     m.destinos == NULL || (compacta && m.linhas == NULL)) {
+    free(m.linhas);
+    free(m.destinos);
+    destroi_grafo(m.dis);
+    return NULL;
+  }
+
+  /* Inicializa os vértices do grafo de distâncias */
+  for(i = 0, sucesso = 1; sucesso && i < g->n_vertices; ++i) {
+    m.dis->n_vertices = i + 1;
+    m.dis->vertices[i].nome = strdup(g->vertices[i].nome);
+    inicializa_lista(&m.dis->vertices[i].arestas);
+    sucesso = (m.dis->vertices[i].nome != NULL && m.dis->vertices[i].arestas != NULL);
+  }
+
+  m.dis->capacidade = m.dis->n_vertices;
+
+  /* Cada linha de distâncias vira os arcos que saem da sua fonte; sem
+     memória para algum deles, o grafo inteiro é descartado */
+  sucesso = sucesso && linhas_distancias(g, 0, NULL, insere_linha_distancias, &m, NULL, memoria_distancias(g, compacta)) && !m.falhou &&
+            (!compacta || monta_distancias_compactas(&m));
+
+  for(i = 0; compacta && i < g->n_vertices; ++i) {
+    free(m.linhas[i].dados);
+    free(m.linhas[i].pesos);
+  }
+
+  free(m.linhas);
+  free(m.destinos);
+
+  if(!sucesso) {
+    destroi_grafo(m.dis);
+    return NULL;
+  }
+
+  return m.dis;
+}
+
+//------------------------------------------------------------------------------
+grafo distancias(grafo g) {
+  struct grafo *dis;
+  struct medida m;
+  unsigned long versao;
+
+  /* O grafo de distâncias guardado em g, ou calculado e guardado */
+  inicia_medida(&m);
+  erro_thread = ERRO_NENHUM;
+  versao = g->versao;
+
+  if((dis = grafo_guardado(g, GUARDADO_DISTANCIAS)) == NULL && (dis = guarda_grafo(g, GUARDADO_DISTANCIAS, versao, _distancias(g))) == NULL) {
+    falha(ERRO_MEMORIA);
+  }
+
+  termina_medida(g, &m, FASE_CALCULO);
+  return dis;
+}
+
+//------------------------------------------------------------------------------
+static int passadas_distancias(grafo g, long int *d, int inverso, int alcance) {
+  struct cursor c;
+  struct passada p;
+  long int peso;
+  unsigned long examinadas = 0;
+  unsigned int i, k, v, w;
+  int mudou;
+
+  /* Bellman-Ford em passadas sequenciais pelos arcos que saem de cada
+     vértice, alternando a ordem dos vértices (crescente e decrescente) para
+     que os caminhos que seguem a numeração se propaguem numa única passada.
+     Com inverso, d[v] é a distância de v às fontes (e não delas a v), e com
+     alcance os pesos valem 0 (d[v] é 0 se v é alcançável, ou infinito).
+     Só o vetor d fica em memória; se d ainda muda depois de n passadas há
+     um circuito negativo e devolve 0 */
+  for(k = 0, mudou = 1; mudou; ++k) {
+    if(k > g->n_vertices) {
+      CONTA(g, arestas_examinadas, examinadas);
+      return 0;
+    }
+
+    mudou = 0;
+    inicia_passada(g, 0, &p);
+
+    for(i = 0; i < g->n_vertices; ++i) {
+      v = (k % 2) ? g->n_vertices - 1 - i : i;
+      avanca_passada(&p, v);
+
+      for(inicia_cursor(g, v, 0, &c); proximo_arco(&c, &w, &peso); ++examinadas) {
+        peso = alcance ? 0 : peso;
+
+        if(!inverso && d[v] != infinito && d[v] + peso < d[w]) {
+          d[w] = d[v] + peso;
+          mudou = 1;
+        } else if(inverso && d[w] != infinito && d[w] + peso < d[v]) {
+          d[v] = d[w] + peso;
+          mudou = 1;
+        }
+      }
+    }
+
+    termina_passada(&p);
+  }
+
+  CONTA(g, arestas_examinadas, examinadas);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static int fortemente_conexo_externo(grafo g) {
+  long int *d;
+  unsigned int i;
+  int sentido, forte;
+
+  if(g->n_vertices < 2) {
+    return 1;
+  }
+
+  if((d = (long int *) malloc(sizeof(long int) * g->n_vertices)) == NULL) {
+    return 0;
+  }
+
+  /* g é fortemente conexo se o vértice 0 alcança todos e é alcançado por
+     todos, o que só exige passadas sequenciais pelos arcos de saída */
+  for(sentido = 0, forte = 1; sentido < 2 && forte; ++sentido) {
+    for(i = 0; i < g->n_vertices; ++i) {
+      d[i] = infinito;
+    }
+
+    d[0] = 0;
+    passadas_distancias(g, d, sentido, 1);
+
+    for(i = 0; i < g->n_vertices && forte; ++i) {
+      forte = (d[i] != infinito);
+    }
+  }
+
+  free(d);
+  return forte;
+}
+
+//------------------------------------------------------------------------------
+int fortemente_conexo(grafo g) {
+  struct condensacao *c;
+  struct medida m;
+  int forte;
+
+  erro_thread = ERRO_NENHUM;
+  conta_resultado(g, __atomic_load_n(&g->condensacao, __ATOMIC_ACQUIRE) != NULL);
+
+  /* Com as arestas em disco, evita a busca em profundidade (de acessos
+     aleatórios ao arquivo) da condensação */
+  if(g->externo != NULL && g->compacto == NULL && __atomic_load_n(&g->condensacao, __ATOMIC_ACQUIRE) == NULL) {
+    inicia_medida(&m);
+    forte = fortemente_conexo_externo(g);
+    termina_medida(g, &m, FASE_CALCULO);
+    return forte;
+  }
+
+  /* g é fortemente conexo se a condensação tem um único componente */
+  if((c = condensacao(g)) == NULL) {
+    falha(ERRO_MEMORIA);
+    return 0;
+  }
+
+  return (c->n_componentes < 2) ? 1 : 0;
+}
+
+//------------------------------------------------------------------------------
+lista subgrafos_fortemente_conexos(grafo g) {
+  struct lista *l;
+  struct condensacao *c;
+  struct particao *p;
+  struct subgrafo *s;
+  unsigned int i;
+
+  erro_thread = ERRO_NENHUM;
+  conta_resultado(g, __atomic_load_n(&g->condensacao, __ATOMIC_ACQUIRE) != NULL);
+
+  if(!orcamento_operacao(g, OPERACAO_FORTES) || (c = condensacao(g)) == NULL) {
+    falha(ERRO_MEMORIA);
+    return NULL;
+  }
+
+  inicializa_lista(&l);
+
+  if(l == NULL || (p = aloca_particao(g, g->n_vertices)) == NULL) {
+    destroi_lista(l, NULL);
+    falha(ERRO_MEMORIA);
+    return NULL;
+  }
+
+  /* A partição copia os componentes da condensação, que são inseridos na
+     cabeça da lista do último para o primeiro: a lista fica em ordem
+     topológica */
+  p->n_partes = c->n_componentes;
+  memcpy(p->rotulo, c->componente, sizeof(unsigned int) * g->n_vertices);
+  memcpy(p->inicio, c->inicio_membros, sizeof(unsigned int) * (c->n_componentes + 1));
+  memcpy(p->membros, c->membros, sizeof(unsigned int) * g->n_vertices);
+
+  for(i = c->n_componentes; l != NULL && i > 0; --i) {
+    if((s = cria_subgrafo(p, i - 1)) == NULL || !insere_cabeca_conteudo(l, s)) {
+      destroi_subgrafo(s);
+      destroi_lista(l, destroi_subgrafo);
+      falha(ERRO_MEMORIA);
+      l = NULL;
+    }
+  }
+
+  libera_particao(p);
+  return l;
+}
+
+//------------------------------------------------------------------------------
+static void maior_distancia(void *dados, unsigned int fonte, long int *maximo, const unsigned int *regiao, unsigned int n_regiao) {
+  /* Com so_maximo a linha traz apenas a maior distância a partir da fonte */
+  (void) fonte;
+  (void) regiao;
+  (void) n_regiao;
+
+  if(*maximo > *(long int *) dados) {
+    *(long int *) dados = *maximo;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void guarda_diametro(grafo g, unsigned long versao, long int diametro) {
+  long int *d;
+
+  if((d = (long int *) malloc(sizeof(long int))) != NULL) {
+    *d = diametro;
+
+    if(!guarda_resultado(g, GUARDADO_DIAMETRO, versao, d, bloco(1, sizeof(long int)), _destroi)) {
+      free(d);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static int diametro_guardado(grafo g, long int *diametro) {
+  struct guardado *r;
+  struct aresta *a;
+  struct no *n;
+  unsigned int v;
+
+  /* O diâmetro guardado em g ou, se não há, o maior peso do grafo de
+     distâncias guardado, que passa a ser guardado também */
+  if((r = busca_guardado(g, GUARDADO_DIAMETRO)) != NULL) {
+    *diametro = *(long int *) r->dados;
+    solta_guardado(r);
+    return 1;
+  }
+
+  if((r = busca_guardado(g, GUARDADO_DISTANCIAS)) == NULL) {
+    return 0;
+  }
+
+  for(v = 0, *diametro = 0; v < ((grafo) r->dados)->n_vertices; ++v) {
+    for(n = ((grafo) r->dados)->vertices[v].arestas->primeiro; n != NULL; n = n->proximo) {
+      a = (struct aresta *) n->conteudo;
+      *diametro = (a->peso > *diametro) ? a->peso : *diametro;
+    }
+  }
+
+  guarda_diametro(g, r->versao, *diametro);
+  solta_guardado(r);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+long int diametro(grafo g) {
+  struct medida m;
+  long int diametro = 0;
+  unsigned long versao;
+
+  /* O maior valor finito entre as maiores distâncias a partir de cada
+     vértice, sem guardar as distâncias entre todos os pares; o valor fica
+     guardado em g */
+  inicia_medida(&m);
+  erro_thread = ERRO_NENHUM;
+  versao = g->versao;
+
+  if(diametro_guardado(g, &diametro)) {
+    conta_resultado(g, 1);
+  } else if(conta_resultado(g, 0), !orcamento_operacao(g, OPERACAO_DIAMETRO) || !linhas_distancias(g, 1, NULL, maior_distancia, &diametro, NULL, 0)) {
+    falha(ERRO_MEMORIA);
+    diametro = -1;
+  } else {
+    guarda_diametro(g, versao, diametro);
+  }
+
+  termina_medida(g, &m, FASE_CALCULO);
+  return diametro;
+}
+
+//------------------------------------------------------------------------------
+static size_t memoria_esteira(grafo g) {
+  size_t vaga;
+  unsigned int n;
+
+  /* Duas vagas por thread, cada uma com até uma linha inteira, e os
+     vizinhos passados aos redutores */
+  n = numero_threads();
+  n = (n < g->n_vertices) ? n : (g->n_vertices > 0) ? g->n_vertices : 1;
+  vaga = soma_memoria(bloco(g->n_vertices, sizeof(unsigned int)), bloco(g->n_vertices, sizeof(long int)));
+  return soma_memoria(bloco(2 * n, sizeof(struct vaga_esteira) + 2 * vaga), bloco(g->n_vertices + 1, sizeof(struct vertice *)));
+}
+
+//------------------------------------------------------------------------------
+static int _percorre_distancias(grafo g, struct esteira *e) {
+  unsigned int i, n_tarefas;
+  int sucesso;
+
+  /* As vagas, duas por thread de busca, crescem com as linhas */
+  memoria_linhas(g, memoria_esteira(g), &n_tarefas);
+  e->n_vagas = 2 * n_tarefas;
+  e->escrita = 0;
+  e->escrevendo = 0;
+  e->vagas = (struct vaga_esteira *) calloc(e->n_vagas, sizeof(struct vaga_esteira));
+  e->vizinhos = (e->n_redutores > 0) ? (struct vertice **) malloc(sizeof(struct vertice *) * (g->n_vertices + 1)) : NULL;
+
+  if(e->vagas == NULL || (e->n_redutores > 0 && e->vizinhos == NULL)) {
+    free(e->vagas);
+    free(e->vizinhos);
+    return 0;
+  }
+
+  for(i = 0; i < e->n_vagas; ++i) {
+    e->vagas[i].estado = 2 * (unsigned long) i;
+  }
+
+  /* O cabeçalho de escreve_grafo para o grafo de distâncias, que não tem
+     nome */
+  if(e->saida != NULL) {
+    escreve_cabecalho(e->saida, g, NULL, NULL, g->n_vertices);
+  }
+
+  sucesso = linhas_distancias(g, 0, NULL, NULL, NULL, e, memoria_esteira(g)) && e->escrita == g->n_vertices;
+
+  if(e->saida != NULL) {
+    fprintf(e->saida, "}\n");
+    sucesso = sucesso && !ferror(e->saida);
+  }
+
+  for(i = 0; i < e->n_vagas; ++i) {
+    free(e->vagas[i].destinos);
+    free(e->vagas[i].distancias);
+  }
+
+  free(e->vagas);
+  free(e->vizinhos);
+  return sucesso;
+}
+
+//------------------------------------------------------------------------------
+int percorre_distancias(grafo g, FILE *output, struct resumo_distancias *r, unsigned int n, struct redutor_distancias *redutores) {
+  struct esteira e;
+  struct medida m;
+  unsigned long versao;
+  int sucesso;
+
+  /* As linhas de distancias, consumidas à medida que ficam prontas em vez
+     de montadas num grafo; com o resumo, o diâmetro fica guardado em g */
+  inicia_medida(&m);
+  erro_thread = ERRO_NENHUM;
+  versao = g->versao;
+
+  if(r != NULL) {
+    r->diametro = 0;
+    r->pares = 0;
+    r->largura_faixa = 1;
+    memset(r->histograma, 0, sizeof(r->histograma));
+  }
+
+  e.saida = output;
+  e.resumo = r;
+  e.n_redutores = n;
+  e.redutores = redutores;
+
+  if(!(sucesso = orcamento_operacao(g, OPERACAO_PERCORRE) && _percorre_distancias(g, &e))) {
+    falha(ERRO_MEMORIA);
+  } else if(r != NULL) {
+    guarda_diametro(g, versao, r->diametro);
+  }
+
+  termina_medida(g, &m, FASE_CALCULO);
+  return sucesso;
+}
+
+//------------------------------------------------------------------------------
+static int varre_distancias(grafo g, long int *d, int inverso, long int passo) {
+  struct area_trabalho *area;
+  struct busca_largura b;
+  unsigned int v, n_fontes;
+
+  /* Distâncias a partir das fontes (d[v] = 0, os demais infinito), ou até
+     elas com inverso: com todos os pesos iguais a passo (não negativo),
+     uma única busca em largura a partir de todas as fontes; com outros
+     pesos, ou com as arestas só em disco, as passadas sequenciais */
+  if(passo < 0 || (g->externo != NULL && g->compacto == NULL) || !prepara_entrada(g) || (area = pega_area(g)) == NULL) {
+    return passadas_distancias(g, d, inverso, 0);
+  }
+
+  for(v = 0, n_fontes = 0; v < g->n_vertices; ++v) {
+    if(d[v] == 0) {
+      area->heap[n_fontes++] = v;
+    }
+  }
+
+  b.g = g;
+  b.modo = modo_percurso(g, 0, 0);
+  b.sentido = inverso ? LARGURA_ENTRADA : LARGURA_SAIDA;
+  b.distancia = d;
+  b.pai = NULL;
+  b.fila = area->heap;
+  b.fronteira = area->marcas;
+  b.candidatos = NULL;
+  b.n_candidatos = g->n_vertices;
+  b.nao_visitados = g->n_vertices;
+  b.passo = passo;
+  busca_largura(&b, n_fontes, numero_threads());
+  devolve_area(g, area);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static int _limites_diametro(grafo g, long int *inferior, long int *superior) {
+  struct conectividade *c;
+  long int *d, *d_entrada, *excentricidade, *excentricidade_entrada, *limite;
+  unsigned int *longe;
+  unsigned char *forte;
+  long int maior, minimo, maximo, passo;
+  unsigned int i, r, varredura;
+  int sucesso;
+
+  *inferior = 0;
+  *superior = 0;
+
+  if(g->n_vertices == 0) {
+    return 1;
+  }
+
+  /* Com todos os pesos iguais as varreduras são buscas em largura */
+  faixa_pesos(g, &minimo, &maximo);
+  passo = (minimo == maximo && minimo >= 0) ? minimo : -1;
+
+  /* Os vetores são indexados pelos vértices (a raiz de cada componente
+     guarda os dados do componente), então tudo fica em O(V) */
+  c = gera_conectividade(g);
+  d = (long int *) malloc(sizeof(long int) * g->n_vertices);
+  d_entrada = g->direcionado ? (long int *) malloc(sizeof(long int) * g->n_vertices) : NULL;
+  excentricidade = (long int *) malloc(sizeof(long int) * g->n_vertices);
+  excentricidade_entrada = (long int *) malloc(sizeof(long int) * g->n_vertices);
+  limite = (long int *) malloc(sizeof(long int) * g->n_vertices);
+  longe = (unsigned int *) malloc(sizeof(unsigned int) * g->n_vertices);
+  forte = (unsigned char *) malloc(sizeof(unsigned char) * g->n_vertices);
+  sucesso = (c != NULL && d != NULL && (d_entrada != NULL || !g->direcionado) && excentricidade != NULL &&
+             excentricidade_entrada != NULL && limite != NULL && longe != NULL && forte != NULL);
+
+  if(sucesso) {
+    for(i = 0; i < g->n_vertices; ++i) {
+      c->pai[i] = encontra_representante(c, i);
+      longe[i] = i;
+      limite[i] = infinito;
+    }
+  }
+
+  /* Duas varreduras: a primeira a partir da raiz de cada componente e a
+     segunda a partir do vértice mais distante dela */
+  for(varredura = 0; sucesso && varredura < 2; ++varredura) {
+    for(i = 0; i < g->n_vertices; ++i) {
+      d[i] = infinito;
+
+      if(d_entrada != NULL) {
+        d_entrada[i] = infinito;
+      }
+    }
+
+    for(i = 0; i < g->n_vertices; ++i) {
+      if(c->pai[i] == i) {
+        d[longe[i]] = 0;
+        excentricidade[i] = 0;
+        excentricidade_entrada[i] = 0;
+        forte[i] = 1;
+
+        if(d_entrada != NULL) {
+          d_entrada[longe[i]] = 0;
+        }
+      }
+    }
+
+    if(!varre_distancias(g, d, 0, passo) || (d_entrada != NULL && !varre_distancias(g, d_entrada, 1, passo))) {
+      sucesso = 0;
+      break;
+    }
+
+    /* Toda distância finita encontrada é um limite inferior; um vértice
+       não alcançado (ou que não alcança a fonte) mostra que seu componente
+       não é fortemente conexo */
+    for(i = 0; i < g->n_vertices; ++i) {
+      r = c->pai[i];
+
+      if(d[i] == infinito) {
+        forte[r] = 0;
+      } else if(d[i] > excentricidade[r]) {
+        excentricidade[r] = d[i];
+
+        if(varredura == 0) {
+          longe[r] = i;
+        }
+      }
+
+      if(d_entrada != NULL) {
+        if(d_entrada[i] == infinito) {
+          forte[r] = 0;
+        } else if(d_entrada[i] > excentricidade_entrada[r]) {
+          excentricidade_entrada[r] = d_entrada[i];
+        }
+      }
+    }
+
+    /* Num grafo não direcionado nenhuma distância do componente passa de 2
+       vezes a excentricidade da fonte; num componente fortemente conexo,
+       da soma das excentricidades de saída e de entrada da fonte */
+    for(i = 0; i < g->n_vertices; ++i) {
+      if(c->pai[i] != i) {
+        continue;
+      }
+
+      maior = (excentricidade[i] > excentricidade_entrada[i]) ? excentricidade[i] : excentricidade_entrada[i];
+      *inferior = (maior > *inferior) ? maior : *inferior;
+
+      if(!g->direcionado) {
+        maior = 2 * excentricidade[i];
+      } else {
+        maior = forte[i] ? excentricidade[i] + excentricidade_entrada[i] : infinito;
+      }
+
+      limite[i] = (maior < limite[i]) ? maior : limite[i];
+    }
+  }
+
+  if(sucesso) {
+    for(i = 0; i < g->n_vertices; ++i) {
+      if(c->pai[i] == i && limite[i] > *superior) {
+        *superior = limite[i];
+      }
+    }
+  }
+
+  destroi_conectividade(c);
+  free(d);
+  free(d_entrada);
+  free(excentricidade);
+  free(excentricidade_entrada);
+  free(limite);
+  free(longe);
+  free(forte);
+  return sucesso;
+}
+
+//------------------------------------------------------------------------------
+int limites_diametro(grafo g, long int *inferior, long int *superior) {
+  struct medida m;
+  int sucesso;
+
+  inicia_medida(&m);
+  sucesso = _limites_diametro(g, inferior, superior);
+  termina_medida(g, &m, FASE_CALCULO);
+  return sucesso;
+}
+
+//------------------------------------------------------------------------------
+struct tarefa_alcancabilidade {
+  struct condensacao *c;
+  struct alcancabilidade *a;
+  unsigned int inicio, fim;
+};
+
+//------------------------------------------------------------------------------
+static void *_gera_fecho_transitivo(void *p) {
+  struct tarefa_alcancabilidade *t;
+  uint64_t *linha;
+  unsigned int i, j, k;
+
+  t = (struct tarefa_alcancabilidade *) p;
+
+  /* Cada thread calcula as palavras [inicio, fim) de todas as linhas do
+     fecho, então não há dependência entre os threads. Os sucessores têm
+     número maior, logo suas linhas já estão prontas quando i é processado */
+  for(i = t->c->n_componentes; i > 0; --i) {
+    linha = t->a->fecho + (size_t) (i - 1) * t->a->n_palavras;
+
+    for(k = t->inicio; k < t->fim; ++k) {
+      linha[k] = 0;
+    }
+
+    if((i - 1) / 64 >= t->inicio && (i - 1) / 64 < t->fim) {
+      linha[(i - 1) / 64] |= (uint64_t) 1 << ((i - 1) % 64);
+    }
+
+    for(j = t->c->inicio_sucessores[i - 1]; j < t->c->inicio_sucessores[i]; ++j) {
+      for(k = t->inicio; k < t->fim; ++k) {
+        linha[k] |= t->a->fecho[(size_t) t->c->sucessores[j] * t->a->n_palavras + k];
+      }
+    }
+  }
+
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void *_gera_rotulos(void *p) {
+  struct tarefa_alcancabilidade *t;
+  unsigned int *baixo, *pos, *pilha, *proximo, *deslocamento;
+  unsigned int i, r, v, w, topo, n, grau, contador;
+  uint64_t semente;
+
+  t = (struct tarefa_alcancabilidade *) p;
+  n = t->c->n_componentes;
+  baixo = t->a->baixo + (size_t) t->inicio * n;
+  pos = t->a->pos + (size_t) t->inicio * n;
+
+  pilha = (unsigned int *) malloc(sizeof(unsigned int) * n);
+  proximo = (unsigned int *) malloc(sizeof(unsigned int) * n);
+  deslocamento = (unsigned int *) malloc(sizeof(unsigned int) * n);
+
+  if(pilha == NULL || proximo == NULL || deslocamento == NULL) {
+    /* Sem memória, o rótulo [0, n] contém todos os outros e não poda nada */
+    for(i = 0; i < n; ++i) {
+      baixo[i] = 0;
+      pos[i] = n;
+    }
+  } else {
+    /* Cada rótulo usa uma ordem aleatória (mas reproduzível) dos sucessores */
+    semente = 0x9e3779b97f4a7c15ULL * (t->inicio + 1);
+
+    for(i = 0; i < n; ++i) {
+      semente = semente * 6364136223846793005ULL + 1442695040888963407ULL;
+      grau = t->c->inicio_sucessores[i + 1] - t->c->inicio_sucessores[i];
+      deslocamento[i] = (grau > 0) ? (unsigned int) (semente >> 33) % grau : 0;
+      proximo[i] = 0;
+      pos[i] = 0;
+    }
+
+    /* Busca em profundidade no DAG: pos[v] é a pós-ordem de v e baixo[v]
+       a menor pós-ordem entre os descendentes de v, de forma que se v
+       alcança w então [baixo[w], pos[w]] está contido em [baixo[v], pos[v]] */
+    contador = 0;
+
+    for(r = 0; r < n; ++r) {
+      /* Rótulos ímpares percorrem as raízes na ordem inversa */
+      v = (t->inicio % 2) ? n - 1 - r : r;
+
+      if(pos[v] != 0) {
+        continue;
+      }
+
+      pos[v] = (unsigned int) -1;
+      baixo[v] = (unsigned int) -1;
+      pilha[0] = v;
+      topo = 1;
+
+      while(topo > 0) {
+        v = pilha[topo - 1];
+        grau = t->c->inicio_sucessores[v + 1] - t->c->inicio_sucessores[v];
+
+        if(proximo[v] < grau) {
+          w = t->c->sucessores[t->c->inicio_sucessores[v] + (proximo[v] + deslocamento[v]) % grau];
+          ++proximo[v];
+
+          if(pos[w] == 0) {
+            pos[w] = (unsigned int) -1;
+            baixo[w] = (unsigned int) -1;
+            pilha[topo++] = w;
+          } else if(baixo[w] < baixo[v]) {
+            baixo[v] = baixo[w];
+          }
+        } else {
+          pos[v] = ++contador;
+
+          if(pos[v] < baixo[v]) {
+            baixo[v] = pos[v];
+          }
+
+          if(--topo > 0 && baixo[v] < baixo[pilha[topo - 1]]) {
+            baixo[pilha[topo - 1]] = baixo[v];
+          }
+        }
+      }
+    }
+  }
+
+  free(pilha);
+  free(proximo);
+  free(deslocamento);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static struct alcancabilidade *gera_alcancabilidade(struct condensacao *c) {
+  struct alcancabilidade *a;
+  struct tarefa_alcancabilidade *tarefas;
+  unsigned int i, n_tarefas;
+
+  a = (struct alcancabilidade *) malloc(sizeof(struct alcancabilidade));
+
+  if(a == NULL) {
+    return NULL;
+  }
+
+  a->n_palavras = (c->n_componentes + 63) / 64;
+  a->fecho = NULL;
+  a->n_rotulos = 0;
+  a->baixo = NULL;
+  a->pos = NULL;
+
+  if(c->n_componentes <= LIMITE_FECHO_TRANSITIVO) {
+    /* Poucos componentes: fecho transitivo em bits, dividido entre os
+       threads por faixas de palavras */
+    a->fecho = (uint64_t *) malloc(sizeof(uint64_t) * a->n_palavras * c->n_componentes + 1);
+    n_tarefas = numero_threads();
+
+    if(n_tarefas > a->n_palavras) {
+      n_tarefas = a->n_palavras;
+    }
+  } else {
+    /* Muitos componentes: N_ROTULOS rotulações por intervalos, uma por thread */
+    a->n_rotulos = N_ROTULOS;
+    a->baixo = (unsigned int *) malloc(sizeof(unsigned int) * N_ROTULOS * c->n_componentes);
+    a->pos = (unsigned int *) malloc(sizeof(unsigned int) * N_ROTULOS * c->n_componentes);
+    n_tarefas = N_ROTULOS;
+  }
+
+  if(n_tarefas == 0) {
+    n_tarefas = 1;
+  }
+
+  tarefas = (struct tarefa_alcancabilidade *) malloc(sizeof(struct tarefa_alcancabilidade) * n_tarefas);
+
+  if(tarefas == NULL || (a->fecho == NULL && (a->baixo == NULL || a->pos == NULL))) {
+    free(tarefas);
+    destroi_alcancabilidade(a);
+    return NULL;
+  }
+
+  for(i = 0; i < n_tarefas; ++i) {
+    tarefas[i].c = c;
+    tarefas[i].a = a;
+
+    if(a->fecho != NULL) {
+      tarefas[i].inicio = (unsigned int) ((uint64_t) a->n_palavras * i / n_tarefas);
+      tarefas[i].fim = (unsigned int) ((uint64_t) a->n_palavras * (i + 1) / n_tarefas);
+    } else {
+      tarefas[i].inicio = i;
+      tarefas[i].fim = i + 1;
+    }
+  }
+
+  executa_paralelo((a->fecho != NULL) ? _gera_fecho_transitivo : _gera_rotulos, tarefas, sizeof(struct tarefa_alcancabilidade), n_tarefas);
+  free(tarefas);
+  return a;
+}
+
+//------------------------------------------------------------------------------
+static int rotulo_contido(struct alcancabilidade *a, unsigned int n, unsigned int x, unsigned int y) {
+  unsigned int i;
+
+  /* Verifica se o intervalo de y está contido no de x em todos os rótulos */
+  for(i = 0; i < a->n_rotulos; ++i) {
+    if(a->baixo[i * n + y] < a->baixo[i * n + x] || a->pos[i * n + y] > a->pos[i * n + x]) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static int componente_alcancavel(struct condensacao *c, struct alcancabilidade *a, unsigned int x, unsigned int y) {
+  unsigned char *visitado;
+  unsigned int *pilha;
+  unsigned int i, v, w, topo;
+  int alcancou;
+
+  /* Como a numeração é topológica, x só alcança y se x <= y */
+  if(x == y) {
+    return 1;
+  }
+
+  if(x > y) {
+    return 0;
+  }
+
+  if(a->fecho != NULL) {
+    return (a->fecho[(size_t) x * a->n_palavras + y / 64] >> (y % 64)) & 1;
+  }
+
+  if(!rotulo_contido(a, c->n_componentes, x, y)) {
+    return 0;
+  }
+
+  /* Os rótulos não descartaram o par: busca a partir de x podando os
+     componentes depois de y e os que os rótulos garantem não alcançar y */
+  visitado = (unsigned char *) calloc(c->n_componentes, sizeof(unsigned char));
+  pilha = (unsigned int *) malloc(sizeof(unsigned int) * c->n_componentes);
+  alcancou = 0;
+
+  if(visitado != NULL && pilha != NULL) {
+    pilha[0] = x;
+    visitado[x] = 1;
+    topo = 1;
+
+    while(topo > 0 && !alcancou) {
+      v = pilha[--topo];
+
+      for(i = c->inicio_sucessores[v]; i < c->inicio_sucessores[v + 1]; ++i) {
+        w = c->sucessores[i];
+
+        if(w == y) {
+          alcancou = 1;
+          break;
+        }
+
+        if(w < y && !visitado[w] && rotulo_contido(a, c->n_componentes, w, y)) {
+          visitado[w] = 1;
+          pilha[topo++] = w;
+        }
+      }
+    }
+  }
+
+  free(visitado);
+  free(pilha);
+  return alcancou;
+}
+
+//------------------------------------------------------------------------------
+int alcancavel(grafo g, vertice u, vertice v) {
+  struct condensacao *c;
+  struct medida m;
+  unsigned int x, y;
+
+  if((x = indice_vertice(g, u)) == (unsigned int) -1 || (y = indice_vertice(g, v)) == (unsigned int) -1) {
+    return 0;
+  }
+
+  if((c = condensacao(g)) == NULL) {
+    return 0;
+  }
+
+  /* O índice é construído na primeira consulta e reaproveitado nas próximas */
+  if(__atomic_load_n(&g->alcancabilidade, __ATOMIC_ACQUIRE) == NULL) {
+    pthread_mutex_lock(&g->trava);
+
+    if(g->alcancabilidade == NULL) {
+      inicia_medida(&m);
+      __atomic_store_n(&g->alcancabilidade, gera_alcancabilidade(c), __ATOMIC_RELEASE);
+      termina_medida(g, &m, FASE_INDICE);
+    }
+
+    pthread_mutex_unlock(&g->trava);
+
+    if(g->alcancabilidade == NULL) {
+      return 0;
+    }
+  }
+
+  return componente_alcancavel(c, g->alcancabilidade, c->componente[x], c->componente[y]);
+}
+
+//------------------------------------------------------------------------------
+grafo cria_grafo(char *nome, int direcionado, int ponderado) {
+  struct grafo *g;
+
+  /* Aloca um grafo sem vértices, que é preenchido com insere_vertice e
+     insere_aresta */
+  inicializa_grafo(&g);
+
+  if(g != NULL) {
+    g->nome = strdup(nome != NULL ? nome : "");
+    g->direcionado = direcionado;
+    g->ponderado = ponderado;
+
+    if(g->nome == NULL) {
+      destroi_grafo(g);
+      return NULL;
+    }
+  }
+
+  return g;
+}
+
+//------------------------------------------------------------------------------
+static void invalida_guardados(grafo g) {
+  /* Os resultados guardados são de versões anteriores */
+  ++g->versao;
+  descarta_guardados(g);
+}
+
+//------------------------------------------------------------------------------
+static void invalida_derivados(grafo g) {
+  /* Descarta as estruturas derivadas de g que não são atualizadas
+     incrementalmente; são recalculadas quando forem usadas novamente */
+  destroi_condensacao(g->condensacao);
+  destroi_alcancabilidade(g->alcancabilidade);
+  destroi_entrada(g->entrada);
+  g->condensacao = NULL;
+  g->alcancabilidade = NULL;
+  g->entrada = NULL;
+  g->pesos_conhecidos = 0;
+
+  invalida_guardados(g);
+}
+
+//------------------------------------------------------------------------------
+static void descarta_conectividade(grafo g) {
+  /* Uma remoção pode separar componentes, o que o union-find não
+     representa; o próximo conexo recalcula os componentes */
+  destroi_conectividade(g->conectividade);
+  g->conectividade = NULL;
+}
+
+//------------------------------------------------------------------------------
+static void *remove_no(lista l, unsigned int origem, unsigned int destino, struct aresta *a) {
+  struct no *n, **anterior;
+  void *conteudo;
+
+  /* Remove da lista o primeiro nó cujo conteúdo é a, ou (se a é NULL)
+     cuja aresta vai de origem a destino, e devolve o conteúdo removido */
+  for(anterior = &l->primeiro; (n = *anterior) != NULL; anterior = &n->proximo) {
+    if(a != NULL ? n->conteudo == a : (((struct aresta *) n->conteudo)->origem == origem &&
+                                       ((struct aresta *) n->conteudo)->destino == destino)) {
+      *anterior = n->proximo;
+      conteudo = n->conteudo;
+      free(n);
+      return conteudo;
+    }
+  }
+
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+vertice insere_vertice(grafo g, char *nome) {
+  struct vertice *vertices;
+  struct conectividade *c;
+  unsigned int capacidade, i;
+
+  /* Os nomes dos vértices identificam os vértices, então não podem repetir */
+  if(nome == NULL || encontra_vertice_indice(g->vertices, g->n_vertices, nome) != (unsigned int) -1) {
+    return NULL;
+  }
+
+  /* As alterações são feitas sobre as listas de adjacência */
+  if(!descompacta_grafo(g)) {
+    return NULL;
+  }
+
+  /* Dobra o vetor de vértices quando ele está cheio, de forma que a
+     inserção custa O(1) amortizado */
+  if(g->n_vertices >= g->capacidade) {
+    capacidade = (g->n_vertices > 0) ? 2 * g->n_vertices : 4;
+    vertices = (struct vertice *) realloc(g->vertices, sizeof(struct vertice) * capacidade);
+
+    if(vertices == NULL) {
+      return NULL;
+    }
+
+    g->vertices = vertices;
+    g->capacidade = capacidade;
+  }
+
+  i = g->n_vertices;
+  g->vertices[i].nome = strdup(nome);
+  inicializa_lista(&g->vertices[i].arestas);
+
+  if(g->vertices[i].nome == NULL || g->vertices[i].arestas == NULL) {
+    free(g->vertices[i].nome);
+    free(g->vertices[i].arestas);
+    return NULL;
+  }
+
+  ++g->n_vertices;
+  invalida_derivados(g);
+
+  /* O novo vértice forma um componente sozinho */
+  if((c = g->conectividade) != NULL) {
+    if(i >= c->capacidade) {
+      c->capacidade = g->capacidade;
+      c->pai = (unsigned int *) realloc(c->pai, sizeof(unsigned int) * c->capacidade);
+      c->posto = (unsigned char *) realloc(c->posto, sizeof(unsigned char) * c->capacidade);
+    }
+
+    if(c->pai == NULL || c->posto == NULL) {
+      descarta_conectividade(g);
+    } else {
+      c->pai[i] = i;
+      c->posto[i] = 0;
+      ++c->n_componentes;
+    }
+  }
+
+  return g->vertices + i;
+}
+
+//------------------------------------------------------------------------------
+int insere_aresta(grafo g, vertice u, vertice v, long int peso) {
+  struct aresta *a, *b;
+  unsigned int x, y;
+
+  if((x = indice_vertice(g, u)) == (unsigned int) -1 || (y = indice_vertice(g, v)) == (unsigned int) -1 || !descompacta_grafo(g)) {
+    return 0;
+  }
+
+  a = (struct aresta *) malloc(sizeof(struct aresta));
+
+  if(a == NULL) {
+    return 0;
+  }
+
+  a->origem = x;
+  a->destino = y;
+  a->peso = peso;
+
+  /* Mesma representação de le_grafo: o arco fica na lista da origem, e a
+     aresta tem uma cópia em cada ponta com ela como origem */
+  insere_cabeca_conteudo(g->vertices[x].arestas, a);
+
+  if(x != y && !g->direcionado && (b = (struct aresta *) malloc(sizeof(struct aresta))) != NULL) {
+    b->origem = y;
+    b->destino = x;
+    b->peso = peso;
+    insere_cabeca_conteudo(g->vertices[y].arestas, b);
+  }
+
+  invalida_derivados(g);
+
+  if(g->conectividade != NULL) {
+    une_componentes(g->conectividade, x, y);
+  }
+
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+int remove_aresta(grafo g, vertice u, vertice v) {
+  struct no *n;
+  struct aresta *a;
+  unsigned int x, y;
+
+  if((x = indice_vertice(g, u)) == (unsigned int) -1 || (y = indice_vertice(g, v)) == (unsigned int) -1 || !descompacta_grafo(g)) {
+    return 0;
+  }
+
+  /* Procura a aresta (arco) de x para y na lista de x */
+  for(n = g->vertices[x].arestas->primeiro; n != NULL; n = n->proximo) {
+    a = (struct aresta *) n->conteudo;
+
+    if(a->destino == y) {
+      break;
+    }
+  }
+
+  if(n == NULL) {
+    return 0;
+  }
+
+  /* Remove o arco da lista da origem, ou a aresta e sua cópia */
+  remove_no(g->vertices[x].arestas, x, y, a);
+
+  if(x != y && !g->direcionado) {
+    free(remove_no(g->vertices[y].arestas, y, x, NULL));
+  }
+
+  free(a);
+  invalida_derivados(g);
+  descarta_conectividade(g);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+int remove_vertice(grafo g, vertice v) {
+  struct no *n, *p;
+  struct aresta *a;
+  unsigned int i, w, ultimo;
+  size_t k;
+
+  if((i = indice_vertice(g, v)) == (unsigned int) -1 || !descompacta_grafo(g) || !prepara_entrada(g)) {
+    return 0;
+  }
+
+  ultimo = g->n_vertices - 1;
+
+  if(g->direcionado) {
+    /* O último vértice vai para a posição de i, então os arcos que entram
+       nele passam a entrar em i (os que vêm de i são liberados abaixo) */
+    if(i != ultimo) {
+      for(k = g->entrada->inicio[ultimo]; k < g->entrada->inicio[ultimo + 1]; ++k) {
+        g->entrada->arco[k]->destino = i;
+      }
+    }
+
+    /* Remove os arcos que entram em i das listas das suas origens */
+    for(k = g->entrada->inicio[i]; k < g->entrada->inicio[i + 1]; ++k) {
+      a = g->entrada->arco[k];
+
+      if(a->origem != i) {
+        remove_no(g->vertices[a->origem].arestas, 0, 0, a);
+        free(a);
+      }
+    }
+  } else {
+    /* Remove as cópias das arestas de i das listas dos seus vizinhos */
+    for(n = g->vertices[i].arestas->primeiro; n != NULL; n = n->proximo) {
+      w = ((struct aresta *) n->conteudo)->destino;
+
+      if(w != i) {
+        free(remove_no(g->vertices[w].arestas, w, i, NULL));
+      }
+    }
+  }
+
+  /* Restam apenas as arestas (arcos) da lista de i, liberadas aqui */
+  for(n = g->vertices[i].arestas->primeiro; n != NULL; n = p) {
+    p = n->proximo;
+    free(n->conteudo);
+    free(n);
+  }
+
+  free(g->vertices[i].arestas);
+  free(g->vertices[i].nome);
+
+  /* Move o último vértice para a posição de i, renumerando as pontas de
+     suas arestas (e das cópias nas listas dos vizinhos) */
+  --g->n_vertices;
+
+  if(i != ultimo) {
+    g->vertices[i] = g->vertices[ultimo];
+
+    for(n = g->vertices[i].arestas->primeiro; n != NULL; n = n->proximo) {
+      a = (struct aresta *) n->conteudo;
+      a->origem = i;
+
+      if(a->destino == ultimo) {
+        a->destino = i;
+      }
+
+      if(!g->direcionado && (w = a->destino) != i) {
+        for(p = g->vertices[w].arestas->primeiro; p != NULL; p = p->proximo) {
+          if(((struct aresta *) p->conteudo)->destino == ultimo) {
+            ((struct aresta *) p->conteudo)->destino = i;
+          }
+        }
+      }
+    }
+  }
+
+  invalida_derivados(g);
+  descarta_conectividade(g);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+// distâncias entre todos os pares de vértices de um grafo, mantidas
+// durante alterações nas arestas do grafo
+
+struct tabela_distancias {
+  grafo g;
+  unsigned int n_vertices;
+  long int *distancia;
+};
+
+//------------------------------------------------------------------------------
+// aresta (arco) alterada em atualiza_distancias, com peso infinito quando
+// ela não existe antes ou depois da alteração
+
+struct arco_alterado {
+  unsigned int origem;
+  unsigned int destino;
+  long int peso_antigo;
+  long int peso_novo;
+};
+
+//------------------------------------------------------------------------------
+// vetores auxiliares do reparo de uma linha da tabela, reaproveitados
+// entre as linhas e limpos apenas nos vértices tocados
+
+struct area_reparo {
+  struct heap h;
+  unsigned char *candidato;
+  unsigned char *afetado;
+  unsigned int *tocados;
+  unsigned int n_tocados;
+  unsigned int *afetados;
+  unsigned int n_afetados;
+};
+
+//------------------------------------------------------------------------------
+static size_t memoria_tabela(grafo g) {
+  /* A tabela, uma linha de distâncias por vértice */
+  return bloco((size_t) g->n_vertices * g->n_vertices, sizeof(long int));
+}
+
+//------------------------------------------------------------------------------
+static int calcula_tabela(struct tabela_distancias *t) {
+  long int *distancia;
+
+  /* Sem espaço para a tabela inteira no orçamento não há estratégia
+     alternativa: a chamada falha antes de alocá-la */
+  if(!orcamento_operacao(t->g, OPERACAO_TABELA)) {
+    return 0;
+  }
+
+  distancia = (long int *) malloc(sizeof(long int) * t->g->n_vertices * t->g->n_vertices + 1);
+
+  if(distancia == NULL) {
+    return 0;
+  }
+
+  /* Uma busca de Dijkstra a partir de cada vértice preenche a sua linha;
+     as páginas da tabela, ainda não tocadas, ficam no nó do thread que
+     calcula a linha */
+  distribui_memoria(distancia, sizeof(long int) * t->g->n_vertices * t->g->n_vertices, 0);
+
+  if(!linhas_distancias(t->g, 0, distancia, NULL, NULL, NULL, memoria_tabela(t->g))) {
+    free(distancia);
+    return 0;
+  }
+
+  /* A tabela anterior só é substituída quando a nova está completa */
+  free(t->distancia);
+  t->distancia = distancia;
+  t->n_vertices = t->g->n_vertices;
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+tabela_distancias calcula_distancias(grafo g) {
+  struct tabela_distancias *t;
+  struct medida m;
+
+  inicia_medida(&m);
+  erro_thread = ERRO_NENHUM;
+  t = (struct tabela_distancias *) malloc(sizeof(struct tabela_distancias));
+
+  if(t != NULL) {
+    t->g = g;
+    t->distancia = NULL;
+
+    if(!calcula_tabela(t)) {
+      destroi_tabela_distancias(t);
+      t = NULL;
+    }
+  }
+
+  if(t == NULL) {
+    falha(ERRO_MEMORIA);
+  }
+
+  termina_medida(g, &m, FASE_CALCULO);
+  return t;
+}
+
+//------------------------------------------------------------------------------
+int destroi_tabela_distancias(void *t) {
+  if(t != NULL) {
+    free(((struct tabela_distancias *) t)->distancia);
+    free(t);
+  }
+
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+long int distancia(tabela_distancias t, vertice u, vertice v) {
+  unsigned int x, y;
+
+  if((x = indice_vertice(t->g, u)) == (unsigned int) -1 || (y = indice_vertice(t->g, v)) == (unsigned int) -1) {
+    return infinito;
+  }
+
+  return t->distancia[(size_t) x * t->n_vertices + y];
+}
+
+//------------------------------------------------------------------------------
+static struct aresta *procura_arco(grafo g, unsigned int x, unsigned int y) {
+  struct no *n;
+  struct aresta *a;
+
+  /* Devolve a aresta (arco) de x para y na lista de x, ou NULL */
+  for(n = g->vertices[x].arestas->primeiro; n != NULL; n = n->proximo) {
+    a = (struct aresta *) n->conteudo;
+
+    if(a->destino == y) {
+      return a;
+    }
+  }
+
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void toca(struct area_reparo *r, unsigned int v) {
+  /* Registra v para que seus marcadores sejam limpos no fim da linha */
+  if(!r->candidato[v]) {
+    r->candidato[v] = 1;
+    r->tocados[r->n_tocados++] = v;
+  }
+}
+
+//------------------------------------------------------------------------------
+static int suportado(grafo g, long int *d, unsigned int s, unsigned int v, struct area_reparo *r) {
+  struct cursor c;
+  long int peso;
+  unsigned int u;
+
+  if(v == s) {
+    return 1;
+  }
+
+  /* v mantém sua distância se alguma aresta que entra nele ainda é justa
+     e vem de um vértice que não foi afetado nem está pendente no heap.
+     Uma aresta de peso 0 só vale vinda de s: por ela v poderia apoiar-se
+     num vértice que ainda não foi examinado e que depende do próprio v,
+     então v é tratado como afetado e apenas recalculado sem necessidade */
+  for(inicia_cursor(g, v, 1, &c); proximo_arco(&c, &u, &peso); ) {
+    if(u != v && d[u] != infinito && !r->afetado[u] && r->h.posicao[u] == (unsigned int) -1 &&
+       d[u] + peso == d[v] && (peso > 0 || u == s)) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static int _repara_linha(grafo g, long int *d, unsigned int s, struct arco_alterado *alteracoes, unsigned int n_alteracoes, struct area_reparo *r, unsigned int limite) {
+  struct no *n;
+  struct aresta *a;
+  struct cursor c;
+  unsigned int i, u, v, w;
+  long int melhor, peso;
+
+  r->h.chave = d;
+
+  /* Fase 1 (aumentos e remoções): procura, em ordem de distância, os
+     vértices que perderam todos os caminhos mínimos, a partir das pontas
+     das arestas alteradas que eram justas. As que diminuíram também
+     entram, pois sua ponta depende da origem se esta for afetada */
+  for(i = 0; i < n_alteracoes; ++i) {
+    u = alteracoes[i].origem;
+    v = alteracoes[i].destino;
+
+    if(alteracoes[i].peso_novo != alteracoes[i].peso_antigo && alteracoes[i].peso_antigo != infinito && d[u] != infinito &&
+       d[u] + alteracoes[i].peso_antigo == d[v] && !r->candidato[v]) {
+      toca(r, v);
+      heap_insere(&r->h, v);
+    }
+  }
+
+  while(r->h.n > 0) {
+    v = heap_remove(&r->h);
+
+    if(suportado(g, d, s, v, r)) {
+      continue;
+    }
+
+    r->afetado[v] = 1;
+    r->afetados[r->n_afetados++] = v;
+
+    if(r->n_afetados > limite) {
+      return 0;
+    }
+
+    /* Os vértices para os quais v era justo podem ter sido afetados também */
+    for(n = g->vertices[v].arestas->primeiro; n != NULL; n = n->proximo) {
+      a = (struct aresta *) n->conteudo;
+      w = a->destino;
+
+      if(!r->candidato[w] && d[w] != infinito && d[v] + a->peso == d[w]) {
+        toca(r, w);
+        heap_insere(&r->h, w);
+      }
+    }
+  }
+
+  /* Recalcula os afetados a partir da melhor aresta vinda de fora da
+     região */
+  for(i = 0; i < r->n_afetados; ++i) {
+    d[r->afetados[i]] = infinito;
+  }
+
+  for(i = 0; i < r->n_afetados; ++i) {
+    v = r->afetados[i];
+    melhor = infinito;
+
+    for(inicia_cursor(g, v, 1, &c); proximo_arco(&c, &u, &peso); ) {
+      if(!r->afetado[u] && d[u] != infinito && d[u] + peso < melhor) {
+        melhor = d[u] + peso;
+      }
+    }
+
+    if(melhor != infinito) {
+      d[v] = melhor;
+      heap_insere(&r->h, v);
+    }
+  }
+
+  /* Fase 2: junta ao heap as pontas das arestas que ficaram mais curtas
+     (diminuições e inserções) e propaga as distâncias dos afetados e as
+     melhoras por Dijkstra, tocando apenas os vértices cuja distância muda */
+  for(i = 0; i < n_alteracoes; ++i) {
+    u = alteracoes[i].origem;
+    v = alteracoes[i].destino;
+
+    if(alteracoes[i].peso_novo < alteracoes[i].peso_antigo && d[u] != infinito && d[u] + alteracoes[i].peso_novo < d[v]) {
+      d[v] = d[u] + alteracoes[i].peso_novo;
+      heap_insere(&r->h, v);
+    }
+  }
+
+  i = 0;
+
+  while(r->h.n > 0) {
+    v = heap_remove(&r->h);
+
+    if(++i > limite) {
+      return 0;
+    }
+
+    for(n = g->vertices[v].arestas->primeiro; n != NULL; n = n->proximo) {
+      a = (struct aresta *) n->conteudo;
+
+      if(d[v] + a->peso < d[a->destino]) {
+        d[a->destino] = d[v] + a->peso;
+        heap_insere(&r->h, a->destino);
+      }
+    }
+  }
+
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static int repara_linha(grafo g, long int *d, unsigned int s, struct arco_alterado *alteracoes, unsigned int n_alteracoes, struct area_reparo *r) {
+  unsigned int i;
+  int reparou;
+
+  r->n_tocados = 0;
+  r->n_afetados = 0;
+
+  /* Se a região afetada passa de uma fração dos vértices o reparo deixa
+     de compensar, e a linha é recalculada do zero */
+  reparou = _repara_linha(g, d, s, alteracoes, n_alteracoes, r, g->n_vertices / FRACAO_REPARO);
+
+  /* Limpa os marcadores apenas dos vértices tocados e esvazia o heap */
+  for(i = 0; i < r->n_tocados; ++i) {
+    r->candidato[r->tocados[i]] = 0;
+    r->afetado[r->tocados[i]] = 0;
+  }
+
+  while(r->h.n > 0) {
+    heap_remove(&r->h);
+  }
+
+  if(!reparou) {
+    dijkstra(g, s, d, NULL, &r->h);
+  }
+
+  return reparou;
+}
+
+//------------------------------------------------------------------------------
+static long int altera_arco(grafo g, unsigned int x, unsigned int y, long int peso) {
+  struct aresta *a;
+  long int peso_antigo;
+
+  /* Aplica a alteração em g e devolve o peso anterior da aresta (arco) */
+  if((a = procura_arco(g, x, y)) == NULL) {
+    if(peso != infinito) {
+      insere_aresta(g, g->vertices + x, g->vertices + y, peso);
+    }
+
+    return infinito;
+  }
+
+  peso_antigo = a->peso;
+
+  if(peso == infinito) {
+    remove_aresta(g, g->vertices + x, g->vertices + y);
+  } else {
+    a->peso = peso;
+
+    /* A cópia da aresta na lista de y tem o mesmo peso */
+    if(!g->direcionado && x != y && (a = procura_arco(g, y, x)) != NULL) {
+      a->peso = peso;
+    }
+
+    /* A condensação, a alcançabilidade e os arcos de entrada não dependem
+       dos pesos, mas os resultados guardados sim */
+    g->pesos_conhecidos = 0;
+    invalida_guardados(g);
+  }
+
+  return peso_antigo;
+}
+
+//------------------------------------------------------------------------------
+static long int peso_arco(grafo g, unsigned int x, unsigned int y) {
+  struct aresta *a;
+
+  /* Devolve o peso da aresta (arco) de x para y, ou infinito */
+  return ((a = procura_arco(g, x, y)) == NULL) ? infinito : a->peso;
+}
+
+//------------------------------------------------------------------------------
+static int compara_alteracoes(const void *a, const void *b) {
+  const struct arco_alterado *x, *y;
+
+  x = (const struct arco_alterado *) a;
+  y = (const struct arco_alterado *) b;
+
+  if(x->origem != y->origem) {
+    return (x->origem < y->origem) ? -1 : 1;
+  }
+
+  return (x->destino < y->destino) ? -1 : (x->destino > y->destino);
+}
+
+//------------------------------------------------------------------------------
+static unsigned int agrupa_alteracoes(grafo g, struct arco_alterado *alteracoes, unsigned int n) {
+  unsigned int i, k;
+
+  /* Um arco alterado mais de uma vez no lote vira um só registro, com o
+     peso de antes do lote e o peso final em g; os registros foram feitos
+     antes de aplicar o lote, então todas as cópias têm o mesmo peso
+     antigo. Os arcos que voltaram ao peso antigo são descartados */
+  qsort(alteracoes, n, sizeof(struct arco_alterado), compara_alteracoes);
+
+  for(i = 0, k = 0; i < n; ++i) {
+    if(i > 0 && alteracoes[i].origem == alteracoes[i - 1].origem && alteracoes[i].destino == alteracoes[i - 1].destino) {
+      continue;
+    }
+
+    alteracoes[k] = alteracoes[i];
+    alteracoes[k].peso_novo = peso_arco(g, alteracoes[k].origem, alteracoes[k].destino);
+
+    if(alteracoes[k].peso_novo != alteracoes[k].peso_antigo) {
+      ++k;
+    }
+  }
+
+  return k;
+}
+
+//------------------------------------------------------------------------------
+static void desfaz_alteracoes(grafo g, struct arco_alterado *alteracoes, unsigned int n) {
+  unsigned int i;
+
+  /* Devolve a g os pesos de antes do lote; num grafo não direcionado a
+     aresta é restaurada uma vez, pelo registro com origem <= destino */
+  for(i = 0; i < n; ++i) {
+    if(g->direcionado || alteracoes[i].origem <= alteracoes[i].destino) {
+      altera_arco(g, alteracoes[i].origem, alteracoes[i].destino, alteracoes[i].peso_antigo);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static int _atualiza_distancias(tabela_distancias t, unsigned int n, vertice *u, vertice *v, long int *peso) {
+  struct arco_alterado *alteracoes;
+  struct area_reparo r;
+  grafo g;
+  long int minimo, maximo;
+  unsigned int i, x, y, n_alteracoes;
+  int retorno;
+
+  g = t->g;
+
+  if(!descompacta_grafo(g)) {
+    return 0;
+  }
+
+  alteracoes = (struct arco_alterado *) malloc(sizeof(struct arco_alterado) * (2 * n + 1));
+
+  if(alteracoes == NULL) {
+    return 0;
+  }
+
+  /* Registra os arcos alterados com os pesos de antes do lote; uma aresta
+     não direcionada altera os arcos nos dois sentidos */
+  for(i = 0, n_alteracoes = 0; i < n; ++i) {
+    if((x = indice_vertice(g, u[i])) == (unsigned int) -1 || (y = indice_vertice(g, v[i])) == (unsigned int) -1) {
+      continue;
+    }
+
+    alteracoes[n_alteracoes].origem = x;
+    alteracoes[n_alteracoes].destino = y;
+    alteracoes[n_alteracoes].peso_antigo = peso_arco(g, x, y);
+    alteracoes[n_alteracoes].peso_novo = peso[i];
+    ++n_alteracoes;
+
+    if(!g->direcionado) {
+      alteracoes[n_alteracoes].origem = y;
+      alteracoes[n_alteracoes].destino = x;
+      alteracoes[n_alteracoes].peso_antigo = alteracoes[n_alteracoes - 1].peso_antigo;
+      alteracoes[n_alteracoes].peso_novo = peso[i];
+      ++n_alteracoes;
+    }
+  }
+
+  /* Aplica as alterações em g, na ordem do lote */
+  for(i = 0; i < n_alteracoes; i += g->direcionado ? 1 : 2) {
+    altera_arco(g, alteracoes[i].origem, alteracoes[i].destino, alteracoes[i].peso_novo);
+  }
+
+  n_alteracoes = agrupa_alteracoes(g, alteracoes, n_alteracoes);
+
+  /* Se os vértices de g mudaram desde o cálculo, ou se g tem pesos
+     negativos (o reparo usa o heap binário), a tabela é refeita; se isso
+     falha, g volta ao que era e a tabela anterior continua valendo */
+  faixa_pesos(g, &minimo, &maximo);
+
+  if(t->n_vertices != g->n_vertices || minimo < 0) {
+    if(!(retorno = calcula_tabela(t))) {
+      desfaz_alteracoes(g, alteracoes, n_alteracoes);
+    }
+
+    free(alteracoes);
+    return retorno;
+  }
+
+  /* O reparo segue os arcos que entram em cada vértice */
+  if(!prepara_entrada(g)) {
+    desfaz_alteracoes(g, alteracoes, n_alteracoes);
+    free(alteracoes);
+    return 0;
+  }
+
+  r.candidato = (unsigned char *) calloc(g->n_vertices + 1, sizeof(unsigned char));
+  r.afetado = (unsigned char *) calloc(g->n_vertices + 1, sizeof(unsigned char));
+  r.tocados = (unsigned int *) malloc(sizeof(unsigned int) * (g->n_vertices + 1));
+  r.afetados = (unsigned int *) malloc(sizeof(unsigned int) * (g->n_vertices + 1));
+  retorno = (r.candidato != NULL && r.afetado != NULL && r.tocados != NULL && r.afetados != NULL &&
+             inicializa_heap(&r.h, g->n_vertices, NULL));
+
+  /* Repara cada linha da tabela (distâncias a partir de cada vértice);
+     se a maioria das primeiras linhas precisou ser recalculada, o lote é
+     grande demais e as demais linhas são recalculadas diretamente */
+  if(retorno) {
+    for(i = 0, x = 0; i < g->n_vertices; ++i) {
+      if(i >= 16 && 2 * x > i) {
+        dijkstra(g, i, t->distancia + (size_t) i * g->n_vertices, NULL, &r.h);
+      } else if(!repara_linha(g, t->distancia + (size_t) i * g->n_vertices, i, alteracoes, n_alteracoes, &r)) {
+        ++x;
+      }
+
+      informa_progresso(g, i + 1, g->n_vertices);
+    }
+
+    destroi_heap(&r.h);
+  } else {
+    desfaz_alteracoes(g, alteracoes, n_alteracoes);
+  }
+
+  free(r.candidato);
+  free(r.afetado);
+  free(r.tocados);
+  free(r.afetados);
+  free(alteracoes);
+  return retorno;
+}
+
+//------------------------------------------------------------------------------
+int atualiza_distancias(tabela_distancias t, unsigned int n, vertice *u, vertice *v, long int *peso) {
+  struct medida m;
+  int retorno;
+
+  inicia_medida(&m);
+  retorno = _atualiza_distancias(t, n, u, v, peso);
+  termina_medida(t->g, &m, FASE_CALCULO);
+  return retorno;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t proximo_aleatorio(uint64_t *estado) {
+  uint64_t z;
+
+  /* splitmix64: sequência reproduzível a partir da semente */
+  z = (*estado += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+//------------------------------------------------------------------------------
+static int compara_arcos(const void *a, const void *b) {
+  const unsigned int *x, *y;
+
+  x = (const unsigned int *) a;
+  y = (const unsigned int *) b;
+
+  if(x[0] != y[0]) {
+    return (x[0] < y[0]) ? -1 : 1;
+  }
+
+  return (x[1] < y[1]) ? -1 : (x[1] > y[1]);
+}
+
+//------------------------------------------------------------------------------
+static grafo gera_grafo(char *nome, unsigned int n, int direcionado, int ponderado, unsigned int *arcos, unsigned int n_arcos, uint64_t *estado) {
+  struct grafo *g;
+  char nome_vertice[16];
+  unsigned int i, x, y;
+
+  /* arcos tem n_arcos pares (origem, destino); laços e arestas repetidas
+     são descartados para que o grafo gerado seja simples */
+  if((g = cria_grafo(nome, direcionado, ponderado)) == NULL) {
+    free(arcos);
+    return NULL;
+  }
+
+  g->vertices = (struct vertice *) malloc(sizeof(struct vertice) * (n + 1));
+
+  if(g->vertices == NULL) {
+    free(arcos);
+    destroi_grafo(g);
+    return NULL;
+  }
+
+  /* Os vértices são criados diretamente, sem a busca por nomes repetidos
+     de insere_vertice, e se chamam v0, v1, ... */
+  for(i = 0; i < n; ++i) {
+    sprintf(nome_vertice, "v%u", i);
+    g->vertices[i].nome = strdup(nome_vertice);
+    inicializa_lista(&g->vertices[i].arestas);
+    g->n_vertices = i + 1;
+
+    if(g->vertices[i].nome == NULL || g->vertices[i].arestas == NULL) {
+      free(arcos);
+      destroi_grafo(g);
+      return NULL;
+    }
+  }
+
+  g->capacidade = n;
+
+  for(i = 0; i < n_arcos; ++i) {
+    if(!direcionado && arcos[2 * i] > arcos[2 * i + 1]) {
+      x = arcos[2 * i];
+      arcos[2 * i] = arcos[2 * i + 1];
+      arcos[2 * i + 1] = x;
+    }
+  }
+
+  qsort(arcos, n_arcos, 2 * sizeof(unsigned int), compara_arcos);
+
+  for(i = 0; i < n_arcos; ++i) {
+    x = arcos[2 * i];
+    y = arcos[2 * i + 1];
+
+    if(x != y && (i == 0 || x != arcos[2 * i - 2] || y != arcos[2 * i - 1])) {
+      insere_aresta(g, g->vertices + x, g->vertices + y, ponderado ? 1 + (long int) (proximo_aleatorio(estado) % 100) : 1);
+    }
+  }
+
+  free(arcos);
+  return g;
+}
+
+//------------------------------------------------------------------------------
+grafo gera_erdos_renyi(unsigned int n, unsigned int m, int direcionado, int ponderado, unsigned int semente) {
+  unsigned int *arcos;
+  unsigned int i;
+  uint64_t estado;
+
+  estado = semente;
+
+  if(n == 0 || (arcos = (unsigned int *) malloc(sizeof(unsigned int) * 2 * (m + 1))) == NULL) {
+    return (n == 0) ? cria_grafo("erdos_renyi", direcionado, ponderado) : NULL;
   }
 
-  return t;
+  /* G(n, m): m pares de vértices sorteados uniformemente */
+  for(i = 0; i < m; ++i) {
+    arcos[2 * i] = (unsigned int) (proximo_aleatorio(&estado) % n);
+    arcos[2 * i + 1] = (unsigned int) (proximo_aleatorio(&estado) % n);
+  }
+
+  return gera_grafo("erdos_renyi", n, direcionado, ponderado, arcos, m, &estado);
 }
 
 //------------------------------------------------------------------------------
-static void _gera_componente(grafo g, lista vertices_componente, unsigned int *n_vertices_componente, unsigned int r) {
-  struct no *n;
-  struct aresta *a;
+grafo gera_rmat(unsigned int escala, unsigned int m, int direcionado, int ponderado, unsigned int semente) {
+  unsigned int *arcos;
+  unsigned int i, nivel, x, y;
+  uint64_t estado, r;
 
-  /* Insere o vértice na lista de vértices do componente apenas se
-     ele ainda não estiver nela */
-  if(!lista_contem(vertices_componente, g->vertices + r)) {
-    insere_cabeca_conteudo(vertices_componente, g->vertices + r);
+  estado = semente;
 
-    /* Percorre todos os vizinhos do vértice e os adiciona no componente */
-    for(n = g->vertices[r].arestas->primeiro; n != NULL; n = n->proximo) {
-      a = (struct aresta *) n->conteudo;
+  if((arcos = (unsigned int *) malloc(sizeof(unsigned int) * 2 * (m + 1))) == NULL) {
+    return NULL;
+  }
 
-      if(a->destino != r) {
-        _gera_componente(g, vertices_componente, n_vertices_componente, a->destino);
-      }
+  /* R-MAT (Kronecker) com probabilidades a = 0.57, b = c = 0.19 e d = 0.05:
+     cada nível escolhe um quadrante da matriz de adjacência */
+  for(i = 0; i < m; ++i) {
+    for(nivel = 0, x = 0, y = 0; nivel < escala; ++nivel) {
+      r = proximo_aleatorio(&estado) % 100;
+      x = 2 * x + (r >= 76);
+      y = 2 * y + ((r >= 57 && r < 76) || r >= 95);
     }
 
-    ++(*n_vertices_componente);
+    arcos[2 * i] = x;
+    arcos[2 * i + 1] = y;
   }
+
+  return gera_grafo("rmat", 1u << escala, direcionado, ponderado, arcos, m, &estado);
 }
 
 //------------------------------------------------------------------------------
-static grafo gera_componente(grafo g, unsigned int r) {
-  struct grafo *componente;
-  struct lista *vertices_componente;
-  struct vertice *v;
-  struct aresta *a, *aresta_componente;
-  struct no *n, *no_arestas;
-  unsigned int n_vertices_componente = 1, count;
-
-  /* Inicializa lista dos vértices do componente */
-  inicializa_lista(&vertices_componente);
-  insere_cabeca_conteudo(vertices_componente, g->vertices + r);
-
-  /* Realiza uma busca adicionando todos os vértices do componente na lista */
-  for(n = g->vertices[r].arestas->primeiro; n != NULL; n = n->proximo) {
-    a = (struct aresta *) n->conteudo;
-
-    /* Se r é origem da aresta, realiza uma busca em largura e vai
-       adicionando os vértices no componente */
-    if(a->destino != r) {
-      _gera_componente(g, vertices_componente, &n_vertices_componente, a->destino);
-    }
-  }
+grafo gera_grade(unsigned int linhas, unsigned int colunas, int ponderado, unsigned int semente) {
+  unsigned int *arcos;
+  unsigned int i, j, n_arcos;
+  uint64_t estado;
 
-  /* Aloca a estrutura do componente */
-  componente = (struct grafo *) malloc(sizeof(struct grafo));
+  estado = semente;
 
-  if(componente != NULL) {
-    /* Inicializa o componente */
-    componente->nome = (char *) NULL;
-    componente->direcionado = g->direcionado;
-    componente->ponderado = g->ponderado;
-    componente->n_vertices = n_vertices_componente;
-    componente->vertices = (struct vertice *) malloc(sizeof(struct vertice) * n_vertices_componente);
+  if((arcos = (unsigned int *) malloc(sizeof(unsigned int) * 4 * (linhas * colunas + 1))) == NULL) {
+    return NULL;
+  }
 
-    /* Percorre todos os vértices da lista */
-    if(componente->vertices != NULL) {
-      /* Adiciona os vértices da lista na estrutura do componente */
-      for(n = vertices_componente->primeiro, count = 0; n != NULL; n = n->proximo, ++count) {
-        v = (struct vertice *) n->conteudo;
+  /* Cada vértice é ligado ao vizinho da direita e ao de baixo */
+  for(i = 0, n_arcos = 0; i < linhas; ++i) {
+    for(j = 0; j < colunas; ++j) {
+      if(j + 1 < colunas) {
+        arcos[2 * n_arcos] = i * colunas + j;
+        arcos[2 * n_arcos++ + 1] = i * colunas + j + 1;
+      }
 
-        componente->vertices[count].nome = strdup(v->nome);
-        componente->vertices[count].arestas = (struct lista *) malloc(sizeof(struct lista));
-        componente->vertices[count].arestas->primeiro = NULL;
+      if(i + 1 < linhas) {
+        arcos[2 * n_arcos] = i * colunas + j;
+        arcos[2 * n_arcos++ + 1] = (i + 1) * colunas + j;
       }
+    }
+  }
 
-      /* Percorre todos os vértices do componente */
-      for(n = vertices_componente->primeiro, count = 0; n != NULL; n = n->proximo, ++count) {
-        v = (struct vertice *) n->conteudo;
+  return gera_grafo("grade", linhas * colunas, 0, ponderado, arcos, n_arcos, &estado);
+}
 
-        /* Percorre todas suas arestas adjacentes */
-        for(no_arestas = v->arestas->primeiro; no_arestas != NULL; no_arestas = no_arestas->proximo) {
-          a = (struct aresta *) no_arestas->conteudo;
+//------------------------------------------------------------------------------
+grafo gera_caminho(unsigned int n, int direcionado, int ponderado, unsigned int semente) {
+  unsigned int *arcos;
+  unsigned int i;
+  uint64_t estado;
 
-          /* Se o vértice é origem na aresta (isso garante que ela seja adicionada apenas uma vez) */
-          if(v == g->vertices + a->origem) {
-            /* Aloca a aresta */
-            aresta_componente = (struct aresta *) malloc(sizeof(struct aresta));
+  estado = semente;
 
-            if(aresta_componente != NULL) {
-              /* Define os elementos da aresta */
-              aresta_componente->origem = count;
-              aresta_componente->destino = encontra_vertice_indice(componente->vertices, componente->n_vertices, g->vertices[a->destino].nome);
-              aresta_componente->peso = a->peso;
+  if((arcos = (unsigned int *) malloc(sizeof(unsigned int) * 2 * (n + 1))) == NULL) {
+    return NULL;
+  }
 
-              /* Insere a aresta na lista de adjacência do vértice no componente */
-              insere_cabeca_conteudo(componente->vertices[count].arestas, aresta_componente);
-            }
-          }
-        }
-      }
-    }
+  /* v0 - v1 - ... - v(n-1) */
+  for(i = 0; i + 1 < n; ++i) {
+    arcos[2 * i] = i;
+    arcos[2 * i + 1] = i + 1;
   }
 
-  destroi_lista(vertices_componente, _mantem);
-  return componente;
+  return gera_grafo("caminho", n, direcionado, ponderado, arcos, (n > 0) ? n - 1 : 0, &estado);
 }
 
 //------------------------------------------------------------------------------
-lista componentes(grafo g) {
-  struct lista *lista_componentes;
-  struct grafo *componente;
-  unsigned int i, v, vertices_processados;
-  unsigned int *vertice_processado;
-
-  /* Inicializa a lista de componentes */
-  inicializa_lista(&lista_componentes);
+grafo gera_arvore(unsigned int n, int ponderado, unsigned int semente) {
+  unsigned int *arcos;
+  unsigned int i;
+  uint64_t estado;
 
-  vertice_processado = (unsigned int *) malloc(sizeof(unsigned int) * g->n_vertices);
+  estado = semente;
 
-  if(vertice_processado != NULL) {
-    /* Marca todos os vértices como não processados */
-    for(i = 0; i < g->n_vertices; ++i) {
-      vertice_processado[i] = 0;
-    }
+  if((arcos = (unsigned int *) malloc(sizeof(unsigned int) * 2 * (n + 1))) == NULL) {
+    return NULL;
+  }
 
-    vertices_processados = 0;
+  /* Árvore aleatória: o pai de cada vértice é sorteado entre os anteriores */
+  for(i = 1; i < n; ++i) {
+    arcos[2 * (i - 1)] = (unsigned int) (proximo_aleatorio(&estado) % i);
+    arcos[2 * (i - 1) + 1] = i;
+  }
 
-    /* Enquanto não forem processados todos os vértices de G */
-    while(vertices_processados < g->n_vertices) {
-      /* Procura um vértice em G ainda não processado */
-      for(v = 0; v < g->n_vertices && vertice_processado[v] == 1; ++v);
+  return gera_grafo("arvore", n, 0, ponderado, arcos, (n > 0) ? n - 1 : 0, &estado);
+}
 
-      /* Gera o componente a qual pertence o vértice encontrado */
-      componente = gera_componente(g, v);
+//------------------------------------------------------------------------------
+grafo gera_dag(unsigned int n, unsigned int m, int ponderado, unsigned int semente) {
+  unsigned int *arcos, *permutacao;
+  unsigned int i, j, x, y;
+  uint64_t estado;
+
+  estado = semente;
+  arcos = (unsigned int *) malloc(sizeof(unsigned int) * 2 * (m + 1));
+  permutacao = (unsigned int *) malloc(sizeof(unsigned int) * (n + 1));
+
+  if(n == 0 || arcos == NULL || permutacao == NULL) {
+    free(arcos);
+    free(permutacao);
+    return (n == 0) ? cria_grafo("dag", 1, ponderado) : NULL;
+  }
 
-      if(componente != NULL) {
-        /* Insere o componente na lista */
-        insere_cabeca_conteudo(lista_componentes, componente);
+  /* Sorteia uma ordem topológica e arcos que a respeitam */
+  for(i = 0; i < n; ++i) {
+    permutacao[i] = i;
+  }
 
-        /* Marca como processados todos os vértices do componente */
-        for(i = 0; i < componente->n_vertices; ++i) {
-          vertice_processado[encontra_vertice_indice(g->vertices, g->n_vertices, componente->vertices[i].nome)] = 1;
-          ++vertices_processados;
-        }
-      }
-    }
+  for(i = n - 1; i > 0; --i) {
+    j = (unsigned int) (proximo_aleatorio(&estado) % (i + 1));
+    x = permutacao[i];
+    permutacao[i] = permutacao[j];
+    permutacao[j] = x;
+  }
 
-    free(vertice_processado);
+  for(i = 0; i < m; ++i) {
+    x = (unsigned int) (proximo_aleatorio(&estado) % n);
+    y = (unsigned int) (proximo_aleatorio(&estado) % n);
+    arcos[2 * i] = permutacao[(x < y) ? x : y];
+    arcos[2 * i + 1] = permutacao[(x < y) ? y : x];
   }
 
-  return lista_componentes;
+  free(permutacao);
+  return gera_grafo("dag", n, 1, ponderado, arcos, m, &estado);
 }
 
 //------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-static void _ordena(grafo g, lista l, unsigned int v, unsigned char *v_processado, unsigned int *v_pai) {
-  struct no *n;
-  struct aresta *a;
+// distâncias a partir de uma fonte sorteada em amostra_distancias: a soma
+// das distâncias aos vértices alcançados, quantos são, a maior delas e seu
+// histograma em faixas de largura potência de 2, dobrada quando uma
+// distância não cabe nas faixas
+
+struct fonte_amostrada {
+  unsigned int v;
+  double fator;
+  double soma;
+  double alcancados;
+  long int excentricidade;
+  long int largura;
+  double faixa[FAIXAS_DISTANCIAS];
+};
 
-  /* Marca o vértice v como processado */
-  v_processado[v] = 1;
+struct tarefa_amostra {
+  grafo g;
+  struct fonte_amostrada *fontes;
+  const struct fila_busca *fila;
+  unsigned int inicio, fim;
+  int sucesso;
+};
 
-  /* Percorre todos os vizinhos do vértice v */
-  for(n = g->vertices[v].arestas->primeiro; n != NULL; n = n->proximo) {
-    a = (struct aresta *) n->conteudo;
+//------------------------------------------------------------------------------
+static void insere_faixa(struct fonte_amostrada *f, long int d) {
+  unsigned int i;
+
+  /* Junta as faixas duas a duas até que d caiba na última */
+  while(d / f->largura >= FAIXAS_DISTANCIAS) {
+    for(i = 0; i < FAIXAS_DISTANCIAS / 2; ++i) {
+      f->faixa[i] = f->faixa[2 * i] + f->faixa[2 * i + 1];
+    }
 
-    /* Se o vértice não está processado, então define v como seu pai e o processa */
-    if(a->destino != v && v_processado[a->destino] == 0) {
-      v_pai[a->destino] = v;
-      _ordena(g, l, a->destino, v_processado, v_pai);
+    for(; i < FAIXAS_DISTANCIAS; ++i) {
+      f->faixa[i] = 0;
     }
+
+    f->largura *= 2;
   }
 
-  /* Adiciona a estrutura do vértice na lista l */
-  insere_cabeca_conteudo(l, g->vertices + v);
+  f->faixa[d / f->largura] += 1;
 }
 
 //------------------------------------------------------------------------------
-lista ordena(grafo g) {
-  struct lista *l;
-  unsigned char *v_processado;
-  unsigned int *v_pai;
-  unsigned int i;
-
-  /* Se o grafo não é direcionado, retorna NULL conforme especificação */
-  if(!g->direcionado) {
+static void *_amostra_fontes(void *p) {
+  struct tarefa_amostra *t;
+  struct fonte_amostrada *f;
+  struct area_trabalho *area;
+  struct heap h;
+  long int d;
+  unsigned int i, w;
+
+  t = (struct tarefa_amostra *) p;
+
+  if((area = pega_area(t->g)) == NULL) {
+    t->sucesso = 0;
     return NULL;
   }
 
-  /* Aloca a lista dos vértices ordenados */
-  l = (struct lista *) malloc(sizeof(struct lista));
+  prepara_fila(&h, area, area->distancia, t->fila);
 
-  if(l != NULL) {
-    /* Aloca os campos de estado (processado ou não) e de pai dos vértices */
-    v_processado = (unsigned char *) malloc(sizeof(unsigned char) * g->n_vertices);
-    v_pai = (unsigned int *) malloc(sizeof(unsigned int) * g->n_vertices);
+  for(i = t->inicio; i < t->fim && t->sucesso; ++i) {
+    f = t->fontes + i;
+    dijkstra(t->g, f->v, area->distancia, NULL, &h);
 
-    if(v_processado != NULL && v_pai != NULL) {
-      /* Inicializa a lista l */
-      l->primeiro = NULL;
+    f->soma = 0;
+    f->alcancados = 0;
+    f->excentricidade = 0;
+    f->largura = 1;
+    memset(f->faixa, 0, sizeof(f->faixa));
 
-      /* Marca todos os vértices não processados com pais indefinidos */
-      for(i = 0; i < g->n_vertices; ++i) {
-        v_processado[i] = 0;
-        v_pai[i] = (unsigned int) -1;
+    for(w = 0; w < t->g->n_vertices; ++w) {
+      if(w == f->v || (d = area->distancia[w]) == infinito) {
+        continue;
       }
 
-      /* Percorre todos os vértices e os ordena */
-      for(i = 0; i < g->n_vertices; ++i) {
-        if(!v_processado[i]) {
-          v_pai[i] = i;
-          _ordena(g, l, i, v_processado, v_pai);
-        }
+      /* O histograma só cobre distâncias não negativas */
+      if(d < 0) {
+        t->sucesso = 0;
+        break;
       }
 
-      free(v_processado);
-      free(v_pai);
+      f->soma += (double) d;
+      f->alcancados += 1;
+      f->excentricidade = (d > f->excentricidade) ? d : f->excentricidade;
+      insere_faixa(f, d);
     }
   }
 
-  return l;
+  devolve_area(t->g, area);
+  return NULL;
 }
 
 //------------------------------------------------------------------------------
-grafo arborescencia_caminhos_minimos(grafo g, vertice r) {
-  struct grafo *t;
-  struct aresta *a, *aresta_selecionada;
-  struct no *n;
-  long int menor_distancia;
-  unsigned int i, v;
-  unsigned int *vertice_processado, *distancias;
+static void estima_razao(struct fonte_amostrada *fontes, unsigned int k, double *x, double total, double correcao, double *razao, double *erro) {
+  double e, soma, soma_quadrados;
+  unsigned int i;
 
-  /* Encontra o id do vértice raiz r no grafo g */
-  if((v = encontra_vertice_indice(g->vertices, g->n_vertices, r->nome)) == -1) {
-    return NULL;
+  /* Estimador de razão: a razão entre o total de x e o total de pares
+     alcançáveis, com a variância pela linearização dos resíduos
+     x - razao * alcancados, cada fonte pesada pelo seu fator */
+  for(i = 0, soma = 0; i < k; ++i) {
+    soma += fontes[i].fator * x[i];
   }
 
-  /* Aloca a estrutura da arborescência */
-  t = (struct grafo *) malloc(sizeof(struct grafo));
+  *razao = (total > 0) ? soma / total : 0;
 
-  if(t != NULL) {
-    /* Aloca os vértices da arborescência, seus estados (processado ou não) e suas distâncias */
-    t->vertices = (struct vertice *) malloc(sizeof(struct vertice) * g->n_vertices);
-    vertice_processado = (unsigned int *) malloc(sizeof(unsigned int) * g->n_vertices);
-    distancias = (unsigned int *) malloc(sizeof(unsigned int) * g->n_vertices);
+  if(total <= 0 || correcao == 0) {
+    *erro = 0;
+    return;
+  }
 
-    if(t->vertices != NULL && vertice_processado != NULL && distancias != NULL) {
-      /* Inicializa a arborescência */
-      t->nome = NULL;
-      t->n_vertices = g->n_vertices;
-      t->ponderado = g->ponderado;
-      t->direcionado = 1;
+  if(k < 2) {
+    *erro = HUGE_VAL;
+    return;
+  }
 
-      /* Inicializa os vértices da arborescência e marca todos como não processado */
-      for(i = 0; i < g->n_vertices; ++i) {
-        t->vertices[i].nome = strdup(g->vertices[i].nome);
-        t->vertices[i].arestas = (struct lista *) malloc(sizeof(struct lista));
-        t->vertices[i].arestas->primeiro = NULL;
+  for(i = 0, soma_quadrados = 0; i < k; ++i) {
+    e = k * fontes[i].fator * (x[i] - *razao * fontes[i].alcancados);
+    soma_quadrados += e * e;
+  }
 
-        vertice_processado[i] = 0;
-      }
+  *erro = 1.96 * sqrt(correcao * soma_quadrados / ((double) k * (k - 1))) / total;
+}
 
-      /* Marca como processado o vértice raiz e define sua distância 0 */
-      vertice_processado[v] = 1;
-      distancias[v] = 0;
+//------------------------------------------------------------------------------
+static int _amostra_distancias(grafo g, unsigned int k, int por_grau, unsigned int semente, struct amostra_distancias *a) {
+  struct fonte_amostrada *fontes;
+  struct tarefa_amostra *tarefas;
+  double *acumulado, *x;
+  double total, soma_quadrados, e, correcao;
+  long int inferior, superior;
+  unsigned int *permutacao;
+  unsigned int i, j, n_tarefas, tamanho, faixa;
+  struct fila_busca fila;
+  uint64_t estado;
+  int sucesso;
+
+  memset(a, 0, sizeof(struct amostra_distancias));
+  a->largura_faixa = 1;
+
+  if(g->n_vertices == 0 || k == 0) {
+    return g->n_vertices == 0;
+  }
 
-      do {
-        aresta_selecionada = NULL;
-        menor_distancia = infinito;
+  /* Sem reposição, k vértices distintos bastam para o cálculo exato */
+  if(!por_grau && k > g->n_vertices) {
+    k = g->n_vertices;
+  }
 
-        /* Seleciona a aresta da fronteira menor caminho, i.e. a aresta cuja
-           soma da distância da raiz até ela mais o seu peso (d(r, a) + a->peso)
-           seja mínima */
-        for(i = 0; i < g->n_vertices; ++i) {
-          if(vertice_processado[i] == 1) {
-            for(n = g->vertices[i].arestas->primeiro; n != NULL; n = n->proximo) {
-              a = (struct aresta *) n->conteudo;
-
-              /* Se o vértice não foi processado ainda, ou seja, faz parte da fronteira */
-              if(vertice_processado[a->destino] == 0) {
-                /* Seleciona a aresta apenas se tiver distância menor que a já selecionada */
-                if(menor_distancia > distancias[i] + a->peso) {
-                  menor_distancia = distancias[i] + a->peso;
-                  aresta_selecionada = a;
-                }
-              }
-            }
-          }
-        }
+  fontes = (struct fonte_amostrada *) malloc(sizeof(struct fonte_amostrada) * k);
+  permutacao = por_grau ? NULL : (unsigned int *) malloc(sizeof(unsigned int) * g->n_vertices);
+  acumulado = por_grau ? (double *) malloc(sizeof(double) * (g->n_vertices + 1)) : NULL;
+  x = (double *) malloc(sizeof(double) * k);
 
-        if(aresta_selecionada != NULL) {
-          /* Marca o vértice como processado e armazena sua distância */
-          vertice_processado[aresta_selecionada->destino] = 1;
-          distancias[aresta_selecionada->destino] = menor_distancia;
+  if(fontes == NULL || (permutacao == NULL && acumulado == NULL) || x == NULL) {
+    free(fontes);
+    free(permutacao);
+    free(acumulado);
+    free(x);
+    return 0;
+  }
 
-          /* Aloca a nova aresta da arborescência */
-          a = (struct aresta *) malloc(sizeof(struct aresta));
+  estado = semente;
 
-          if(a != NULL) {
-            /* Define os elementos da aresta */
-            a->origem = aresta_selecionada->origem;
-            a->destino = aresta_selecionada->destino;
-            a->peso = aresta_selecionada->peso;
+  if(!por_grau) {
+    /* Amostra uniforme sem reposição: as k primeiras posições de um
+       embaralhamento parcial */
+    for(i = 0; i < g->n_vertices; ++i) {
+      permutacao[i] = i;
+    }
 
-            /* Insere a aresta na arborescência */
-            insere_cabeca_conteudo(t->vertices[aresta_selecionada->origem].arestas, a);
-          }
-        }
-      } while(aresta_selecionada != NULL);
+    for(i = 0; i < k; ++i) {
+      j = i + (unsigned int) (proximo_aleatorio(&estado) % (g->n_vertices - i));
+      fontes[i].v = permutacao[j];
+      fontes[i].fator = (double) g->n_vertices / k;
+      permutacao[j] = permutacao[i];
+    }
 
-      free(distancias);
-      free(vertice_processado);
+    correcao = 1 - (double) k / g->n_vertices;
+  } else {
+    /* Amostra com reposição, cada vértice com probabilidade proporcional
+       ao seu grau de saída mais 1, pesado pelo inverso dela */
+    for(acumulado[0] = 0, i = 0; i < g->n_vertices; ++i) {
+      acumulado[i + 1] = acumulado[i] + grau_saida(g, g->vertices + i) + 1;
     }
-  }
 
-  return t;
-}
+    for(i = 0; i < k; ++i) {
+      e = ldexp((double) (proximo_aleatorio(&estado) >> 11), -53) * acumulado[g->n_vertices];
 
-//------------------------------------------------------------------------------
-static void computa_distancia(struct grafo *dis, struct grafo *acm, unsigned int v, struct no *n, long int d, unsigned int *v_processado) {
-  struct no *p;
-  struct aresta *a, *aresta_p, *aresta_distancia;
+      for(j = 0, tamanho = g->n_vertices; tamanho > 1; ) {
+        if(acumulado[j + tamanho / 2] <= e) {
+          j += tamanho / 2;
+          tamanho -= tamanho / 2;
+        } else {
+          tamanho /= 2;
+        }
+      }
 
-  /* Aloca a aresta de distância */
-  aresta_distancia = (struct aresta *) malloc(sizeof(struct aresta));
+      fontes[i].v = j;
+      fontes[i].fator = acumulado[g->n_vertices] / ((acumulado[j + 1] - acumulado[j]) * k);
+    }
 
-  if(aresta_distancia != NULL) {
-    a = (struct aresta *) n->conteudo;
+    correcao = 1;
+  }
 
-    /* Define os elementos da aresta de distância a partir da aresta do nó */
-    aresta_distancia->origem = v;
-    aresta_distancia->destino = a->destino;
-    aresta_distancia->peso = d;
+  /* As buscas a partir das fontes são divididas entre os threads, cada um
+     com uma área de trabalho da reserva de g e a mesma fila de prioridade */
+  sucesso = escolhe_fila(g, &fila);
+  n_tarefas = numero_threads();
+  n_tarefas = (n_tarefas < k) ? n_tarefas : k;
+
+  if(!sucesso || (tarefas = (struct tarefa_amostra *) malloc(sizeof(struct tarefa_amostra) * n_tarefas)) == NULL) {
+    sucesso = 0;
+  } else {
+    for(i = 0; i < n_tarefas; ++i) {
+      tarefas[i].g = g;
+      tarefas[i].fontes = fontes;
+      tarefas[i].fila = &fila;
+      tarefas[i].inicio = (unsigned int) ((unsigned long) k * i / n_tarefas);
+      tarefas[i].fim = (unsigned int) ((unsigned long) k * (i + 1) / n_tarefas);
+      tarefas[i].sucesso = 1;
+    }
 
-    /* Insere a aresta de distância na lista de adjacência do vértice no
-       grafo de distâncias */
-    insere_cabeca_conteudo(dis->vertices[v].arestas, aresta_distancia);
+    executa_paralelo(_amostra_fontes, tarefas, sizeof(struct tarefa_amostra), n_tarefas);
 
-    /* Percorre o resto dos vértices da arborescência de caminhos mínimos
-       de v, acumulando seus pesos e armazenando em d (onde d é a distância da aresta atual) */
-    for(p = acm->vertices[a->destino].arestas->primeiro; p != NULL; p = p->proximo) {
-      aresta_p = (struct aresta *) p->conteudo;
-      computa_distancia(dis, acm, v, p, d + aresta_p->peso, v_processado);
+    for(i = 0; i < n_tarefas; ++i) {
+      sucesso = sucesso && tarefas[i].sucesso;
     }
 
-    /* Marca o vértice destino da aresta como processado */
-    v_processado[a->destino] = 1;
+    free(tarefas);
   }
-}
-
-//------------------------------------------------------------------------------
-grafo distancias(grafo g) {
-  struct grafo *dis, *acm;
-  struct no *n;
-  struct aresta *a;
-  unsigned int *v_processado;
-  unsigned int i, j;
 
-  /* Aloca o grafo de distâncias */
-  dis = (struct grafo *) malloc(sizeof(struct grafo));
+  free(fila.potencial);
 
-  if(dis != NULL) {
-    /* Aloca os vértices do grafo de distâncias e seus estados (processado ou não) */
-    dis->vertices = (struct vertice *) malloc(sizeof(struct vertice) * g->n_vertices);
-    v_processado = (unsigned int *) malloc(sizeof(unsigned int) * g->n_vertices);
+  /* Os limites do diâmetro são os de limites_diametro, com o inferior
+     aumentado pela maior excentricidade das fontes */
+  if(sucesso && (sucesso = _limites_diametro(g, &inferior, &superior))) {
+    a->fontes = k;
+    a->diametro_inferior = inferior;
+    a->diametro_superior = superior;
 
-    if(dis->vertices != NULL && v_processado != NULL) {
-      /* Inicializa os vértices do grafo de distâncias */
-      for(i = 0; i < g->n_vertices; ++i) {
-        dis->vertices[i].arestas = (struct lista *) malloc(sizeof(struct lista));
-        dis->vertices[i].arestas->primeiro = NULL;
-        dis->vertices[i].nome = strdup(g->vertices[i].nome);
-      }
+    for(i = 0; i < k; ++i) {
+      a->diametro_inferior = (fontes[i].excentricidade > a->diametro_inferior) ? fontes[i].excentricidade : a->diametro_inferior;
+      a->largura_faixa = (fontes[i].largura > a->largura_faixa) ? fontes[i].largura : a->largura_faixa;
+    }
 
-      /* Inicializa o grafo de distâncias */
-      dis->nome = NULL;
-      dis->n_vertices = g->n_vertices;
-      dis->direcionado = g->direcionado;
-      dis->ponderado = 1;
+    /* Total de pares alcançáveis, pelo estimador de Horvitz-Thompson */
+    for(i = 0, total = 0; i < k; ++i) {
+      total += fontes[i].fator * fontes[i].alcancados;
+    }
 
-      /* Percorre todos os vértices do grafo g */
-      for(i = 0; i < g->n_vertices; ++i) {
-        /* Gera uma arborescência de caminhos mínimos para cada vértice em g */
-        acm = arborescencia_caminhos_minimos(g, g->vertices + i);
+    a->pares_alcancaveis = total;
 
-        /* Marca todos os vértices como não processados */
-        for(j = 0; j < g->n_vertices; ++j) {
-          v_processado[j] = 0;
-        }
+    if(correcao == 0) {
+      a->erro_pares_alcancaveis = 0;
+    } else if(k < 2) {
+      a->erro_pares_alcancaveis = HUGE_VAL;
+    } else {
+      for(i = 0, soma_quadrados = 0; i < k; ++i) {
+        e = k * fontes[i].fator * fontes[i].alcancados - total;
+        soma_quadrados += e * e;
+      }
 
-        /* Marca o vértice raiz da árvore como processado */
-        v_processado[i] = 1;
+      a->erro_pares_alcancaveis = 1.96 * sqrt(correcao * soma_quadrados / ((double) k * (k - 1)));
+    }
 
-        /* Vai percorrendo a arborescência, gerando as arestas e as adicionando
-           no grafo de distâncias */
-        for(n = acm->vertices[i].arestas->primeiro; n != NULL; n = n->proximo) {
-          a = (struct aresta *) n->conteudo;
-          computa_distancia(dis, acm, i, n, a->peso, v_processado);
-        }
+    for(i = 0; i < k; ++i) {
+      x[i] = fontes[i].soma;
+    }
 
-        /* Se existir algum vértice não processado, então ele não é
-           alcançável a partir de i e a distância de i à ele é infinita */
-        for(j = 0; j < g->n_vertices; ++j) {
-          if(v_processado[j] == 0) {
-            /* Aloca a aresta de distância */
-            a = (struct aresta *) malloc(sizeof(struct aresta));
+    estima_razao(fontes, k, x, total, correcao, &a->media, &a->erro_media);
 
-            if(a != NULL) {
-              /* Inicializa a aresta com peso infinito */
-              a->origem = i;
-              a->destino = j;
-              a->peso = infinito;
+    /* As faixas de cada fonte são juntadas na largura comum, que é a maior
+       delas (as larguras são potências de 2) */
+    for(j = 0; j < FAIXAS_DISTANCIAS; ++j) {
+      for(i = 0; i < k; ++i) {
+        x[i] = 0;
+      }
 
-              /* Insere a aresta na lista de adjacência de i no grafo de distâncias */
-              insere_cabeca_conteudo(dis->vertices[i].arestas, a);
-            }
+      for(i = 0; i < k; ++i) {
+        for(faixa = 0; faixa < FAIXAS_DISTANCIAS; ++faixa) {
+          if(faixa * fontes[i].largura / a->largura_faixa == j) {
+            x[i] += fontes[i].faixa[faixa];
           }
         }
-
-        /* Destroi a arborescência */
-        destroi_grafo(acm);
       }
 
-      free(v_processado);
+      estima_razao(fontes, k, x, total, correcao, &a->fracao[j], &a->erro_fracao[j]);
     }
   }
 
-  return dis;
+  free(fontes);
+  free(permutacao);
+  free(acumulado);
+  free(x);
+  return sucesso;
 }
 
 //------------------------------------------------------------------------------
-static void _busca_profundidade_transposta(grafo g, unsigned int v, unsigned int *t_pre, unsigned int *t_pos, unsigned int *pre, unsigned int *pos) {
-  struct no *n;
-  struct aresta *a;
+int amostra_distancias(grafo g, unsigned int k, int por_grau, unsigned int semente, struct amostra_distancias *a) {
+  struct medida m;
+  int sucesso;
+
+  inicia_medida(&m);
+  sucesso = _amostra_distancias(g, k, por_grau, semente, a);
+  termina_medida(g, &m, FASE_CALCULO);
+  return sucesso;
+}
+
+//------------------------------------------------------------------------------
+// contadores HyperLogLog da função de vizinhança (funcao_vizinhanca): cada
+// vértice tem 2^bits registradores de um byte, numa matriz por iteração
+
+struct tarefa_vizinhanca {
+  grafo g;
+  unsigned int bits;
+  unsigned char *atual;
+  unsigned char *proximo;
+  unsigned int inicio, fim;
+  int mudou;
+  double soma;
+};
+
+//------------------------------------------------------------------------------
+static double estima_cardinalidade(const unsigned char *registradores, unsigned int bits) {
+  double m, soma, alfa, estimativa;
+  unsigned int i, zeros;
+
+  m = (double) (1u << bits);
 
-  /* Define a pré-ordem de v */
-  if(t_pre != NULL && pre != NULL) {
-    pre[v] = ++(*t_pre);
+  for(i = 0, soma = 0, zeros = 0; i < (1u << bits); ++i) {
+    soma += ldexp(1.0, -(int) registradores[i]);
+    zeros += (registradores[i] == 0);
   }
 
-  /* Percorre todos os vizinhos de v */
-  for(n = g->vertices[v].arestas->primeiro; n != NULL; n = n->proximo) {
-    a = (struct aresta *) n->conteudo;
+  switch(bits) {
+    case 4: alfa = 0.673; break;
+    case 5: alfa = 0.697; break;
+    case 6: alfa = 0.709; break;
+    default: alfa = 0.7213 / (1 + 1.079 / m); break;
+  }
+
+  estimativa = alfa * m * m / soma;
+
+  /* Correção para conjuntos pequenos (contagem linear) */
+  if(estimativa <= 2.5 * m && zeros > 0) {
+    estimativa = m * log(m / zeros);
+  }
+
+  return estimativa;
+}
 
-    /* Faz a busca em profundidade transposta (i.e. considerando g transposto)
-       nos vizinhos não processados */
-    if(a->origem != v) {
-      if(pre[a->origem] == 0) {
-        _busca_profundidade_transposta(g, a->origem, t_pre, t_pos, pre, pos);
+//------------------------------------------------------------------------------
+static void *_itera_vizinhanca(void *p) {
+  struct tarefa_vizinhanca *t;
+  struct cursor c;
+  unsigned char *destino, *origem;
+  long int peso;
+  size_t m;
+  unsigned int v, w, i;
+
+  t = (struct tarefa_vizinhanca *) p;
+  m = (size_t) 1 << t->bits;
+  t->mudou = 0;
+  t->soma = 0;
+
+  /* A bola de raio r + 1 em torno de v é v mais as bolas de raio r dos
+     vértices para os quais sai um arco de v: une os contadores deles,
+     registrador a registrador, pelo máximo */
+  for(v = t->inicio; v < t->fim; ++v) {
+    destino = t->proximo + v * m;
+    memcpy(destino, t->atual + v * m, m);
+
+    for(inicia_cursor(t->g, v, 0, &c); proximo_arco(&c, &w, &peso); ) {
+      origem = t->atual + w * m;
+
+      for(i = 0; i < m; ++i) {
+        if(origem[i] > destino[i]) {
+          destino[i] = origem[i];
+          t->mudou = 1;
+        }
       }
     }
-  }
 
-  /* Define a pós-ordem de v */
-  if(t_pos != NULL && pos != NULL) {
-    pos[v] = ++(*t_pos);
+    t->soma += estima_cardinalidade(destino, t->bits);
   }
+
+  return NULL;
 }
 
 //------------------------------------------------------------------------------
-static void _busca_profundidade(grafo g, unsigned int v, unsigned int *t_pre, unsigned int *t_pos, unsigned int *pre, unsigned int *pos) {
-  struct no *n;
-  struct aresta *a;
+static unsigned int _funcao_vizinhanca(grafo g, unsigned int bits, unsigned int semente, double *vizinhanca, unsigned int maximo) {
+  struct tarefa_vizinhanca *tarefas;
+  unsigned char *atual, *proximo, *troca;
+  size_t m;
+  uint64_t estado, hash;
+  unsigned int v, i, t, n_tarefas, posto;
+  int mudou;
+
+  if(maximo == 0 || bits < 4 || bits > 16) {
+    return 0;
+  }
 
-  /* Define a pré-ordem de v */
-  if(t_pre != NULL && pre != NULL) {
-    pre[v] = ++(*t_pre);
+  m = (size_t) 1 << bits;
+  atual = (unsigned char *) calloc((size_t) g->n_vertices * m + 1, sizeof(unsigned char));
+  proximo = (unsigned char *) malloc((size_t) g->n_vertices * m + 1);
+  n_tarefas = numero_threads();
+  n_tarefas = (g->n_vertices < n_tarefas) ? ((g->n_vertices > 0) ? g->n_vertices : 1) : n_tarefas;
+  tarefas = (struct tarefa_vizinhanca *) malloc(sizeof(struct tarefa_vizinhanca) * n_tarefas);
+
+  if(atual == NULL || proximo == NULL || tarefas == NULL) {
+    free(atual);
+    free(proximo);
+    free(tarefas);
+    return 0;
   }
 
-  /* Percorre todos os vizinhos de v */
-  for(n = g->vertices[v].arestas->primeiro; n != NULL; n = n->proximo) {
-    a = (struct aresta *) n->conteudo;
+  /* A bola de raio 0 de cada vértice é ele mesmo: o hash do vértice
+     escolhe o registrador e a posição do seu primeiro bit 1 */
+  for(v = 0; v < g->n_vertices; ++v) {
+    estado = ((uint64_t) semente << 32) ^ v;
+    hash = proximo_aleatorio(&estado);
 
-    /* Faz a busca em profundidade nos vizinhos não processados */
-    if(a->destino != v) {
-      if(pre[a->destino] == 0) {
-        _busca_profundidade(g, a->destino, t_pre, t_pos, pre, pos);
-      }
-    }
+    for(posto = 1; posto <= 64 - bits && !((hash << bits) & ((uint64_t) 1 << (64 - posto))); ++posto);
+
+    atual[v * m + (hash >> (64 - bits))] = (unsigned char) posto;
   }
 
-  /* Define a pós-ordem de v */
-  if(t_pos != NULL && pos != NULL) {
-    pos[v] = ++(*t_pos);
+  for(v = 0, vizinhanca[0] = 0; v < g->n_vertices; ++v) {
+    vizinhanca[0] += estima_cardinalidade(atual + v * m, bits);
   }
-}
 
-//------------------------------------------------------------------------------
-static void busca_profundidade(grafo g, unsigned int **pre, unsigned int **pos) {
-  unsigned int i, t_pre = 0, t_pos = 0;
+  for(i = 0; i < n_tarefas; ++i) {
+    tarefas[i].g = g;
+    tarefas[i].bits = bits;
+    tarefas[i].inicio = (unsigned int) ((unsigned long) g->n_vertices * i / n_tarefas);
+    tarefas[i].fim = (unsigned int) ((unsigned long) g->n_vertices * (i + 1) / n_tarefas);
+  }
 
-  /* Aloca os vetores de ordenação em pré-ordem e pós-ordem */
-  *pre = (unsigned int *) malloc(g->n_vertices * sizeof(unsigned int));
-  *pos = (unsigned int *) malloc(g->n_vertices * sizeof(unsigned int));
+  /* Cada iteração aumenta o raio em 1 até que nenhum contador mude */
+  for(t = 1; t < maximo; ++t) {
+    for(i = 0; i < n_tarefas; ++i) {
+      tarefas[i].atual = atual;
+      tarefas[i].proximo = proximo;
+    }
 
-  if(*pre != NULL && *pos != NULL) {
-    /* Define todas as pré-ordens como 0 */
-    for(i = 0; i < g->n_vertices; ++i) {
-      (*pre)[i] = 0;
+    executa_paralelo(_itera_vizinhanca, tarefas, sizeof(struct tarefa_vizinhanca), n_tarefas);
+
+    for(i = 0, mudou = 0, vizinhanca[t] = 0; i < n_tarefas; ++i) {
+      mudou = mudou || tarefas[i].mudou;
+      vizinhanca[t] += tarefas[i].soma;
     }
 
-    /* Percorre todos os vértices realizando a busca em profundidade */
-    for(i = 0; i < g->n_vertices; ++i) {
-      if((*pre)[i] == 0) {
-        _busca_profundidade(g, i, &t_pre, &t_pos, *pre, *pos);
-      }
+    troca = atual;
+    atual = proximo;
+    proximo = troca;
+
+    if(!mudou) {
+      break;
     }
   }
+
+  free(atual);
+  free(proximo);
+  free(tarefas);
+  return t;
 }
 
 //------------------------------------------------------------------------------
-int fortemente_conexo(grafo g) {
-  unsigned int *pre, *pos;
-  unsigned int i, v, t, max_pos, n_trees;
+unsigned int funcao_vizinhanca(grafo g, unsigned int bits, unsigned int semente, double *vizinhanca, unsigned int maximo) {
+  struct medida m;
+  unsigned int n;
+
+  inicia_medida(&m);
+  n = _funcao_vizinhanca(g, bits, semente, vizinhanca, maximo);
+  termina_medida(g, &m, FASE_CALCULO);
+  return n;
+}
 
-  /* Realiza uma busca em profundidade em g */
-  busca_profundidade(g, &pre, &pos);
+//------------------------------------------------------------------------------
+struct estatisticas estatisticas(grafo g) {
+  struct estatisticas e;
+
+  e.chamadas = __atomic_load_n(&g->contadores.chamadas, __ATOMIC_RELAXED);
+  e.arestas_examinadas = __atomic_load_n(&g->contadores.arestas_examinadas, __ATOMIC_RELAXED);
+  e.vertices_fixados = __atomic_load_n(&g->contadores.vertices_fixados, __ATOMIC_RELAXED);
+  e.operacoes_heap = __atomic_load_n(&g->contadores.operacoes_heap, __ATOMIC_RELAXED);
+  e.alocacoes = __atomic_load_n(&g->contadores.alocacoes, __ATOMIC_RELAXED);
+  e.bytes_alocados = __atomic_load_n(&g->contadores.bytes_alocados, __ATOMIC_RELAXED);
+  e.segundos_carga = __atomic_load_n(&g->contadores.nanossegundos[FASE_CARGA], __ATOMIC_RELAXED) / 1e9;
+  e.segundos_conversao = __atomic_load_n(&g->contadores.nanossegundos[FASE_CONVERSAO], __ATOMIC_RELAXED) / 1e9;
+  e.segundos_indice = __atomic_load_n(&g->contadores.nanossegundos[FASE_INDICE], __ATOMIC_RELAXED) / 1e9;
+  e.segundos_calculo = __atomic_load_n(&g->contadores.nanossegundos[FASE_CALCULO], __ATOMIC_RELAXED) / 1e9;
+  e.segundos_saida = __atomic_load_n(&g->contadores.nanossegundos[FASE_SAIDA], __ATOMIC_RELAXED) / 1e9;
+  e.resultados_reusados = __atomic_load_n(&g->contadores.resultados_reusados, __ATOMIC_RELAXED);
+  e.resultados_calculados = __atomic_load_n(&g->contadores.resultados_calculados, __ATOMIC_RELAXED);
+
+  return e;
+}
 
-  if(pre != NULL && pos != NULL) {
-    t = 0;
-    n_trees = 0;
+//------------------------------------------------------------------------------
+void zera_estatisticas(grafo g) {
+  memset(&g->contadores, 0, sizeof(struct contadores));
+}
 
-    /* Define como 0 todas as pré-ordens (não serão utilizadas) */
-    for(i = 0; i < g->n_vertices; ++i) {
-      pre[i] = 0;
-    }
+//------------------------------------------------------------------------------
+grafo escreve_estatisticas(FILE *output, grafo g) {
+  struct estatisticas e;
 
-    /* Faz outra busca em profundidade, desta vez em ordem descrescente
-       de pós-ordem e considerando g transposto */
-    do {
-      max_pos = 0;
+  e = estatisticas(g);
 
-      /* Obtém o vértice de maior pós ordem não processado */
-      for(i = g->n_vertices; i > 0; --i) {
-        if(pre[i - 1] == 0 && max_pos < pos[i - 1]) {
-          max_pos = pos[i - 1];
-          v = i - 1;
-        }
-      }
+  fprintf(output, "{\"instrumentado\": %d, \"chamadas\": %lu", ESTATISTICAS_COLETADAS, e.chamadas);
+  fprintf(output, ", \"arestas_examinadas\": %lu, \"vertices_fixados\": %lu, \"operacoes_heap\": %lu", e.arestas_examinadas, e.vertices_fixados, e.operacoes_heap);
+  fprintf(output, ", \"alocacoes\": %lu, \"bytes_alocados\": %lu", e.alocacoes, e.bytes_alocados);
+  fprintf(output, ", \"resultados\": {\"reusados\": %lu, \"calculados\": %lu}", e.resultados_reusados, e.resultados_calculados);
+  fprintf(output, ", \"segundos\": {\"carga\": %.9f, \"conversao\": %.9f, \"indice\": %.9f, \"calculo\": %.9f, \"saida\": %.9f}}\n",
+          e.segundos_carga, e.segundos_conversao, e.segundos_indice, e.segundos_calculo, e.segundos_saida);
 
-      /* Realiza a busca a partir deste vértice */
-      if(max_pos != 0) {
-        _busca_profundidade_transposta(g, v, &t, NULL, pre, NULL);
-        /* Aumenta o número de subgrafos gerados pela busca */
-        ++n_trees;
-      }
-    } while(max_pos != 0);
+  return g;
+}
+
+//------------------------------------------------------------------------------
+void define_progresso(grafo g, void progresso(void *dados, unsigned int feitos, unsigned int total), void *dados) {
+  g->progresso = progresso;
+  g->dados_progresso = dados;
+}
+
+//------------------------------------------------------------------------------
+controle cria_controle(double segundos, const char *arquivo, double intervalo) {
+  struct controle *c;
+
+  if((c = (struct controle *) malloc(sizeof(struct controle))) == NULL) {
+    return NULL;
+  }
+
+  c->prazo = (segundos > 0) ? relogio() + (unsigned long) (segundos * 1e9) : 0;
+  c->intervalo = (intervalo > 0) ? (unsigned long) (intervalo * 1e9) : 0;
+  c->arquivo = NULL;
+  c->cancelado = 0;
+  c->interrompido = 0;
 
-    free(pre);
-    free(pos);
+  if(arquivo != NULL && (c->arquivo = strdup(arquivo)) == NULL) {
+    free(c);
+    return NULL;
   }
 
-  /* Se existe apenas um subgrafo gerado pela busca, então g é fortemente
-     conexo, caso contrário g não é fortemente conexo */
-  return (n_trees < 2) ? 1 : 0;
+  return c;
 }
 
 //------------------------------------------------------------------------------
-long int diametro(grafo g) {
-  struct grafo *dis;
-  struct no *n;
-  struct aresta *a;
-  long int diametro = 0;
-  unsigned int i;
+void cancela_controle(controle c) {
+  __atomic_store_n(&c->cancelado, 1, __ATOMIC_RELEASE);
+}
 
-  /* Obtêm o grafo de distâncias de g */
-  dis = distancias(g);
+//------------------------------------------------------------------------------
+int interrompido(controle c) {
+  return __atomic_load_n(&c->interrompido, __ATOMIC_RELAXED);
+}
 
-  /* Percorre todas as arestas de g */
-  for(i = 0; i < dis->n_vertices; ++i) {
-    for(n = dis->vertices[i].arestas->primeiro; n != NULL; n = n->proximo) {
-      a = (struct aresta *) n->conteudo;
+//------------------------------------------------------------------------------
+int destroi_controle(void *c) {
+  if(c != NULL) {
+    free(((struct controle *) c)->arquivo);
+    free(c);
+  }
 
-      /* Se o peso da aresta é maior que o diametro e não é infinito,
-         armazena-o no diametro */
-      if(diametro < a->peso && a->peso != infinito) {
-        diametro = a->peso;
-      }
-    }
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+void define_controle(grafo g, controle c) {
+  g->controle = c;
+}
+
+//------------------------------------------------------------------------------
+void define_fila(grafo g, int fila) {
+  g->fila = fila;
+}
+
+//------------------------------------------------------------------------------
+void define_threads(unsigned int n) {
+  __atomic_store_n(&threads_definidos, n, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+size_t estima_memoria(grafo g, int operacao) {
+  size_t condensa, a, b;
+  unsigned int n_tarefas;
+  int escolha;
+
+  /* Cada operação com a estratégia que ela escolheria sob o orçamento, ou
+     com a mais barata se nenhuma cabe; a condensação, que as buscas de
+     distâncias e os componentes fortemente conexos calculam antes, entra
+     da mesma forma */
+  a = memoria_condensacao(g, 0);
+  b = memoria_condensacao(g, 1);
+  escolha = condensacao_preferida(g);
+  condensa = (escolha == 0 || (escolha < 0 && a <= b)) ? a : b;
+
+  switch(operacao) {
+    case OPERACAO_DISTANCIAS:
+      a = memoria_linhas(g, memoria_distancias(g, 0), &n_tarefas);
+      b = memoria_linhas(g, memoria_distancias(g, 1), &n_tarefas);
+      return soma_memoria(condensa, cabe_orcamento(a) ? a : b);
+
+    case OPERACAO_TABELA:
+      return soma_memoria(condensa, memoria_linhas(g, memoria_tabela(g), &n_tarefas));
+
+    case OPERACAO_DIAMETRO:
+      return soma_memoria(condensa, memoria_linhas(g, 0, &n_tarefas));
+
+    case OPERACAO_ARBORESCENCIA:
+      return soma_memoria(g->direcionado ? condensa : 0, memoria_arborescencia(g));
+
+    case OPERACAO_COMPONENTES:
+      a = memoria_particao(g, 0);
+      b = memoria_particao(g, 1);
+      escolha = particao_preferida(g, memoria_componentes(g));
+      return soma_memoria(memoria_componentes(g), (escolha == 0 || (escolha < 0 && a <= b && (g->externo == NULL || g->compacto != NULL))) ? a : b);
+
+    case OPERACAO_FORTES:
+      return soma_memoria(condensa, soma_memoria(memoria_areas(g, 1), memoria_subgrafos(g)));
+
+    case OPERACAO_COMPACTA:
+      return (g->compacto != NULL) ? 0 : memoria_compacta(g);
+
+    case OPERACAO_PERCORRE:
+      return soma_memoria(condensa, memoria_linhas(g, memoria_esteira(g), &n_tarefas));
   }
-  /* Destroi o grafo de distâncias */
-  destroi_grafo(dis);
-  return diametro;
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void define_orcamento(size_t bytes) {
+  __atomic_store_n(&orcamento_memoria, bytes, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+int ultimo_erro(void) {
+  return erro_thread;
+}
+
+//------------------------------------------------------------------------------
+void define_memoria_resultados(grafo g, size_t bytes) {
+  pthread_mutex_lock(&g->trava_guardados);
+  __atomic_store_n(&g->limite_guardados, bytes, __ATOMIC_RELAXED);
+  reduz_guardados(g, bytes);
+  pthread_mutex_unlock(&g->trava_guardados);
 }
@@ -6,7 +6,7 @@
 //------------------------------------------------------------------------------
 // valor que representa "infinito"
 
-const long int infinito;
+extern const long int infinito;
 
 //-----------------------------------------------------------------------------
 // lista encadeada
@@ -73,15 +73,39 @@ char *nome_vertice(vertice v);
 // num grafo com pesos nas arestas, todas as arestas tem peso
 // 
 // o peso de uma aresta é um long int e seu valor default é zero
+//
+// as funções que apenas consultam g (as que não o alteram, abaixo) podem
+// ser chamadas ao mesmo tempo por vários threads sobre o mesmo grafo; as
+// estruturas que elas constroem sob demanda e guardam em g são construídas
+// uma única vez, sob uma trava do grafo, e os vetores auxiliares de cada
+// chamada vêm de uma reserva de áreas de trabalho do grafo
+//
+// alteram g, e não podem ser chamadas ao mesmo tempo que nenhuma outra
+// função sobre ele: insere_vertice, insere_aresta, remove_aresta,
+// remove_vertice, compacta_grafo, descompacta_grafo, atualiza_distancias
+// (que altera o grafo da tabela), define_progresso, define_controle,
+// define_fila, zera_estatisticas e destroi_grafo, que exige também que as visões
+// (subgrafo) de g já tenham sido destruídas
 
 typedef struct grafo *grafo;
 
+//------------------------------------------------------------------------------
+// devolve o vértice de g de nome nome,
+//      ou NULL, se g não tem vértice com este nome
+
+vertice busca_vertice(grafo g, char *nome);
+
 //------------------------------------------------------------------------------
 // lê um grafo no formato dot de input, usando as rotinas de libcgraph
 // 
 // desconsidera todos os atributos do grafo lido
 // exceto o atributo "peso" nas arestas onde ocorra
 // 
+// se input é um arquivo comum, ele é mapeado e lido em paralelo, com os
+// vértices numerados na ordem em que aparecem; as construções que essa
+// leitura não trata (subgrafos, atributos padrão, portas, strings HTML,
+// grafos sem nome) e as demais entradas são lidas pela libcgraph
+// 
 // devolve o grafo lido,
 //      ou NULL, em caso de erro 
 //
@@ -122,6 +146,31 @@ char *nome(grafo g);
 
 unsigned int n_vertices(grafo g);
 
+//------------------------------------------------------------------------------
+// devolve o número de arestas (ou arcos) do grafo g
+
+unsigned int n_arestas(grafo g);
+
+//------------------------------------------------------------------------------
+// devolve o número de arcos que saem de v, se g é direcionado,
+//      ou o número de arestas de v, caso contrário
+//
+// devolve 0 se v não é vértice de g
+
+unsigned int grau_saida(grafo g, vertice v);
+
+//------------------------------------------------------------------------------
+// devolve o número de arcos que entram em v, se g é direcionado,
+//      ou o número de arestas de v, caso contrário
+//
+// devolve 0 se v não é vértice de g
+//
+// num grafo direcionado as listas de cada vértice guardam só os arcos que
+// saem dele; os que entram são montados na primeira chamada (ou no
+// primeiro algoritmo que os percorre) e mantidos até g ser alterado
+
+unsigned int grau_entrada(grafo g, vertice v);
+
 //------------------------------------------------------------------------------
 // devolve 1, se g é direcionado,
 //      ou 0, caso contrário
@@ -131,6 +180,9 @@ int direcionado(grafo g);
 //------------------------------------------------------------------------------
 // devolve 1, se g é não direcionado e conexo,
 //      ou 0, caso contrário
+//
+// os componentes de g são calculados na primeira chamada e mantidos
+// durante as inserções de vértices e arestas
 
 int conexo(grafo g); 
 
@@ -141,10 +193,76 @@ int conexo(grafo g);
 grafo arvore_geradora_minima(grafo g);
 
 //------------------------------------------------------------------------------
-// devolve uma lista de grafos onde cada grafo é um componente de g
+// devolve uma lista de grafos onde cada grafo é um componente de g,
+//      ou NULL, em caso de erro (veja ultimo_erro)
+//
+// cada componente é uma cópia independente de g; para apenas percorrer
+// ou escrever os componentes, subgrafos_componentes evita as cópias
 
 lista componentes(grafo g);
 
+//------------------------------------------------------------------------------
+// o tipo subgrafo: visão de um subconjunto dos vértices de um grafo e das
+// arestas entre eles, sem cópia dos vértices e arestas
+//
+// uma visão é válida enquanto o grafo não for alterado
+
+typedef struct subgrafo *subgrafo;
+
+//------------------------------------------------------------------------------
+// devolve uma lista de subgrafos onde cada subgrafo é um componente de g
+// (fracamente conexo, se g é direcionado), na mesma ordem de componentes,
+//      ou NULL, em caso de erro (veja ultimo_erro)
+//
+// os subgrafos compartilham um único vetor de rótulos e cada um deve ser
+// destruído com destroi_subgrafo (ou destroi_lista(l, destroi_subgrafo))
+
+lista subgrafos_componentes(grafo g);
+
+//------------------------------------------------------------------------------
+// devolve o subgrafo de g induzido pelos n vértices do vetor vertices,
+//      ou NULL, em caso de erro
+
+subgrafo subgrafo_induzido(grafo g, unsigned int n, vertice *vertices);
+
+//------------------------------------------------------------------------------
+// devolve o número de vértices do subgrafo s
+
+unsigned int n_vertices_subgrafo(subgrafo s);
+
+//------------------------------------------------------------------------------
+// devolve o i-ésimo vértice (do grafo original) do subgrafo s,
+//      ou NULL, se i >= n_vertices_subgrafo(s)
+
+vertice vertice_subgrafo(subgrafo s, unsigned int i);
+
+//------------------------------------------------------------------------------
+// devolve 1, se o vértice v pertence ao subgrafo s,
+//      ou 0, caso contrário
+
+int pertence_subgrafo(subgrafo s, vertice v);
+
+//------------------------------------------------------------------------------
+// escreve o subgrafo s em output no formato de escreve_grafo
+//
+// devolve o subgrafo escrito
+
+subgrafo escreve_subgrafo(FILE *output, subgrafo s);
+
+//------------------------------------------------------------------------------
+// devolve uma cópia independente do subgrafo s, com o nome do grafo
+// original,
+//      ou NULL, em caso de erro
+
+grafo materializa_subgrafo(subgrafo s);
+
+//------------------------------------------------------------------------------
+// desaloca a visão s (o grafo original não é alterado)
+//
+// devolve 1
+
+int destroi_subgrafo(void *s);
+
 //------------------------------------------------------------------------------
 // devolve uma lista de grafos onde cada grafo é um bloco de g
 //      ou NULL, se g é um grafo direcionado
@@ -158,10 +276,50 @@ lista blocos(grafo g);
 lista ordena(grafo g);
 
 //------------------------------------------------------------------------------
-// devolve uma arborescência de caminhos mínimos de g de raiz r
+// devolve uma arborescência de caminhos mínimos de g de raiz r,
+//      ou NULL, em caso de erro ou se g tem circuito negativo
+//
+// se g é direcionado e acíclico os vértices são fixados em ordem
+// topológica, em tempo linear e também com pesos negativos; nos demais
+// grafos com pesos negativos a busca de Dijkstra usa os pesos reduzidos
+// de Johnson (veja circuito_negativo)
 
 grafo arborescencia_caminhos_minimos(grafo g, vertice r); 
 
+//------------------------------------------------------------------------------
+// devolve uma arborescência de caminhos máximos (de maior peso) de g de
+// raiz r, calculada em ordem topológica,
+//      ou NULL se g não é direcionado, se tem circuito direcionado ou em
+//      caso de erro
+
+grafo arborescencia_caminhos_maximos(grafo g, vertice r);
+
+//------------------------------------------------------------------------------
+// devolve a lista dos vértices, do primeiro ao último, de um caminho de
+// maior peso de g (o caminho crítico, se os pesos são durações), que pode
+// começar em qualquer vértice, e guarda o seu peso em comprimento (se não
+// é NULL),
+//      ou NULL se g não é direcionado, se tem circuito direcionado ou em
+//      caso de erro
+
+lista caminho_critico(grafo g, long int *comprimento);
+
+//------------------------------------------------------------------------------
+// devolve a lista dos vértices de um circuito de peso negativo de g, na
+// ordem dos seus arcos (o último vértice tem arco para o primeiro; numa
+// aresta negativa de um grafo não direcionado, os seus dois vértices),
+//      ou NULL se g não tem circuito negativo ou em caso de erro
+//
+// o circuito é achado por Bellman-Ford com fila (SPFA) a partir de uma
+// fonte virtual ligada a todos os vértices com peso 0, o mesmo que calcula
+// os potenciais de Johnson das buscas com pesos negativos: as distâncias
+// a partir dela são potenciais com os quais peso(u,v) + p(u) - p(v) nunca
+// é negativo, e as buscas de caminhos mínimos de todas as funções deste
+// módulo passam a valer para qualquer peso; com circuito negativo as
+// distâncias não existem, e essas funções devolvem erro
+
+lista circuito_negativo(grafo g);
+
 //------------------------------------------------------------------------------
 // devolve um grafo com pesos, onde
 //
@@ -172,19 +330,677 @@ grafo arborescencia_caminhos_minimos(grafo g, vertice r);
 //
 //     - o peso da aresta {u,v} (arco (u,v)) é a distância de u a v em g
 //
-// o grafo é computado usando a função arborescencia_caminhos_minimos()
+//     - as arestas de cada vértice estão em ordem crescente de destino
+//
+// o grafo é computado com uma busca de Dijkstra a partir de cada vértice
+// (ou, se g é direcionado e acíclico, em ordem topológica), como em
+// arborescencia_caminhos_minimos(), divididas entre os threads; as fontes
+// são agrupadas pelos componentes fortemente conexos de g (conexos, se g
+// não é direcionado), dos maiores para os menores, e a busca a partir de
+// cada uma só percorre os componentes alcançáveis a partir do seu, de modo
+// que os pares sem caminho, que não têm aresta, não custam nada (o mesmo
+// vale para diametro()); sem memória para as listas no orçamento (veja
+// define_orcamento) o grafo vem na representação compacta, como depois de
+// compacta_grafo,
+//      ou NULL, em caso de erro, se g tem circuito negativo ou se a
+//      chamada foi interrompida pelo controle de g (define_controle)
 
 grafo distancias(grafo g);
 
 //------------------------------------------------------------------------------
 // devolve 1, se g é fortemente conexo,
-//      ou 0, caso contrário
+//      ou 0, caso contrário ou em caso de erro (ultimo_erro() diz qual)
+//
+// os componentes fortemente conexos vêm do algoritmo de Tarjan ou, nos
+// grafos com ao menos 16384 vértices e com mais de um thread (veja
+// define_threads), de uma decomposição paralela: poda dos componentes de
+// um só vértice, buscas em largura para frente e para trás a partir de um
+// pivô, que acham o componente gigante, e propagação de cores para o resto
 
 int fortemente_conexo(grafo g);
 
 //------------------------------------------------------------------------------
-// devolve o diâmetro de g
+// devolve uma lista de subgrafos onde cada subgrafo é um componente
+// fortemente conexo de g (um componente de g, se g não é direcionado), em
+// ordem topológica: nenhum arco vai de um componente para um anterior,
+//      ou NULL, em caso de erro (veja ultimo_erro)
+//
+// como em subgrafos_componentes, cada subgrafo deve ser destruído com
+// destroi_subgrafo
+
+lista subgrafos_fortemente_conexos(grafo g);
+
+//------------------------------------------------------------------------------
+// devolve o diâmetro de g (a maior distância finita entre dois vértices),
+//      ou -1, em caso de erro, se g tem circuito negativo ou se a chamada
+//      foi interrompida pelo controle de g (define_controle)
 
 long int diametro(grafo g);
 
+//------------------------------------------------------------------------------
+// calcula limites para o diâmetro de g sem calcular as distâncias entre
+// todos os pares: duas varreduras de distâncias a partir de um vértice de
+// cada componente, feitas por buscas em largura se os pesos são todos
+// iguais, ou senão em passadas sequenciais pelas arestas (os pesos devem
+// ser não negativos)
+//
+// *inferior recebe uma distância de g e *superior um valor que nenhuma
+// distância finita de g excede (2 vezes a excentricidade de uma fonte, num
+// grafo não direcionado, ou a soma das excentricidades de saída e de
+// entrada, num grafo direcionado), ou infinito, se g é direcionado e algum
+// componente (fracamente conexo) de g não é fortemente conexo
+//
+// devolve 1 em caso de sucesso,
+//      ou 0, em caso de erro
+
+int limites_diametro(grafo g, long int *inferior, long int *superior);
+
+//------------------------------------------------------------------------------
+// número de faixas do histograma de distâncias de amostra_distancias
+
+#define FAIXAS_DISTANCIAS 64
+
+//------------------------------------------------------------------------------
+// estimativas das distâncias de um grafo feitas por amostra_distancias
+//
+// os pares considerados são os (u, v), com u != v e v alcançável a partir
+// de u; media é a distância média desses pares e fracao[i] a fração deles
+// com distância em [i * largura_faixa, (i + 1) * largura_faixa) (a
+// largura é uma potência de 2 e nenhuma distância passa da última faixa)
+//
+// cada erro_ é a metade do intervalo de confiança de 95% da estimativa
+// correspondente: 0 quando a estimativa é exata e HUGE_VAL quando uma
+// única fonte não permite estimar o erro
+//
+// diametro_inferior e diametro_superior são limites garantidos (não
+// estimativas) do diâmetro de g
+
+struct amostra_distancias {
+  unsigned int fontes;
+  long int diametro_inferior;
+  long int diametro_superior;
+  double pares_alcancaveis;
+  double erro_pares_alcancaveis;
+  double media;
+  double erro_media;
+  long int largura_faixa;
+  double fracao[FAIXAS_DISTANCIAS];
+  double erro_fracao[FAIXAS_DISTANCIAS];
+};
+
+//------------------------------------------------------------------------------
+// estima as distâncias de g a partir de k fontes sorteadas com a semente
+// dada, sem calcular as distâncias entre todos os pares: uma busca de
+// caminhos mínimos a partir de cada fonte, divididas entre os threads
+//
+// as fontes são sorteadas uniformemente sem reposição (com k >= número de
+// vértices de g o resultado é exato), ou, se por_grau, com reposição e
+// probabilidade proporcional ao grau de saída mais 1, o que favorece os
+// vértices centrais; os limites do diâmetro são os de limites_diametro,
+// com o inferior aumentado pela maior distância encontrada
+//
+// devolve 1 em caso de sucesso, preenchendo *a,
+//      ou 0, em caso de erro ou se g tem circuito negativo ou alguma
+//      distância negativa
+
+int amostra_distancias(grafo g, unsigned int k, int por_grau, unsigned int semente, struct amostra_distancias *a);
+
+//------------------------------------------------------------------------------
+// resumo das distâncias de um grafo calculado por percorre_distancias
+//
+// os pares considerados são os (u, v), com u != v e v alcançável a partir
+// de u; diametro é a maior distância entre eles (como em diametro()) e
+// histograma[i] o número deles com distância em [i * largura_faixa,
+// (i + 1) * largura_faixa) (a largura é a menor potência de 2 com a qual
+// nenhuma distância passa da última faixa; as negativas, que só ocorrem
+// com pesos negativos, ficam na primeira)
+//
+// se excentricidade não é NULL, excentricidade[i] recebe a maior distância
+// a partir do i-ésimo vértice de g, na ordem em que escreve_grafo os
+// escreve (0, se nenhum outro é alcançável a partir dele)
+
+struct resumo_distancias {
+  long int diametro;
+  unsigned long pares;
+  long int largura_faixa;
+  unsigned long histograma[FAIXAS_DISTANCIAS];
+  long int *excentricidade;
+};
+
+//------------------------------------------------------------------------------
+// redutor das linhas de distâncias de percorre_distancias: linha é chamada
+// com dados uma vez para cada vértice u, com os n vértices v[0], ...,
+// v[n - 1] alcançáveis a partir de u (exceto u), em ordem, e as distâncias
+// de u a eles; os vetores só valem durante a chamada
+
+struct redutor_distancias {
+  void (*linha)(void *dados, vertice u, unsigned int n, vertice *v, long int *distancia);
+  void *dados;
+};
+
+//------------------------------------------------------------------------------
+// percorre as distâncias entre todos os pares de g numa única passada, sem
+// guardar o grafo de distâncias: as linhas calculadas pelos threads (como
+// em distancias()) passam por uma fila circular limitada, sem travas, e
+// são consumidas uma a uma, na ordem dos vértices de g (a de escreve_grafo),
+// por quem estiver livre para escoar a fila
+//
+// cada linha é escrita em output (se não é NULL) exatamente como
+// escreve_grafo escreveria distancias(g), com os destinos em ordem
+// crescente e o grafo sem nome, preenche *r (se não é NULL) e é
+// passada a cada um dos n redutores; a memória é proporcional ao número de
+// threads vezes o número de vértices de g (veja OPERACAO_PERCORRE)
+//
+// devolve 1 em caso de sucesso,
+//      ou 0, em caso de erro (veja ultimo_erro), se g tem circuito negativo
+//      ou se a chamada foi interrompida pelo controle de g, quando o que
+//      foi escrito e reduzido fica incompleto; o controle não faz
+//      retomada, já que as linhas não são guardadas
+
+int percorre_distancias(grafo g, FILE *output, struct resumo_distancias *r, unsigned int n, struct redutor_distancias *redutores);
+
+//------------------------------------------------------------------------------
+// estima a função de vizinhança de g, ignorando os pesos: vizinhanca[t]
+// recebe o número de pares (u, v) com v alcançável a partir de u por um
+// caminho de até t arestas (incluindo os pares (u, u)), para t = 0, 1, ...
+// até que ela se estabilize ou até maximo - 1
+//
+// cada vértice guarda um contador HyperLogLog de 2^bits registradores
+// (4 <= bits <= 16), de um byte cada, sorteados com a semente dada, e cada
+// valor tem erro relativo padrão de cerca de 1.04 / sqrt(2^bits); as
+// iterações são divididas entre os threads
+//
+// o número de valores devolvidos menos 1 estima o diâmetro de g em número
+// de arestas, e as diferenças entre valores consecutivos a distribuição
+// das distâncias em número de arestas
+//
+// devolve o número de valores escritos em vizinhanca,
+//      ou 0, em caso de erro
+
+unsigned int funcao_vizinhanca(grafo g, unsigned int bits, unsigned int semente, double *vizinhanca, unsigned int maximo);
+
+//------------------------------------------------------------------------------
+// devolve 1, se v é alcançável a partir de u em g,
+//      ou 0, caso contrário
+//
+// na primeira chamada é construído (em paralelo) um índice sobre os
+// componentes fortemente conexos de g, que é guardado em g; as consultas
+// seguintes custam O(1) em grafos com até alguns milhares de componentes
+// e, acima disso, são quase sempre respondidas pelos rótulos do índice
+
+int alcancavel(grafo g, vertice u, vertice v);
+
+//------------------------------------------------------------------------------
+// devolve um grafo sem vértices de nome nome, direcionado ou não e com
+// pesos nas arestas ou não,
+//      ou NULL, em caso de erro
+
+grafo cria_grafo(char *nome, int direcionado, int ponderado);
+
+//------------------------------------------------------------------------------
+// insere em g um vértice de nome nome, sem arestas
+//
+// devolve o vértice inserido,
+//      ou NULL, se g já tem um vértice com este nome ou em caso de erro
+//
+// a inserção custa O(1) amortizado, mas pode mudar a posição dos vértices
+// de g na memória, invalidando os vértices obtidos anteriormente
+
+vertice insere_vertice(grafo g, char *nome);
+
+//------------------------------------------------------------------------------
+// insere em g a aresta {u,v} (arco (u,v)) com peso peso, em tempo O(1)
+//
+// se g não é direcionado, mantém incrementalmente seus componentes, de
+// forma que conexo(g) continua custando O(1)
+//
+// devolve 1 em caso de sucesso,
+//      ou 0, caso contrário
+
+int insere_aresta(grafo g, vertice u, vertice v, long int peso);
+
+//------------------------------------------------------------------------------
+// remove de g a aresta {u,v} (arco (u,v))
+//
+// depois de uma remoção, a próxima chamada de conexo(g) recalcula os
+// componentes de g em tempo O(V+E)
+//
+// devolve 1 em caso de sucesso,
+//      ou 0, se a aresta (arco) não existe
+
+int remove_aresta(grafo g, vertice u, vertice v);
+
+//------------------------------------------------------------------------------
+// remove de g o vértice v e todas as suas arestas
+//
+// o último vértice de g passa a ocupar a posição de v
+//
+// devolve 1 em caso de sucesso,
+//      ou 0, se v não é vértice de g
+
+int remove_vertice(grafo g, vertice v);
+
+//------------------------------------------------------------------------------
+// troca as listas de adjacência de g por uma representação compacta
+// somente leitura: vizinhos ordenados e codificados por diferenças em
+// stream VByte, com pesos na menor largura que os comporta
+//
+// as consultas continuam funcionando sobre g; as que ainda dependem das
+// listas (alterações e atualiza_distancias) chamam descompacta_grafo antes
+//
+// devolve 1 em caso de sucesso,
+//      ou 0, em caso de erro (g fica inalterado)
+
+int compacta_grafo(grafo g);
+
+//------------------------------------------------------------------------------
+// reconstrói as listas de adjacência de um grafo compactado ou lido com
+// le_grafo_externo (que passa a ter as arestas em memória)
+//
+// devolve 1 em caso de sucesso (ou se g já está em listas),
+//      ou 0, em caso de erro (g continua como estava)
+
+int descompacta_grafo(grafo g);
+
+//------------------------------------------------------------------------------
+// devolve o número de bytes ocupados pelas arestas de g, na representação
+// em que ele está (no arquivo, se g foi lido com le_grafo_externo)
+
+size_t memoria_arestas(grafo g);
+
+//------------------------------------------------------------------------------
+// grava as arestas de g em caminho, no formato lido por le_grafo_externo:
+// os nomes e, para cada vértice em ordem, os arcos que saem dele (as
+// arestas, num grafo não direcionado) e, num grafo direcionado, os que
+// entram nele
+//
+// devolve 1 em caso de sucesso,
+//      ou 0, em caso de erro
+
+int grava_grafo_externo(grafo g, const char *caminho);
+
+//------------------------------------------------------------------------------
+// lê um grafo gravado por grava_grafo_externo mantendo em memória apenas
+// os vértices: o arquivo é mapeado com mmap e as arestas são lidas dele
+// sob demanda
+//
+// conexo, componentes, subgrafos_componentes, fortemente_conexo,
+// limites_diametro e escreve_grafo percorrem as arestas em passadas
+// sequenciais com leitura antecipada, mantendo residentes no máximo
+// orcamento bytes delas (64MB, se orcamento é 0); as demais consultas
+// leem o arquivo sem esse limite, e compacta_grafo, descompacta_grafo e as
+// funções que dependem das listas trazem as arestas para a memória
+//
+// devolve o grafo lido,
+//      ou NULL, em caso de erro
+
+grafo le_grafo_externo(const char *caminho, size_t orcamento);
+
+//------------------------------------------------------------------------------
+// tabela com as distâncias entre todos os pares de vértices de um grafo
+//
+// ao contrário de distancias(), a tabela pode ser atualizada depois de
+// alterações nas arestas do grafo sem ser recalculada do zero
+
+typedef struct tabela_distancias *tabela_distancias;
+
+//------------------------------------------------------------------------------
+// devolve a tabela de distâncias de g, calculada com uma busca de
+// Dijkstra a partir de cada vértice, divididas entre os threads (com
+// pesos negativos, a de Johnson, veja circuito_negativo),
+//      ou NULL, em caso de erro, se g tem circuito negativo ou se a
+//      chamada foi interrompida pelo controle de g (define_controle)
+//
+// a tabela guarda g, que deve existir enquanto ela for usada
+
+tabela_distancias calcula_distancias(grafo g);
+
+//------------------------------------------------------------------------------
+// devolve a distância de u a v na tabela t,
+//      ou infinito, se v não é alcançável a partir de u
+
+long int distancia(tabela_distancias t, vertice u, vertice v);
+
+//------------------------------------------------------------------------------
+// aplica ao grafo de t as n alterações de arestas (arcos) {u[i],v[i]}
+// para peso[i], e atualiza as distâncias de t
+//
+// se a aresta não existe ela é inserida, se peso[i] é infinito ela é
+// removida e, caso contrário, apenas seu peso é alterado; as alterações
+// são aplicadas na ordem dada, e uma aresta que aparece mais de uma vez
+// fica com o último peso
+//
+// em cada linha de t são recalculados apenas os vértices cuja distância
+// muda; se eles passam de uma fração dos vértices a linha é recalculada
+// do zero, e se os vértices do grafo mudaram ou ele tem pesos negativos a
+// tabela inteira o é
+//
+// devolve 1 em caso de sucesso,
+//      ou 0, caso contrário (inclusive se as alterações criam um circuito
+//      negativo), e nesse caso as alterações são desfeitas: g e t ficam
+//      como antes da chamada
+
+int atualiza_distancias(tabela_distancias t, unsigned int n, vertice *u, vertice *v, long int *peso);
+
+//------------------------------------------------------------------------------
+// desaloca a tabela t
+//
+// devolve 1 em caso de sucesso,
+//      ou 0, caso contrário
+
+int destroi_tabela_distancias(void *t);
+
+//------------------------------------------------------------------------------
+// geradores de grafos sintéticos
+//
+// os vértices se chamam v0, v1, ..., os grafos gerados não têm laços nem
+// arestas repetidas e, se ponderado, os pesos são sorteados entre 1 e 100
+// (caso contrário valem 1)
+//
+// a mesma semente gera sempre o mesmo grafo
+//
+// devolvem o grafo gerado,
+//      ou NULL, em caso de erro
+
+//------------------------------------------------------------------------------
+// grafo G(n, m) com n vértices e m pares de vértices sorteados (menos os
+// laços e repetições)
+
+grafo gera_erdos_renyi(unsigned int n, unsigned int m, int direcionado, int ponderado, unsigned int semente);
+
+//------------------------------------------------------------------------------
+// grafo R-MAT com 2^escala vértices e m pares de vértices sorteados (menos
+// os laços e repetições), com distribuição de graus semelhante à de redes
+// sociais
+
+grafo gera_rmat(unsigned int escala, unsigned int m, int direcionado, int ponderado, unsigned int semente);
+
+//------------------------------------------------------------------------------
+// grade não direcionada com linhas x colunas vértices
+
+grafo gera_grade(unsigned int linhas, unsigned int colunas, int ponderado, unsigned int semente);
+
+//------------------------------------------------------------------------------
+// caminho v0, v1, ..., v(n-1)
+
+grafo gera_caminho(unsigned int n, int direcionado, int ponderado, unsigned int semente);
+
+//------------------------------------------------------------------------------
+// árvore não direcionada aleatória com n vértices
+
+grafo gera_arvore(unsigned int n, int ponderado, unsigned int semente);
+
+//------------------------------------------------------------------------------
+// grafo direcionado acíclico com n vértices e m pares sorteados, cada um
+// orientado de acordo com uma ordem topológica também sorteada
+
+grafo gera_dag(unsigned int n, unsigned int m, int ponderado, unsigned int semente);
+
+//------------------------------------------------------------------------------
+// estatísticas de desempenho acumuladas pelas chamadas sobre um grafo
+//
+// só são coletadas se a biblioteca for compilada com -DGRAFO_ESTATISTICAS;
+// caso contrário a instrumentação não gera código e os campos ficam em zero
+//
+// os tempos são separados nas fases de carga (leitura pela cgraph),
+// conversão (da cgraph para o grafo), construção de índices (condensação,
+// alcançabilidade, componentes), cálculo e saída (escreve_grafo); as
+// alocações são atribuídas à chamada pública que as fez
+//
+// resultados_reusados e resultados_calculados contam, sempre (mesmo sem
+// -DGRAFO_ESTATISTICAS), as consultas respondidas por um resultado guardado
+// em g (veja define_memoria_resultados) e as que o calcularam
+
+struct estatisticas {
+  unsigned long chamadas;
+  unsigned long arestas_examinadas;
+  unsigned long vertices_fixados;
+  unsigned long operacoes_heap;
+  unsigned long alocacoes;
+  unsigned long bytes_alocados;
+  double segundos_carga;
+  double segundos_conversao;
+  double segundos_indice;
+  double segundos_calculo;
+  double segundos_saida;
+  unsigned long resultados_reusados;
+  unsigned long resultados_calculados;
+};
+
+//------------------------------------------------------------------------------
+// devolve as estatísticas acumuladas em g desde sua criação ou desde a
+// última chamada de zera_estatisticas (para medir uma única chamada basta
+// zerá-las antes dela)
+
+struct estatisticas estatisticas(grafo g);
+
+//------------------------------------------------------------------------------
+// zera as estatísticas acumuladas em g
+
+void zera_estatisticas(grafo g);
+
+//------------------------------------------------------------------------------
+// escreve as estatísticas de g em output, em JSON numa única linha
+// 
+// devolve o grafo g
+
+grafo escreve_estatisticas(FILE *output, grafo g);
+
+//------------------------------------------------------------------------------
+// define a função chamada durante os cálculos de distâncias entre todos os
+// pares (distancias, diametro, calcula_distancias e atualiza_distancias)
+// a cada linha concluída, com dados, o número de linhas feitas e o total
+//
+// progresso NULL desliga o aviso; com consultas simultâneas sobre g ela
+// pode ser chamada por vários threads ao mesmo tempo
+
+void define_progresso(grafo g, void progresso(void *dados, unsigned int feitos, unsigned int total), void *dados);
+
+//------------------------------------------------------------------------------
+// controle das chamadas demoradas, que fazem uma busca a partir de cada
+// vértice (distancias, diametro e calcula_distancias, inclusive quando
+// refeita por atualiza_distancias): prazo, cancelamento e arquivo de
+// retomada
+
+typedef struct controle *controle;
+
+//------------------------------------------------------------------------------
+// devolve um controle com prazo de segundos a partir de agora (sem prazo,
+// se segundos <= 0) e, se arquivo != NULL, com retomada: as linhas de
+// distâncias concluídas são gravadas em arquivo, e forçadas ao disco a cada
+// intervalo segundos, e a mesma chamada sobre o mesmo grafo com um
+// controle com o mesmo arquivo continua de onde a anterior parou
+//
+// o arquivo é removido quando a chamada termina, e descartado se for de
+// outra chamada ou de outro grafo (outros arcos ou pesos)
+//
+//      ou NULL, em caso de erro
+
+controle cria_controle(double segundos, const char *arquivo, double intervalo);
+
+//------------------------------------------------------------------------------
+// pede a interrupção das chamadas controladas por c, que param antes da
+// próxima busca; pode ser chamada de qualquer thread (ou de um tratador
+// de sinal), e c continua cancelado para as chamadas seguintes
+
+void cancela_controle(controle c);
+
+//------------------------------------------------------------------------------
+// devolve 1, se a última chamada controlada por c parou pelo prazo ou pelo
+// cancelamento,
+//      ou 0, caso contrário
+
+int interrompido(controle c);
+
+//------------------------------------------------------------------------------
+// desaloca o controle c, que não pode mais estar associado a um grafo
+//
+// devolve 1
+
+int destroi_controle(void *c);
+
+//------------------------------------------------------------------------------
+// passa a controlar as chamadas demoradas sobre g por c (NULL remove o
+// controle), como define_progresso
+
+void define_controle(grafo g, controle c);
+
+//------------------------------------------------------------------------------
+// filas de prioridade das buscas de Dijkstra (arborescencia_caminhos_minimos,
+// distancias, diametro, calcula_distancias e amostra_distancias)
+//
+// FILA_AUTOMATICA, o padrão, escolhe a fila por uma passada pelos pesos a
+// cada chamada: como os pesos são inteiros, com todos iguais a busca é em
+// largura (FILA_LARGURA, sem fila de prioridade), com todos não negativos
+// e menores que 1024 usa os baldes circulares de Dial, com pesos maiores
+// um heap radix, e com algum peso negativo um heap radix sobre os pesos
+// reduzidos pelos potenciais de Johnson (veja circuito_negativo)
+//
+// a busca em largura alterna, a cada nível, entre expandir a fronteira e
+// procurar, a partir de cada vértice não visitado, um vizinho nela, o que
+// for mais barato, e divide os níveis grandes entre os processadores; ela
+// também é usada por componentes, subgrafos_componentes e limites_diametro
+//
+// num grafo direcionado acíclico nenhuma fila é usada, qualquer que seja a
+// definida: os vértices são fixados em ordem topológica
+
+#define FILA_AUTOMATICA 0
+#define FILA_HEAP 1
+#define FILA_DIAL 2
+#define FILA_RADIX 3
+#define FILA_LARGURA 4
+
+//------------------------------------------------------------------------------
+// passa a usar a fila de prioridade fila nas buscas sobre g, quando os
+// pesos de g a permitem (FILA_DIAL vira FILA_RADIX com pesos a partir de
+// 1024, FILA_LARGURA vira FILA_DIAL ou FILA_RADIX com pesos diferentes, e
+// com pesos negativos todas usam os pesos reduzidos de Johnson)
+
+void define_fila(grafo g, int fila);
+
+//------------------------------------------------------------------------------
+// passa a usar n threads nos algoritmos paralelos (busca em largura,
+// componentes fortemente conexos, tabela de distâncias etc.) de todos os
+// grafos, ou um por processador disponível, o padrão, se n é 0
+//
+// numa máquina com mais de um nó NUMA (lidos de /sys/devices/system/node)
+// os threads são distribuídos entre os nós e fixados nos seus
+// processadores, cada thread reaproveita de preferência as áreas de
+// trabalho criadas no seu nó, os vetores grandes lidos por todos (vértices,
+// arcos de entrada e representação compacta) são intercalados entre os
+// nós e as páginas da tabela de distâncias ficam no nó do thread que
+// calcula cada linha; os vetores grandes usam páginas grandes
+// transparentes (madvise), e com um único nó nada é fixado nem intercalado
+
+void define_threads(unsigned int n);
+
+//------------------------------------------------------------------------------
+// deixa na reserva de g ao menos n áreas de trabalho (os vetores auxiliares
+// de distâncias, pais, heap e rótulos de uma chamada), para que n threads
+// consultando g ao mesmo tempo não aloquem memória para elas
+//
+// sem a reserva as áreas são criadas na primeira chamada de cada thread e
+// reaproveitadas depois; elas são liberadas por destroi_grafo
+//
+// devolve 1 em caso de sucesso,
+//      ou 0, em caso de erro
+
+int reserva_areas_trabalho(grafo g, unsigned int n);
+
+//------------------------------------------------------------------------------
+// operações cobertas pelo orçamento de memória (define_orcamento) e por
+// estima_memoria:
+//
+//     - OPERACAO_DISTANCIAS: distancias
+//     - OPERACAO_TABELA: calcula_distancias
+//     - OPERACAO_DIAMETRO: diametro
+//     - OPERACAO_ARBORESCENCIA: arborescencia_caminhos_minimos e
+//       arborescencia_caminhos_maximos
+//     - OPERACAO_COMPONENTES: componentes e subgrafos_componentes
+//     - OPERACAO_FORTES: fortemente_conexo e subgrafos_fortemente_conexos
+//     - OPERACAO_COMPACTA: compacta_grafo
+//     - OPERACAO_PERCORRE: percorre_distancias
+
+#define OPERACAO_DISTANCIAS 0
+#define OPERACAO_TABELA 1
+#define OPERACAO_DIAMETRO 2
+#define OPERACAO_ARBORESCENCIA 3
+#define OPERACAO_COMPONENTES 4
+#define OPERACAO_FORTES 5
+#define OPERACAO_COMPACTA 6
+#define OPERACAO_PERCORRE 7
+
+//------------------------------------------------------------------------------
+// devolve uma estimativa, em bytes, do pico de memória que a operação
+// alocaria sobre g, além da já ocupada por g, com a estratégia que ela
+// escolheria sob o orçamento atual (a mais barata, se nenhuma cabe nele),
+//      ou 0, se operacao não é uma das operações acima
+//
+// a estimativa é um limite superior calculado a partir dos números de
+// vértices e de arcos de g (contados numa passada pelas listas, guardada
+// até a próxima alteração) e do que g já guarda (arcos de entrada,
+// componentes fortemente conexos e áreas de trabalho); os pares de
+// distancias são limitados pelos componentes fortemente conexos, se eles
+// já foram calculados, ou pelo quadrado do número de vértices
+
+size_t estima_memoria(grafo g, int operacao);
+
+//------------------------------------------------------------------------------
+// limita a bytes a memória que cada operação coberta pode alocar, em
+// todos os grafos (0, o padrão, remove o limite)
+//
+// com um orçamento, as operações trocam a estratégia preferida por uma
+// mais econômica quando ela não cabe: distancias, diametro e
+// calcula_distancias usam menos threads (cada um com a sua área de
+// trabalho) e a busca em largura deixa de montar os arcos de entrada,
+// distancias monta o resultado na representação compacta em vez de
+// listas, os componentes fortemente conexos vêm do algoritmo de Tarjan em
+// vez da decomposição paralela (ou o contrário, o que couber) e os
+// componentes saem de um union-find numa passada pelas arestas; se nem a
+// estratégia mais econômica cabe, a operação falha antes de alocar, com
+// ultimo_erro() == ERRO_ORCAMENTO
+
+void define_orcamento(size_t bytes);
+
+//------------------------------------------------------------------------------
+// causas de falha das operações cobertas (ultimo_erro)
+
+#define ERRO_NENHUM 0
+#define ERRO_MEMORIA 1
+#define ERRO_ORCAMENTO 2
+#define ERRO_CIRCUITO 3
+#define ERRO_INTERROMPIDO 4
+#define ERRO_VERTICE 5
+
+//------------------------------------------------------------------------------
+// devolve a causa da falha da última operação coberta chamada pelo thread
+// (ERRO_NENHUM se ela não falhou):
+//
+//     - ERRO_MEMORIA: faltou memória
+//     - ERRO_ORCAMENTO: nenhuma estratégia cabe no orçamento (nada foi
+//       alocado)
+//     - ERRO_CIRCUITO: g tem circuito negativo (ou, nos caminhos máximos,
+//       algum circuito)
+//     - ERRO_INTERROMPIDO: o controle de g interrompeu a chamada
+//     - ERRO_VERTICE: o vértice passado não é de g
+//
+// uma operação que falha nunca devolve um resultado parcial
+
+int ultimo_erro(void);
+
+//------------------------------------------------------------------------------
+// define em bytes a memória dos resultados guardados em g (256MB se não
+// definida; 0 não guarda nenhum), descartando os usados há mais tempo
+// quando ela é excedida
+//
+// componentes, arvore_geradora_minima, distancias e diametro (também pelo
+// resumo de percorre_distancias) guardam o resultado, que responde às
+// chamadas seguintes (com uma cópia, no caso dos grafos e das listas) até
+// a próxima alteração de g; os grafos na representação compacta não são
+// guardados. A condensação (fortemente_conexo, subgrafos_fortemente_conexos
+// e ordena) e os componentes de conexo já ficam em g até a alteração, fora
+// desse limite
+
+void define_memoria_resultados(grafo g, size_t bytes);
+
 #endif
@@ -1,83 +1,706 @@
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include "grafo.h"
 
+//------------------------------------------------------------------------------
+// resultados guardados entre os comandos até que o grafo seja alterado;
+// cada resultado tem sua trava, e as estruturas derivadas guardadas em g
+// (a condensação em ordena, scc, alcancavel e fortes) são sincronizadas
+// pela própria biblioteca
+
+enum {
+  ORDENA,
+  SCC,
+  ALCANCAVEL,
+  COMPONENTES,
+  MST,
+  DISTANCIAS,
+  DIAMETRO,
+  CONEXO,
+  DIST,
+  CRITICO,
+  NEGATIVO,
+  FORTES,
+  N_RESULTADOS
+};
+
+struct cache {
+  pthread_rwlock_t trava_grafo;
+  pthread_mutex_t trava[N_RESULTADOS];
+  char *texto[N_RESULTADOS];
+  tabela_distancias tabela;
+};
+
+//------------------------------------------------------------------------------
+// comando de uma sessão; a resposta é escrita em memória pelo thread que
+// executa o comando e enviada pelo escritor da sessão na ordem de chegada
+
+struct tarefa {
+  char *linha;
+  char *resposta;
+  size_t tamanho;
+  int pronta;
+  struct sessao *sessao;
+  struct tarefa *proxima;
+  struct tarefa *proxima_fila;
+};
+
+struct sessao {
+  FILE *saida;
+  pthread_mutex_t trava;
+  pthread_cond_t mudou;
+  struct tarefa *primeira, *ultima;
+  int encerrada;
+};
+
+//------------------------------------------------------------------------------
+// fila de tarefas do conjunto de threads que executam os comandos
+
+struct fila {
+  pthread_mutex_t trava;
+  pthread_cond_t nao_vazia;
+  struct tarefa *primeira, *ultima;
+};
+
+static struct grafo *g;
+static struct cache cache;
+static struct fila fila;
+
+//------------------------------------------------------------------------------
 int nao_destroi_nos(void *p) {
   return 1;
 }
 
 //------------------------------------------------------------------------------
-int main(void) {
-  struct grafo *g, *d, *c;
+static int separa_argumentos(char *linha, char **argumentos, int maximo) {
+  int n;
+
+  /* Separa a linha em palavras, aceitando nomes entre aspas */
+  for(n = 0; n < maximo; ) {
+    while(*linha == ' ' || *linha == '\t' || *linha == '\n' || *linha == '\r') {
+      ++linha;
+    }
+
+    if(*linha == '\0') {
+      break;
+    }
+
+    if(*linha == '"') {
+      argumentos[n++] = ++linha;
+      linha = strchr(linha, '"');
+    } else {
+      argumentos[n++] = linha;
+      linha += strcspn(linha, " \t\n\r");
+    }
+
+    if(linha == NULL || *linha == '\0') {
+      break;
+    }
+
+    *linha++ = '\0';
+  }
+
+  return n;
+}
+
+//------------------------------------------------------------------------------
+static void escreve_resultado(FILE *saida, int resultado) {
+  struct grafo *d;
   struct vertice *v;
   struct no *n;
   lista l;
+  long int comprimento;
 
-  g = le_grafo(stdin);
-  escreve_grafo(stdout, g);
+  switch(resultado) {
+    case ORDENA:
+      if((l = ordena(g)) != NULL) {
+        for(n = primeiro_no(l); n != NULL; n = proximo_no(n)) {
+          v = (struct vertice *) conteudo(n);
+          fprintf(saida, "%s\n", nome_vertice(v));
+        }
 
-  if((l = ordena(g)) != NULL) {
-    for(n = primeiro_no(l); n != NULL; n = proximo_no(n)) {
-      v = (struct vertice *) conteudo(n);
-      fprintf(stdout, "%s\n", nome_vertice(v));
-    }
+        destroi_lista(l, nao_destroi_nos);
+      }
+      break;
+
+    case COMPONENTES:
+      /* Os componentes são escritos a partir de visões de g, sem copiá-los */
+      if((l = subgrafos_componentes(g)) != NULL) {
+        for(n = primeiro_no(l); n != NULL; n = proximo_no(n)) {
+          escreve_subgrafo(saida, (subgrafo) conteudo(n));
+        }
+
+        destroi_lista(l, destroi_subgrafo);
+      }
+      break;
+
+    case FORTES:
+      /* Os componentes fortemente conexos, em ordem topológica */
+      if((l = subgrafos_fortemente_conexos(g)) != NULL) {
+        for(n = primeiro_no(l); n != NULL; n = proximo_no(n)) {
+          escreve_subgrafo(saida, (subgrafo) conteudo(n));
+        }
+
+        destroi_lista(l, destroi_subgrafo);
+      }
+      break;
+
+    case MST:
+      if((d = arvore_geradora_minima(g)) != NULL) {
+        escreve_grafo(saida, d);
+        destroi_grafo(d);
+      }
+      break;
+
+    case DIAMETRO:
+      fprintf(saida, "Diametro = %ld\n", diametro(g));
+      break;
+
+    case CONEXO:
+      fprintf(saida, conexo(g) ? "Conexo!\n" : "Não é conexo!\n");
+      break;
+
+    case SCC:
+      fprintf(saida, fortemente_conexo(g) ? "Fortemente conexo!\n" : "Não é fortemente conexo!\n");
+      break;
+
+    case CRITICO:
+      if((l = caminho_critico(g, &comprimento)) != NULL) {
+        fprintf(saida, "Caminho critico = %ld\n", comprimento);
+
+        for(n = primeiro_no(l); n != NULL; n = proximo_no(n)) {
+          v = (struct vertice *) conteudo(n);
+          fprintf(saida, "%s\n", nome_vertice(v));
+        }
+
+        destroi_lista(l, nao_destroi_nos);
+      } else {
+        fprintf(saida, "erro: o grafo não é direcionado ou tem circuito\n");
+      }
+      break;
 
-    destroi_lista(l, nao_destroi_nos);
+    case NEGATIVO:
+      if((l = circuito_negativo(g)) != NULL) {
+        fprintf(saida, "Circuito negativo:\n");
+
+        for(n = primeiro_no(l); n != NULL; n = proximo_no(n)) {
+          v = (struct vertice *) conteudo(n);
+          fprintf(saida, "%s\n", nome_vertice(v));
+        }
+
+        destroi_lista(l, nao_destroi_nos);
+      } else {
+        fprintf(saida, "Sem circuito negativo\n");
+      }
+      break;
   }
+}
 
-  if((l = componentes(g)) != NULL) {
-    for(n = primeiro_no(l); n != NULL; n = proximo_no(n)) {
-      c = (struct grafo *) conteudo(n);
-      escreve_grafo(stdout, c);
+//------------------------------------------------------------------------------
+static void responde_guardado(FILE *saida, int resultado) {
+  FILE *texto;
+  size_t tamanho;
+
+  /* Calcula o resultado na primeira vez e guarda o texto da resposta */
+  pthread_mutex_lock(&cache.trava[resultado]);
+
+  if(cache.texto[resultado] == NULL) {
+    if((texto = open_memstream(&cache.texto[resultado], &tamanho)) != NULL) {
+      escreve_resultado(texto, resultado);
+      fclose(texto);
     }
+  }
+
+  if(cache.texto[resultado] != NULL) {
+    fputs(cache.texto[resultado], saida);
+  }
+
+  pthread_mutex_unlock(&cache.trava[resultado]);
+}
+
+//------------------------------------------------------------------------------
+static void responde_distancias(FILE *saida) {
+  struct resumo_distancias r;
+  FILE *texto;
+  size_t tamanho;
 
-    destroi_lista(l, destroi_grafo);
+  /* O grafo de distâncias é escrito à medida que as linhas são calculadas,
+     sem ser montado nem guardado, e o diâmetro sai da mesma passada: ele
+     fica guardado para o comando diametro, que não refaz as buscas */
+  r.excentricidade = NULL;
+
+  if(!percorre_distancias(g, saida, &r, 0, NULL)) {
+    return;
   }
 
-  d = arvore_geradora_minima(g);
-  if(d != NULL) {
-    escreve_grafo(stdout, d);
-    destroi_grafo(d);
+  pthread_mutex_lock(&cache.trava[DIAMETRO]);
+
+  if(cache.texto[DIAMETRO] == NULL && (texto = open_memstream(&cache.texto[DIAMETRO], &tamanho)) != NULL) {
+    fprintf(texto, "Diametro = %ld\n", r.diametro);
+    fclose(texto);
   }
 
+  pthread_mutex_unlock(&cache.trava[DIAMETRO]);
+}
 
-  /*
-  d = arborescencia_caminhos_minimos(g, v);
-  if(d != NULL) {
-    escreve_grafo(stdout, d);
-    destroi_grafo(d);
+//------------------------------------------------------------------------------
+static void responde_par(FILE *saida, int resultado, char *nome_u, char *nome_v) {
+  struct vertice *u, *v;
+  long int d;
+
+  if((u = busca_vertice(g, nome_u)) == NULL || (v = busca_vertice(g, nome_v)) == NULL) {
+    fprintf(saida, "erro: vértice inexistente\n");
+    return;
   }
-  */
 
-  d = distancias(g);
-  if(d != NULL) {
-    escreve_grafo(stdout, d);
-    destroi_grafo(d);
+  /* As consultas de alcançabilidade podem ser feitas ao mesmo tempo */
+  if(resultado == ALCANCAVEL) {
+    fprintf(saida, "%d\n", alcancavel(g, u, v));
+    return;
   }
 
-  fprintf(stdout, "Diametro = %ld\n", diametro(g));
+  pthread_mutex_lock(&cache.trava[resultado]);
+
+  /* A tabela de distâncias é calculada uma vez e as consultas seguintes
+     são respondidas sem trava, já que ela só muda com o grafo */
+  if(cache.tabela == NULL) {
+    cache.tabela = calcula_distancias(g);
+  }
 
-  if(conexo(g)) {
-    fprintf(stdout, "Conexo!\n");
+  pthread_mutex_unlock(&cache.trava[resultado]);
+
+  if(cache.tabela == NULL) {
+    fprintf(saida, "erro: memória insuficiente\n");
+  } else if((d = distancia(cache.tabela, u, v)) == infinito) {
+    fprintf(saida, "oo\n");
   } else {
-    fprintf(stdout, "Não é conexo!\n");
+    fprintf(saida, "%ld\n", d);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void descarta_guardados(int mantem_tabela) {
+  int i;
+
+  /* Chamada com o grafo travado para escrita, então ninguém mais usa o cache */
+  for(i = 0; i < N_RESULTADOS; ++i) {
+    free(cache.texto[i]);
+    cache.texto[i] = NULL;
   }
 
-  if(fortemente_conexo(g)) {
-    fprintf(stdout, "Fortemente conexo!\n");
+  if(!mantem_tabela && cache.tabela != NULL) {
+    destroi_tabela_distancias(cache.tabela);
+    cache.tabela = NULL;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void altera(FILE *saida, char *nome_u, char *nome_v, long int peso) {
+  struct vertice *u, *v;
+  int sucesso;
+
+  pthread_rwlock_wrlock(&cache.trava_grafo);
+
+  if((u = busca_vertice(g, nome_u)) == NULL || (v = busca_vertice(g, nome_v)) == NULL) {
+    pthread_rwlock_unlock(&cache.trava_grafo);
+    fprintf(saida, "erro: vértice inexistente\n");
+    return;
+  }
+
+  /* Com a tabela de distâncias calculada, a alteração é feita por ela
+     para que seja reparada em vez de descartada */
+  if(cache.tabela != NULL) {
+    sucesso = atualiza_distancias(cache.tabela, 1, &u, &v, &peso);
+  } else if(peso == infinito) {
+    sucesso = remove_aresta(g, u, v);
   } else {
-    fprintf(stdout, "Não é fortemente conexo!\n");
+    remove_aresta(g, u, v);
+    sucesso = insere_aresta(g, u, v, peso);
+  }
+
+  descarta_guardados(cache.tabela != NULL && sucesso);
+  pthread_rwlock_unlock(&cache.trava_grafo);
+  fprintf(saida, sucesso ? "ok\n" : "erro\n");
+}
+
+//------------------------------------------------------------------------------
+static int alteracao(char *linha) {
+  /* Comandos que alteram o grafo */
+  return strncmp(linha, "insere ", 7) == 0 || strncmp(linha, "remove ", 7) == 0;
+}
+
+//------------------------------------------------------------------------------
+static int encerramento(char *linha) {
+  char *copia, *argumentos[1];
+  int sair;
+
+  /* O comando "sair" inteiro, e não qualquer linha que comece por ele;
+     separa_argumentos altera a linha, que ainda vai para a fila */
+  if((copia = strdup(linha)) == NULL) {
+    return 0;
+  }
+
+  sair = separa_argumentos(copia, argumentos, 1) == 1 && strcmp(argumentos[0], "sair") == 0;
+  free(copia);
+  return sair;
+}
+
+//------------------------------------------------------------------------------
+static void executa_comando(FILE *saida, char *linha) {
+  static const char *nomes[N_RESULTADOS] = { "ordena", "scc", "alcancavel", "componentes", "mst", "distancias", "diametro", "conexo", "dist", "critico", "negativo", "fortes" };
+  char *argumentos[4];
+  int n, i;
+
+  if((n = separa_argumentos(linha, argumentos, 4)) == 0) {
+    return;
+  }
+
+  if(strcmp(argumentos[0], "insere") == 0 && n == 4) {
+    altera(saida, argumentos[1], argumentos[2], atol(argumentos[3]));
+    return;
+  }
+
+  if(strcmp(argumentos[0], "remove") == 0 && n == 3) {
+    altera(saida, argumentos[1], argumentos[2], infinito);
+    return;
   }
 
-  /*if((l_blocos = blocos(g)) != NULL) {
-    fprintf(stderr, "\n--Blocos criados:\n" );
-    for(n = primeiro_no(l); n != NULL; n = proximo_no(n)) {
-      c = (struct grafo *) conteudo(n);
-      escreve_grafo(stdout, c);
+  /* As consultas compartilham o grafo, travado apenas para leitura */
+  pthread_rwlock_rdlock(&cache.trava_grafo);
+
+  if(strcmp(argumentos[0], "escreve") == 0) {
+    escreve_grafo(saida, g);
+  } else if(strcmp(argumentos[0], "estatisticas") == 0) {
+    escreve_estatisticas(saida, g);
+  } else {
+    for(i = 0; i < N_RESULTADOS && strcmp(argumentos[0], nomes[i]) != 0; ++i);
+
+    if(i == N_RESULTADOS) {
+      fprintf(saida, "erro: comando desconhecido %s\n", argumentos[0]);
+    } else if(i == DISTANCIAS) {
+      responde_distancias(saida);
+    } else if(i == DIST || i == ALCANCAVEL) {
+      if(n == 3) {
+        responde_par(saida, i, argumentos[1], argumentos[2]);
+      } else {
+        fprintf(saida, "erro: uso: %s u v\n", nomes[i]);
+      }
+    } else {
+      responde_guardado(saida, i);
     }
+  }
 
-    destroi_lista(l_blocos, destroi_grafo);
-  }*/
+  pthread_rwlock_unlock(&cache.trava_grafo);
+}
 
-  destroi_grafo(g);
+//------------------------------------------------------------------------------
+static void conclui_tarefa(struct tarefa *t) {
+  pthread_mutex_lock(&t->sessao->trava);
+  t->pronta = 1;
+  pthread_cond_broadcast(&t->sessao->mudou);
+  pthread_mutex_unlock(&t->sessao->trava);
+}
+
+//------------------------------------------------------------------------------
+static void *trabalhador(void *p) {
+  struct tarefa *t;
+  FILE *resposta;
+
+  /* Executa as tarefas da fila, escrevendo cada resposta em memória */
+  for(;;) {
+    pthread_mutex_lock(&fila.trava);
+
+    while(fila.primeira == NULL) {
+      pthread_cond_wait(&fila.nao_vazia, &fila.trava);
+    }
+
+    t = fila.primeira;
+    fila.primeira = t->proxima_fila;
+
+    if(fila.primeira == NULL) {
+      fila.ultima = NULL;
+    }
+
+    pthread_mutex_unlock(&fila.trava);
+
+    if((resposta = open_memstream(&t->resposta, &t->tamanho)) != NULL) {
+      executa_comando(resposta, t->linha);
+      fclose(resposta);
+    }
+
+    conclui_tarefa(t);
+  }
+
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void *escritor(void *p) {
+  struct sessao *s;
+  struct tarefa *t;
+
+  s = (struct sessao *) p;
+  pthread_mutex_lock(&s->trava);
+
+  /* Envia as respostas na ordem dos comandos, assim que ficam prontas */
+  for(;;) {
+    while((s->primeira == NULL && !s->encerrada) || (s->primeira != NULL && !s->primeira->pronta)) {
+      pthread_cond_wait(&s->mudou, &s->trava);
+    }
+
+    if((t = s->primeira) == NULL) {
+      break;
+    }
+
+    pthread_mutex_unlock(&s->trava);
+
+    if(t->resposta != NULL) {
+      fwrite(t->resposta, 1, t->tamanho, s->saida);
+    }
+
+    fprintf(s->saida, ".\n");
+    fflush(s->saida);
+
+    pthread_mutex_lock(&s->trava);
+    s->primeira = t->proxima;
+
+    if(s->primeira == NULL) {
+      s->ultima = NULL;
+    }
+
+    pthread_cond_broadcast(&s->mudou);
+    free(t->linha);
+    free(t->resposta);
+    free(t);
+  }
+
+  pthread_mutex_unlock(&s->trava);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void atende(FILE *entrada, FILE *saida) {
+  struct sessao s;
+  struct tarefa *t;
+  pthread_t thread_escritor;
+  FILE *resposta;
+  char *linha = NULL;
+  size_t tamanho = 0;
+  int pronta;
+
+  s.saida = saida;
+  s.primeira = s.ultima = NULL;
+  s.encerrada = 0;
+  pthread_mutex_init(&s.trava, NULL);
+  pthread_cond_init(&s.mudou, NULL);
+  pthread_create(&thread_escritor, NULL, escritor, &s);
+
+  /* Lê os comandos da sessão e os coloca na fila, até "sair" ou o fim da entrada */
+  while(getline(&linha, &tamanho, entrada) != -1 && !encerramento(linha)) {
+    t = (struct tarefa *) calloc(1, sizeof(struct tarefa));
+
+    if(t == NULL || (t->linha = strdup(linha)) == NULL) {
+      free(t);
+      break;
+    }
+
+    t->sessao = &s;
+
+    /* Uma alteração espera as respostas anteriores da sessão e é
+       executada aqui mesmo, antes de ler os próximos comandos */
+    if(alteracao(linha)) {
+      pthread_mutex_lock(&s.trava);
+
+      while(s.primeira != NULL) {
+        pthread_cond_wait(&s.mudou, &s.trava);
+      }
+
+      pthread_mutex_unlock(&s.trava);
+
+      if((resposta = open_memstream(&t->resposta, &t->tamanho)) != NULL) {
+        executa_comando(resposta, t->linha);
+        fclose(resposta);
+      }
+
+      t->pronta = 1;
+    }
+
+    /* Depois de entrar na sessão, uma tarefa pronta pode ser enviada e
+       liberada pelo escritor a qualquer momento: t não é mais lido */
+    pronta = t->pronta;
+    pthread_mutex_lock(&s.trava);
+
+    if(s.ultima != NULL) {
+      s.ultima->proxima = t;
+    } else {
+      s.primeira = t;
+    }
+
+    s.ultima = t;
+    pthread_cond_broadcast(&s.mudou);
+    pthread_mutex_unlock(&s.trava);
+
+    if(!pronta) {
+      pthread_mutex_lock(&fila.trava);
+
+      if(fila.ultima != NULL) {
+        fila.ultima->proxima_fila = t;
+      } else {
+        fila.primeira = t;
+      }
+
+      fila.ultima = t;
+      pthread_cond_signal(&fila.nao_vazia);
+      pthread_mutex_unlock(&fila.trava);
+    }
+  }
+
+  /* Espera o escritor enviar todas as respostas pendentes */
+  pthread_mutex_lock(&s.trava);
+  s.encerrada = 1;
+  pthread_cond_broadcast(&s.mudou);
+  pthread_mutex_unlock(&s.trava);
+  pthread_join(thread_escritor, NULL);
+
+  pthread_mutex_destroy(&s.trava);
+  pthread_cond_destroy(&s.mudou);
+  free(linha);
+}
+
+//------------------------------------------------------------------------------
+static void *atende_conexao(void *p) {
+  FILE *entrada, *saida;
+  int conexao;
+
+  conexao = (int) (long) p;
+  entrada = fdopen(conexao, "r");
+  saida = fdopen(dup(conexao), "w");
+
+  if(entrada != NULL && saida != NULL) {
+    atende(entrada, saida);
+  }
+
+  if(entrada != NULL) {
+    fclose(entrada);
+  }
+
+  if(saida != NULL) {
+    fclose(saida);
+  }
+
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static int serve(char *caminho) {
+  struct sockaddr_un endereco;
+  pthread_t thread;
+  int servidor, conexao;
+
+  servidor = socket(AF_UNIX, SOCK_STREAM, 0);
+  memset(&endereco, 0, sizeof(endereco));
+  endereco.sun_family = AF_UNIX;
+  strncpy(endereco.sun_path, caminho, sizeof(endereco.sun_path) - 1);
+  unlink(caminho);
+
+  if(servidor < 0 || bind(servidor, (struct sockaddr *) &endereco, sizeof(endereco)) < 0 || listen(servidor, 16) < 0) {
+    perror(caminho);
+    return 1;
+  }
+
+  /* Cada conexão é uma sessão, atendida por seu próprio thread */
+  while((conexao = accept(servidor, NULL, NULL)) >= 0) {
+    if(pthread_create(&thread, NULL, atende_conexao, (void *) (long) conexao) == 0) {
+      pthread_detach(thread);
+    } else {
+      close(conexao);
+    }
+  }
+
+  close(servidor);
   return 0;
 }
+
+//------------------------------------------------------------------------------
+// uso: main < grafo.dot
+//          lê o grafo e escreve o resultado de todas as funções
+//
+//      main grafo.dot [-s caminho]
+//          lê o grafo uma única vez e responde aos comandos lidos da
+//          entrada padrão (ou de cada conexão no socket UNIX caminho),
+//          um por linha, terminando cada resposta com uma linha "."
+//
+// comandos: escreve, ordena, componentes, mst, distancias, diametro,
+//           conexo, scc, fortes, critico, negativo, dist u v,
+//           alcancavel u v, insere u v peso, remove u v, estatisticas, sair
+
+int main(int argc, char *argv[]) {
+  static char *todos[] = { "escreve", "ordena", "componentes", "mst", "distancias", "diametro", "conexo", "scc" };
+  pthread_t thread;
+  FILE *entrada;
+  char linha[32];
+  long int i, n_threads;
+  int retorno = 0;
+
+  /* Sem argumentos, mantém o comportamento original: lê o grafo da
+     entrada padrão e executa todos os comandos em sequência */
+  if(argc < 2) {
+    if((g = le_grafo(stdin)) == NULL) {
+      return 1;
+    }
+
+    pthread_rwlock_init(&cache.trava_grafo, NULL);
+
+    for(i = 0; i < N_RESULTADOS; ++i) {
+      pthread_mutex_init(&cache.trava[i], NULL);
+    }
+
+    for(i = 0; i < (long int) (sizeof(todos) / sizeof(todos[0])); ++i) {
+      strcpy(linha, todos[i]);
+      executa_comando(stdout, linha);
+    }
+
+    descarta_guardados(0);
+    destroi_grafo(g);
+    return 0;
+  }
+
+  if((entrada = fopen(argv[1], "r")) == NULL || (g = le_grafo(entrada)) == NULL) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  fclose(entrada);
+
+  pthread_rwlock_init(&cache.trava_grafo, NULL);
+
+  for(i = 0; i < N_RESULTADOS; ++i) {
+    pthread_mutex_init(&cache.trava[i], NULL);
+  }
+
+  pthread_mutex_init(&fila.trava, NULL);
+  pthread_cond_init(&fila.nao_vazia, NULL);
+
+  /* Um thread trabalhador por processador */
+  n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+  for(i = 0; i < ((n_threads > 0) ? n_threads : 1); ++i) {
+    if(pthread_create(&thread, NULL, trabalhador, NULL) == 0) {
+      pthread_detach(thread);
+    }
+  }
+
+  if(argc > 3 && strcmp(argv[2], "-s") == 0) {
+    retorno = serve(argv[3]);
+  } else {
+    atende(stdin, stdout);
+  }
+
+  descarta_guardados(0);
+  destroi_grafo(g);
+  return retorno;
+}